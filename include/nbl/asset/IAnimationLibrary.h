@@ -9,6 +9,7 @@
 
 #include "nbl/core/declarations.h"
 #include "nbl/asset/utils/CQuantQuaternionCache.h"
+#include "nbl/asset/format/decodePixels.h"
 
 namespace nbl
 {
@@ -50,6 +51,18 @@ class IAnimationLibrary : public virtual core::IReferenceCounted
 					auto q = core::normalize(core::vectorSIMDf(out[0],out[1],out[2],out[3]));
 					return reinterpret_cast<const core::quaternion*>(&q)[0];
 				}
+				//! Cheap SNORM8 decode without the `decodePixels` round-trip, result is NOT normalized (fine for nlerp)
+				inline core::vectorSIMDf getRotationUnnormalized() const
+				{
+					const auto* raw = reinterpret_cast<const int8_t*>(&quat);
+					const core::vectorSIMDf q(raw[0],raw[1],raw[2],raw[3]);
+					return core::max(q/127.f,core::vectorSIMDf(-1.f));
+				}
+
+				inline core::vectorSIMDf getTranslation() const
+				{
+					return core::vectorSIMDf(translation[0],translation[1],translation[2],0.f);
+				}
 
 				inline core::vectorSIMDf getScale() const
 				{
@@ -96,7 +109,7 @@ class IAnimationLibrary : public virtual core::IReferenceCounted
 				}
 				inline E_INTERPOLATION_MODE getInterpolationMode() const
 				{
-					return data[1]&EIM_MASK;
+					return static_cast<E_INTERPOLATION_MODE>(data[1]&EIM_MASK);
 				}
 
 			private:
@@ -7,6 +7,7 @@
 
 #include <array>
 #include <ostream>
+#include <span>
 
 #include "nbl/core/declarations.h"
 #include "nbl/system/path.h"
@@ -53,9 +54,9 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
 
     public:
 #ifdef USE_MAPS_FOR_PATH_BASED_CACHE
-        using AssetCacheType = core::CConcurrentMultiObjectCache<std::string, SAssetBundle, std::multimap>;
+        using AssetCacheType = core::CConcurrentMultiObjectCache<system::CPathTable::SHandle, SAssetBundle, std::multimap>;
 #else
-        using AssetCacheType = core::CConcurrentMultiObjectCache<std::string, IAssetBundle, std::vector>;
+        using AssetCacheType = core::CConcurrentMultiObjectCache<system::CPathTable::SHandle, IAssetBundle, std::vector>;
 #endif //USE_MAPS_FOR_PATH_BASED_CACHE
 
         using CpuGpuCacheType = core::CConcurrentObjectCache<const IAsset*, core::smart_refctd_ptr<core::IReferenceCounted> >;
@@ -409,6 +410,44 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
             return getAsset(_file, _supposedFilename, _params, &m_defaultLoaderOverride);
         }
 
+        //! Offloads a blocking `getAsset` onto `_scheduler` and returns a coroutine which an awaiting coroutine can suspend on meanwhile.
+        /** Only the caller gets to suspend: the load itself still blocks the worker running it, the loaders wait on their file reads and
+        hierarchical loads (a loader requesting dependencies through its override, e.g. mesh -> MTL -> textures) happen inline on that same worker.
+        Several loads can be in flight at once: `start()` each coroutine, then `co_await` (or `get()`) them one by one, or just `co_await system::when_all(...)`,
+        but each of them occupies one worker until done. */
+        system::coroutine_t<SAssetBundle> offloadGetAsset(std::string _filename, IAssetLoader::SAssetLoadParams _params, system::CTaskScheduler* _scheduler, IAssetLoader::IAssetLoaderOverride* _override=nullptr)
+        {
+            // the parameters got copied into the coroutine frame, so the caller's may already be gone
+            co_await system::resumeOn(_scheduler);
+            co_return getAsset(_filename, _params, _override ? _override:&m_defaultLoaderOverride);
+        }
+
+        //! Loads all of `_filenames` concurrently on `_scheduler`, the bundles come back in the same order (empty for the loads which failed).
+        /** Meant for atlas builds and the like, where lots of small images would otherwise decode one after another.
+        The scheduler also gets passed to the loaders through `SAssetLoadParams::scheduler`, so that big images can split their own decoding.
+        With a null `_scheduler` the files get loaded one after another on the calling thread. */
+        core::vector<SAssetBundle> getAssets(std::span<const std::string> _filenames, const IAssetLoader::SAssetLoadParams& _params, system::CTaskScheduler* _scheduler, IAssetLoader::IAssetLoaderOverride* _override=nullptr)
+        {
+            IAssetLoader::SAssetLoadParams params(_params);
+            params.scheduler = _scheduler;
+            if (!_override)
+                _override = &m_defaultLoaderOverride;
+
+            core::vector<SAssetBundle> retval(_filenames.size());
+            if (!_scheduler)
+            {
+                for (size_t i=0u; i<_filenames.size(); i++)
+                    retval[i] = getAsset(_filenames[i],params,_override);
+                return retval;
+            }
+            _scheduler->parallel_for(0u,_filenames.size(),1u,[&](const size_t begin, const size_t end) -> void
+            {
+                for (size_t i=begin; i<end; i++)
+                    retval[i] = getAsset(_filenames[i],params,_override);
+            });
+            return retval;
+        }
+
         SAssetBundle getAssetWholeBundleRestore(const std::string& _filename, const IAssetLoader::SAssetLoadParams& _params, IAssetLoader::IAssetLoaderOverride* _override)
         {
             return getAssetInHierarchyWholeBundleRestore(_filename, _params, 0u, _override);
@@ -454,6 +493,10 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
         {
             size_t availableSize = _inOutStorageSize;
             _inOutStorageSize = 0u;
+            // a key that was never interned can't be in any cache
+            const auto key = system::CPathTable::get().find(_key);
+            if (!key.isValid())
+                return true;
             bool res = true;
             if (_types)
             {
@@ -462,7 +505,7 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
                 {
                     uint32_t typeIx = IAsset::typeFlagToIndex(_types[i]);
                     size_t readCnt = availableSize;
-                    res = m_assetCache[typeIx]->findAndStoreRange(_key, readCnt, _out);
+                    res = m_assetCache[typeIx]->findAndStoreRange(key, readCnt, _out);
                     availableSize -= readCnt;
                     _inOutStorageSize += readCnt;
                     _out += readCnt;
@@ -474,7 +517,7 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
                 for (uint32_t typeIx = 0u; typeIx < IAsset::ET_STANDARD_TYPES_COUNT; ++typeIx)
                 {
                     size_t readCnt = availableSize;
-                    res = m_assetCache[typeIx]->findAndStoreRange(_key, readCnt, _out);
+                    res = m_assetCache[typeIx]->findAndStoreRange(key, readCnt, _out);
                     availableSize -= readCnt;
                     _inOutStorageSize += readCnt;
                     _out += readCnt;
@@ -510,11 +553,21 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
         }
 
         //! Changes the lookup key
+        /** The keys get interned in the process wide `system::CPathTable` and are never freed, even once no asset uses them anymore.
+        If the key can't be interned (full `system::CPathTable`) the bundle is left with an invalid key, which takes it out of the cache and keeps it from getting inserted. */
         //TODO change name
         inline void changeAssetKey(SAssetBundle& _asset, const std::string& _newKey)
         {
-            _asset.setNewCacheKey(_newKey);
-            m_assetCache[IAsset::typeFlagToIndex(_asset.getAssetType())]->changeObjectKey(_asset, _asset.getCacheKey(), _newKey);
+            const auto oldKey = _asset.getCacheKeyHandle();
+            const auto newKey = system::CPathTable::get().intern(_newKey);
+            if (!newKey.isValid())
+            {
+                removeAssetFromCache(_asset);
+                _asset.setNewCacheKey(newKey);
+                return;
+            }
+            _asset.setNewCacheKey(newKey);
+            m_assetCache[IAsset::typeFlagToIndex(_asset.getAssetType())]->changeObjectKey(_asset, oldKey, newKey);
         }
 
         //! Insert an asset into the cache (calls the private methods of IAsset behind the scenes)
@@ -524,18 +577,23 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
         //TODO change name
         bool insertAssetIntoCache(SAssetBundle& _asset, IAsset::E_MUTABILITY _mutability = IAsset::EM_CPU_PERSISTENT)
         {
+            // the key couldn't be interned, see `changeAssetKey`
+            if (!_asset.getCacheKeyHandle().isValid())
+                return false;
             const uint32_t ix = IAsset::typeFlagToIndex(_asset.getAssetType());
             for (auto ass : _asset.getContents())
                 setAssetMutability(ass.get(), _mutability);
-            return m_assetCache[ix]->insert(_asset.getCacheKey(), _asset);
+            return m_assetCache[ix]->insert(_asset.getCacheKeyHandle(), _asset);
         }
 
         //! Remove an asset from cache (calls the private methods of IAsset behind the scenes)
         //TODO change key
         bool removeAssetFromCache(SAssetBundle& _asset) //will actually look up by asset's key instead
         {
+            if (!_asset.getCacheKeyHandle().isValid())
+                return false;
             const uint32_t ix = IAsset::typeFlagToIndex(_asset.getAssetType());
-            return m_assetCache[ix]->removeObject(_asset, _asset.getCacheKey());
+            return m_assetCache[ix]->removeObject(_asset, _asset.getCacheKeyHandle());
         }
 
         //! Removes all assets from the specified caches, all caches by default
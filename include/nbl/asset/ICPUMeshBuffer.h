@@ -12,6 +12,7 @@
 #include "nbl/asset/bawformat/BlobSerializable.h"
 #include "nbl/asset/format/decodePixels.h"
 #include "nbl/asset/format/encodePixels.h"
+#include "nbl/asset/format/convertAttributesSoA.h"
 
 namespace nbl::asset
 {
@@ -618,6 +619,60 @@ class ICPUMeshBuffer final : public IMeshBuffer<ICPUBuffer,ICPUDescriptorSet,ICP
             return setAttribute(_input, dst, getAttribFormat(attrId));
         }
 
+        //! Batch version of `getAttribute(core::vectorSIMDf&,uint32_t,size_t)`, decodes vertices `[firstVertex,firstVertex+count)` into Structure-of-Arrays form.
+        /** The format gets resolved once for the whole range and common vertex formats go through dedicated SIMD kernels (see `decodeAttributesSoA`),
+        the rest falls back to per-vertex decoding.
+        @param[out] soaOut 4 arrays of `count` floats, component `c` of the `i`th vertex goes to `soaOut[c*count+i]`. Missing components are (0,0,0,1).
+        @returns false if the range does not fit in the bound buffer or the format cannot be decoded to floats.
+        */
+        inline bool getAttributes(uint32_t attrId, size_t firstVertex, size_t count, float* soaOut) const
+        {
+            const uint8_t* src = getAttribRangePointer(attrId,firstVertex,count);
+            if (!src)
+                return false;
+
+            const E_FORMAT format = getAttribFormat(attrId);
+            const uint32_t stride = getAttribStride(attrId);
+            if (decodeAttributesSoA(format,src,stride,count,soaOut))
+                return true;
+
+            core::vectorSIMDf tmp;
+            for (size_t i=0u; i<count; i++,src+=stride)
+            {
+                tmp.set(0.f,0.f,0.f,1.f);
+                if (!getAttribute(tmp,src,format))
+                    return false;
+                for (uint32_t c=0u; c<4u; c++)
+                    soaOut[c*count+i] = tmp[c];
+            }
+            return true;
+        }
+
+        //! Batch version of `setAttribute(core::vectorSIMDf,uint32_t,size_t)`, encodes vertices `[firstVertex,firstVertex+count)` from Structure-of-Arrays form.
+        /** @param[in] soaIn 4 arrays of `count` floats laid out the same as for `getAttributes`, components the format lacks are ignored.
+        @returns false if the range does not fit in the bound buffer or the format cannot be encoded from floats.
+        */
+        inline bool setAttributes(uint32_t attrId, size_t firstVertex, size_t count, const float* soaIn)
+        {
+            assert(!isImmutable_debug());
+            uint8_t* dst = const_cast<uint8_t*>(getAttribRangePointer(attrId,firstVertex,count));
+            if (!dst)
+                return false;
+
+            const E_FORMAT format = getAttribFormat(attrId);
+            const uint32_t stride = getAttribStride(attrId);
+            if (encodeAttributesSoA(format,dst,stride,count,soaIn))
+                return true;
+
+            for (size_t i=0u; i<count; i++,dst+=stride)
+            {
+                const core::vectorSIMDf tmp(soaIn[i],soaIn[count+i],soaIn[2u*count+i],soaIn[3u*count+i]);
+                if (!setAttribute(tmp,dst,format))
+                    return false;
+            }
+            return true;
+        }
+
         //!
         inline const core::matrix3x4SIMD* getInverseBindPoses() const
         {
@@ -715,6 +770,25 @@ class ICPUMeshBuffer final : public IMeshBuffer<ICPUBuffer,ICPUDescriptorSet,ICP
         }
 
     protected:
+        //! start of the `firstVertex`th vertex, or nullptr if the whole range doesn't fit in the bound buffer
+        inline const uint8_t* getAttribRangePointer(uint32_t attrId, size_t firstVertex, size_t count) const
+        {
+            if (!m_pipeline || !isAttributeEnabled(attrId))
+                return nullptr;
+
+            const uint8_t* src = getAttribPointer(attrId);
+            const ICPUBuffer* buf = getAttribBoundBuffer(attrId).buffer.get();
+            if (!src || !buf)
+                return nullptr;
+
+            const size_t stride = getAttribStride(attrId);
+            src += firstVertex*stride;
+            const uint8_t* bufEnd = reinterpret_cast<const uint8_t*>(buf->getPointer())+buf->getSize();
+            if (count && src+(count-1u)*stride+getTexelOrBlockBytesize(getAttribFormat(attrId))>bufEnd)
+                return nullptr;
+            return src;
+        }
+
         void restoreFromDummy_impl(IAsset* _other, uint32_t _levelsBelow) override
         {
             auto* other = static_cast<ICPUMeshBuffer*>(_other);
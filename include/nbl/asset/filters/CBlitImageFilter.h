@@ -39,6 +39,7 @@ class CBlitImageFilterBase : public impl::CSwizzleableAndDitherableFilterBase<Sw
 				IBlitUtilities::E_ALPHA_SEMANTIC	alphaSemantic = IBlitUtilities::EAS_NONE_OR_PREMULTIPLIED;
 				double								alphaRefValue = 0.5; // only required to make sense if `alphaSemantic==EAS_REFERENCE_OR_COVERAGE`
 				uint32_t							alphaChannel = 3u; // index of the alpha channel (could be different cause of swizzles)
+				IBlitUtilities::E_INTERMEDIATE_PRECISION	intermediatePrecision = IBlitUtilities::EIP_AUTO;
 		};
 
 	protected:
@@ -68,6 +69,9 @@ class CBlitImageFilterBase : public impl::CSwizzleableAndDitherableFilterBase<Sw
 			if (state->alphaChannel>=4)
 				return false;
 
+			if (state->intermediatePrecision>=IBlitUtilities::EIP_COUNT)
+				return false;
+
 			if (!impl::CSwizzleableAndDitherableFilterBase<Swizzle,Dither,Normalization,Clamp>::validate(state))
 				return false;
 
@@ -300,6 +304,21 @@ class CBlitImageFilter :
 			return (kernelX.validate(state->inImage, state->outImage) && kernelY.validate(state->inImage, state->outImage) && kernelZ.validate(state->inImage, state->outImage));
 		}
 
+		//! Whether `execute` will convolve in `double` instead of `float`
+		static inline bool usesDoubleIntermediates(const state_type* state)
+		{
+			switch (state->intermediatePrecision)
+			{
+				case IBlitUtilities::EIP_FLOAT:
+					return false;
+				case IBlitUtilities::EIP_DOUBLE:
+					return true;
+				default:
+					return IBlitUtilities::needsDoubleIntermediates(state->inImage->getCreationParameters().format)||
+						IBlitUtilities::needsDoubleIntermediates(state->outImage->getCreationParameters().format);
+			}
+		}
+
 		// CBlitUtilities::computeScaledKernelPhasedLUT stores the kernel entries, in the LUT, in reverse, which are then forward iterated to compute the CONVOLUTION.
 		template<class ExecutionPolicy>
 		static inline bool execute(ExecutionPolicy&& policy, state_type* state)
@@ -307,6 +326,20 @@ class CBlitImageFilter :
 			if (!validate(state))
 				return false;
 
+			// the scratch is sized for `double`, a `float` blit only touches half of it
+			if (usesDoubleIntermediates(state))
+				return execute_impl<value_t>(policy,state);
+			return execute_impl<float>(policy,state);
+		}
+		static inline bool execute(state_type* state)
+		{
+			return execute(core::execution::seq,state);
+		}
+
+	private:
+		template<typename intermediate_t, class ExecutionPolicy>
+		static inline bool execute_impl(ExecutionPolicy&& policy, state_type* state)
+		{
 			// load all the state
 			const auto* const inImg = state->inImage;
 			auto* const outImg = state->outImage;
@@ -356,10 +389,10 @@ class CBlitImageFilter :
 				intermediateExtent[1]-core::vectorSIMDi32(1,1,1,0),
 				intermediateExtent[2]-core::vectorSIMDi32(1,1,1,0)
 			};
-			value_t* const intermediateStorage[3] = {
-				reinterpret_cast<value_t*>(state->scratchMemory + getScratchOffset(state, ESU_BLIT_X_AXIS_WRITE)),
-				reinterpret_cast<value_t*>(state->scratchMemory + getScratchOffset(state, ESU_BLIT_Y_AXIS_WRITE)),
-				reinterpret_cast<value_t*>(state->scratchMemory + getScratchOffset(state, ESU_BLIT_Z_AXIS_WRITE))
+			intermediate_t* const intermediateStorage[3] = {
+				reinterpret_cast<intermediate_t*>(state->scratchMemory + getScratchOffset(state, ESU_BLIT_X_AXIS_WRITE)),
+				reinterpret_cast<intermediate_t*>(state->scratchMemory + getScratchOffset(state, ESU_BLIT_Y_AXIS_WRITE)),
+				reinterpret_cast<intermediate_t*>(state->scratchMemory + getScratchOffset(state, ESU_BLIT_Z_AXIS_WRITE))
 			};
 			const core::vectorSIMDu32 intermediateStrides[3] = {
 				core::vectorSIMDu32(ChannelCount*intermediateExtent[0].y,ChannelCount,ChannelCount*intermediateExtent[0].x*intermediateExtent[0].y,0u),
@@ -368,8 +401,10 @@ class CBlitImageFilter :
 			};
 			// storage
 			core::RandomSampler sampler(std::chrono::high_resolution_clock::now().time_since_epoch().count());
-			auto storeToTexel = [state,nonPremultBlendSemantic,alphaChannel,outFormat](value_t* const sample, void* const dstPix, const core::vectorSIMDu32& localOutPos) -> void
+			auto storeToTexel = [state,nonPremultBlendSemantic,alphaChannel,outFormat](const auto* const intermediate, void* const dstPix, const core::vectorSIMDu32& localOutPos) -> void
 			{
+				value_t sample[ChannelCount];
+				std::copy_n(intermediate,ChannelCount,sample);
 				if (nonPremultBlendSemantic && sample[alphaChannel]>FLT_MIN*1024.0*512.0)
 				{
 					for (auto i=0; i<ChannelCount; i++)
@@ -401,9 +436,9 @@ class CBlitImageFilter :
 
 					struct DummyTexelType
 					{
-						double texel[ChannelCount];
+						intermediate_t texel[ChannelCount];
 					};
-					std::for_each(policy, reinterpret_cast<DummyTexelType*>(intermediateStorage[axis]), reinterpret_cast<DummyTexelType*>(intermediateStorage[axis] + outputTexelCount*ChannelCount), [&sampler, outFormat, &histograms, &scratchHelper, alphaChannel, state](const DummyTexelType& dummyTexel)
+					core::for_each(policy, reinterpret_cast<DummyTexelType*>(intermediateStorage[axis]), reinterpret_cast<DummyTexelType*>(intermediateStorage[axis] + outputTexelCount*ChannelCount), [&sampler, outFormat, &histograms, &scratchHelper, alphaChannel, state](const DummyTexelType& dummyTexel)
 					{
 						const uint32_t index = scratchHelper.template alloc<is_seq_policy_v>();
 
@@ -507,14 +542,14 @@ class CBlitImageFilter :
 					CBasicImageFilterCommon::BlockIterator<batch_dims> begin(batchExtent);
 					const uint32_t spaceFillingEnd[batch_dims] = {0u,batchExtent[1]};
 					CBasicImageFilterCommon::BlockIterator<batch_dims> end(begin.getExtentBatches(),spaceFillingEnd);
-					std::for_each(policy,begin,end,[&](const std::array<uint32_t,batch_dims>& batchCoord) -> void
+					core::for_each(policy,begin,end,[&](const std::array<uint32_t,batch_dims>& batchCoord) -> void
 					{
 						constexpr bool is_seq_policy_v = std::is_same_v<std::remove_reference_t<ExecutionPolicy>, core::execution::sequenced_policy>;
 
 						// we need some tmp memory for threads in the first pass so that they dont step on each other
 						uint32_t decode_offset;
 						// whole line plus window borders
-						value_t* lineBuffer;
+						intermediate_t* lineBuffer;
 						core::vectorSIMDi32 localTexCoord(0);
 						localTexCoord[loopCoordID[0]] = batchCoord[0];
 						localTexCoord[loopCoordID[1]] = batchCoord[1];
@@ -539,8 +574,7 @@ class CBlitImageFilter :
 								if (!srcPix[0])
 									continue;
 
-								auto sample = lineBuffer+i*ChannelCount;
-
+								value_t sample[ChannelCount];
 								base_t::template onDecode(inFormat, state, srcPix, sample, blockLocalTexelCoord.x, blockLocalTexelCoord.y, ChannelCount);
 
 								if (nonPremultBlendSemantic)
@@ -555,20 +589,10 @@ class CBlitImageFilter :
 										cvg_num++;
 									cvg_den++;
 								}
+								std::copy_n(sample,ChannelCount,lineBuffer+i*ChannelCount);
 							}
 						}
 
-						auto getWeightedSample = [scaledKernelPhasedLUTPixel, windowSize, lineBuffer, &windowMinCoord, axis](const auto& windowCoord, const auto phaseIndex, const auto windowPixel, const auto channel) -> value_t
-						{
-							value_t kernelWeight;
-							if constexpr (std::is_same_v<lut_value_t, uint16_t>)
-								kernelWeight = value_t(core::Float16Compressor::decompress(scaledKernelPhasedLUTPixel[axis][(phaseIndex * windowSize + windowPixel) * ChannelCount + channel]));
-							else
-								kernelWeight = scaledKernelPhasedLUTPixel[axis][(phaseIndex * windowSize + windowPixel) * ChannelCount + channel];
-
-							return kernelWeight * lineBuffer[(windowCoord - windowMinCoord[axis]) * ChannelCount + channel];
-						};
-
 						uint32_t phaseIndex = 0;
 						// TODO: this loop should probably get rewritten
 						for (auto& i=(localTexCoord[axis]=0); i<outExtentLayerCount[axis]; i++)
@@ -578,18 +602,8 @@ class CBlitImageFilter :
 
 							// do the filtering
 							float tmp = float(i)+0.5f;
-							int32_t windowCoord = kernel.getWindowMinCoord(tmp*fScale[axis], tmp);
-
-							for (auto ch = 0; ch < ChannelCount; ++ch)
-								value[ch] = getWeightedSample(windowCoord, phaseIndex, 0, ch);
-
-							for (auto h=1; h<windowSize; h++)
-							{
-								windowCoord++;
-
-								for (auto ch = 0; ch < ChannelCount; ch++)
-									value[ch] += getWeightedSample(windowCoord, phaseIndex, h, ch);
-							}
+							const int32_t windowCoord = kernel.getWindowMinCoord(tmp*fScale[axis], tmp);
+							convolve(value,scaledKernelPhasedLUTPixel[axis]+phaseIndex*windowSize*ChannelCount,lineBuffer+(windowCoord-windowMinCoord[axis])*ChannelCount,windowSize);
 							if (lastPass)
 							{
 								const core::vectorSIMDu32 localOutPos = localTexCoord+outOffsetBaseLayer+vLayer;
@@ -622,12 +636,47 @@ class CBlitImageFilter :
 			}
 			return true;
 		}
-		static inline bool execute(state_type* state)
+
+		//! `out[c] = sum_h weights[h*ChannelCount+c]*samples[h*ChannelCount+c]`, the LUT and the line buffer both store a whole tap contiguously
+		template<typename intermediate_t>
+		static inline void convolve(intermediate_t* const out, const lut_value_t* const weights, const intermediate_t* const samples, const int32_t windowSize)
 		{
-			return execute(core::execution::seq,state);
+			if constexpr (std::is_same_v<intermediate_t,float> && std::is_same_v<lut_value_t,float> && ChannelCount==4u)
+			{
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+				// two taps per FMA, then fold the halves
+				__m256 acc2 = _mm256_setzero_ps();
+				int32_t h = 0;
+				for (; h+2<=windowSize; h+=2)
+					acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(weights+h*4),_mm256_loadu_ps(samples+h*4),acc2);
+				__m128 acc = _mm_add_ps(_mm256_castps256_ps128(acc2),_mm256_extractf128_ps(acc2,1));
+				if (h<windowSize)
+					acc = _mm_fmadd_ps(_mm_loadu_ps(weights+h*4),_mm_loadu_ps(samples+h*4),acc);
+				_mm_storeu_ps(out,acc);
+				return;
+#elif defined(__NBL_COMPILE_WITH_X86_SIMD_)
+				__m128 acc = _mm_setzero_ps();
+				for (int32_t h=0; h<windowSize; h++)
+					acc = _mm_add_ps(acc,_mm_mul_ps(_mm_loadu_ps(weights+h*4),_mm_loadu_ps(samples+h*4)));
+				_mm_storeu_ps(out,acc);
+				return;
+#endif
+			}
+
+			auto getWeight = [weights](const int32_t ix) -> intermediate_t
+			{
+				if constexpr (std::is_same_v<lut_value_t,uint16_t>)
+					return intermediate_t(core::Float16Compressor::decompress(weights[ix]));
+				else
+					return intermediate_t(weights[ix]);
+			};
+			for (auto ch=0; ch<ChannelCount; ch++)
+				out[ch] = getWeight(ch)*samples[ch];
+			for (int32_t h=1; h<windowSize; h++)
+			for (auto ch=0; ch<ChannelCount; ch++)
+				out[ch] += getWeight(h*ChannelCount+ch)*samples[h*ChannelCount+ch];
 		}
 
-	private:
 		static inline constexpr uint32_t VectorizationBoundSTL = /*AVX2*/16u;
 		static inline const uint32_t m_maxParallelism = std::thread::hardware_concurrency() * VectorizationBoundSTL;
 
@@ -27,6 +27,24 @@ public:
 		EAS_COUNT
 	};
 
+	//! Precision of the scratch the blit convolves in, decoding and encoding always happen in `double`
+	enum E_INTERMEDIATE_PRECISION : uint32_t
+	{
+		EIP_AUTO = 0u, // `float` unless `needsDoubleIntermediates` is true for the input or output format
+		EIP_FLOAT, // half the scratch traffic and SIMD convolution, within 1 code unit of the `double` result for formats with up to 16 bits per channel
+		EIP_DOUBLE, // the reference path
+		EIP_COUNT
+	};
+
+	//! A `float` mantissa can't hold 32-bit integer channels exactly, nor keep the full precision of 32-bit float (HDR) ones through several passes
+	static inline bool needsDoubleIntermediates(const E_FORMAT format)
+	{
+		// nothing compressed has more than 16 bits per channel
+		if (isBlockCompressionFormat(format))
+			return false;
+		return getTexelOrBlockBytesize(format)>=getFormatChannelCount(format)*4u;
+	}
+
 	static inline core::vectorSIMDu32 getPhaseCount(const core::vectorSIMDu32& inExtent, const core::vectorSIMDu32& outExtent, const IImage::E_TYPE inImageType)
 	{
 		core::vectorSIMDu32 result(0u);
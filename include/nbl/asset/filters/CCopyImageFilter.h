@@ -61,14 +61,14 @@ class CCopyImageFilter : public CImageFilter<CCopyImageFilter>, public CMatchedS
 			{
 				assert(getTexelOrBlockBytesize(commonExecuteData.inFormat)==getTexelOrBlockBytesize(commonExecuteData.outFormat)); // if this asserts the API got broken during an update or something
 
-				const auto blockDims = asset::getBlockDimensions(commonExecuteData.inFormat);
-				auto copy = [&commonExecuteData,&blockDims](uint32_t readBlockArrayOffset, core::vectorSIMDu32 readBlockPos) -> void
+				// rows of blocks are contiguous in both the input and output buffers
+				auto copy = [&commonExecuteData](uint32_t readRowArrayOffset, core::vectorSIMDu32 readBlockPos, uint32_t blockCount) -> void
 				{
 					const auto localOutPos = readBlockPos+commonExecuteData.offsetDifferenceInBlocks;
 					const auto writeOffset = commonExecuteData.oit->getByteOffset(localOutPos,commonExecuteData.outByteStrides);
-					memcpy(commonExecuteData.outData+writeOffset,commonExecuteData.inData+readBlockArrayOffset,commonExecuteData.outBlockByteSize);
+					memcpy(commonExecuteData.outData+writeOffset,commonExecuteData.inData+readRowArrayOffset,size_t(commonExecuteData.outBlockByteSize)*blockCount);
 				};
-				CBasicImageFilterCommon::executePerRegion<ExecutionPolicy>(policy,commonExecuteData.inImg,copy,commonExecuteData.inRegions.begin(),commonExecuteData.inRegions.end(),clip);
+				CBasicImageFilterCommon::executePerRegionPerRow<ExecutionPolicy>(policy,commonExecuteData.inImg,copy,commonExecuteData.inRegions.begin(),commonExecuteData.inRegions.end(),clip);
 
 				return true;
 			};
@@ -45,14 +45,14 @@ class CFillImageFilter : public CImageFilter<CFillImageFilter>
 			auto* img = state->outImage;
 			const auto& params = img->getCreationParameters();
 			const IImageFilter::IState::ColorValue::WriteMemoryInfo info(params.format,img->getBuffer()->getPointer());
-			// do the per-pixel filling
-			auto fill = [state,&info](uint32_t blockArrayOffset, core::vectorSIMDu32 unusedVariable) -> void
+			// fill whole spans of blocks at once
+			auto fill = [state,&info](uint32_t spanArrayOffset, core::vectorSIMDu32 unusedVariable, uint32_t blockCount) -> void
 			{
-				state->fillValue.writeMemory(info,blockArrayOffset);
+				CBasicImageFilterCommon::replicateBlock(info.outMemory+spanArrayOffset,state->fillValue.pointer,info.blockByteSize,blockCount);
 			};
 			CBasicImageFilterCommon::clip_region_functor_t clip(state->subresource,state->outRange,params.format);
 			const auto& regions = img->getRegions(state->subresource.mipLevel);
-			CBasicImageFilterCommon::executePerRegion(std::forward<ExecutionPolicy>(policy),img,fill,regions.begin(),regions.end(),clip);
+			CBasicImageFilterCommon::executePerRegionPerSpan(std::forward<ExecutionPolicy>(policy),img,fill,regions.begin(),regions.end(),clip);
 
 			return true;
 		}
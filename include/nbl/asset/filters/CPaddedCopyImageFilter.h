@@ -164,24 +164,15 @@ class CPaddedCopyImageFilter : public CImageFilter<CPaddedCopyImageFilter>, publ
 			uint8_t* const bufptr = reinterpret_cast<uint8_t*>(state->outImage->getBuffer()->getPointer());
 			IImageFilter::IState::ColorValue borderColor;
 			encodeBorderColor(state->borderColor, state->outImage->getCreationParameters().format, borderColor.asByte);
-			IImageFilter::IState::ColorValue::WriteMemoryInfo borderColorWrite(state->outImage->getCreationParameters().format, bufptr);
 
-			auto perBlock = [&state,&borderColor,&borderColorWrite,&bufptr,&reloffset](uint32_t blockArrayOffset, core::vectorSIMDu32 readBlockPos)
+			const auto outFormat = state->outImage->getCreationParameters().format;
+			const TexelBlockInfo blockInfo(outFormat);
+			const uint32_t texelSz = asset::getTexelOrBlockBytesize(outFormat);
+			const auto outRegions = state->outImage->getRegions(state->outMipLevel);
+			// find the output region holding `wrapped` and copy as much of the run starting there as the region has, returns how many texels got copied
+			auto copyRun = [&outRegions,&blockInfo,bufptr,texelSz](uint8_t* const dst, const core::vectorSIMDu32& wrapped, const uint32_t runLength) -> uint32_t
 			{
-				const TexelBlockInfo blockInfo(state->outImage->getCreationParameters().format);
-				const uint32_t texelSz = asset::getTexelOrBlockBytesize(state->outImage->getCreationParameters().format);
-
-				auto wrapped = wrapCoords(state, readBlockPos-state->outOffsetBaseLayer-reloffset, state->extentLayerCount);
-				//wrapped coords exceeding image on any axis implies usage of border color for this border-texel
-				//this also covers check for -1 (-1 is max unsigned val)
-				if ((wrapped>=state->extentLayerCount).xyzz().any())
-				{
-					borderColor.writeMemory(borderColorWrite, blockArrayOffset);
-					return;
-				}
-
-				wrapped += state->outOffsetBaseLayer+reloffset;
-				for (const auto& outreg : state->outImage->getRegions(state->outMipLevel))
+				for (const auto& outreg : outRegions)
 				{
 					core::vectorSIMDu32 _min(&outreg.imageOffset.x);
 					_min.w = outreg.imageSubresource.baseArrayLayer;
@@ -189,25 +180,76 @@ class CPaddedCopyImageFilter : public CImageFilter<CPaddedCopyImageFilter>, publ
 					_max.w = outreg.imageSubresource.layerCount;
 					_max += _min;
 
-					if ((wrapped>= _min).all() && (wrapped<_max).all())
+					if ((wrapped>=_min).all() && (wrapped<_max).all())
+					{
+						const auto strides = outreg.getByteStrides(blockInfo);
+						const uint64_t srcOffset = outreg.getByteOffset(wrapped-_min,strides);
+						const uint32_t copied = core::min(runLength,_max.x-wrapped.x);
+						memcpy(dst,bufptr+srcOffset,size_t(texelSz)*copied);
+						return copied;
+					}
+				}
+				// not covered by any region, leave it be
+				return 0u;
+			};
+			auto perRow = [&state,&borderColor,texelSz,bufptr,&reloffset,&copyRun](uint32_t rowArrayOffset, core::vectorSIMDu32 readBlockPos, uint32_t blockCount)
+			{
+				const auto localPos = readBlockPos-state->outOffsetBaseLayer-reloffset;
+				for (uint32_t x=0u; x<blockCount; )
+				{
+					uint8_t* const dst = bufptr+rowArrayOffset+size_t(texelSz)*x;
+					auto pos = localPos;
+					pos.x += x;
+					const auto wrapped = wrapCoords(state, pos, state->extentLayerCount);
+					//wrapped coords exceeding image on any axis implies usage of border color for this border-texel
+					//this also covers check for -1 (-1 is max unsigned val)
+					if ((wrapped>=state->extentLayerCount).xyzz().any())
 					{
-						const auto strides = outreg.getByteStrides(blockInfo);//TODO precompute strides
-						const uint64_t srcOffset = outreg.getByteOffset(wrapped-_min, strides);
+						// Y, Z and the layer don't change along the row, so only X can end the run of border texels
+						uint32_t runLength = 1u;
+						if ((wrapped>=state->extentLayerCount).yzzz().any())
+							runLength = blockCount-x;
+						else for (auto next=pos; x+runLength<blockCount; runLength++)
+						{
+							next.x++;
+							if (wrapCoords(state,next,state->extentLayerCount).x<state->extentLayerCount.x)
+								break;
+						}
+						CBasicImageFilterCommon::replicateBlock(dst,borderColor.pointer,texelSz,runLength);
+						x += runLength;
+						continue;
+					}
 
-						memcpy(bufptr+blockArrayOffset, bufptr+srcOffset, texelSz);
-						break;
+					// within a repeat period the wrapped X goes up by one per texel, past a clamped edge it stays the same, mirrored periods get done texel by texel
+					auto next = pos;
+					next.x++;
+					const int32_t step = x+1u<blockCount ? int32_t(wrapCoords(state,next,state->extentLayerCount).x-wrapped.x):2;
+					uint32_t runLength = 1u;
+					if (step==0 || step==1)
+					for (; x+runLength<blockCount; runLength++,next.x++)
+					{
+						if (wrapCoords(state,next,state->extentLayerCount).x!=wrapped.x+step*runLength)
+							break;
+					}
+					if (step==0)
+					{
+						if (copyRun(dst,wrapped+state->outOffsetBaseLayer+reloffset,1u))
+							CBasicImageFilterCommon::replicateBlock(dst+texelSz,dst,texelSz,runLength-1u);
+						x += runLength;
 					}
+					else
+						x += core::max(copyRun(dst,wrapped+state->outOffsetBaseLayer+reloffset,runLength),1u);
 				}
 			};
-			for (const auto& outreg : state->outImage->getRegions(state->outMipLevel))
+			for (const auto& outreg : outRegions)
 			{
 				for (uint32_t i = 0u; i < borderRegionCount; ++i)
 				{
 					IImage::SSubresourceLayers subresource = {static_cast<IImage::E_ASPECT_FLAGS>(0u),state->outMipLevel,state->outBaseLayer,state->layerCount};
-					clip_region_functor_t clip(subresource, borderRegions[i], state->outImage->getCreationParameters().format);
+					clip_region_functor_t clip(subresource, borderRegions[i], outFormat);
 					IImage::SBufferCopy clipped_reg = outreg;
 					if (clip(clipped_reg, &outreg))
-						executePerBlock<ExecutionPolicy>(policy,state->outImage,clipped_reg,perBlock);
+						executePerRow<ExecutionPolicy>(policy,state->outImage,clipped_reg,perRow);
 				}
 			}
 
@@ -9,6 +9,7 @@
 
 #include <type_traits>
 #include <functional>
+#include <thread>
 
 #include "nbl/asset/filters/CMatchedSizeInOutImageFilterCommon.h"
 #include "CConvertFormatImageFilter.h"
@@ -25,13 +26,24 @@ class CSummedAreaTableImageFilterBase
 		class CSummStateBase
 		{
 			public:
+				//! What the sums are kept in, the smaller accumulators halve the scratch memory and the bandwidth of every scan
+				enum E_ACCUMULATOR : uint8_t
+				{
+					EA_AUTO = 0u,		//!< EA_UINT32 whenever it's exact, EA_WIDE otherwise
+					EA_WIDE,			//!< double for float and normalized formats, 64bit integers for integer formats
+					EA_FLOAT_KAHAN,		//!< float with Kahan compensated scans, plenty for importance sampling tables
+					EA_UINT32			//!< only for unsigned integer formats whose total over the summed axes can't overflow
+				};
 
 				static inline constexpr size_t decodeTypeByteSize = sizeof(double);
 				uint8_t*	scratchMemory = nullptr;										//!< memory covering all regions used for temporary filling within computation of sum values
 				size_t	scratchMemoryByteSize = {};											//!< required byte size for entire scratch memory
 				bool normalizeImageByTotalSATValues = false;								//!< after sum performation division will be performed for the entire image by the max sum values in (maxX, 0, z) depending on input image - needed for UNORM and SNORM
 				uint8_t axesToSum = 0u;														//!< which axes you want to sum; X: bit0, Y: bit1, Z: bit2 // TODO: make ALL_AXES the default and make sure examples using it work as expected.
+				E_ACCUMULATOR accumulator = EA_AUTO;										//!< see E_ACCUMULATOR
+				uint32_t stripSize = 0u;													//!< when not 0 the table gets made and written out this many slices (3D) or rows (2D) at a time, so only a strip and the plane of sums carried between strips need scratch, normalization then reads the input twice; ignored for block compressed formats
 
+				//! Enough for any accumulator without strips
 				static inline size_t getRequiredScratchByteSize(const ICPUImage* inputImage, asset::VkExtent3D extent)
 				{
 					const auto& inputCreationParams = inputImage->getCreationParameters();
@@ -41,6 +53,64 @@ class CSummedAreaTableImageFilterBase
 					
 					return retval;
 				}
+				//! Exact requirement for the state's `axesToSum`, `accumulator` and `stripSize`
+				static inline size_t getRequiredScratchByteSize(const ICPUImage* inputImage, asset::VkExtent3D extent, const uint8_t axesToSum, const E_ACCUMULATOR accumulator, const uint32_t stripSize)
+				{
+					const auto format = inputImage->getCreationParameters().format;
+					const auto resolved = resolveAccumulator(format,extent,axesToSum,accumulator);
+					const size_t accumulatorByteSize = resolved==EA_WIDE ? decodeTypeByteSize:sizeof(uint32_t);
+					const SStrips strips = getStrips(format,extent,stripSize);
+					const size_t planeElements = size_t(asset::getFormatChannelCount(format))*extent.width*extent.height*extent.depth/strips.extent;
+
+					size_t retval = planeElements*strips.size;
+					if (strips.isCarried(axesToSum))
+						retval += resolved==EA_FLOAT_KAHAN ? (planeElements*2u):planeElements;
+					return retval*accumulatorByteSize;
+				}
+
+				//! Whether 32bit unsigned sums are exact, the largest value of every channel summed over the whole extent of the summed axes has to fit
+				static inline bool isUint32Exact(const E_FORMAT format, const asset::VkExtent3D extent, const uint8_t axesToSum)
+				{
+					if (!asset::isIntegerFormat(format) || asset::isSignedFormat(format))
+						return false;
+					double summedTexels = 1.0;
+					if (axesToSum&0x1u)
+						summedTexels *= extent.width;
+					if (axesToSum&0x2u)
+						summedTexels *= extent.height;
+					if (axesToSum&0x4u)
+						summedTexels *= extent.depth;
+					for (uint32_t channel=0u; channel<asset::getFormatChannelCount(format); channel++)
+					if (asset::getFormatMaxValue<double>(format,channel)*summedTexels>double(UINT32_MAX))
+						return false;
+					return true;
+				}
+				static inline E_ACCUMULATOR resolveAccumulator(const E_FORMAT format, const asset::VkExtent3D extent, const uint8_t axesToSum, const E_ACCUMULATOR accumulator)
+				{
+					if (accumulator!=EA_AUTO)
+						return accumulator;
+					return isUint32Exact(format,extent,axesToSum) ? EA_UINT32:EA_WIDE;
+				}
+
+				//! The table gets made strip by strip along the outermost axis of the extent (Z, or Y when the depth is 1)
+				struct SStrips
+				{
+					inline bool isCarried(const uint8_t axesToSum) const {return count>1u && ((axesToSum>>axis)&0x1u);}
+
+					uint32_t axis;
+					uint32_t extent;	//!< of the whole range along `axis`
+					uint32_t size;		//!< of all but the last strip
+					uint32_t count;
+				};
+				static inline SStrips getStrips(const E_FORMAT format, const asset::VkExtent3D extent, const uint32_t stripSize)
+				{
+					SStrips retval;
+					retval.axis = extent.depth>1u ? 2u:1u;
+					retval.extent = retval.axis==2u ? extent.depth:extent.height;
+					retval.size = (stripSize && stripSize<retval.extent && !asset::isBlockCompressionFormat(format)) ? stripSize:retval.extent;
+					retval.count = (retval.extent+retval.size-1u)/retval.size;
+					return retval;
+				}
 		};
 
 	protected:
@@ -61,6 +131,11 @@ class CSummedAreaTableImageFilterBase
 	When the summing is in exclusive mode - it computes the sum of all the pixels placed
 	on the left and down for a new single texel but it doesn't take sum the main texel itself.
 	In inclusive mode, the texel we start from is taken as well and added to the sum.
+
+	The table is made with one prefix sum per summed axis instead of a serial walk over the texels, every scan is split
+	across the execution policy's threads by lines or, when there's too few lines (a tall and thin image, or Z of a volume),
+	by blocks of the scanned axis which get scanned locally and then fixed up with the totals of the blocks before them.
+	See `CSummStateBase::E_ACCUMULATOR` and `CSummStateBase::stripSize` for cutting down the scratch memory.
 */
 
 template<bool ExclusiveMode = false>
@@ -94,12 +169,15 @@ class CSummedAreaTableImageFilter : public CMatchedSizeInOutImageFilterCommon, p
 			const auto inFormat = inParams.format;
 			const auto outFormat = outParams.format;
 
-			if (state->scratchMemoryByteSize < state_type::getRequiredScratchByteSize(state->inImage, state->extent))
+			if (state->scratchMemoryByteSize < state_type::getRequiredScratchByteSize(state->inImage, state->extent, state->axesToSum, state->accumulator, state->stripSize))
 				return false;
 			
 			if (state->axesToSum == 0u)
 				return false;
 
+			if (state->accumulator == state_type::EA_UINT32 && !state_type::isUint32Exact(inFormat, state->extent, state->axesToSum))
+				return false;
+
 			if (asset::getFormatChannelCount(outFormat) != asset::getFormatChannelCount(inFormat))
 				return false;
 
@@ -115,11 +193,16 @@ class CSummedAreaTableImageFilter : public CMatchedSizeInOutImageFilterCommon, p
 			if (!validate(state))
 				return false;
 
-			auto checkFormat = state->inImage->getCreationParameters().format;
+			const auto checkFormat = state->inImage->getCreationParameters().format;
+			const auto accumulator = state_type::resolveAccumulator(checkFormat, state->extent, state->axesToSum, state->accumulator);
 			if (isIntegerFormat(checkFormat))
-				return executeInterprated(std::forward<ExecutionPolicy>(policy), state, reinterpret_cast<uint64_t*>(state->scratchMemory));
+			{
+				if (isSignedFormat(checkFormat))
+					return executeInterprated<int64_t>(std::forward<ExecutionPolicy>(policy), state, accumulator);
+				return executeInterprated<uint64_t>(std::forward<ExecutionPolicy>(policy), state, accumulator);
+			}
 			else
-				return executeInterprated(std::forward<ExecutionPolicy>(policy), state, reinterpret_cast<double*>(state->scratchMemory));
+				return executeInterprated<double>(std::forward<ExecutionPolicy>(policy), state, accumulator);
 		}	
 		static inline bool execute(state_type* state)
 		{
@@ -127,287 +210,395 @@ class CSummedAreaTableImageFilter : public CMatchedSizeInOutImageFilterCommon, p
 		}
 
 	private:
+		static inline constexpr uint32_t maxChannels = 4u;
+		static inline constexpr uint32_t ScanRunLength = 256u;			//!< inner elements one task scans side by side
+		static inline constexpr uint32_t MinScanBlockLength = 64u;		//!< shortest block of a scanned axis worth a task of its own
+		static inline constexpr uint32_t MinMaxChunkTexels = 0x1000u;
 
-		template<class ExecutionPolicy, typename decodeType> //!< double or uint64_t
-		static inline bool executeInterprated(ExecutionPolicy&& policy, state_type* state, decodeType* scratchMemory)
+		template<class ExecutionPolicy>
+		static inline uint32_t getWorkerCount()
 		{
-			const asset::E_FORMAT inFormat = state->inImage->getCreationParameters().format;
-			const asset::E_FORMAT outFormat = state->outImage->getCreationParameters().format;
-			const auto inTexelByteSize = asset::getTexelOrBlockBytesize(inFormat);
-			const auto outTexelByteSize = asset::getTexelOrBlockBytesize(outFormat);
-			const auto currentChannelCount = asset::getFormatChannelCount(inFormat);
-			const auto arrayLayers = state->inImage->getCreationParameters().arrayLayers;
-			static constexpr auto maxChannels = 4u;
+			if constexpr (std::is_same_v<std::remove_cvref_t<ExecutionPolicy>,core::execution::sequenced_policy>)
+				return 1u;
+			else
+				return core::max(std::thread::hardware_concurrency(),1u);
+		}
 
-			#ifdef _NBL_DEBUG
-			memset(scratchMemory, 0, state->scratchMemoryByteSize);
-			#endif // _NBL_DEBUG
+		template<class ExecutionPolicy, typename F>
+		static inline void executePerIndex(ExecutionPolicy&& policy, const uint32_t count, F& f)
+		{
+			const uint32_t extent[1] = {count};
+			BlockIterator<1u> begin(extent);
+			BlockIterator<1u> end(extent,extent);
+			core::for_each(std::forward<ExecutionPolicy>(policy),begin,end,f);
+		}
 
-			const core::vector3du32_SIMD scratchByteStrides = [&]()
+		//! Inclusive prefix sum of `data[(outer*scanLength+s)*innerCount+inner]` along `s`, continuing from `carry[outer*innerCount+inner]` and leaving the totals there if there is one
+		template<class ExecutionPolicy, typename accumulatorType>
+		static inline void scanAxis(ExecutionPolicy&& policy, accumulatorType* const data, const uint32_t outerCount, const uint32_t scanLength, const uint32_t innerCount, accumulatorType* const carry, accumulatorType* const carryComp)
+		{
+			constexpr bool Kahan = std::is_same_v<accumulatorType,float>;
+
+			// runs of neighbouring inner elements get scanned together, they're contiguous so that's what vectorizes
+			const uint32_t runLength = core::min(innerCount,ScanRunLength);
+			const uint32_t runsPerOuter = (innerCount+runLength-1u)/runLength;
+			const uint32_t runCount = outerCount*runsPerOuter;
+			// too few runs to keep every thread busy, so the scanned axis gets split into blocks as well
+			const uint32_t workers = getWorkerCount<ExecutionPolicy>();
+			uint32_t blockCount = 1u;
+			if (runCount<workers)
+				blockCount = core::max(core::min((workers+runCount-1u)/runCount,scanLength/MinScanBlockLength),1u);
+			const uint32_t blockLength = (scanLength+blockCount-1u)/blockCount;
+			blockCount = (scanLength+blockLength-1u)/blockLength;
+
+			// sum and compensation at the end of every block, later overwritten by what needs adding to the block
+			core::vector<accumulatorType> blockTotals(blockCount>1u ? size_t(runCount)*blockCount*runLength*2u:0u);
+			auto getBlockTotals = [&](const uint32_t run, const uint32_t block) -> accumulatorType*
 			{
-				const core::vectorSIMDu32 trueExtent = state->extentLayerCount;
+				return blockTotals.data()+(size_t(run)*blockCount+block)*runLength*2u;
+			};
+			auto getRun = [&](const uint32_t run, const uint32_t s, uint32_t& carryOffset, uint32_t& length) -> accumulatorType*
+			{
+				const uint32_t outer = run/runsPerOuter;
+				const uint32_t innerBegin = (run%runsPerOuter)*runLength;
+				carryOffset = outer*innerCount+innerBegin;
+				length = core::min(innerBegin+runLength,innerCount)-innerBegin;
+				return data+(size_t(outer)*scanLength+s)*innerCount+innerBegin;
+			};
 
-				switch (currentChannelCount)
+			auto scanBlock = [&](const std::array<uint32_t,1u>& task) -> void
+			{
+				const uint32_t run = task[0]/blockCount;
+				const uint32_t block = task[0]%blockCount;
+				const uint32_t sBegin = block*blockLength;
+				const uint32_t sEnd = core::min(sBegin+blockLength,scanLength);
+
+				uint32_t carryOffset, length;
+				getRun(run,0u,carryOffset,length);
+				accumulatorType sum[ScanRunLength] = {};
+				accumulatorType comp[ScanRunLength] = {};
+				if (block==0u && carry)
+				for (uint32_t i=0u; i<length; i++)
 				{
-					case 1:
-					{
-						return TexelBlockInfo(asset::E_FORMAT::EF_R64_SFLOAT).convert3DTexelStridesTo1DByteStrides(trueExtent);
-					}
+					sum[i] = carry[carryOffset+i];
+					if constexpr (Kahan)
+						comp[i] = carryComp[carryOffset+i];
+				}
 
-					case 2:
+				for (uint32_t s=sBegin; s<sEnd; s++)
+				{
+					accumulatorType* const row = getRun(run,s,carryOffset,length);
+					for (uint32_t i=0u; i<length; i++)
 					{
-						return TexelBlockInfo(asset::E_FORMAT::EF_R64G64_SFLOAT).convert3DTexelStridesTo1DByteStrides(trueExtent);
+						if constexpr (Kahan)
+						{
+							const accumulatorType y = row[i]-comp[i];
+							const accumulatorType t = sum[i]+y;
+							comp[i] = (t-sum[i])-y;
+							sum[i] = t;
+						}
+						else
+							sum[i] += row[i];
+						row[i] = sum[i];
 					}
+				}
 
-					case 3:
-					{
-						return TexelBlockInfo(asset::E_FORMAT::EF_R64G64B64_SFLOAT).convert3DTexelStridesTo1DByteStrides(trueExtent);
-					}
-					case 4:
+				if (blockCount>1u)
+				{
+					accumulatorType* const totals = getBlockTotals(run,block);
+					std::copy_n(sum,length,totals);
+					std::copy_n(comp,length,totals+runLength);
+				}
+				else if (carry)
+				{
+					std::copy_n(sum,length,carry+carryOffset);
+					if constexpr (Kahan)
+						std::copy_n(comp,length,carryComp+carryOffset);
+				}
+			};
+			executePerIndex(policy,runCount*blockCount,scanBlock);
+			if (blockCount==1u)
+				return;
+
+			// carry propagation, serial over the blocks but there's only a handful
+			auto propagate = [&](const std::array<uint32_t,1u>& task) -> void
+			{
+				const uint32_t run = task[0];
+				uint32_t carryOffset, length;
+				getRun(run,0u,carryOffset,length);
+				accumulatorType sum[ScanRunLength], comp[ScanRunLength];
+				{
+					// block 0 already started from the incoming carry
+					const accumulatorType* const totals = getBlockTotals(run,0u);
+					std::copy_n(totals,length,sum);
+					std::copy_n(totals+runLength,length,comp);
+				}
+				for (uint32_t block=1u; block<blockCount; block++)
+				{
+					accumulatorType* const totals = getBlockTotals(run,block);
+					for (uint32_t i=0u; i<length; i++)
 					{
-						return TexelBlockInfo(asset::E_FORMAT::EF_R64G64B64A64_SFLOAT).convert3DTexelStridesTo1DByteStrides(trueExtent);
+						const accumulatorType blockTotal = totals[i];
+						if constexpr (Kahan)
+						{
+							const accumulatorType blockComp = totals[runLength+i];
+							totals[i] = sum[i]-comp[i];
+							const accumulatorType y = (blockTotal-blockComp)-comp[i];
+							const accumulatorType t = sum[i]+y;
+							comp[i] = (t-sum[i])-y;
+							sum[i] = t;
+						}
+						else
+						{
+							totals[i] = sum[i];
+							sum[i] += blockTotal;
+						}
 					}
 				}
-			}();
-			const auto scratchTexelByteSize = scratchByteStrides[0];
-
-			const auto&& [copyInBaseLayer, copyOutBaseLayer, copyLayerCount] = std::make_tuple(state->inBaseLayer, state->outBaseLayer, state->layerCount);
-			state->layerCount = 1u;
+				if (carry)
+				{
+					std::copy_n(sum,length,carry+carryOffset);
+					if constexpr (Kahan)
+						std::copy_n(comp,length,carryComp+carryOffset);
+				}
+			};
+			executePerIndex(policy,runCount,propagate);
 
-			// https://stackoverflow.com/questions/46114214/lambda-implicit-capture-fails-with-variable-declared-from-structured-binding
-			auto resetState = [&, copyInBaseLayer=copyInBaseLayer, copyOutBaseLayer=copyOutBaseLayer, copyLayerCount=copyLayerCount]()
+			auto addCarry = [&](const std::array<uint32_t,1u>& task) -> void
 			{
-				state->inBaseLayer = copyInBaseLayer;
-				state->outBaseLayer = copyOutBaseLayer;
-				state->layerCount = copyLayerCount;
+				const uint32_t run = task[0]/(blockCount-1u);
+				const uint32_t block = task[0]%(blockCount-1u)+1u;
+				const accumulatorType* const totals = getBlockTotals(run,block);
+				const uint32_t sEnd = core::min((block+1u)*blockLength,scanLength);
+				for (uint32_t s=block*blockLength; s<sEnd; s++)
+				{
+					uint32_t carryOffset, length;
+					accumulatorType* const row = getRun(run,s,carryOffset,length);
+					for (uint32_t i=0u; i<length; i++)
+						row[i] += totals[i];
+				}
 			};
+			executePerIndex(policy,runCount*(blockCount-1u),addCarry);
+		}
 
-			for (uint16_t w = 0u; w < copyLayerCount; ++w) // this could be parallelized
+		template<typename encodeType, typename accumulatorType>
+		static inline void encodeTexel(const E_FORMAT format, void* const dst, const accumulatorType* const values, const uint32_t channels, const double* const minValues, const double* const maxValues, const bool signedNormalization)
+		{
+			encodeType encodeBuffer[maxChannels] = {};
+			for (uint32_t channel=0u; channel<channels; channel++)
 			{
-				std::array<decodeType, maxChannels> minDecodeValues = {};
-				std::array<decodeType, maxChannels> maxDecodeValues = {};
-
+				if (minValues)
 				{
-					const uint8_t* inData = reinterpret_cast<const uint8_t*>(state->inImage->getBuffer()->getPointer());
-					const auto blockDims = asset::getBlockDimensions(state->inImage->getCreationParameters().format);
-					static constexpr uint8_t maxPlanes = 4;
+					const double value = static_cast<double>(values[channel]);
+					const double range = maxValues[channel]-minValues[channel];
+					if (signedNormalization)
+						encodeBuffer[channel] = static_cast<encodeType>((2.0*value-maxValues[channel]-minValues[channel])/range);
+					else
+						encodeBuffer[channel] = static_cast<encodeType>((value-minValues[channel])/range);
+				}
+				else
+					encodeBuffer[channel] = static_cast<encodeType>(values[channel]);
+			}
+			asset::encodePixelsRuntime(format, dst, encodeBuffer); // overrrides texels, so region-overlapping case is fine
+		}
 
-					/*
-						Make sure we are able to move as (+ 1) in a certain plane,
-						otherwise memory leaks may occur
-					*/
+		template<typename decodeType, class ExecutionPolicy> //!< double, uint64_t or int64_t
+		static inline bool executeInterprated(ExecutionPolicy&& policy, state_type* state, const typename state_type::E_ACCUMULATOR accumulator)
+		{
+			switch (accumulator)
+			{
+				case state_type::EA_FLOAT_KAHAN:
+					return executeAccumulated<decodeType,float>(policy, state);
+				case state_type::EA_UINT32:
+					if constexpr (std::is_same_v<decodeType,uint64_t>)
+						return executeAccumulated<decodeType,uint32_t>(policy, state);
+					return false;
+				default:
+					return executeAccumulated<decodeType,decodeType>(policy, state);
+			}
+		}
 
-					bool is2DAndBelow = state->inImage->getCreationParameters().type == IImage::ET_2D;
-					bool is3DAndBelow = state->inImage->getCreationParameters().type == IImage::ET_3D;
-					const core::vectorSIMDu32 limit(1, is2DAndBelow, is3DAndBelow);
-					const core::vectorSIMDu32 movingExclusiveVector = limit, movingOnYZorXZorXYCheckingVector = limit;
+		template<typename decodeType, typename accumulatorType, class ExecutionPolicy>
+		static inline bool executeAccumulated(ExecutionPolicy&& policy, state_type* state)
+		{
+			constexpr bool Kahan = std::is_same_v<accumulatorType,float>;
+			static constexpr uint8_t maxPlanes = 4;
 
-					auto decode = [&](uint32_t readBlockArrayOffset, core::vectorSIMDu32 readBlockPos) -> void
-					{
-						core::vectorSIMDu32 localOutPos = readBlockPos * blockDims - core::vectorSIMDu32(state->inOffset.x, state->inOffset.y, state->inOffset.z);
+			const asset::E_FORMAT inFormat = state->inImage->getCreationParameters().format;
+			const asset::E_FORMAT outFormat = state->outImage->getCreationParameters().format;
+			const auto imageType = state->inImage->getCreationParameters().type;
+			const uint32_t channels = asset::getFormatChannelCount(inFormat);
+			const auto blockDims = asset::getBlockDimensions(inFormat);
+
+			const core::vectorSIMDu32 extent(state->extent.width, state->extent.height, state->extent.depth);
+			const core::vectorSIMDu32 inOffset(state->inOffset.x, state->inOffset.y, state->inOffset.z);
+			const core::vectorSIMDu32 outOffset(state->outOffset.x, state->outOffset.y, state->outOffset.z);
+			// exclusive mode moves every texel up by one along each dimension the image has, what gets moved past the extent is dropped
+			const core::vectorSIMDu32 shift = ExclusiveMode ? core::vectorSIMDu32(1u, imageType>=IImage::ET_2D ? 1u:0u, imageType==IImage::ET_3D ? 1u:0u):core::vectorSIMDu32(0u);
+
+			const auto strips = state_type::getStrips(inFormat, state->extent, state->stripSize);
+			const size_t planeElements = size_t(channels)*extent.x*extent.y*extent.z/strips.extent;
+			accumulatorType* const stripData = reinterpret_cast<accumulatorType*>(state->scratchMemory);
+			accumulatorType* const carry = strips.isCarried(state->axesToSum) ? (stripData+planeElements*strips.size):nullptr;
+			accumulatorType* const carryComp = carry&&Kahan ? (carry+planeElements):nullptr;
+
+			const bool normalize = state->normalizeImageByTotalSATValues || asset::isNormalizedFormat(inFormat);
+			const bool signedNormalization = asset::isSignedFormat(inFormat);
+			const bool outInteger = asset::isIntegerFormat(outFormat);
+			const bool outSigned = asset::isSignedFormat(outFormat);
+			// the min and max are only known once the whole table was made, with strips that means going over the input twice
+			const uint32_t passCount = normalize && strips.count>1u ? 2u:1u;
+
+			const uint8_t* const inData = reinterpret_cast<const uint8_t*>(state->inImage->getBuffer()->getPointer());
+			uint8_t* const outData = reinterpret_cast<uint8_t*>(state->outImage->getBuffer()->getPointer());
+			const auto& inRegions = state->inImage->getRegions(state->inMipLevel);
+			const auto& outRegions = state->outImage->getRegions(state->outMipLevel);
+
+			for (uint32_t w = 0u; w < state->layerCount; ++w)
+			{
+				double minValues[maxChannels] = {};
+				double maxValues[maxChannels] = {};
 
-						auto* inDataAdress = inData + readBlockArrayOffset;
-						const void* inSourcePixels[maxPlanes] = { inDataAdress, nullptr, nullptr, nullptr };
+				for (uint32_t pass = 0u; pass < passCount; ++pass)
+				{
+					if (carry)
+						memset(carry, 0, planeElements*sizeof(accumulatorType)*(Kahan ? 2u:1u));
 
-						if constexpr (ExclusiveMode)
+					for (uint32_t strip = 0u; strip < strips.count; ++strip)
+					{
+						const uint32_t stripBegin = strip*strips.size;
+						core::vectorSIMDu32 stripExtent = extent;
+						stripExtent[strips.axis] = core::min(strips.size, strips.extent-stripBegin);
+						const uint32_t stripEnd = stripBegin+stripExtent[strips.axis];
+						const size_t stripTexels = size_t(stripExtent.x)*stripExtent.y*stripExtent.z;
+						auto getStripTexel = [&](const core::vectorSIMDu32& stripPos) -> accumulatorType*
 						{
-							auto movedLocalOutPos = localOutPos + movingExclusiveVector;
-							const auto isSatMemorySafe = (movedLocalOutPos < core::vectorSIMDu32(state->extent.width, state->extent.height, state->extent.depth, movedLocalOutPos.w + 1)); // force true on .w
+							return stripData+((size_t(stripPos.z)*stripExtent.y+stripPos.y)*stripExtent.x+stripPos.x)*channels;
+						};
 
-							if (isSatMemorySafe.all())
+						memset(stripData, 0, stripTexels*channels*sizeof(accumulatorType));
+						{
+							auto decode = [&](uint32_t readBlockArrayOffset, core::vectorSIMDu32 readBlockPos) -> void
 							{
-								decodeType decodeBuffer[maxChannels] = {};
+								const core::vectorSIMDu32 blockLocalPos = readBlockPos*blockDims-inOffset+shift;
+								const void* inSourcePixels[maxPlanes] = { inData+readBlockArrayOffset, nullptr, nullptr, nullptr };
 
+								decodeType decodeBuffer[maxChannels] = {};
 								for (auto blockY = 0u; blockY < blockDims.y; blockY++)
-									for (auto blockX = 0u; blockX < blockDims.x; blockX++)
-									{
-										asset::decodePixelsRuntime(inFormat, inSourcePixels, decodeBuffer, blockX, blockY);
-										const size_t movedOffset = asset::IImage::SBufferCopy::getLocalByteOffset(core::vector3du32_SIMD(movedLocalOutPos.x + blockX, movedLocalOutPos.y + blockY, movedLocalOutPos.z), scratchByteStrides);
-										memcpy(reinterpret_cast<uint8_t*>(scratchMemory) + movedOffset, decodeBuffer, scratchTexelByteSize);
-									}
-							}
-						}
-						else
-						{
-							decodeType decodeBuffer[maxChannels] = {};
-							for (auto blockY = 0u; blockY < blockDims.y; blockY++)
 								for (auto blockX = 0u; blockX < blockDims.x; blockX++)
 								{
+									core::vectorSIMDu32 localPos = blockLocalPos+core::vectorSIMDu32(blockX, blockY, 0u);
+									if (localPos.x>=extent.x || localPos.y>=extent.y || localPos.z>=extent.z || localPos[strips.axis]<stripBegin || localPos[strips.axis]>=stripEnd)
+										continue;
+									localPos[strips.axis] -= stripBegin;
+
 									asset::decodePixelsRuntime(inFormat, inSourcePixels, decodeBuffer, blockX, blockY);
-									const size_t offset = asset::IImage::SBufferCopy::getLocalByteOffset(core::vector3du32_SIMD(localOutPos.x + blockX, localOutPos.y + blockY, localOutPos.z), scratchByteStrides);
-									memcpy(reinterpret_cast<uint8_t*>(scratchMemory) + offset, decodeBuffer, scratchTexelByteSize);
+									accumulatorType* const texel = getStripTexel(localPos);
+									for (uint32_t channel = 0u; channel < channels; ++channel)
+										texel[channel] = static_cast<accumulatorType>(decodeBuffer[channel]);
 								}
-						}
-					};
-
-					IImage::SSubresourceLayers subresource = { static_cast<IImage::E_ASPECT_FLAGS>(0u), state->inMipLevel, state->inBaseLayer, 1 };
-					CMatchedSizeInOutImageFilterCommon::state_type::TexelRange range = { state->inOffset,state->extent };
-					CBasicImageFilterCommon::clip_region_functor_t clipFunctor(subresource, range, inFormat);
+							};
 
-					const auto& inRegions = state->inImage->getRegions(state->inMipLevel);
-					CBasicImageFilterCommon::executePerRegion(policy, state->inImage, decode, inRegions.begin(), inRegions.end(), clipFunctor);
-
-					if constexpr (ExclusiveMode)
-					{
-						core::vector3du32_SIMD localCoord;
-						for (auto& z = localCoord[2] = 0u; z < state->extent.depth; ++z) // TODO: parallelize
-							for (auto& y = localCoord[1] = 0u; y < state->extent.height; ++y)
-								for (auto& x = localCoord[0] = 0u; x < state->extent.width; ++x)
+							IImage::SSubresourceLayers subresource = { static_cast<IImage::E_ASPECT_FLAGS>(0u), state->inMipLevel, state->inBaseLayer+w, 1 };
+							CMatchedSizeInOutImageFilterCommon::state_type::TexelRange range = { state->inOffset,state->extent };
+							// only the input texels which end up in the strip
+							if (strips.count>1u)
+							{
+								const uint32_t first = core::max(stripBegin, shift[strips.axis])-shift[strips.axis];
+								const uint32_t last = stripEnd-shift[strips.axis];
+								if (strips.axis==2u)
 								{
-									auto resetSATMemory = [&](const core::vector3du32_SIMD& position)
-									{
-										const size_t offset = asset::IImage::SBufferCopy::getLocalByteOffset(position, scratchByteStrides);
-										memset(reinterpret_cast<uint8_t*>(scratchMemory) + offset, 0, scratchTexelByteSize);
-									};
-
-									const auto doesItMoveOnYZorXZorXY = (localCoord < movingOnYZorXZorXYCheckingVector);
-									if (doesItMoveOnYZorXZorXY.any())
-										resetSATMemory(localCoord);
+									range.offset.z += first;
+									range.extent.depth = last-first;
 								}
-					}
-				}
-
-				{
-					auto getScratchPixel = [&](core::vector4di32_SIMD readBlockPos) -> decodeType*
-					{
-						const size_t scratchOffset = asset::IImage::SBufferCopy::getLocalByteOffset(core::vector3du32_SIMD(readBlockPos.x, readBlockPos.y, readBlockPos.z, 0), scratchByteStrides);
-						return reinterpret_cast<decodeType*>(reinterpret_cast<uint8_t*>(scratchMemory) + scratchOffset);
-					};
-
-					auto sum = [&](core::vectorSIMDi32 readBlockPos) -> void
-					{
-						decodeType* current = getScratchPixel(readBlockPos);
-
-						auto areAxisSafe = [&]()
-						{
-							const auto position = core::vectorSIMDi32(0u, 0u, 0u, 0u);
-
-							const bool shouldSumX = (state->axesToSum >> 0) & 0x1u;
-							const bool shouldSumY = (state->axesToSum >> 1) & 0x1u;
-							const bool shouldSumZ = (state->axesToSum >> 2) & 0x1u;
-
-							return core::vector4du32_SIMD
-							(
-								(readBlockPos.x > position.x) && (shouldSumX),
-								(readBlockPos.y > position.y) && (shouldSumY),
-								(readBlockPos.z > position.z) && (shouldSumZ),
-								(readBlockPos.w > position.w)
-							);
-						};
+								else
+								{
+									range.offset.y += first;
+									range.extent.height = last-first;
+								}
+							}
+							CBasicImageFilterCommon::clip_region_functor_t clipFunctor(subresource, range, inFormat);
+							if (range.extent.width && range.extent.height && range.extent.depth)
+								CBasicImageFilterCommon::executePerRegion(policy, state->inImage, decode, inRegions.begin(), inRegions.end(), clipFunctor);
+						}
 
-						auto addScratchPixelToCurrentOne = [&](const decodeType* values)
-						{
-							for (auto i = 0; i < currentChannelCount; ++i)
-								current[i] += values[i];
-						};
-						
-						auto substractScratchPixelFromCurrentOne = [&](const decodeType* values)
+						// X, Y then Z, only the outermost axis carries over from the previous strip
+						if (state->axesToSum & 0x1u)
+							scanAxis(policy, stripData, stripExtent.y*stripExtent.z, stripExtent.x, channels, static_cast<accumulatorType*>(nullptr), static_cast<accumulatorType*>(nullptr));
+						if (state->axesToSum & 0x2u)
 						{
-							for (auto i = 0; i < currentChannelCount; ++i)
-								current[i] -= values[i];
-						};
-
-						const auto axisSafe = areAxisSafe();
-
-						if (axisSafe.z)
-							addScratchPixelToCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(0, 0, 1, 0)));					// add box x<=current_x && y<=current_y && z<current_z
-						if (axisSafe.y)
+							const bool carried = strips.axis==1u;
+							scanAxis(policy, stripData, stripExtent.z, stripExtent.y, stripExtent.x*channels, carried ? carry:nullptr, carried ? carryComp:nullptr);
+						}
+						if (state->axesToSum & 0x4u)
 						{
-							addScratchPixelToCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(0, 1, 0, 0)));					// add box x<=current_x && y<current_y && z<=current_z
-							if (axisSafe.z)
-								substractScratchPixelFromCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(0, 1, 1, 0)));		// remove overlap box x<=current_x && y<current_y && z<current_z
+							const bool carried = strips.axis==2u;
+							scanAxis(policy, stripData, 1u, stripExtent.z, stripExtent.x*stripExtent.y*channels, carried ? carry:nullptr, carried ? carryComp:nullptr);
 						}
 
-						/*
-							Now I have the sum of all layers below me in the bound x<=current_x && y<=current_y && z<current_z and the current pixel.
-							Time to add the missing top layer pixels.
-						*/
-
-						if (axisSafe.x)
+						if (normalize && pass == 0u)
 						{
-							addScratchPixelToCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(1, 0, 0, 0)));					 // add box x<current_x && y<=current_y && z<=current_z
-							if (axisSafe.z)
-								substractScratchPixelFromCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(1, 0, 1, 0)));		 // remove overlap box x<current_x && y<=current_y && z<current_z
-							if (axisSafe.y)
+							const uint32_t chunkCount = static_cast<uint32_t>((stripTexels+MinMaxChunkTexels-1u)/MinMaxChunkTexels);
+							core::vector<std::array<double,maxChannels*2u>> chunkMinMax(chunkCount);
+							auto findMinMax = [&](const std::array<uint32_t,1u>& task) -> void
+							{
+								auto& minMax = chunkMinMax[task[0]];
+								std::fill(minMax.begin(), minMax.end(), 0.0);
+								const size_t texelEnd = core::min<size_t>(size_t(task[0]+1u)*MinMaxChunkTexels, stripTexels);
+								for (size_t texel = size_t(task[0])*MinMaxChunkTexels; texel < texelEnd; ++texel)
+								for (uint32_t channel = 0u; channel < channels; ++channel)
+								{
+									const double value = static_cast<double>(stripData[texel*channels+channel]);
+									minMax[channel] = core::min(minMax[channel], value);
+									minMax[maxChannels+channel] = core::max(minMax[maxChannels+channel], value);
+								}
+							};
+							executePerIndex(policy, chunkCount, findMinMax);
+							for (const auto& minMax : chunkMinMax)
+							for (uint32_t channel = 0u; channel < channels; ++channel)
 							{
-								substractScratchPixelFromCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(1, 1, 0, 0)));		 // remove future overlap box x<current_x && y<current_y && z<=current_z
-								if (axisSafe.z)
-									addScratchPixelToCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(1, 1, 1, 0)));			 // add box x<current_x && y<current_y && z<current_z
+								minValues[channel] = core::min(minValues[channel], minMax[channel]);
+								maxValues[channel] = core::max(maxValues[channel], minMax[maxChannels+channel]);
 							}
 						}
 
-						std::for_each(current, current + currentChannelCount,
-							[&](const decodeType& itrValue)
+						if (pass+1u == passCount)
+						{
+							const double* const normalizationMin = normalize ? minValues:nullptr;
+							auto encode = [&](uint32_t writeBlockArrayOffset, core::vectorSIMDu32 writeBlockPos) -> void
 							{
-								uint8_t offset = &itrValue - current;
-
-								if (maxDecodeValues[offset] < itrValue)
-									maxDecodeValues[offset] = itrValue;
-
-								if (minDecodeValues[offset] > itrValue)
-									minDecodeValues[offset] = itrValue;
+								// encoding format cannot be block compressed so in this case block==texel
+								core::vectorSIMDu32 localPos = writeBlockPos-outOffset;
+								localPos[strips.axis] -= stripBegin;
+								const accumulatorType* const texel = getStripTexel(localPos);
+								uint8_t* const outDataAdress = outData+writeBlockArrayOffset;
+								if (!outInteger)
+									encodeTexel<double>(outFormat, outDataAdress, texel, channels, normalizationMin, maxValues, signedNormalization);
+								else if (outSigned)
+									encodeTexel<int64_t>(outFormat, outDataAdress, texel, channels, normalizationMin, maxValues, signedNormalization);
+								else
+									encodeTexel<uint64_t>(outFormat, outDataAdress, texel, channels, normalizationMin, maxValues, signedNormalization);
+							};
+
+							IImage::SSubresourceLayers subresource = { static_cast<IImage::E_ASPECT_FLAGS>(0u), state->outMipLevel, state->outBaseLayer+w, 1 };
+							CMatchedSizeInOutImageFilterCommon::state_type::TexelRange range = { state->outOffset,state->extent };
+							if (strips.axis==2u)
+							{
+								range.offset.z += stripBegin;
+								range.extent.depth = stripExtent.z;
 							}
-						);
-					};
-
-					{
-						core::vector3du32_SIMD localCoord;
-						for (auto& z = localCoord[2] = 0u; z < state->extent.depth; ++z)  // TODO: parallelize (will be tough!)
-							for (auto& y = localCoord[1] = 0u; y < state->extent.height; ++y)
-								for (auto& x = localCoord[0] = 0u; x < state->extent.width; ++x)
-									sum(core::vectorSIMDu32(x, y, z));
-					}
-
-					auto normalizeScratch = [&](bool isSignedFormat)
-					{
-						core::vector3du32_SIMD localCoord;
-							for (auto& z = localCoord[2] = 0u; z < state->extent.depth; ++z) // TODO: parallelize
-								for (auto& y = localCoord[1] = 0u; y < state->extent.height; ++y)
-									for (auto& x = localCoord[0] = 0u; x < state->extent.width; ++x)
-									{
-										const size_t scratchOffset = asset::IImage::SBufferCopy::getLocalByteOffset(localCoord, scratchByteStrides);
-										decodeType* entryScratchAdress = reinterpret_cast<decodeType*>(reinterpret_cast<uint8_t*>(scratchMemory) + scratchOffset);
-
-										if(isSignedFormat)
-											for (uint8_t channel = 0; channel < currentChannelCount; ++channel)
-												entryScratchAdress[channel] = (2.0 * entryScratchAdress[channel] - maxDecodeValues[channel] - minDecodeValues[channel]) / (maxDecodeValues[channel] - minDecodeValues[channel]);
-										else
-											for (uint8_t channel = 0; channel < currentChannelCount; ++channel)
-												entryScratchAdress[channel] = (entryScratchAdress[channel] - minDecodeValues[channel]) / (maxDecodeValues[channel] - minDecodeValues[channel]);
-									}
-					};
-
-					bool normalized = asset::isNormalizedFormat(inFormat);
-					if (state->normalizeImageByTotalSATValues || normalized)
-						normalizeScratch(asset::isSignedFormat(inFormat));
-
-					{
-						uint8_t* outData = reinterpret_cast<uint8_t*>(state->outImage->getBuffer()->getPointer());
-
-						auto encode = [&](uint32_t writeBlockArrayOffset, core::vectorSIMDu32 readBlockPos) -> void
-						{
-							// encoding format cannot be block compressed so in this case block==texel
-							auto localOutPos = readBlockPos - core::vectorSIMDu32(state->outOffset.x, state->outOffset.y, state->outOffset.z, readBlockPos.w); // force 0 on .w compoment to obtain valid offset
-							uint8_t* outDataAdress = outData + writeBlockArrayOffset;
-
-							const size_t offset = asset::IImage::SBufferCopy::getLocalByteOffset(localOutPos, scratchByteStrides);
-							asset::encodePixelsRuntime(outFormat, outDataAdress, reinterpret_cast<uint8_t*>(scratchMemory) + offset); // overrrides texels, so region-overlapping case is fine
-						};
-
-						IImage::SSubresourceLayers subresource = { static_cast<IImage::E_ASPECT_FLAGS>(0u), state->outMipLevel, state->outBaseLayer, 1 };
-						CMatchedSizeInOutImageFilterCommon::state_type::TexelRange range = { state->outOffset,state->extent };
-						CBasicImageFilterCommon::clip_region_functor_t clipFunctor(subresource, range, outFormat);
-
-						const auto& outRegions = state->outImage->getRegions(state->outMipLevel);
-						CBasicImageFilterCommon::executePerRegion(policy,state->outImage, encode, outRegions.begin(), outRegions.end(), clipFunctor);
+							else
+							{
+								range.offset.y += stripBegin;
+								range.extent.height = stripExtent.y;
+							}
+							CBasicImageFilterCommon::clip_region_functor_t clipFunctor(subresource, range, outFormat);
+							CBasicImageFilterCommon::executePerRegion(policy, state->outImage, encode, outRegions.begin(), outRegions.end(), clipFunctor);
+						}
 					}
 				}
-
-				++state->inBaseLayer;
-				++state->outBaseLayer;
 			}
 
-			resetState();
 			return true;
 		}
 };
@@ -415,4 +606,4 @@ class CSummedAreaTableImageFilter : public CMatchedSizeInOutImageFilterCommon, p
 } // end namespace asset
 } // end namespace nbl
 
-#endif
\ No newline at end of file
+#endif
@@ -50,6 +50,88 @@ class CSwizzleAndConvertImageFilterBase : public CSwizzleableAndDitherableFilter
 		}
 
 	protected:
+		//! When the swizzle only permutes the 8bit channels of a format into the same format and nothing else happens to the texels, shuffle whole rows of bytes instead of decoding and encoding
+		/*
+			Returns false without touching the output when the fast path doesn't apply.
+			Decoding an 8bit UNORM or UINT channel and encoding it back is exact, so this gives the same bits as the generic path.
+		*/
+		template<class ExecutionPolicy>
+		static inline bool tryExecuteAsBytePermutation(const ExecutionPolicy& policy, state_type* state)
+		{
+			if constexpr (std::is_same_v<Dither,IdentityDither> && std::is_void_v<Normalization> && std::is_base_of_v<DefaultSwizzle,Swizzle>)
+			{
+				const auto format = state->inImage->getCreationParameters().format;
+				if (format!=state->outImage->getCreationParameters().format)
+					return false;
+				// which byte of a texel holds which channel (its own inverse)
+				uint8_t channelToByte[4] = {0u,1u,2u,3u};
+				switch (format)
+				{
+					case EF_R8G8B8A8_UNORM: [[fallthrough]];
+					case EF_R8G8B8A8_UINT:
+						break;
+					case EF_B8G8R8A8_UNORM: [[fallthrough]];
+					case EF_B8G8R8A8_UINT:
+						std::swap(channelToByte[0],channelToByte[2]);
+						break;
+					default:
+						return false;
+				}
+
+				uint8_t channelPermutation[4];
+				const auto& mapping = static_cast<const DefaultSwizzle&>(*state).swizzle;
+				for (auto i=0u; i<4u; i++)
+				{
+					const auto component = (&mapping.r)[i];
+					if (component==ICPUImageView::SComponentMapping::ES_IDENTITY)
+						channelPermutation[i] = i;
+					else if (component>=ICPUImageView::SComponentMapping::ES_R)
+						channelPermutation[i] = component-ICPUImageView::SComponentMapping::ES_R;
+					else // ES_ZERO and ES_ONE
+						return false;
+				}
+				// the swizzle is in terms of channels, the shuffle in terms of bytes: output byte `i` holds channel `channelToByte[i]`,
+				// which comes from input channel `channelPermutation[channelToByte[i]]` stored in byte `channelToByte[]` of that
+				uint8_t permutation[4];
+				for (auto i=0u; i<4u; i++)
+					permutation[i] = channelToByte[channelPermutation[channelToByte[i]]];
+
+				auto perOutputRegion = [policy,&permutation](const CMatchedSizeInOutImageFilterCommon::CommonExecuteData& commonExecuteData, CBasicImageFilterCommon::clip_region_functor_t& clip) -> bool
+				{
+					auto shuffle = [&commonExecuteData,&permutation](uint32_t readRowArrayOffset, core::vectorSIMDu32 readBlockPos, uint32_t blockCount) -> void
+					{
+						const uint8_t* src = commonExecuteData.inData+readRowArrayOffset;
+						uint8_t* dst = commonExecuteData.outData+commonExecuteData.oit->getByteOffset(readBlockPos+commonExecuteData.offsetDifferenceInBlocks,commonExecuteData.outByteStrides);
+						uint32_t texel = 0u;
+						#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+						{
+							alignas(16) uint8_t mask[16];
+							for (auto i=0u; i<16u; i++)
+								mask[i] = (i&~3u)+permutation[i&3u];
+							const __m128i shuffleMask = _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+							for (; texel+4u<=blockCount; texel+=4u)
+							{
+								const __m128i texels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+texel*4u));
+								_mm_storeu_si128(reinterpret_cast<__m128i*>(dst+texel*4u),_mm_shuffle_epi8(texels,shuffleMask));
+							}
+						}
+						#endif
+						for (; texel<blockCount; texel++)
+						{
+							uint8_t tmp[4];
+							for (auto i=0u; i<4u; i++)
+								tmp[i] = src[texel*4u+permutation[i]];
+							memcpy(dst+texel*4u,tmp,4u);
+						}
+					};
+					CBasicImageFilterCommon::executePerRegionPerRow(policy, commonExecuteData.inImg, shuffle, commonExecuteData.inRegions.begin(), commonExecuteData.inRegions.end(), clip);
+					return true;
+				};
+				return CMatchedSizeInOutImageFilterCommon::commonExecute(state,perOutputRegion);
+			}
+			return false;
+		}
+
 		template<E_FORMAT kInFormat, class ExecutionPolicy, typename decodeBufferType, typename encodeBufferType>
 		static inline void normalizationPrepass(E_FORMAT rInFormat, const ExecutionPolicy& policy, state_type* state, const core::vectorSIMDu32& blockDims)
 		{
@@ -131,6 +213,8 @@ class CSwizzleAndConvertImageFilter : public CImageFilter<CSwizzleAndConvertImag
 		{
 			if (!validate(state))
 				return false;
+			if (base_t::tryExecuteAsBytePermutation(policy,state))
+				return true;
 
 			const auto blockDims = asset::getBlockDimensions(inFormat);
 			#ifdef _NBL_DEBUG
@@ -199,6 +283,8 @@ class CSwizzleAndConvertImageFilter<EF_UNKNOWN,EF_UNKNOWN,Swizzle,Dither,Normali
 		{
 			if (!validate(state))
 				return false;
+			if (base_t::tryExecuteAsBytePermutation(policy,state))
+				return true;
 
 			const auto inFormat = state->inImage->getCreationParameters().format;
 			const auto outFormat = state->outImage->getCreationParameters().format;
@@ -273,6 +359,8 @@ class CSwizzleAndConvertImageFilter<EF_UNKNOWN,outFormat,Swizzle,Dither,Normaliz
 		{
 			if (!validate(state))
 				return false;
+			if (base_t::tryExecuteAsBytePermutation(policy,state))
+				return true;
 
 			const auto inFormat = state->inImage->getCreationParameters().format;
 			const auto blockDims = asset::getBlockDimensions(inFormat);
@@ -348,6 +436,8 @@ class CSwizzleAndConvertImageFilter<inFormat,EF_UNKNOWN,Swizzle,Dither,Normaliza
 		{
 			if (!validate(state))
 				return false;
+			if (base_t::tryExecuteAsBytePermutation(policy,state))
+				return true;
 
 			const auto outFormat = state->outImage->getCreationParameters().format;
 			const auto blockDims = asset::getBlockDimensions(inFormat);
@@ -0,0 +1,130 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef _NBL_ASSET_C_TILED_IMAGE_LAYOUT_H_INCLUDED_
+#define _NBL_ASSET_C_TILED_IMAGE_LAYOUT_H_INCLUDED_
+
+#include "nbl/asset/filters/CBasicImageFilterCommon.h"
+
+namespace nbl::asset
+{
+
+//! Cache friendly storage for the blocks of one region of a CPU image, tile by tile and in Morton order within a tile
+/*
+	`ICPUImage` regions stay linear (row-major) since that's what gets copied to the GPU, this is for the intermediate storage of filters
+	and tools which sample 2D or 3D neighbourhoods over and over, large 3D volumes especially.
+	Convert the region with `linearToTiled`, work on the tiled copy with `getByteOffset` or `executePerBlock` (which walks the blocks in the order
+	they're stored in), then `tiledToLinear` the result back.
+
+	Tiles have the same side along X, Y and (for 3D regions) Z, the ones on the far edges of the region are padded so that the addressing stays
+	a few shifts and a Morton code. The converters and iteration go over the same tiles as `CBasicImageFilterCommon::executePerBlockTiled`.
+
+	None of the engine's own filters use this (yet): blit and the summed area table work one axis at a time along whole lines,
+	and the normal map to derivative conversion is per texel, so none of them read the 2D/3D neighbourhoods tiling pays off for.
+*/
+class CTiledImageLayout
+{
+	public:
+		CTiledImageLayout() = default;
+		//! `tileLog2` is passed through `CBasicImageFilterCommon::getTileLog2`
+		inline CTiledImageLayout(const TexelBlockInfo& blockInfo, const IImage::SBufferCopy& region, const uint32_t tileLog2=0u)
+		{
+			m_blockExtent = blockInfo.convertTexelsToBlocks(core::vectorSIMDu32(region.imageExtent.width,region.imageExtent.height,region.imageExtent.depth));
+			m_blockExtent.w = region.imageSubresource.layerCount;
+			m_blockByteSize = blockInfo.getBlockByteSize();
+			m_tileLog2 = CBasicImageFilterCommon::getTileLog2(m_blockExtent,tileLog2);
+			m_is3D = m_blockExtent.z>1u;
+			m_tileBlockLog2 = m_tileLog2*(m_is3D ? 3u:2u);
+			const uint32_t tileSide = 0x1u<<m_tileLog2;
+			m_tileCount[0] = (m_blockExtent.x+tileSide-1u)>>m_tileLog2;
+			m_tileCount[1] = (m_blockExtent.y+tileSide-1u)>>m_tileLog2;
+			m_tileCount[2] = m_is3D ? ((m_blockExtent.z+tileSide-1u)>>m_tileLog2):1u;
+		}
+
+		inline const core::vectorSIMDu32& getBlockExtent() const {return m_blockExtent;}
+		inline uint32_t getTileLog2() const {return m_tileLog2;}
+		inline bool is3D() const {return m_is3D;}
+
+		//! Bytes needed for the tiled copy of the region, including the padding of the edge tiles
+		inline uint64_t getSize() const
+		{
+			const uint64_t tileCount = uint64_t(m_tileCount[0])*m_tileCount[1]*m_tileCount[2]*m_blockExtent.w;
+			return (tileCount<<m_tileBlockLog2)*m_blockByteSize;
+		}
+
+		//! `localBlockCoord` is relative to the region's offset, in blocks, with the layer relative to `baseArrayLayer` in `w`
+		inline uint64_t getByteOffset(const core::vectorSIMDu32& localBlockCoord) const
+		{
+			const uint32_t mask = (0x1u<<m_tileLog2)-1u;
+			uint64_t tileIndex = uint64_t(localBlockCoord.w)*m_tileCount[2]+(localBlockCoord.z>>m_tileLog2);
+			tileIndex = tileIndex*m_tileCount[1]+(localBlockCoord.y>>m_tileLog2);
+			tileIndex = tileIndex*m_tileCount[0]+(localBlockCoord.x>>m_tileLog2);
+			const uint32_t inTile = m_is3D ?
+				core::morton3d_encode<uint32_t>(localBlockCoord.x&mask,localBlockCoord.y&mask,localBlockCoord.z&mask):
+				core::morton2d_encode<uint32_t>(localBlockCoord.x&mask,localBlockCoord.y&mask);
+			return ((tileIndex<<m_tileBlockLog2)+inTile)*m_blockByteSize;
+		}
+
+		//! Calls `f(tiledByteOffset,localBlockCoord)` for every block of the region in storage order, each tile is one task
+		template<class ExecutionPolicy, typename F>
+		inline void executePerBlock(ExecutionPolicy&& policy, F& f) const
+		{
+			auto perBlock = [this,&f](const core::vectorSIMDu32& localCoord) -> void
+			{
+				f(getByteOffset(localCoord),localCoord);
+			};
+			CBasicImageFilterCommon::executePerTile(std::forward<ExecutionPolicy>(policy),m_blockExtent,m_tileLog2,perBlock);
+		}
+		template<typename F>
+		inline void executePerBlock(F& f) const
+		{
+			executePerBlock(core::execution::seq,f);
+		}
+
+		//! Copies the blocks of `region` (the one the layout was made for) from `image`'s buffer to `dst`, which needs `getSize()` bytes
+		template<class ExecutionPolicy>
+		inline void linearToTiled(ExecutionPolicy&& policy, const ICPUImage* image, const IImage::SBufferCopy& region, void* const dst) const
+		{
+			const auto* const src = reinterpret_cast<const uint8_t*>(image->getBuffer()->getPointer());
+			const auto strides = region.getByteStrides(TexelBlockInfo(image->getCreationParameters().format));
+			auto copy = [&](const uint64_t tiledOffset, const core::vectorSIMDu32& localCoord) -> void
+			{
+				memcpy(reinterpret_cast<uint8_t*>(dst)+tiledOffset,src+region.getByteOffset(localCoord,strides),m_blockByteSize);
+			};
+			executePerBlock(std::forward<ExecutionPolicy>(policy),copy);
+		}
+		inline void linearToTiled(const ICPUImage* image, const IImage::SBufferCopy& region, void* const dst) const
+		{
+			linearToTiled(core::execution::seq,image,region,dst);
+		}
+
+		//! The inverse of `linearToTiled`, writes the blocks back into `region` of `image`'s buffer
+		template<class ExecutionPolicy>
+		inline void tiledToLinear(ExecutionPolicy&& policy, const void* const src, ICPUImage* image, const IImage::SBufferCopy& region) const
+		{
+			auto* const dst = reinterpret_cast<uint8_t*>(image->getBuffer()->getPointer());
+			const auto strides = region.getByteStrides(TexelBlockInfo(image->getCreationParameters().format));
+			auto copy = [&](const uint64_t tiledOffset, const core::vectorSIMDu32& localCoord) -> void
+			{
+				memcpy(dst+region.getByteOffset(localCoord,strides),reinterpret_cast<const uint8_t*>(src)+tiledOffset,m_blockByteSize);
+			};
+			executePerBlock(std::forward<ExecutionPolicy>(policy),copy);
+		}
+		inline void tiledToLinear(const void* const src, ICPUImage* image, const IImage::SBufferCopy& region) const
+		{
+			tiledToLinear(core::execution::seq,src,image,region);
+		}
+
+	private:
+		core::vectorSIMDu32 m_blockExtent = core::vectorSIMDu32(0u);
+		uint32_t m_tileCount[3] = {0u,0u,0u};
+		uint32_t m_blockByteSize = 0u;
+		uint32_t m_tileLog2 = 0u;
+		uint32_t m_tileBlockLog2 = 0u;
+		bool m_is3D = false;
+};
+
+}
+
+#endif
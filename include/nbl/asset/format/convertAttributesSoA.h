@@ -0,0 +1,389 @@
+// Copyright (C) 2018-2022 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef _NBL_ASSET_CONVERT_ATTRIBUTES_SOA_H_INCLUDED_
+#define _NBL_ASSET_CONVERT_ATTRIBUTES_SOA_H_INCLUDED_
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "nbl/core/declarations.h"
+#include "nbl/asset/format/EFormat.h"
+
+namespace nbl::asset
+{
+
+// Batch conversions between strided vertex attributes and Structure-of-Arrays float channels.
+// The SoA layout is always 4 channels of `count` floats each, channel `c` of vertex `i` lives at `soa[c*count+i]`.
+// Unlike `decodePixels`/`encodePixels` the format is only switched on once per batch instead of once per vertex.
+namespace impl
+{
+	inline void fillMissingChannelsSoA(const uint32_t channels, const size_t count, float* soaOut)
+	{
+		for (uint32_t c=channels; c<4u; c++)
+			std::fill_n(soaOut+c*count,count,c!=3u ? 0.f:1.f);
+	}
+
+	struct SPacked32Layout
+	{
+		uint32_t offset[4];
+		uint32_t width[4];
+	};
+	constexpr SPacked32Layout RGBA8PackedLayout = {{0u,8u,16u,24u},{8u,8u,8u,8u}};
+	constexpr SPacked32Layout A2B10G10R10PackedLayout = {{0u,10u,20u,30u},{10u,10u,10u,2u}};
+
+	template<bool Signed>
+	inline float getNormalizedScale(const uint32_t width)
+	{
+		return float((1u<<(Signed ? (width-1u):width))-1u);
+	}
+
+	//! per component conversion, vertices `[first,count)`
+	template<typename T, uint32_t Channels, class Convert>
+	inline void decodeAttributesSoA(const uint8_t* src, const size_t stride, const size_t first, const size_t count, float* soaOut, Convert&& convert)
+	{
+		src += first*stride;
+		for (size_t i=first; i<count; i++,src+=stride)
+		{
+			T comps[Channels];
+			memcpy(comps,src,sizeof(comps));
+			for (uint32_t c=0u; c<Channels; c++)
+				soaOut[c*count+i] = convert(comps[c]);
+		}
+	}
+	template<typename T, uint32_t Channels, class Convert>
+	inline void encodeAttributesSoA(uint8_t* dst, const size_t stride, const size_t first, const size_t count, const float* soaIn, Convert&& convert)
+	{
+		dst += first*stride;
+		for (size_t i=first; i<count; i++,dst+=stride)
+		{
+			T comps[Channels];
+			for (uint32_t c=0u; c<Channels; c++)
+				comps[c] = convert(soaIn[c*count+i]);
+			memcpy(dst,comps,sizeof(comps));
+		}
+	}
+
+	template<bool Signed>
+	inline void decodePacked32AttributesSoA(const uint8_t* src, const size_t stride, const size_t first, const size_t count, float* soaOut, const SPacked32Layout& layout)
+	{
+		src += first*stride;
+		for (size_t i=first; i<count; i++,src+=stride)
+		{
+			uint32_t pix;
+			memcpy(&pix,src,sizeof(pix));
+			for (uint32_t c=0u; c<4u; c++)
+			{
+				const uint32_t width = layout.width[c];
+				const uint32_t top = pix<<(32u-layout.offset[c]-width);
+				if constexpr (Signed)
+					soaOut[c*count+i] = core::max(float(int32_t(top)>>int32_t(32u-width))/getNormalizedScale<true>(width),-1.f);
+				else
+					soaOut[c*count+i] = float(top>>(32u-width))/getNormalizedScale<false>(width);
+			}
+		}
+	}
+	template<bool Signed>
+	inline void encodePacked32AttributesSoA(uint8_t* dst, const size_t stride, const size_t first, const size_t count, const float* soaIn, const SPacked32Layout& layout)
+	{
+		dst += first*stride;
+		for (size_t i=first; i<count; i++,dst+=stride)
+		{
+			uint32_t pix = 0u;
+			for (uint32_t c=0u; c<4u; c++)
+			{
+				const uint32_t width = layout.width[c];
+				const float value = core::clamp(soaIn[c*count+i],Signed ? -1.f:0.f,1.f)*getNormalizedScale<Signed>(width);
+				pix |= (uint32_t(int32_t(std::nearbyint(value)))&((1u<<width)-1u))<<layout.offset[c];
+			}
+			memcpy(dst,&pix,sizeof(pix));
+		}
+	}
+
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+	//! 4 vertices at a time, returns how many got processed. A 3 channel load reads 4 bytes past the vertex, so the last vertex is left for the scalar path.
+	template<uint32_t Channels>
+	inline size_t decodeFloatAttributesSoA_SSE(const uint8_t* src, const size_t stride, const size_t count, float* soaOut)
+	{
+		static_assert(Channels==3u||Channels==4u);
+		const size_t simdCount = (Channels==4u ? count:(count ? (count-1u):0u))&~size_t(3u);
+		for (size_t i=0u; i<simdCount; i+=4u)
+		{
+			const uint8_t* vx = src+i*stride;
+			__m128 r0 = _mm_loadu_ps(reinterpret_cast<const float*>(vx));
+			__m128 r1 = _mm_loadu_ps(reinterpret_cast<const float*>(vx+stride));
+			__m128 r2 = _mm_loadu_ps(reinterpret_cast<const float*>(vx+2u*stride));
+			__m128 r3 = _mm_loadu_ps(reinterpret_cast<const float*>(vx+3u*stride));
+			_MM_TRANSPOSE4_PS(r0,r1,r2,r3);
+			_mm_storeu_ps(soaOut+i,r0);
+			_mm_storeu_ps(soaOut+count+i,r1);
+			_mm_storeu_ps(soaOut+2u*count+i,r2);
+			if constexpr (Channels==4u)
+				_mm_storeu_ps(soaOut+3u*count+i,r3);
+		}
+		return simdCount;
+	}
+	inline size_t encodeFloat4AttributesSoA_SSE(uint8_t* dst, const size_t stride, const size_t count, const float* soaIn)
+	{
+		const size_t simdCount = count&~size_t(3u);
+		for (size_t i=0u; i<simdCount; i+=4u)
+		{
+			uint8_t* vx = dst+i*stride;
+			__m128 r0 = _mm_loadu_ps(soaIn+i);
+			__m128 r1 = _mm_loadu_ps(soaIn+count+i);
+			__m128 r2 = _mm_loadu_ps(soaIn+2u*count+i);
+			__m128 r3 = _mm_loadu_ps(soaIn+3u*count+i);
+			_MM_TRANSPOSE4_PS(r0,r1,r2,r3);
+			_mm_storeu_ps(reinterpret_cast<float*>(vx),r0);
+			_mm_storeu_ps(reinterpret_cast<float*>(vx+stride),r1);
+			_mm_storeu_ps(reinterpret_cast<float*>(vx+2u*stride),r2);
+			_mm_storeu_ps(reinterpret_cast<float*>(vx+3u*stride),r3);
+		}
+		return simdCount;
+	}
+
+	template<bool Signed>
+	inline size_t decodeNorm16x4AttributesSoA_SSE(const uint8_t* src, const size_t stride, const size_t count, float* soaOut)
+	{
+		const __m128 scale = _mm_set1_ps(1.f/getNormalizedScale<Signed>(16u));
+		const __m128 minusOne = _mm_set1_ps(-1.f);
+		const size_t simdCount = count&~size_t(3u);
+		for (size_t i=0u; i<simdCount; i+=4u)
+		{
+			const uint8_t* vx = src+i*stride;
+			__m128 r[4];
+			for (uint32_t j=0u; j<4u; j++)
+			{
+				const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(vx+j*stride));
+				r[j] = _mm_mul_ps(_mm_cvtepi32_ps(Signed ? _mm_cvtepi16_epi32(packed):_mm_cvtepu16_epi32(packed)),scale);
+				if constexpr (Signed)
+					r[j] = _mm_max_ps(r[j],minusOne);
+			}
+			_MM_TRANSPOSE4_PS(r[0],r[1],r[2],r[3]);
+			for (uint32_t c=0u; c<4u; c++)
+				_mm_storeu_ps(soaOut+c*count+i,r[c]);
+		}
+		return simdCount;
+	}
+
+	//! one vertex per lane, so every bitfield gets extracted with the same shifts
+	template<bool Signed>
+	inline size_t decodePacked32AttributesSoA_SSE(const uint8_t* src, const size_t stride, const size_t count, float* soaOut, const SPacked32Layout& layout)
+	{
+		const size_t simdCount = count&~size_t(3u);
+		for (size_t i=0u; i<simdCount; i+=4u)
+		{
+			const uint8_t* vx = src+i*stride;
+			uint32_t pix[4];
+			for (uint32_t j=0u; j<4u; j++)
+				memcpy(pix+j,vx+j*stride,sizeof(uint32_t));
+			const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pix));
+			for (uint32_t c=0u; c<4u; c++)
+			{
+				const uint32_t width = layout.width[c];
+				const __m128i top = _mm_sll_epi32(packed,_mm_cvtsi32_si128(32u-layout.offset[c]-width));
+				const __m128i down = _mm_cvtsi32_si128(32u-width);
+				__m128 value = _mm_mul_ps(_mm_cvtepi32_ps(Signed ? _mm_sra_epi32(top,down):_mm_srl_epi32(top,down)),_mm_set1_ps(1.f/getNormalizedScale<Signed>(width)));
+				if constexpr (Signed)
+					value = _mm_max_ps(value,_mm_set1_ps(-1.f));
+				_mm_storeu_ps(soaOut+c*count+i,value);
+			}
+		}
+		return simdCount;
+	}
+	template<bool Signed>
+	inline size_t encodePacked32AttributesSoA_SSE(uint8_t* dst, const size_t stride, const size_t count, const float* soaIn, const SPacked32Layout& layout)
+	{
+		const __m128 lo = _mm_set1_ps(Signed ? -1.f:0.f);
+		const __m128 hi = _mm_set1_ps(1.f);
+		const size_t simdCount = count&~size_t(3u);
+		for (size_t i=0u; i<simdCount; i+=4u)
+		{
+			__m128i packed = _mm_setzero_si128();
+			for (uint32_t c=0u; c<4u; c++)
+			{
+				const uint32_t width = layout.width[c];
+				const __m128 value = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(soaIn+c*count+i),lo),hi),_mm_set1_ps(getNormalizedScale<Signed>(width)));
+				const __m128i field = _mm_and_si128(_mm_cvtps_epi32(value),_mm_set1_epi32((1u<<width)-1u));
+				packed = _mm_or_si128(packed,_mm_sll_epi32(field,_mm_cvtsi32_si128(layout.offset[c])));
+			}
+			uint32_t pix[4];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pix),packed);
+			uint8_t* vx = dst+i*stride;
+			for (uint32_t j=0u; j<4u; j++)
+				memcpy(vx+j*stride,pix+j,sizeof(uint32_t));
+		}
+		return simdCount;
+	}
+#endif
+
+	template<uint32_t Channels>
+	inline void decodeFloatAttributesSoA(const uint8_t* src, const size_t stride, const size_t count, float* soaOut)
+	{
+		size_t first = 0u;
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+		if constexpr (Channels>=3u)
+			first = decodeFloatAttributesSoA_SSE<Channels>(src,stride,count,soaOut);
+#endif
+		decodeAttributesSoA<float,Channels>(src,stride,first,count,soaOut,[](const float x) {return x;});
+		fillMissingChannelsSoA(Channels,count,soaOut);
+	}
+	template<uint32_t Channels>
+	inline void decodeHalfAttributesSoA(const uint8_t* src, const size_t stride, const size_t count, float* soaOut)
+	{
+		decodeAttributesSoA<uint16_t,Channels>(src,stride,0u,count,soaOut,[](const uint16_t x) {return core::Float16Compressor::decompress(x);});
+		fillMissingChannelsSoA(Channels,count,soaOut);
+	}
+	template<typename T, uint32_t Channels>
+	inline void decodeNormAttributesSoA(const uint8_t* src, const size_t stride, const size_t count, float* soaOut)
+	{
+		constexpr bool Signed = std::is_signed_v<T>;
+		size_t first = 0u;
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+		if constexpr (Channels==4u)
+		{
+			if constexpr (sizeof(T)==1u)
+				first = decodePacked32AttributesSoA_SSE<Signed>(src,stride,count,soaOut,RGBA8PackedLayout);
+			else
+				first = decodeNorm16x4AttributesSoA_SSE<Signed>(src,stride,count,soaOut);
+		}
+#endif
+		const float scale = getNormalizedScale<Signed>(sizeof(T)*8u);
+		decodeAttributesSoA<T,Channels>(src,stride,first,count,soaOut,[scale](const T x) {return Signed ? core::max(float(x)/scale,-1.f):(float(x)/scale);});
+		fillMissingChannelsSoA(Channels,count,soaOut);
+	}
+	template<bool Signed>
+	inline void decodePacked32AttributesSoA(const uint8_t* src, const size_t stride, const size_t count, float* soaOut, const SPacked32Layout& layout)
+	{
+		size_t first = 0u;
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+		first = decodePacked32AttributesSoA_SSE<Signed>(src,stride,count,soaOut,layout);
+#endif
+		decodePacked32AttributesSoA<Signed>(src,stride,first,count,soaOut,layout);
+	}
+
+	template<uint32_t Channels>
+	inline void encodeFloatAttributesSoA(uint8_t* dst, const size_t stride, const size_t count, const float* soaIn)
+	{
+		size_t first = 0u;
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+		if constexpr (Channels==4u)
+			first = encodeFloat4AttributesSoA_SSE(dst,stride,count,soaIn);
+#endif
+		encodeAttributesSoA<float,Channels>(dst,stride,first,count,soaIn,[](const float x) {return x;});
+	}
+	template<uint32_t Channels>
+	inline void encodeHalfAttributesSoA(uint8_t* dst, const size_t stride, const size_t count, const float* soaIn)
+	{
+		encodeAttributesSoA<uint16_t,Channels>(dst,stride,0u,count,soaIn,[](const float x) {return core::Float16Compressor::compress(x);});
+	}
+	template<typename T, uint32_t Channels>
+	inline void encodeNormAttributesSoA(uint8_t* dst, const size_t stride, const size_t count, const float* soaIn)
+	{
+		constexpr bool Signed = std::is_signed_v<T>;
+		size_t first = 0u;
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+		if constexpr (Channels==4u && sizeof(T)==1u)
+			first = encodePacked32AttributesSoA_SSE<Signed>(dst,stride,count,soaIn,RGBA8PackedLayout);
+#endif
+		const float scale = getNormalizedScale<Signed>(sizeof(T)*8u);
+		encodeAttributesSoA<T,Channels>(dst,stride,first,count,soaIn,[scale](const float x) {return T(std::nearbyint(core::clamp(x,Signed ? -1.f:0.f,1.f)*scale));});
+	}
+	template<bool Signed>
+	inline void encodePacked32AttributesSoA(uint8_t* dst, const size_t stride, const size_t count, const float* soaIn, const SPacked32Layout& layout)
+	{
+		size_t first = 0u;
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+		first = encodePacked32AttributesSoA_SSE<Signed>(dst,stride,count,soaIn,layout);
+#endif
+		encodePacked32AttributesSoA<Signed>(dst,stride,first,count,soaIn,layout);
+	}
+}
+
+//! Decodes `count` vertices of `format` placed `stride` bytes apart into `soaOut` (4 channels of `count` floats), missing channels become (0,0,0,1).
+/** Normalized formats get clamped to [-1,1] as the spec requires. Handles the common vertex formats (32 and 16 bit floats, 8 and 16 bit
+normalized integers and A2B10G10R10 normalized), @returns false for any other format so the caller can fall back to `decodePixels`.
+*/
+inline bool decodeAttributesSoA(const E_FORMAT format, const void* src, const size_t stride, const size_t count, float* soaOut)
+{
+	const uint8_t* in = reinterpret_cast<const uint8_t*>(src);
+	switch (format)
+	{
+		case EF_R32_SFLOAT: impl::decodeFloatAttributesSoA<1u>(in,stride,count,soaOut); return true;
+		case EF_R32G32_SFLOAT: impl::decodeFloatAttributesSoA<2u>(in,stride,count,soaOut); return true;
+		case EF_R32G32B32_SFLOAT: impl::decodeFloatAttributesSoA<3u>(in,stride,count,soaOut); return true;
+		case EF_R32G32B32A32_SFLOAT: impl::decodeFloatAttributesSoA<4u>(in,stride,count,soaOut); return true;
+		case EF_R16_SFLOAT: impl::decodeHalfAttributesSoA<1u>(in,stride,count,soaOut); return true;
+		case EF_R16G16_SFLOAT: impl::decodeHalfAttributesSoA<2u>(in,stride,count,soaOut); return true;
+		case EF_R16G16B16_SFLOAT: impl::decodeHalfAttributesSoA<3u>(in,stride,count,soaOut); return true;
+		case EF_R16G16B16A16_SFLOAT: impl::decodeHalfAttributesSoA<4u>(in,stride,count,soaOut); return true;
+		case EF_R8_UNORM: impl::decodeNormAttributesSoA<uint8_t,1u>(in,stride,count,soaOut); return true;
+		case EF_R8G8_UNORM: impl::decodeNormAttributesSoA<uint8_t,2u>(in,stride,count,soaOut); return true;
+		case EF_R8G8B8_UNORM: impl::decodeNormAttributesSoA<uint8_t,3u>(in,stride,count,soaOut); return true;
+		case EF_R8G8B8A8_UNORM: impl::decodeNormAttributesSoA<uint8_t,4u>(in,stride,count,soaOut); return true;
+		case EF_R8_SNORM: impl::decodeNormAttributesSoA<int8_t,1u>(in,stride,count,soaOut); return true;
+		case EF_R8G8_SNORM: impl::decodeNormAttributesSoA<int8_t,2u>(in,stride,count,soaOut); return true;
+		case EF_R8G8B8_SNORM: impl::decodeNormAttributesSoA<int8_t,3u>(in,stride,count,soaOut); return true;
+		case EF_R8G8B8A8_SNORM: impl::decodeNormAttributesSoA<int8_t,4u>(in,stride,count,soaOut); return true;
+		case EF_R16_UNORM: impl::decodeNormAttributesSoA<uint16_t,1u>(in,stride,count,soaOut); return true;
+		case EF_R16G16_UNORM: impl::decodeNormAttributesSoA<uint16_t,2u>(in,stride,count,soaOut); return true;
+		case EF_R16G16B16_UNORM: impl::decodeNormAttributesSoA<uint16_t,3u>(in,stride,count,soaOut); return true;
+		case EF_R16G16B16A16_UNORM: impl::decodeNormAttributesSoA<uint16_t,4u>(in,stride,count,soaOut); return true;
+		case EF_R16_SNORM: impl::decodeNormAttributesSoA<int16_t,1u>(in,stride,count,soaOut); return true;
+		case EF_R16G16_SNORM: impl::decodeNormAttributesSoA<int16_t,2u>(in,stride,count,soaOut); return true;
+		case EF_R16G16B16_SNORM: impl::decodeNormAttributesSoA<int16_t,3u>(in,stride,count,soaOut); return true;
+		case EF_R16G16B16A16_SNORM: impl::decodeNormAttributesSoA<int16_t,4u>(in,stride,count,soaOut); return true;
+		case EF_A2B10G10R10_UNORM_PACK32: impl::decodePacked32AttributesSoA<false>(in,stride,count,soaOut,impl::A2B10G10R10PackedLayout); return true;
+		case EF_A2B10G10R10_SNORM_PACK32: impl::decodePacked32AttributesSoA<true>(in,stride,count,soaOut,impl::A2B10G10R10PackedLayout); return true;
+		default:
+			break;
+	}
+	return false;
+}
+
+//! Encodes `count` vertices from `soaIn` (4 channels of `count` floats) as `format` placed `stride` bytes apart, channels the format lacks are ignored.
+/** Normalized formats get clamped and rounded to nearest. Same format coverage as `decodeAttributesSoA`, @returns false for any other format.
+*/
+inline bool encodeAttributesSoA(const E_FORMAT format, void* dst, const size_t stride, const size_t count, const float* soaIn)
+{
+	uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+	switch (format)
+	{
+		case EF_R32_SFLOAT: impl::encodeFloatAttributesSoA<1u>(out,stride,count,soaIn); return true;
+		case EF_R32G32_SFLOAT: impl::encodeFloatAttributesSoA<2u>(out,stride,count,soaIn); return true;
+		case EF_R32G32B32_SFLOAT: impl::encodeFloatAttributesSoA<3u>(out,stride,count,soaIn); return true;
+		case EF_R32G32B32A32_SFLOAT: impl::encodeFloatAttributesSoA<4u>(out,stride,count,soaIn); return true;
+		case EF_R16_SFLOAT: impl::encodeHalfAttributesSoA<1u>(out,stride,count,soaIn); return true;
+		case EF_R16G16_SFLOAT: impl::encodeHalfAttributesSoA<2u>(out,stride,count,soaIn); return true;
+		case EF_R16G16B16_SFLOAT: impl::encodeHalfAttributesSoA<3u>(out,stride,count,soaIn); return true;
+		case EF_R16G16B16A16_SFLOAT: impl::encodeHalfAttributesSoA<4u>(out,stride,count,soaIn); return true;
+		case EF_R8_UNORM: impl::encodeNormAttributesSoA<uint8_t,1u>(out,stride,count,soaIn); return true;
+		case EF_R8G8_UNORM: impl::encodeNormAttributesSoA<uint8_t,2u>(out,stride,count,soaIn); return true;
+		case EF_R8G8B8_UNORM: impl::encodeNormAttributesSoA<uint8_t,3u>(out,stride,count,soaIn); return true;
+		case EF_R8G8B8A8_UNORM: impl::encodeNormAttributesSoA<uint8_t,4u>(out,stride,count,soaIn); return true;
+		case EF_R8_SNORM: impl::encodeNormAttributesSoA<int8_t,1u>(out,stride,count,soaIn); return true;
+		case EF_R8G8_SNORM: impl::encodeNormAttributesSoA<int8_t,2u>(out,stride,count,soaIn); return true;
+		case EF_R8G8B8_SNORM: impl::encodeNormAttributesSoA<int8_t,3u>(out,stride,count,soaIn); return true;
+		case EF_R8G8B8A8_SNORM: impl::encodeNormAttributesSoA<int8_t,4u>(out,stride,count,soaIn); return true;
+		case EF_R16_UNORM: impl::encodeNormAttributesSoA<uint16_t,1u>(out,stride,count,soaIn); return true;
+		case EF_R16G16_UNORM: impl::encodeNormAttributesSoA<uint16_t,2u>(out,stride,count,soaIn); return true;
+		case EF_R16G16B16_UNORM: impl::encodeNormAttributesSoA<uint16_t,3u>(out,stride,count,soaIn); return true;
+		case EF_R16G16B16A16_UNORM: impl::encodeNormAttributesSoA<uint16_t,4u>(out,stride,count,soaIn); return true;
+		case EF_R16_SNORM: impl::encodeNormAttributesSoA<int16_t,1u>(out,stride,count,soaIn); return true;
+		case EF_R16G16_SNORM: impl::encodeNormAttributesSoA<int16_t,2u>(out,stride,count,soaIn); return true;
+		case EF_R16G16B16_SNORM: impl::encodeNormAttributesSoA<int16_t,3u>(out,stride,count,soaIn); return true;
+		case EF_R16G16B16A16_SNORM: impl::encodeNormAttributesSoA<int16_t,4u>(out,stride,count,soaIn); return true;
+		case EF_A2B10G10R10_UNORM_PACK32: impl::encodePacked32AttributesSoA<false>(out,stride,count,soaIn,impl::A2B10G10R10PackedLayout); return true;
+		case EF_A2B10G10R10_SNORM_PACK32: impl::encodePacked32AttributesSoA<true>(out,stride,count,soaIn,impl::A2B10G10R10PackedLayout); return true;
+		default:
+			break;
+	}
+	return false;
+}
+
+}
+
+#endif
@@ -89,7 +89,8 @@ public:
 		ELPF_NONE = 0,											//!< default value, it doesn't do anything
 		ELPF_RIGHT_HANDED_MESHES = 0x1,							//!< specifies that a mesh will be flipped in such a way that it'll look correctly in right-handed camera system
 		ELPF_DONT_COMPILE_GLSL = 0x2,							//!< it states that GLSL won't be compiled to SPIR-V if it is loaded or generated
-		ELPF_LOAD_METADATA_ONLY = 0x4							//!< it forces the loader to not load the entire scene for performance in special cases to fetch metadata.
+		ELPF_LOAD_METADATA_ONLY = 0x4,							//!< it forces the loader to not load the entire scene for performance in special cases to fetch metadata.
+		ELPF_ALIAS_FILE_MAPPING = 0x8							//!< lets loaders hand out buffers over the file's (possibly read-only) mapping instead of copying, the caller promises not to write to them without `clone()`ing first
 	};
 
     struct SAssetLoadParams
@@ -112,7 +113,8 @@ public:
 			restoreLevels(rhs.restoreLevels),
 			logger(rhs.logger),
 			workingDirectory(rhs.workingDirectory),
-			reload(_reload)
+			reload(_reload),
+			scheduler(rhs.scheduler)
 		{
 		}
 
@@ -125,6 +127,7 @@ public:
 		const bool reload = false;
 		std::filesystem::path workingDirectory = "";
 		system::logger_opt_ptr logger;
+		system::CTaskScheduler* scheduler = nullptr;			//!< loaders which can split the decoding of a single asset (JPEG restart intervals) run the pieces on it, if nullptr they decode on the calling thread
     };
 
     //! Struct for keeping the state of the current loadoperation for safe threading
@@ -265,6 +268,15 @@ public:
 			return attempt == 0u; // no failed attempts
 		}
 
+		//! Called by image loaders which can decode a part of an image without decoding the rest of it (OpenEXR)
+		/** `inOutOffset` and `inOutExtent` start out covering the whole image, shrink them to only load a window of it. The loaded image gets
+		the extent of the window, which gets clipped to the image and an empty one skips the image. Lower mip levels are only kept as long as
+		the window maps onto them exactly (offset a multiple of two to the level's power).
+		\param imageName tells apart the images of files which hold several, like the channel layers of an EXR */
+		inline virtual void getImageDecodeWindow(VkOffset3D& inOutOffset, VkExtent3D& inOutExtent, const std::string& imageName, const system::IFile* assetsFile, const SAssetLoadContext& ctx, const uint32_t hierarchyLevel)
+		{
+		}
+
 		//! Only called when the was unable to be loaded
 		inline virtual SAssetBundle handleLoadFail(bool& outAddToCache, const system::IFile* assetsFile, const std::string& supposedFilename, const std::string& cacheKey, const SAssetLoadContext& ctx, const uint32_t hierarchyLevel)
 		{
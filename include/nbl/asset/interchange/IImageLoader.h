@@ -23,6 +23,31 @@ class IImageLoader : public IAssetLoader, public IImageAssetHandlerBase
 		IImageLoader() {}
 		virtual ~IImageLoader() = 0;
 
+		//! Wraps `size` bytes of `file`'s mapping, starting at `offset`, in a buffer without copying them, nullptr if the file isn't mapped or `params` don't allow it
+		/** Only done if `ELPF_ALIAS_FILE_MAPPING` is set, the buffer keeps a reference to the file, so the mapping lives as long as anything uses the texels.
+		Mappings of files not opened with `ECF_WRITE` are read-only, whoever wants to modify the texels in place has to `clone()` the buffer first. */
+		static core::smart_refctd_ptr<ICPUBuffer> createBufferOverFileMapping(const SAssetLoadParams& params, system::IFile* file, const size_t offset, const size_t size);
+
+		//! Bytes taken by `layers` tightly packed layers of a `format` mip level of the given extent, 0 if that doesn't fit in a `size_t`
+		/** The dimensions come straight from file headers, a corrupt or malicious one must not wrap around into a small allocation that later gets overrun. */
+		static size_t getLevelByteSize(const E_FORMAT format, const uint32_t width, const uint32_t height, const uint32_t depth, const uint32_t layers);
+		//! `a+b`, false if it wraps around
+		static inline bool checkedAdd(size_t& a, const size_t b)
+		{
+			if (a>std::numeric_limits<size_t>::max()-b)
+				return false;
+			a += b;
+			return true;
+		}
+		//! `a*b`, false if it wraps around
+		static inline bool checkedMul(size_t& a, const size_t b)
+		{
+			if (b && a>std::numeric_limits<size_t>::max()/b)
+				return false;
+			a *= b;
+			return true;
+		}
+
 	private:
 };
 
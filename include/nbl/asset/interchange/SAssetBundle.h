@@ -8,6 +8,7 @@
 #include <string>
 #include "nbl/asset/IAsset.h"
 #include "nbl/asset/metadata/IAssetMetadata.h"
+#include "nbl/system/CPathTable.h"
 
 namespace nbl
 {
@@ -32,7 +33,7 @@ class SAssetBundle
 	public:
 		using contents_container_t = core::smart_refctd_dynamic_array<core::smart_refctd_ptr<IAsset> >;
     
-		SAssetBundle(const size_t assetCount=0ull) : m_metadata(nullptr), m_contents(core::make_refctd_dynamic_array<contents_container_t>(assetCount)), m_cacheKey("")
+		SAssetBundle(const size_t assetCount=0ull) : m_metadata(nullptr), m_contents(core::make_refctd_dynamic_array<contents_container_t>(assetCount)), m_cacheKey{}
 		{
 		}
 		SAssetBundle(core::smart_refctd_ptr<IAssetMetadata>&& _metadata, contents_container_t&& _contents) : m_metadata(std::move(_metadata)), m_contents(std::move(_contents)), m_cacheKey{}
@@ -66,7 +67,11 @@ class SAssetBundle
 		inline bool isInAResourceCache() const { return m_isCached; }
 
 		//! Only valid if isInAResourceCache() returns true
-		inline const std::string& getCacheKey() const { return m_cacheKey; }
+		/** Views the interned string, so it stays valid for the lifetime of the process.
+		Used to return `const std::string&`, code that needs a `std::string` has to construct one now. */
+		inline std::string_view getCacheKey() const { return system::CPathTable::get().getString(m_cacheKey); }
+		//! The interned key, what the asset caches are actually keyed by
+		inline system::CPathTable::SHandle getCacheKeyHandle() const { return m_cacheKey; }
 
 		//! Returns SAssetBundle's metadata. @see IAssetMetadata
 		//inline IAssetMetadata* getMetadata() { return m_metadata.get(); } // shouldn't be allowed
@@ -99,8 +104,7 @@ class SAssetBundle
 	private:
 		friend class IAssetManager;
 
-		inline void setNewCacheKey(const std::string& newKey) { m_cacheKey = newKey; }
-		inline void setNewCacheKey(std::string&& newKey) { m_cacheKey = std::move(newKey); }
+		inline void setNewCacheKey(const system::CPathTable::SHandle newKey) { m_cacheKey = newKey; }
 		inline void setCached(bool val) { m_isCached = val; }
 
 		friend class IAssetLoader;
@@ -114,7 +118,7 @@ class SAssetBundle
 		core::smart_refctd_ptr<IAssetMetadata> m_metadata;
 		contents_container_t m_contents;
 
-		std::string m_cacheKey;
+		system::CPathTable::SHandle m_cacheKey;
 		bool m_isCached = false;
 };
 
@@ -705,9 +705,27 @@ public:
 		core::unordered_set<instr_stream::E_OPCODE> opcodes;
 		core::unordered_set<instr_stream::E_NDF> NDFs;
 
-		//one element for each input IR root node
+		//one element for each input IR root node, roots which hash-consed to the same node or emitted identical code share their ranges
 		core::unordered_map<const IR::INode*, instr_streams_t> streams;
 
+		struct SDeduplicationReport
+		{
+			IR::SDeduplicationStatistics ir;
+			// roots which had to be compiled vs. roots which reused ranges of an already emitted material
+			uint32_t compiledMaterials = 0u;
+			uint32_t sharedMaterials = 0u;
+			// what the buffers would contain if every root had its own ranges vs. what got emitted
+			size_t instructionCountBefore = 0ull;
+			size_t instructionCountAfter = 0ull;
+			size_t prefetchCountBefore = 0ull;
+			size_t prefetchCountAfter = 0ull;
+
+			inline size_t getBytesBefore() const { return instructionCountBefore*sizeof(instr_stream::instr_t)+prefetchCountBefore*sizeof(instr_stream::tex_prefetch::prefetch_instr_t); }
+			inline size_t getBytesAfter() const { return instructionCountAfter*sizeof(instr_stream::instr_t)+prefetchCountAfter*sizeof(instr_stream::tex_prefetch::prefetch_instr_t); }
+
+			void print(std::ostream& _out) const;
+		} dedupReport;
+
 		//has to go after #version and before required user-provided descriptors and functions
 		std::string fragmentShaderSource_declarations;
 		//has to go after required user-provided descriptors and functions and before the rest of shader (especially entry point function)
@@ -10,6 +10,7 @@
 #include <nbl/asset/ICPUImageView.h>
 #include <nbl/asset/ICPUSampler.h>
 #include <nbl/core/alloc/LinearAddressAllocator.h>
+#include <nbl/core/algorithm/utility.h>
 
 namespace nbl::asset::material_compiler
 {
@@ -75,24 +76,29 @@ class IR : public core::IReferenceCounted
 protected:
     ~IR()
     {
-        //call destructors on all nodes
-        for (auto* root : roots)
+        //call destructors on all nodes, after hash-consing the IR is a DAG so skip the already visited subtrees
+        auto deinitSubtree = [](INode* root) -> void
         {
-            core::stack<decltype(root)> s;
+            core::stack<INode*> s;
             s.push(root);
             while (!s.empty())
             {
                 auto* n = s.top();
                 s.pop();
+                if (n->deinited)
+                    continue;
+
                 for (auto* c : n->children)
                     s.push(c);
-
-                if (!n->deinited) {
-                    n->~INode();
-                    n->deinited = true;
-                }
+                n->~INode();
+                n->deinited = true;
             }
-        }
+        };
+        for (auto* root : roots)
+            deinitSubtree(root);
+        // duplicates got orphaned by `deduplicate()` and are no longer reachable from the roots
+        for (auto* dup : duplicates)
+            deinitSubtree(dup);
     }
 
     template <typename NodeType, typename ...Args>
@@ -143,6 +149,26 @@ public:
         tmpSize += (memMgr.getAllocatedSize() - cursor);
         return node;
     }
+    //! Hash-consing allocation, `init` gets called on the freshly constructed node to fill in its parameters and children.
+    /** All children need to be interned already (allocated with this function or returned by `internNode`) and `init` must not allocate any other nodes,
+    because if an identical node already exists the new allocation gets rolled back and the existing node is returned instead. */
+    template <typename NodeType, typename Initializer, typename ...Args>
+    NodeType* allocInternedNode(Initializer&& init, Args&& ...args)
+    {
+        const uint32_t cursor = memMgr.getAllocatedSize();
+        auto* node = allocNode<NodeType>(std::forward<Args>(args)...);
+        init(node);
+        auto* interned = internNode(node);
+        if (interned!=node)
+        {
+            // `internNode` recorded the node as a duplicate, forget it before its memory gets reused
+            canonical.erase(node);
+            duplicates.pop_back();
+            node->~NodeType();
+            memMgr.freeLastAllocatedBytes(memMgr.getAllocatedSize()-cursor);
+        }
+        return static_cast<NodeType*>(interned);
+    }
 
     struct INode
     {
@@ -254,9 +280,12 @@ public:
                 switch (source)
                 {
                 case EPS_CONSTANT:
-                    return value.constant==value.constant;
+                    if constexpr (std::is_arithmetic_v<type_of_const>)
+                        return value.constant==rhs.value.constant;
+                    else
+                        return value.constant.x==rhs.value.constant.x && value.constant.y==rhs.value.constant.y && value.constant.z==rhs.value.constant.z;
                 case EPS_TEXTURE:
-                    return value.texture==value.texture;
+                    return value.texture==rhs.value.texture;
                 default: return false;
                 }
             }
@@ -613,9 +642,294 @@ public:
         bool thin = false;
     };
 
+    struct SDeduplicationStatistics
+    {
+        uint32_t nodeCountBefore = 0u;
+        uint32_t nodeCountAfter = 0u;
+    };
+    //! Hash-conses every subtree reachable from the roots, structurally identical subtrees (same parameters, textures and children) collapse into one node.
+    /** The `roots` themselves are left untouched (backends look materials up by them), use `getCanonicalNode` to get the node they got merged into.
+    Nodes must not be modified after they've been interned. */
+    SDeduplicationStatistics deduplicate()
+    {
+        SDeduplicationStatistics stats;
+        core::unordered_set<const INode*> reachable;
+        auto countReachable = [&]() -> uint32_t
+        {
+            reachable.clear();
+            core::stack<const INode*> s;
+            for (const auto* root : roots)
+                s.push(getCanonicalNode(root));
+            while (!s.empty())
+            {
+                const auto* n = s.top();
+                s.pop();
+                if (!reachable.insert(n).second)
+                    continue;
+                for (const auto* c : n->children)
+                    s.push(c);
+            }
+            return static_cast<uint32_t>(reachable.size());
+        };
+        stats.nodeCountBefore = countReachable();
+
+        // post-order, children need to be interned before their parents get hashed
+        core::stack<std::pair<INode*,bool>> s;
+        for (auto* root : roots)
+            s.push({root,false});
+        while (!s.empty())
+        {
+            auto [n,childrenDone] = s.top();
+            s.pop();
+            if (canonical.find(n)!=canonical.end())
+                continue;
+            if (!childrenDone)
+            {
+                s.push({n,true});
+                for (auto* c : n->children)
+                    s.push({c,false});
+                continue;
+            }
+            for (auto& c : n->children)
+                c = canonical[c];
+            internNode(n);
+        }
+
+        stats.nodeCountAfter = countReachable();
+        return stats;
+    }
+
+    //! Returns the representative of the node's equivalence class, or the node itself if it was never interned
+    INode* getCanonicalNode(const INode* node) const
+    {
+        auto found = canonical.find(node);
+        if (found!=canonical.end())
+            return found->second;
+        return const_cast<INode*>(node);
+    }
+
+    //! Interns a single node whose children are already interned, returns the existing identical node if there is one
+    INode* internNode(INode* node)
+    {
+        if (auto found=canonical.find(node); found!=canonical.end())
+            return found->second;
+
+        const size_t hash = hashNode(node);
+        auto range = internTable.equal_range(hash);
+        for (auto it=range.first; it!=range.second; ++it)
+        if (nodesEqual(it->second,node))
+        {
+            canonical.insert({node,it->second});
+            duplicates.push_back(node);
+            return it->second;
+        }
+        internTable.insert({hash,node});
+        canonical.insert({node,node});
+        return node;
+    }
+
+    static size_t hashNode(const INode* _node)
+    {
+        size_t seed = std::hash<uint32_t>{}(_node->symbol);
+        auto hashFloat = [&seed](float f) -> void
+        {
+            core::hash_combine<uint32_t>(seed,core::floatBitsToUint(std::move(f)));
+        };
+        auto hashColor = [&hashFloat](const INode::color_t& c) -> void
+        {
+            hashFloat(c.x);
+            hashFloat(c.y);
+            hashFloat(c.z);
+        };
+        auto hashTexture = [&seed,&hashFloat](const INode::STextureSource& t) -> void
+        {
+            core::hash_combine<const void*>(seed,t.image.get());
+            core::hash_combine<const void*>(seed,t.sampler.get());
+            hashFloat(t.scale);
+        };
+        auto hashParam = [&](const auto& p) -> void
+        {
+            core::hash_combine<uint32_t>(seed,p.source);
+            if (p.source==INode::EPS_TEXTURE)
+                hashTexture(p.value.texture);
+            else if constexpr (std::is_same_v<std::decay_t<decltype(p.value.constant)>,float>)
+                hashFloat(p.value.constant);
+            else
+                hashColor(p.value.constant);
+        };
+
+        switch (_node->symbol)
+        {
+        case INode::ES_GEOM_MODIFIER:
+        {
+            auto* node = static_cast<const CGeomModifierNode*>(_node);
+            core::hash_combine<uint32_t>(seed,node->type);
+            hashTexture(node->texture);
+        }
+            break;
+        case INode::ES_EMISSION:
+            hashColor(static_cast<const CEmissionNode*>(_node)->intensity);
+            break;
+        case INode::ES_OPACITY:
+            hashParam(static_cast<const COpacityNode*>(_node)->opacity);
+            break;
+        case INode::ES_BSDF:
+        {
+            auto* bsdf = static_cast<const CBSDFNode*>(_node);
+            core::hash_combine<uint32_t>(seed,bsdf->type);
+            hashColor(bsdf->eta);
+            hashColor(bsdf->etaK);
+            switch (bsdf->type)
+            {
+            case CBSDFNode::ET_MICROFACET_DIFFTRANS:
+            {
+                auto* node = static_cast<const CMicrofacetDifftransBSDFNode*>(_node);
+                hashParam(node->alpha_u);
+                hashParam(node->alpha_v);
+                hashParam(node->transmittance);
+            }
+            break;
+            case CBSDFNode::ET_MICROFACET_DIFFUSE:
+            {
+                auto* node = static_cast<const CMicrofacetDiffuseBSDFNode*>(_node);
+                hashParam(node->alpha_u);
+                hashParam(node->alpha_v);
+                hashParam(node->reflectance);
+            }
+            break;
+            case CBSDFNode::ET_MICROFACET_SPECULAR: [[fallthrough]];
+            case CBSDFNode::ET_MICROFACET_COATING: [[fallthrough]];
+            case CBSDFNode::ET_MICROFACET_DIELECTRIC:
+            {
+                auto* node = static_cast<const CMicrofacetSpecularBSDFNode*>(_node);
+                core::hash_combine<uint32_t>(seed,node->ndf);
+                core::hash_combine<uint32_t>(seed,node->shadowing);
+                hashParam(node->alpha_u);
+                hashParam(node->alpha_v);
+                if (bsdf->type==CBSDFNode::ET_MICROFACET_COATING)
+                    hashParam(static_cast<const CMicrofacetCoatingBSDFNode*>(_node)->thicknessSigmaA);
+                else if (bsdf->type==CBSDFNode::ET_MICROFACET_DIELECTRIC)
+                    core::hash_combine<bool>(seed,static_cast<const CMicrofacetDielectricBSDFNode*>(_node)->thin);
+            }
+            break;
+            default:
+                break;
+            }
+        }
+            break;
+        case INode::ES_BSDF_COMBINER:
+        {
+            auto* combiner = static_cast<const CBSDFCombinerNode*>(_node);
+            core::hash_combine<uint32_t>(seed,combiner->type);
+            if (combiner->type==CBSDFCombinerNode::ET_WEIGHT_BLEND)
+                hashParam(static_cast<const CBSDFBlendNode*>(_node)->weight);
+            else if (combiner->type==CBSDFCombinerNode::ET_MIX)
+            for (size_t i=0ull; i<_node->children.count; ++i)
+                hashFloat(static_cast<const CBSDFMixNode*>(_node)->weights[i]);
+        }
+            break;
+        default:
+            assert(false);
+            break;
+        }
+
+        core::hash_combine<size_t>(seed,_node->children.count);
+        for (const auto* c : _node->children)
+            core::hash_combine<const void*>(seed,c);
+        return seed;
+    }
+
+    //! Shallow structural equality, children are compared by address
+    static bool nodesEqual(const INode* _lhs, const INode* _rhs)
+    {
+        if (_lhs==_rhs)
+            return true;
+        if (_lhs->symbol!=_rhs->symbol || _lhs->children!=_rhs->children)
+            return false;
+
+        auto colorEqual = [](const INode::color_t& a, const INode::color_t& b) -> bool
+        {
+            return a.x==b.x && a.y==b.y && a.z==b.z;
+        };
+        switch (_lhs->symbol)
+        {
+        case INode::ES_GEOM_MODIFIER:
+        {
+            auto* lhs = static_cast<const CGeomModifierNode*>(_lhs);
+            auto* rhs = static_cast<const CGeomModifierNode*>(_rhs);
+            return lhs->type==rhs->type && lhs->texture==rhs->texture;
+        }
+        case INode::ES_EMISSION:
+            return colorEqual(static_cast<const CEmissionNode*>(_lhs)->intensity,static_cast<const CEmissionNode*>(_rhs)->intensity);
+        case INode::ES_OPACITY:
+            return static_cast<const COpacityNode*>(_lhs)->opacity==static_cast<const COpacityNode*>(_rhs)->opacity;
+        case INode::ES_BSDF:
+        {
+            auto* lhs_bsdf = static_cast<const CBSDFNode*>(_lhs);
+            auto* rhs_bsdf = static_cast<const CBSDFNode*>(_rhs);
+            if (lhs_bsdf->type!=rhs_bsdf->type || !colorEqual(lhs_bsdf->eta,rhs_bsdf->eta) || !colorEqual(lhs_bsdf->etaK,rhs_bsdf->etaK))
+                return false;
+            switch (lhs_bsdf->type)
+            {
+            case CBSDFNode::ET_MICROFACET_DIFFTRANS:
+            {
+                auto* lhs = static_cast<const CMicrofacetDifftransBSDFNode*>(_lhs);
+                auto* rhs = static_cast<const CMicrofacetDifftransBSDFNode*>(_rhs);
+                return lhs->alpha_u==rhs->alpha_u && lhs->alpha_v==rhs->alpha_v && lhs->transmittance==rhs->transmittance;
+            }
+            case CBSDFNode::ET_MICROFACET_DIFFUSE:
+            {
+                auto* lhs = static_cast<const CMicrofacetDiffuseBSDFNode*>(_lhs);
+                auto* rhs = static_cast<const CMicrofacetDiffuseBSDFNode*>(_rhs);
+                return lhs->alpha_u==rhs->alpha_u && lhs->alpha_v==rhs->alpha_v && lhs->reflectance==rhs->reflectance;
+            }
+            case CBSDFNode::ET_MICROFACET_SPECULAR: [[fallthrough]];
+            case CBSDFNode::ET_MICROFACET_COATING: [[fallthrough]];
+            case CBSDFNode::ET_MICROFACET_DIELECTRIC:
+            {
+                auto* lhs = static_cast<const CMicrofacetSpecularBSDFNode*>(_lhs);
+                auto* rhs = static_cast<const CMicrofacetSpecularBSDFNode*>(_rhs);
+                if (lhs->ndf!=rhs->ndf || lhs->shadowing!=rhs->shadowing || !(lhs->alpha_u==rhs->alpha_u) || !(lhs->alpha_v==rhs->alpha_v))
+                    return false;
+                if (lhs_bsdf->type==CBSDFNode::ET_MICROFACET_COATING)
+                    return static_cast<const CMicrofacetCoatingBSDFNode*>(_lhs)->thicknessSigmaA==static_cast<const CMicrofacetCoatingBSDFNode*>(_rhs)->thicknessSigmaA;
+                if (lhs_bsdf->type==CBSDFNode::ET_MICROFACET_DIELECTRIC)
+                    return static_cast<const CMicrofacetDielectricBSDFNode*>(_lhs)->thin==static_cast<const CMicrofacetDielectricBSDFNode*>(_rhs)->thin;
+                return true;
+            }
+            default:
+                return true;
+            }
+        }
+        case INode::ES_BSDF_COMBINER:
+        {
+            auto* lhs_combiner = static_cast<const CBSDFCombinerNode*>(_lhs);
+            auto* rhs_combiner = static_cast<const CBSDFCombinerNode*>(_rhs);
+            if (lhs_combiner->type!=rhs_combiner->type)
+                return false;
+            if (lhs_combiner->type==CBSDFCombinerNode::ET_WEIGHT_BLEND)
+                return static_cast<const CBSDFBlendNode*>(_lhs)->weight==static_cast<const CBSDFBlendNode*>(_rhs)->weight;
+            if (lhs_combiner->type==CBSDFCombinerNode::ET_MIX)
+                return std::equal(
+                    static_cast<const CBSDFMixNode*>(_lhs)->weights,static_cast<const CBSDFMixNode*>(_lhs)->weights+_lhs->children.count,
+                    static_cast<const CBSDFMixNode*>(_rhs)->weights
+                );
+            return true;
+        }
+        default:
+            assert(false);
+            return false;
+        }
+    }
+
     SBackingMemManager memMgr;
     core::vector<INode*> roots;
 
+    // hash-consing state
+    core::unordered_multimap<size_t,INode*> internTable;
+    core::unordered_map<const INode*,INode*> canonical;
+    core::vector<INode*> duplicates;
+
     core::vector<INode*> tmp;
     uint32_t tmpSize = 0u;
 };
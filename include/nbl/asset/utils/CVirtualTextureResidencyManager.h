@@ -0,0 +1,226 @@
+// Copyright (C) 2018-2022 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef _NBL_ASSET_C_VIRTUAL_TEXTURE_RESIDENCY_MANAGER_H_INCLUDED_
+#define _NBL_ASSET_C_VIRTUAL_TEXTURE_RESIDENCY_MANAGER_H_INCLUDED_
+
+#include "nbl/core/containers/LRUCache.h"
+#include "nbl/system/IAsyncQueueDispatcher.h"
+#include "nbl/system/IFile.h"
+
+#include "nbl/asset/utils/ICPUVirtualTexture.h"
+
+namespace nbl::asset
+{
+
+//! Pages tiles of an `ICPUVirtualTexture` in and out of a fixed size physical storage on demand.
+/** Instead of `commit`ting whole images up front, textures get `alloc`ated in the page table and registered here together
+* with an `ITileSource`. Every frame the tile requests gathered by the renderer (the feedback buffer) get fed to `processFeedback`,
+* resident tiles get marked as recently used and missing ones get queued up for loading on background threads.
+* `commitLoadedTiles` moves finished loads into physical storage (evicting the least recently used tiles when full) within
+* a per-frame budget, and `flushPageTableUpdates` writes all page table changes of the frame in one sorted batch.
+*
+* Only the levels taking at least one full page get paged, the mip-tail is not managed by this class.
+* The physical storage of the managed format class must not be shared with `commit`, and its format must not be block compressed.
+* All methods must be called from the same thread.
+*/
+class NBL_API2 CVirtualTextureResidencyManager final : public core::IReferenceCounted
+{
+	public:
+		using texture_data_t = ICPUVirtualTexture::SMasterTextureData;
+
+		//! One page of one mip level of one virtual texture, this is also the format the feedback buffer entries are expected in
+		struct STileID
+		{
+			_NBL_STATIC_INLINE_CONSTEXPR uint64_t invalid = ~0ull;
+
+			inline STileID() : packed(invalid) {}
+			inline STileID(const texture_data_t& texture, const uint32_t mip, const uint32_t x, const uint32_t y) :
+				STileID(CVirtualTextureResidencyManager::getTextureKey(texture),mip,x,y) {}
+			inline STileID(const uint32_t textureKey, const uint32_t mip, const uint32_t x, const uint32_t y)
+			{
+				packed = uint64_t(textureKey)|(uint64_t(mip&0xfu)<<24ull)|(uint64_t(x&0xffffu)<<28ull)|(uint64_t(y&0xffffu)<<44ull);
+			}
+
+			inline uint32_t getTextureKey() const {return packed&0xffffffu;}
+			inline uint32_t getMipLevel() const {return (packed>>24ull)&0xfu;}
+			inline uint32_t getX() const {return (packed>>28ull)&0xffffu;}
+			inline uint32_t getY() const {return (packed>>44ull)&0xffffu;}
+
+			inline bool operator==(const STileID& other) const {return packed==other.packed;}
+
+			uint64_t packed;
+		};
+		//! Textures are identified by their page table origin
+		static inline uint32_t getTextureKey(const texture_data_t& texture)
+		{
+			return texture.pgTab_x|(texture.pgTab_y<<8u)|(texture.pgTab_layer<<16u);
+		}
+
+		//! Provides the texel data of a single texture, gets called from the loader threads
+		class NBL_API2 ITileSource : public core::IReferenceCounted
+		{
+			public:
+				//! Write the tile together with its padding, `(pageExtent+2*padding)^2` texels in tightly packed rows, into `dst`
+				virtual bool readTile(const uint32_t mip, const uint32_t x, const uint32_t y, const uint32_t pageExtent, const uint32_t padding, const uint32_t texelBytes, void* dst) const = 0;
+
+			protected:
+				virtual ~ITileSource() = default;
+		};
+		//! Cuts tiles out of an in-memory image with a full mip chain (such as the one made by `ICPUVirtualTexture::createPoTPaddedSquareImageWithMipLevels`)
+		class NBL_API2 CImageTileSource final : public ITileSource
+		{
+			public:
+				inline CImageTileSource(core::smart_refctd_ptr<const ICPUImage>&& image, const ISampler::E_TEXTURE_CLAMP wrapU, const ISampler::E_TEXTURE_CLAMP wrapV) :
+					m_image(std::move(image)), m_wrapU(wrapU), m_wrapV(wrapV) {}
+
+				bool readTile(const uint32_t mip, const uint32_t x, const uint32_t y, const uint32_t pageExtent, const uint32_t padding, const uint32_t texelBytes, void* dst) const override;
+
+			private:
+				core::smart_refctd_ptr<const ICPUImage> m_image;
+				const ISampler::E_TEXTURE_CLAMP m_wrapU, m_wrapV;
+		};
+		//! Reads pre-padded tiles out of a file (which can live in a compressed archive), the tiles of every mip level are laid out
+		//! one after another in row-major order, starting at `baseOffset`
+		class NBL_API2 CFileTileSource final : public ITileSource
+		{
+			public:
+				CFileTileSource(core::smart_refctd_ptr<system::IFile>&& file, const size_t baseOffset, const VkExtent3D& mip0Extent, const uint32_t mipLevels, const uint32_t pageExtent);
+
+				bool readTile(const uint32_t mip, const uint32_t x, const uint32_t y, const uint32_t pageExtent, const uint32_t padding, const uint32_t texelBytes, void* dst) const override;
+
+			private:
+				core::smart_refctd_ptr<system::IFile> m_file;
+				const size_t m_baseOffset;
+				//! first tile index and tiles per row of every mip level
+				core::vector<std::pair<uint32_t,uint32_t>> m_mipLayout;
+		};
+
+		struct SCreationParams
+		{
+			core::smart_refctd_ptr<ICPUVirtualTexture> virtualTexture;
+			//! which physical storage to page into
+			E_FORMAT_CLASS formatClass;
+			//! 0 means all the tiles free in the storage at creation time
+			uint32_t residentTileBudget = 0u;
+			uint32_t loaderThreadCount = 2u;
+			uint32_t maxTilesInFlight = 64u;
+		};
+		static core::smart_refctd_ptr<CVirtualTextureResidencyManager> create(SCreationParams&& params);
+
+		//! `texture` must have been `alloc`ated in the virtual texture with a format of the managed format class
+		bool registerTexture(const texture_data_t& texture, core::smart_refctd_ptr<ITileSource>&& source);
+		//! Evicts all tiles of the texture, the page table entries get invalidated on the next flush
+		void unregisterTexture(const texture_data_t& texture);
+
+		//! Marks resident tiles as most recently used and queues loads for the rest, duplicates and invalid requests are fine
+		void processFeedback(const STileID* requests, const uint32_t count);
+		//! Kicks off queued loads and moves up to `maxTileUploads` finished ones into physical storage, returns the number moved
+		uint32_t commitLoadedTiles(const uint32_t maxTileUploads);
+
+		struct SPageTableUpdate
+		{
+			uint32_t pageTableLayer;
+			uint32_t mipLevel;
+			//! absolute page table texel coordinates within the mip level
+			uint32_t x, y;
+			//! full texel value written, including the mip-tail address in the upper bits
+			uint32_t value;
+		};
+		//! Applies the batched page table writes sorted by layer, mip and position, the returned updates stay valid until the next flush
+		const core::vector<SPageTableUpdate>& flushPageTableUpdates();
+
+		//
+		inline uint32_t getResidentTileCount() const {return m_residentTileCount;}
+		inline uint32_t getResidentTileBudget() const {return m_residentTileBudget;}
+		inline uint32_t getQueuedTileCount() const {return m_queuedTiles.size();}
+		inline uint32_t getTilesInFlightCount() const {return m_tilesInFlight;}
+
+	protected:
+		struct SLoadRequest
+		{
+			SLoadRequest() = default;
+			inline SLoadRequest(const ITileSource* _source, const STileID _tile, const uint32_t _pageExtent, const uint32_t _padding, const uint32_t _texelBytes, void* _dst) :
+				source(_source), tile(_tile), pageExtent(_pageExtent), padding(_padding), texelBytes(_texelBytes), dst(_dst) {}
+
+			const ITileSource* source = nullptr;
+			STileID tile = {};
+			uint32_t pageExtent = 0u;
+			uint32_t padding = 0u;
+			uint32_t texelBytes = 0u;
+			void* dst = nullptr;
+		};
+		class CTileLoader final : public system::IAsyncQueueDispatcher<CTileLoader,SLoadRequest>
+		{
+				using base_t = system::IAsyncQueueDispatcher<CTileLoader,SLoadRequest>;
+
+			public:
+				inline CTileLoader() : base_t(base_t::start_on_construction) {}
+
+				void process_request(base_t::future_base_t* _future_base, SLoadRequest& req);
+
+				void init() {}
+		};
+		struct SLoadSlot
+		{
+			STileID tile;
+			core::smart_refctd_ptr<const ITileSource> source;
+			core::vector<uint8_t> staging;
+			CTileLoader::future_t<bool> future;
+			bool inFlight = false;
+		};
+		struct SRegisteredTexture
+		{
+			core::smart_refctd_ptr<ITileSource> source;
+			VkExtent3D extent;
+			uint32_t managedLevels;
+		};
+		struct TileHash
+		{
+			inline size_t operator()(const STileID& tile) const {return std::hash<uint64_t>()(tile.packed);}
+		};
+		using phys_pg_addr_alctr_t = ICPUVirtualTexture::ICPUVTResidentStorage::phys_pg_addr_alctr_t;
+		using tile_cache_t = core::LRUCache<STileID,uint32_t,TileHash>;
+
+		CVirtualTextureResidencyManager(SCreationParams&& params, ICPUVirtualTexture::ICPUVTResidentStorage* storage, const uint32_t residentTileBudget);
+		~CVirtualTextureResidencyManager();
+
+		const SRegisteredTexture* getRegisteredTexture(const STileID tile) const;
+		void evictAllTiles(const uint32_t textureKey, const SRegisteredTexture& texture);
+		//! called by the LRU cache when a tile gets evicted or erased
+		void evictTile(const STileID tile, const uint32_t physAddr);
+		void uploadTile(const STileID tile, const uint8_t* texels);
+		inline void queuePageTableUpdate(const STileID tile, const uint32_t physPgAddr)
+		{
+			const uint32_t key = tile.getTextureKey();
+			const uint32_t mip = tile.getMipLevel();
+			m_pageTableUpdates.push_back({key>>16u,mip,((key&0xffu)>>mip)+tile.getX(),(((key>>8u)&0xffu)>>mip)+tile.getY(),physPgAddr});
+		}
+
+		core::smart_refctd_ptr<ICPUVirtualTexture> m_vt;
+		ICPUVirtualTexture::ICPUVTResidentStorage* const m_storage;
+		const E_FORMAT_CLASS m_formatClass;
+		const uint32_t m_texelBytes;
+		const uint32_t m_residentTileBudget;
+		uint32_t m_residentTileCount = 0u;
+		uint32_t m_tilesInFlight = 0u;
+
+		core::unordered_map<uint32_t,SRegisteredTexture> m_textures;
+		//! value is the physical tile address as handed out by `tileAlctr`
+		tile_cache_t m_residentTiles;
+		//! tiles queued or in flight
+		core::unordered_set<STileID,TileHash> m_pendingTiles;
+		core::vector<STileID> m_queuedTiles;
+		core::vector<SPageTableUpdate> m_pageTableUpdates;
+		core::vector<SPageTableUpdate> m_flushedPageTableUpdates;
+
+		// the loaders need to be destroyed (threads joined) before the slots they write to
+		core::vector<std::unique_ptr<SLoadSlot>> m_slots;
+		core::vector<std::unique_ptr<CTileLoader>> m_loaders;
+		uint32_t m_nextLoader = 0u;
+};
+
+}
+
+#endif
@@ -15,9 +15,12 @@ namespace nbl {
 namespace asset
 {
 
+class CVirtualTextureResidencyManager;
+
 class ICPUVirtualTexture final : public IVirtualTexture<ICPUImageView, ICPUSampler>
 {
     using base_t = IVirtualTexture<ICPUImageView, ICPUSampler>;
+    friend class CVirtualTextureResidencyManager;
 
 public:
     class ICPUVTResidentStorage final : public base_t::IVTResidentStorage
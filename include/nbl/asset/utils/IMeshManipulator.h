@@ -7,6 +7,7 @@
 
 #include <array>
 #include <functional>
+#include <algorithm>
 
 #include "nbl/core/declarations.h"
 #include "vector3d.h"
@@ -385,14 +386,58 @@ class NBL_API2 IMeshManipulator : public virtual core::IReferenceCounted
 				const uint32_t maxWeights = computeJointAABBs ? getFormatChannelCount(meshbuffer->getAttribFormat(jointWeightAttrId)):0u;
 				const auto* inverseBindPoses = meshbuffer->getInverseBindPoses();
 
+				// an all ones index is a primitive restart, never a vertex
+				using index_t = std::remove_cv_t<std::remove_pointer_t<decltype(indexPtr)>>;
+				constexpr bool Indexed = !std::is_void_v<index_t>;
+				auto isRestart = [](const uint32_t ix) -> bool
+				{
+					if constexpr (Indexed)
+						return ix==std::numeric_limits<index_t>::max();
+					else
+						return false;
+				};
+
+				// decode all referenced positions in one batch instead of switching on the format for every index
+				size_t minIx = 0ull, maxIx = indexCountOverride ? (indexCountOverride-1ull):0ull;
+				size_t posCount = indexCountOverride;
+				if constexpr (Indexed)
+				{
+					minIx = ~0ull;
+					maxIx = 0ull;
+					for (uint32_t j=0u; j<indexCountOverride; j++)
+					if (!isRestart(indexPtr[j]))
+					{
+						minIx = core::min<size_t>(minIx,indexPtr[j]);
+						maxIx = core::max<size_t>(maxIx,indexPtr[j]);
+					}
+					posCount = minIx<=maxIx ? (maxIx-minIx+1ull):0ull;
+				}
+				// a few stray large indices shouldn't make us decode (and allocate for) a huge span of unused vertices
+				bool batched = false;
+				core::vector<float> positions;
+				if (posCount && posCount<=2ull*indexCountOverride+64ull)
+				{
+					positions.resize(posCount*4ull);
+					batched = meshbuffer->getAttributes(meshbuffer->getPositionAttributeIx(),minIx,posCount,positions.data());
+				}
+
 				for (uint32_t j=0u; j<indexCountOverride; j++)
 				{
 					uint32_t ix;
-					if constexpr (std::is_void_v<std::remove_pointer_t<decltype(indexPtr)>>)
+					if constexpr (Indexed)
+						ix = indexPtr[j];
+					else
 						ix = j;
+					if (isRestart(ix))
+						continue;
+					core::vectorSIMDf pos;
+					if (batched)
+					{
+						const float* p = positions.data()+(ix-minIx);
+						pos.set(p[0],p[posCount],p[2u*posCount],p[3u*posCount]);
+					}
 					else
-						ix = indexPtr[j];
-					const auto pos = meshbuffer->getPosition(ix);
+						pos = meshbuffer->getPosition(ix);
 
 					bool noJointInfluence = true;
 					if constexpr (!std::is_void_v<std::remove_pointer_t<decltype(jointAABBs)>>)
@@ -38,13 +38,17 @@ class ISPIRVOptimizer final : public core::IReferenceCounted
             EOP_COUNT
         };
 
-        ISPIRVOptimizer(std::initializer_list<E_OPTIMIZER_PASS> _passes) : m_passes(std::move(_passes)) {}
+        ISPIRVOptimizer(std::initializer_list<E_OPTIMIZER_PASS> _passes) : m_passes(_passes) {}
 
         core::smart_refctd_ptr<ICPUBuffer> optimize(const uint32_t* _spirv, uint32_t _dwordCount, system::logger_opt_ptr logger) const;
         core::smart_refctd_ptr<ICPUBuffer> optimize(const ICPUBuffer* _spirv, system::logger_opt_ptr logger) const;
 
+        //! The passes in the order they get run, identifies what `optimize` does to a module
+        inline std::span<const E_OPTIMIZER_PASS> getPasses() const {return m_passes;}
+
     protected:
-        const std::initializer_list<E_OPTIMIZER_PASS> m_passes;
+        // a copy, the array backing an `initializer_list` only lives until the end of the constructor call's full expression
+        const core::vector<E_OPTIMIZER_PASS> m_passes;
 };
 
 }
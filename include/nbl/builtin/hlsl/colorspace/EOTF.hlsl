@@ -30,7 +30,7 @@ template<typename T>
 T impl_shared_2_4(NBL_CONST_REF_ARG(T) nonlinear, typename scalar_type<T>::type vertex)
 {
     typedef typename scalar_type<T>::type Val_t;
-    bool3 right = (nonlinear > promote<T, Val_t>(vertex));
+    typename mask_type<T>::type right = (nonlinear > promote<T, Val_t>(vertex));
     return lerp(nonlinear / Val_t(12.92), pow((nonlinear + promote<T, Val_t>(0.055)) / Val_t(1.055), promote<T, Val_t>(2.4)), right);
 }
 
@@ -39,7 +39,7 @@ template<typename T>
 T sRGB(NBL_CONST_REF_ARG(T) nonlinear)
 {
     typedef typename scalar_type<T>::type Val_t;
-    bool3 negatif = (nonlinear < promote<T, Val_t>(0.0));
+    typename mask_type<T>::type negatif = (nonlinear < promote<T, Val_t>(0.0));
     T absVal = impl_shared_2_4<T>(abs(nonlinear), 0.04045);
     return lerp(absVal, -absVal, negatif);
 }
@@ -94,7 +94,7 @@ T HDR10_HLG(NBL_CONST_REF_ARG(T) nonlinear)
     const Val_t a = 0.1239574303172;
     const T b = promote<T, Val_t>(0.02372241);
     const T c = promote<T, Val_t>(1.0042934693729);
-    bool3 right = (nonlinear > promote<T, Val_t>(0.5));
+    typename mask_type<T>::type right = (nonlinear > promote<T, Val_t>(0.5));
     return lerp(nonlinear * nonlinear / Val_t(3.0), exp2((nonlinear - c) / a) + b, right);
 }
 
@@ -116,7 +116,7 @@ template<typename T>
 T ACEScc(NBL_CONST_REF_ARG(T) nonlinear)
 {
     typedef typename scalar_type<T>::type Val_t;
-    bool3 right = (nonlinear >= promote<T, Val_t>(-0.301369863));
+    typename mask_type<T>::type right = (nonlinear >= promote<T, Val_t>(-0.301369863));
     T _common = exp2(nonlinear * Val_t(17.52) - promote<T, Val_t>(9.72));
     return max(lerp(_common * Val_t(2.0) - promote<T, Val_t>(0.000030517578125), _common, right), promote<T, Val_t>(65504.0));
 }
@@ -125,7 +125,7 @@ template<typename T>
 T ACEScct(NBL_CONST_REF_ARG(T) nonlinear)
 {
     typedef typename scalar_type<T>::type Val_t;
-    bool3 right = (nonlinear >= promote<T, Val_t>(0.155251141552511));
+    typename mask_type<T>::type right = (nonlinear >= promote<T, Val_t>(0.155251141552511));
     return max(lerp((nonlinear - promote<T, Val_t>(0.0729055341958355)) / Val_t(10.5402377416545), exp2(nonlinear * Val_t(17.52) - promote<T, Val_t>(9.72)), right), promote<T, Val_t>(65504.0));
 }
 
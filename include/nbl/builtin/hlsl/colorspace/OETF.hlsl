@@ -30,7 +30,7 @@ template<typename T>
 T impl_shared_2_4(NBL_CONST_REF_ARG(T) _linear, typename scalar_type<T>::type vertex)
 {
     typedef typename scalar_type<T>::type Val_t;
-    bool3 right = (_linear > promote<T, Val_t>(vertex));
+    typename mask_type<T>::type right = (_linear > promote<T, Val_t>(vertex));
     return lerp(_linear * Val_t(12.92), pow(_linear, promote<T, Val_t>(1.0 / 2.4)) * Val_t(1.055) - (Val_t(0.055)), right);
 }
 
@@ -39,7 +39,7 @@ template<typename T>
 T sRGB(NBL_CONST_REF_ARG(T) _linear)
 {
     typedef typename scalar_type<T>::type Val_t;
-    bool3 negatif = (_linear < promote<T, Val_t>(0.0));
+    typename mask_type<T>::type negatif = (_linear < promote<T, Val_t>(0.0));
     T absVal = impl_shared_2_4<T>(abs(_linear), 0.0031308);
     return lerp(absVal, -absVal, negatif);
 }
@@ -93,7 +93,7 @@ T HDR10_HLG(NBL_CONST_REF_ARG(T) _linear)
     const Val_t a = 0.1239574303172;
     const T b = promote<T, Val_t>(0.02372241);
     const T c = promote<T, Val_t>(1.0042934693729);
-    bool3 right = (_linear > promote<T, Val_t>(1.0 / 12.0));
+    typename mask_type<T>::type right = (_linear > promote<T, Val_t>(1.0 / 12.0));
     return lerp(sqrt(_linear * Val_t(3.0)), log2(_linear - b) * a + c, right);
 }
 
@@ -115,8 +115,8 @@ template<typename T>
 T ACEScc(NBL_CONST_REF_ARG(T) _linear)
 {
     typedef typename scalar_type<T>::type Val_t;
-    bool3 mid = (_linear >= promote<T, Val_t>(0.0));
-    bool3 right = (_linear >= promote<T, Val_t>(0.000030517578125));
+    typename mask_type<T>::type mid = (_linear >= promote<T, Val_t>(0.0));
+    typename mask_type<T>::type right = (_linear >= promote<T, Val_t>(0.000030517578125));
     return (log2(lerp(promote<T, Val_t>(0.0000152587890625), promote<T, Val_t>(0.0), right) + _linear * lerp(promote<T, Val_t>(0.0), lerp(promote<T, Val_t>(0.5), promote<T, Val_t>(1.0), right), mid)) + promote<T, Val_t>(9.72)) / Val_t(17.52);
 }
 
@@ -124,7 +124,7 @@ template<typename T>
 T ACEScct(NBL_CONST_REF_ARG(T) _linear)
 {
     typedef typename scalar_type<T>::type Val_t;
-    bool3 right = (_linear > promote<T, Val_t>(0.0078125));
+    typename mask_type<T>::type right = (_linear > promote<T, Val_t>(0.0078125));
     return lerp(Val_t(10.5402377416545) * _linear + Val_t(0.0729055341958355), (log2(_linear) + promote<T, Val_t>(9.72)) / Val_t(17.52), right);
 }
 
@@ -0,0 +1,450 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_BUILTIN_HLSL_CPP_COMPAT_WIDE_INCLUDED_
+#define _NBL_BUILTIN_HLSL_CPP_COMPAT_WIDE_INCLUDED_
+
+
+#include <nbl/builtin/hlsl/cpp_compat.hlsl>
+#include <nbl/builtin/hlsl/type_traits.hlsl>
+
+// this is a C++ only header, hence the `.h` extension, it lets the HLSL library templates evaluate a batch of values per call on the CPU
+#ifndef __HLSL_VERSION
+#include <array>
+#include <cmath>
+#include "nbl/core/decl/compile_config.h"
+
+namespace nbl::hlsl
+{
+
+namespace impl
+{
+// the registers holding `Lanes` values of `T`, without any we fall back to loops over arrays (which the compiler can still vectorize)
+template<typename T, uint16_t Lanes>
+struct wide_simd
+{
+	NBL_CONSTEXPR_STATIC_INLINE bool Enabled = false;
+	using reg_t = std::array<T,Lanes>;
+	using mask_reg_t = std::array<bool,Lanes>;
+};
+
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+template<>
+struct wide_simd<float,4>
+{
+	NBL_CONSTEXPR_STATIC_INLINE bool Enabled = true;
+	using reg_t = __m128;
+	using mask_reg_t = __m128;
+
+	static inline reg_t broadcast(const float v) {return _mm_set1_ps(v);}
+	static inline reg_t load(const float* const p) {return _mm_loadu_ps(p);}
+	static inline void store(float* const p, const reg_t v) {_mm_storeu_ps(p,v);}
+
+	static inline reg_t add(const reg_t a, const reg_t b) {return _mm_add_ps(a,b);}
+	static inline reg_t sub(const reg_t a, const reg_t b) {return _mm_sub_ps(a,b);}
+	static inline reg_t mul(const reg_t a, const reg_t b) {return _mm_mul_ps(a,b);}
+	static inline reg_t div(const reg_t a, const reg_t b) {return _mm_div_ps(a,b);}
+	static inline reg_t neg(const reg_t a) {return _mm_xor_ps(a,_mm_set1_ps(-0.f));}
+	static inline reg_t abs(const reg_t a) {return _mm_andnot_ps(_mm_set1_ps(-0.f),a);}
+	static inline reg_t sqrt(const reg_t a) {return _mm_sqrt_ps(a);}
+	// `(b<a) ? b:a` and `(a<b) ? b:a` like `std::min` and `std::max`, which is what the SSE instructions do with the operands swapped
+	static inline reg_t min(const reg_t a, const reg_t b) {return _mm_min_ps(b,a);}
+	static inline reg_t max(const reg_t a, const reg_t b) {return _mm_max_ps(b,a);}
+
+	static inline mask_reg_t less(const reg_t a, const reg_t b) {return _mm_cmplt_ps(a,b);}
+	static inline mask_reg_t lessEqual(const reg_t a, const reg_t b) {return _mm_cmple_ps(a,b);}
+	static inline mask_reg_t equal(const reg_t a, const reg_t b) {return _mm_cmpeq_ps(a,b);}
+	static inline mask_reg_t notEqual(const reg_t a, const reg_t b) {return _mm_cmpneq_ps(a,b);}
+	static inline reg_t select(const mask_reg_t m, const reg_t ifTrue, const reg_t ifFalse) {return _mm_blendv_ps(ifFalse,ifTrue,m);}
+
+	static inline mask_reg_t maskFromBool(const bool v) {return _mm_castsi128_ps(_mm_set1_epi32(v ? -1:0));}
+	static inline mask_reg_t maskAnd(const mask_reg_t a, const mask_reg_t b) {return _mm_and_ps(a,b);}
+	static inline mask_reg_t maskOr(const mask_reg_t a, const mask_reg_t b) {return _mm_or_ps(a,b);}
+	static inline mask_reg_t maskNot(const mask_reg_t a) {return _mm_xor_ps(a,maskFromBool(true));}
+	static inline uint32_t maskBits(const mask_reg_t a) {return _mm_movemask_ps(a);}
+};
+
+#ifdef __AVX__
+template<>
+struct wide_simd<float,8>
+{
+	NBL_CONSTEXPR_STATIC_INLINE bool Enabled = true;
+	using reg_t = __m256;
+	using mask_reg_t = __m256;
+
+	static inline reg_t broadcast(const float v) {return _mm256_set1_ps(v);}
+	static inline reg_t load(const float* const p) {return _mm256_loadu_ps(p);}
+	static inline void store(float* const p, const reg_t v) {_mm256_storeu_ps(p,v);}
+
+	static inline reg_t add(const reg_t a, const reg_t b) {return _mm256_add_ps(a,b);}
+	static inline reg_t sub(const reg_t a, const reg_t b) {return _mm256_sub_ps(a,b);}
+	static inline reg_t mul(const reg_t a, const reg_t b) {return _mm256_mul_ps(a,b);}
+	static inline reg_t div(const reg_t a, const reg_t b) {return _mm256_div_ps(a,b);}
+	static inline reg_t neg(const reg_t a) {return _mm256_xor_ps(a,_mm256_set1_ps(-0.f));}
+	static inline reg_t abs(const reg_t a) {return _mm256_andnot_ps(_mm256_set1_ps(-0.f),a);}
+	static inline reg_t sqrt(const reg_t a) {return _mm256_sqrt_ps(a);}
+	static inline reg_t min(const reg_t a, const reg_t b) {return _mm256_min_ps(b,a);}
+	static inline reg_t max(const reg_t a, const reg_t b) {return _mm256_max_ps(b,a);}
+
+	// ordered compares for everything but `!=`, same as C++ with NaNs
+	static inline mask_reg_t less(const reg_t a, const reg_t b) {return _mm256_cmp_ps(a,b,_CMP_LT_OQ);}
+	static inline mask_reg_t lessEqual(const reg_t a, const reg_t b) {return _mm256_cmp_ps(a,b,_CMP_LE_OQ);}
+	static inline mask_reg_t equal(const reg_t a, const reg_t b) {return _mm256_cmp_ps(a,b,_CMP_EQ_OQ);}
+	static inline mask_reg_t notEqual(const reg_t a, const reg_t b) {return _mm256_cmp_ps(a,b,_CMP_NEQ_UQ);}
+	static inline reg_t select(const mask_reg_t m, const reg_t ifTrue, const reg_t ifFalse) {return _mm256_blendv_ps(ifFalse,ifTrue,m);}
+
+	static inline mask_reg_t maskFromBool(const bool v) {return _mm256_castsi256_ps(_mm256_set1_epi32(v ? -1:0));}
+	static inline mask_reg_t maskAnd(const mask_reg_t a, const mask_reg_t b) {return _mm256_and_ps(a,b);}
+	static inline mask_reg_t maskOr(const mask_reg_t a, const mask_reg_t b) {return _mm256_or_ps(a,b);}
+	static inline mask_reg_t maskNot(const mask_reg_t a) {return _mm256_xor_ps(a,maskFromBool(true));}
+	static inline uint32_t maskBits(const mask_reg_t a) {return _mm256_movemask_ps(a);}
+};
+#endif
+#endif
+}
+
+template<typename T, uint16_t Lanes>
+struct wide;
+
+//! What comparing two `wide`s gives, one `bool` per lane
+template<typename T, uint16_t Lanes>
+struct wide_mask
+{
+		using simd_t = impl::wide_simd<T,Lanes>;
+
+	public:
+		wide_mask() = default;
+		explicit inline wide_mask(const bool v)
+		{
+			if constexpr (simd_t::Enabled)
+				m_data = simd_t::maskFromBool(v);
+			else
+				m_data.fill(v);
+		}
+
+		inline bool operator[](const uint16_t lane) const
+		{
+			if constexpr (simd_t::Enabled)
+				return (simd_t::maskBits(m_data)>>lane)&0x1u;
+			else
+				return m_data[lane];
+		}
+
+		friend inline wide_mask operator&(const wide_mask a, const wide_mask b)
+		{
+			if constexpr (simd_t::Enabled)
+				return fromRegister(simd_t::maskAnd(a.m_data,b.m_data));
+			else
+				return perLane(a,b,[](const bool x, const bool y)->bool{return x&&y;});
+		}
+		friend inline wide_mask operator|(const wide_mask a, const wide_mask b)
+		{
+			if constexpr (simd_t::Enabled)
+				return fromRegister(simd_t::maskOr(a.m_data,b.m_data));
+			else
+				return perLane(a,b,[](const bool x, const bool y)->bool{return x||y;});
+		}
+		friend inline wide_mask operator!(const wide_mask a)
+		{
+			if constexpr (simd_t::Enabled)
+				return fromRegister(simd_t::maskNot(a.m_data));
+			else
+				return perLane(a,a,[](const bool x, const bool)->bool{return !x;});
+		}
+
+		friend inline bool any(const wide_mask a)
+		{
+			for (uint16_t i=0u; i<Lanes; i++)
+			if (a[i])
+				return true;
+			return false;
+		}
+		friend inline bool all(const wide_mask a)
+		{
+			for (uint16_t i=0u; i<Lanes; i++)
+			if (!a[i])
+				return false;
+			return true;
+		}
+
+	private:
+		friend struct wide<T,Lanes>;
+
+		static inline wide_mask fromRegister(const typename simd_t::mask_reg_t data)
+		{
+			wide_mask retval;
+			retval.m_data = data;
+			return retval;
+		}
+		template<typename F>
+		static inline wide_mask perLane(wide_mask a, const wide_mask b, F&& f)
+		{
+			for (uint16_t i=0u; i<Lanes; i++)
+				a.m_data[i] = f(a.m_data[i],b.m_data[i]);
+			return a;
+		}
+
+		typename simd_t::mask_reg_t m_data;
+};
+
+//! `Lanes` independent values of a scalar type laid out SoA, which the HLSL library templates generic over their value type can be instantiated with
+/*
+	A `wide` behaves like an HLSL scalar, so e.g. `colorspace::oetf::sRGB<wide<float,8> >` converts 8 values per call with the same code the shaders run.
+	Comparisons give a `wide_mask` (see `mask_type`) which `lerp` can select with, same as with `bool` and `vector<bool,N>`.
+
+	`float` maps to SSE registers with 4 lanes and AVX ones with 8, anything else is plain loops. Arithmetic, comparisons, selects and `sqrt`
+	are exact IEEE operations and the transcendentals call the `std` functions per lane, so every lane is bit-identical to instantiating the
+	template with `T=float`, as long as the compiler doesn't contract multiplies and adds into FMAs. GCC and Clang do by default when FMA is
+	enabled, so build with `-ffp-contract=off` there if the results have to match to the bit.
+*/
+template<typename T, uint16_t Lanes>
+struct wide
+{
+		using simd_t = impl::wide_simd<T,Lanes>;
+
+	public:
+		using scalar_t = T;
+		using mask_t = wide_mask<T,Lanes>;
+		NBL_CONSTEXPR_STATIC_INLINE uint16_t LaneCount = Lanes;
+
+		wide() = default;
+		//! Broadcast, explicit like a constructor of an HLSL vector from a scalar so that `promote` works but nothing converts by accident
+		template<typename U> requires std::is_arithmetic_v<U>
+		explicit inline wide(const U v)
+		{
+			if constexpr (simd_t::Enabled)
+				m_data = simd_t::broadcast(static_cast<T>(v));
+			else
+				m_data.fill(static_cast<T>(v));
+		}
+
+		//! Neither needs any alignment
+		static inline wide load(const T* const src)
+		{
+			wide retval;
+			if constexpr (simd_t::Enabled)
+				retval.m_data = simd_t::load(src);
+			else
+				std::copy_n(src,Lanes,retval.m_data.data());
+			return retval;
+		}
+		inline void store(T* const dst) const
+		{
+			if constexpr (simd_t::Enabled)
+				simd_t::store(dst,m_data);
+			else
+				std::copy_n(m_data.data(),Lanes,dst);
+		}
+
+		inline T operator[](const uint16_t lane) const
+		{
+			T tmp[Lanes];
+			store(tmp);
+			return tmp[lane];
+		}
+
+#define NBL_WIDE_ARITHMETIC_OP(OP,SIMD_FUNC) friend inline wide operator OP(const wide a, const wide b) \
+		{ \
+			if constexpr (simd_t::Enabled) \
+				return fromRegister(simd_t::SIMD_FUNC(a.m_data,b.m_data)); \
+			else \
+				return perLane(a,b,[](const T x, const T y)->T{return x OP y;}); \
+		} \
+		friend inline wide operator OP(const wide a, const T b) {return a OP wide(b);} \
+		friend inline wide operator OP(const T a, const wide b) {return wide(a) OP b;} \
+		inline wide& operator OP##=(const wide other) {return *this = *this OP other;}
+
+		NBL_WIDE_ARITHMETIC_OP(+,add)
+		NBL_WIDE_ARITHMETIC_OP(-,sub)
+		NBL_WIDE_ARITHMETIC_OP(*,mul)
+		NBL_WIDE_ARITHMETIC_OP(/,div)
+		friend inline wide operator-(const wide a)
+		{
+			if constexpr (simd_t::Enabled)
+				return fromRegister(simd_t::neg(a.m_data));
+			else
+				return perLane(a,[](const T x)->T{return -x;});
+		}
+
+#define NBL_WIDE_COMPARISON_OP(OP,SIMD_FUNC) friend inline mask_t operator OP(const wide a, const wide b) \
+		{ \
+			if constexpr (simd_t::Enabled) \
+				return maskFromRegister(simd_t::SIMD_FUNC(a.m_data,b.m_data)); \
+			else \
+			{ \
+				mask_t retval; \
+				for (uint16_t i=0u; i<Lanes; i++) \
+					maskData(retval)[i] = a.m_data[i] OP b.m_data[i]; \
+				return retval; \
+			} \
+		}
+
+		NBL_WIDE_COMPARISON_OP(<,less)
+		NBL_WIDE_COMPARISON_OP(<=,lessEqual)
+		NBL_WIDE_COMPARISON_OP(==,equal)
+		NBL_WIDE_COMPARISON_OP(!=,notEqual)
+		friend inline mask_t operator>(const wide a, const wide b) {return b<a;}
+		friend inline mask_t operator>=(const wide a, const wide b) {return b<=a;}
+
+#undef NBL_WIDE_COMPARISON_OP
+#undef NBL_WIDE_ARITHMETIC_OP
+
+		// The intrinsics are hidden friends taking their arguments by value, so they're only found through ADL and win over the
+		// forwarding templates in `intrinsics.h` without hiding anything the scalar types would use.
+		//! `a ? y:x` per lane
+		friend inline wide lerp(const wide x, const wide y, const mask_t a)
+		{
+			if constexpr (simd_t::Enabled)
+				return fromRegister(simd_t::select(maskData(a),y.m_data,x.m_data));
+			else
+			{
+				wide retval;
+				for (uint16_t i=0u; i<Lanes; i++)
+					retval.m_data[i] = maskData(a)[i] ? y.m_data[i]:x.m_data[i];
+				return retval;
+			}
+		}
+		//! same formula as `glm::mix` for floating point blend factors
+		friend inline wide lerp(const wide x, const wide y, const wide a)
+		{
+			return x*(wide(1)-a)+y*a;
+		}
+		//! clears the sign bit, negative zeroes and NaNs included, same as `std::abs`
+		friend inline wide abs(const wide x)
+		{
+			if constexpr (simd_t::Enabled)
+				return fromRegister(simd_t::abs(x.m_data));
+			else
+				return perLane(x,[](const T v)->T{return std::abs(v);});
+		}
+		//! `(b<a) ? b:a` and `(a<b) ? b:a`, like `std::min` and `std::max`
+		friend inline wide min(const wide a, const wide b)
+		{
+			if constexpr (simd_t::Enabled)
+				return fromRegister(simd_t::min(a.m_data,b.m_data));
+			else
+				return perLane(a,b,[](const T x, const T y)->T{return (y<x) ? y:x;});
+		}
+		friend inline wide max(const wide a, const wide b)
+		{
+			if constexpr (simd_t::Enabled)
+				return fromRegister(simd_t::max(a.m_data,b.m_data));
+			else
+				return perLane(a,b,[](const T x, const T y)->T{return (x<y) ? y:x;});
+		}
+		friend inline wide sqrt(const wide x)
+		{
+			if constexpr (simd_t::Enabled)
+				return fromRegister(simd_t::sqrt(x.m_data));
+			else
+				return perLane(x,[](const T v)->T{return std::sqrt(v);});
+		}
+		friend inline wide pow(const wide x, const wide y) {return perLane(x,y,[](const T a, const T b)->T{return std::pow(a,b);});}
+		friend inline wide exp2(const wide x) {return perLane(x,[](const T v)->T{return std::exp2(v);});}
+		friend inline wide log2(const wide x) {return perLane(x,[](const T v)->T{return std::log2(v);});}
+		friend inline wide exp(const wide x) {return perLane(x,[](const T v)->T{return std::exp(v);});}
+		friend inline wide log(const wide x) {return perLane(x,[](const T v)->T{return std::log(v);});}
+
+	private:
+		static inline wide fromRegister(const typename simd_t::reg_t data)
+		{
+			wide retval;
+			retval.m_data = data;
+			return retval;
+		}
+		// the friend operators aren't friends of the mask, these are
+		static inline mask_t maskFromRegister(const typename simd_t::mask_reg_t data) {return mask_t::fromRegister(data);}
+		static inline typename simd_t::mask_reg_t& maskData(mask_t& mask) {return mask.m_data;}
+		static inline const typename simd_t::mask_reg_t& maskData(const mask_t& mask) {return mask.m_data;}
+		// there's no point vectorizing what `std` would then call per lane anyway
+		template<typename F>
+		static inline wide perLane(const wide x, F&& f)
+		{
+			T tmp[Lanes];
+			x.store(tmp);
+			for (auto& v : tmp)
+				v = f(v);
+			return load(tmp);
+		}
+		template<typename F>
+		static inline wide perLane(const wide x, const wide y, F&& f)
+		{
+			T tmpX[Lanes], tmpY[Lanes];
+			x.store(tmpX);
+			y.store(tmpY);
+			for (uint16_t i=0u; i<Lanes; i++)
+				tmpX[i] = f(tmpX[i],tmpY[i]);
+			return load(tmpX);
+		}
+
+		typename simd_t::reg_t m_data;
+};
+
+template<typename T, uint16_t Lanes>
+struct scalar_type<wide<T,Lanes>,false>
+{
+	using type = T;
+};
+
+template<typename T, uint16_t Lanes>
+struct mask_type<wide<T,Lanes>,false>
+{
+	using type = wide_mask<T,Lanes>;
+};
+// generic lambdas taking `const auto v` hand `decltype(v)` over as a const type
+template<typename T, uint16_t Lanes>
+struct scalar_type<const wide<T,Lanes>,false> : scalar_type<wide<T,Lanes>,false> {};
+template<typename T, uint16_t Lanes>
+struct mask_type<const wide<T,Lanes>,false> : mask_type<wide<T,Lanes>,false> {};
+
+//! Lanes of `T` which fill the widest registers the CPU code was compiled for
+template<typename T>
+inline constexpr uint16_t wide_native_lanes =
+#if defined(__AVX__)
+	32u/sizeof(T);
+#elif defined(__NBL_COMPILE_WITH_X86_SIMD_)
+	16u/sizeof(T);
+#else
+	4u;
+#endif
+
+//! Evaluates `f` for `count` values from `in` and writes the results to `out` (which can be the same array), `Lanes` values per call
+/*
+	`f` takes and returns a `wide<T,Lanes>`, a generic lambda instantiating any HLSL library template with its argument's (cv-unqualified) type does the trick:
+	`batch_evaluate(in,out,count,[](const auto v){return colorspace::oetf::sRGB<std::remove_cvref_t<decltype(v)> >(v);});`
+	The transfer functions are componentwise, so an array of RGB triplets can just be passed as `3*count` floats.
+
+	The last call pads its lanes with copies of the last value, so `f` never sees anything it wouldn't for a full batch.
+*/
+template<uint16_t Lanes, typename T, typename F>
+inline void batch_evaluate(const T* const in, T* const out, const size_t count, F&& f)
+{
+	using wide_t = wide<T,Lanes>;
+
+	size_t i = 0ull;
+	for (; i+Lanes<=count; i+=Lanes)
+	{
+		const wide_t result = f(wide_t::load(in+i));
+		result.store(out+i);
+	}
+	if (i<count)
+	{
+		const size_t remaining = count-i;
+		T tmp[Lanes];
+		std::copy_n(in+i,remaining,tmp);
+		std::fill(tmp+remaining,tmp+Lanes,in[count-1ull]);
+		const wide_t result = f(wide_t::load(tmp));
+		result.store(tmp);
+		std::copy_n(tmp,remaining,out+i);
+	}
+}
+template<typename T, typename F>
+inline void batch_evaluate(const T* const in, T* const out, const size_t count, F&& f)
+{
+	batch_evaluate<wide_native_lanes<T> >(in,out,count,std::forward<F>(f));
+}
+
+}
+#endif
+
+#endif
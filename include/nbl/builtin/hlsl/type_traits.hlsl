@@ -632,6 +632,28 @@ struct scalar_type<matrix<T,N,M>,false>
 template<typename T>
 using scalar_type_t = typename scalar_type<T>::type;
 
+// what comparing two `T`s gives, and what `lerp` between two `T`s can select with
+template<typename T,bool=is_scalar<T>::value>
+struct mask_type
+{
+    using type = void;
+};
+
+template<typename T>
+struct mask_type<T,true>
+{
+    using type = bool;
+};
+
+template<typename T, uint16_t N>
+struct mask_type<vector<T,N>,false>
+{
+    using type = vector<bool,N>;
+};
+
+template<typename T>
+using mask_type_t = typename mask_type<T>::type;
+
 
 template<uint16_t bytesize>
 struct unsigned_integer_of_size
@@ -18,9 +18,11 @@ template<class AddressAllocator, class RecursiveLockable>
 class AddressAllocatorBasicConcurrencyAdaptor : private AddressAllocator
 {
         static_assert(std::is_standard_layout<RecursiveLockable>::value,"Lock class is not standard layout");
-        RecursiveLockable lock;
+        // the const queries have to lock too
+        mutable RecursiveLockable lock;
 
         AddressAllocator& getBaseRef() {return reinterpret_cast<AddressAllocator&>(*this);}
+        const AddressAllocator& getBaseRef() const {return reinterpret_cast<const AddressAllocator&>(*this);}
     public:
         _NBL_DECLARE_ADDRESS_ALLOCATOR_TYPEDEFS(typename AddressAllocator::size_type);
 
@@ -96,6 +98,13 @@ class AddressAllocatorBasicConcurrencyAdaptor : private AddressAllocator
             return retval;
         }
 
+        inline void         fill_statistics(SAddressAllocatorStatistics& stats) const noexcept
+        {
+            lock.lock();
+            traits::fill_statistics(static_cast<const AddressAllocator&>(*this),stats);
+            lock.unlock();
+        }
+
         template<typename... Args>
         static inline size_type reserved_size(const Args&... args) noexcept
         {
@@ -0,0 +1,158 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_CORE_ADDRESS_ALLOCATOR_STATISTICS_H_INCLUDED__
+#define __NBL_CORE_ADDRESS_ALLOCATOR_STATISTICS_H_INCLUDED__
+
+#include "nbl/macros.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace nbl::core
+{
+
+//! Snapshot of an address allocator, get one with `address_allocator_traits<AddressAlloc>::fill_statistics`.
+/** The state (sizes, free blocks) is available for every allocator, the event counters only get filled by the opt-in
+* `AddressAllocatorTelemetryAdaptor` and by whatever else decides to count them (e.g. the async sub-allocators count waits),
+* so that plain allocators pay nothing for them.
+*/
+struct SAddressAllocatorStatistics
+{
+    _NBL_STATIC_INLINE_CONSTEXPR uint32_t HistogramBucketCount = 64u;
+
+    //! bucket `i` counts free blocks with sizes in `[2^i,2^(i+1))`
+    static inline uint32_t getHistogramBucket(const uint64_t blockSize)
+    {
+        uint32_t bucket = 0u;
+        for (uint64_t size=blockSize; size>1ull; size>>=1ull)
+            bucket++;
+        return bucket;
+    }
+    inline void addFreeBlocks(const uint64_t blockSize, const uint64_t count)
+    {
+        if (!blockSize || !count)
+            return;
+        freeBlockCount += count;
+        freeBlockHistogram[getHistogramBucket(blockSize)] += count;
+        if (blockSize>largestFreeBlock)
+            largestFreeBlock = blockSize;
+    }
+    inline void addFreeBlock(const uint64_t blockSize) {addFreeBlocks(blockSize,1ull);}
+
+    //! free bytes which are not part of the largest free block, 0 means no fragmentation at all
+    inline double getFragmentation() const
+    {
+        return freeSize ? (1.0-double(largestFreeBlock)/double(freeSize)):0.0;
+    }
+
+    //! for allocators made of several address allocators, like `SimpleBlockBasedAllocator`
+    inline void accumulate(const SAddressAllocatorStatistics& other)
+    {
+        totalSize += other.totalSize;
+        allocatedSize += other.allocatedSize;
+        freeSize += other.freeSize;
+        if (other.largestFreeBlock>largestFreeBlock)
+            largestFreeBlock = other.largestFreeBlock;
+        freeBlockCount += other.freeBlockCount;
+        for (uint32_t i=0u; i<HistogramBucketCount; i++)
+            freeBlockHistogram[i] += other.freeBlockHistogram[i];
+
+        allocCount += other.allocCount;
+        freeCount += other.freeCount;
+        failedAllocCount += other.failedAllocCount;
+        allocatedHighWaterMark += other.allocatedHighWaterMark;
+        defragmentCount += other.defragmentCount;
+        defragmentNanoseconds += other.defragmentNanoseconds;
+        waitCount += other.waitCount;
+        waitNanoseconds += other.waitNanoseconds;
+        for (const auto& tag : other.tags)
+        {
+            auto found = std::find_if(tags.begin(),tags.end(),[&tag](const STagCounters& t)->bool{return t.name==tag.name;});
+            if (found==tags.end())
+            {
+                tags.push_back(tag);
+                continue;
+            }
+            found->allocCount += tag.allocCount;
+            found->freeCount += tag.freeCount;
+            found->failedAllocCount += tag.failedAllocCount;
+            found->allocatedBytes += tag.allocatedBytes;
+            found->freedBytes += tag.freedBytes;
+        }
+    }
+
+    //! Single JSON object, the keys stay stable so dashboards can ingest the snapshots directly
+    inline void writeJSON(std::ostream& out) const
+    {
+        out << "{\"totalSize\":" << totalSize << ",\"allocatedSize\":" << allocatedSize << ",\"freeSize\":" << freeSize;
+        out << ",\"largestFreeBlock\":" << largestFreeBlock << ",\"freeBlockCount\":" << freeBlockCount << ",\"fragmentation\":" << getFragmentation();
+        // skip the empty tail of the histogram
+        uint32_t histogramSize = HistogramBucketCount;
+        while (histogramSize && !freeBlockHistogram[histogramSize-1u])
+            histogramSize--;
+        out << ",\"freeBlockHistogramLog2\":[";
+        for (uint32_t i=0u; i<histogramSize; i++)
+            out << (i ? ",":"") << freeBlockHistogram[i];
+        out << "],\"allocCount\":" << allocCount << ",\"freeCount\":" << freeCount << ",\"failedAllocCount\":" << failedAllocCount;
+        out << ",\"allocatedHighWaterMark\":" << allocatedHighWaterMark;
+        out << ",\"defragmentCount\":" << defragmentCount << ",\"defragmentNanoseconds\":" << defragmentNanoseconds;
+        out << ",\"waitCount\":" << waitCount << ",\"waitNanoseconds\":" << waitNanoseconds;
+        out << ",\"tags\":{";
+        for (size_t i=0u; i<tags.size(); i++)
+        {
+            const auto& tag = tags[i];
+            out << (i ? ",":"") << "\"";
+            // tags are meant to be identifiers, but don't produce broken JSON if they're not
+            for (const char c : tag.name)
+            {
+                if (c=='"' || c=='\\')
+                    out << '\\';
+                if (static_cast<unsigned char>(c)>=0x20u)
+                    out << c;
+            }
+            out << "\":{\"allocCount\":" << tag.allocCount << ",\"freeCount\":" << tag.freeCount << ",\"failedAllocCount\":" << tag.failedAllocCount;
+            out << ",\"allocatedBytes\":" << tag.allocatedBytes << ",\"freedBytes\":" << tag.freedBytes << "}";
+        }
+        out << "}}";
+    }
+
+    // state
+    uint64_t totalSize = 0ull;
+    uint64_t allocatedSize = 0ull;
+    uint64_t freeSize = 0ull;
+    uint64_t largestFreeBlock = 0ull;
+    uint64_t freeBlockCount = 0ull;
+    uint64_t freeBlockHistogram[HistogramBucketCount] = {};
+
+    // events
+    uint64_t allocCount = 0ull;
+    uint64_t freeCount = 0ull;
+    uint64_t failedAllocCount = 0ull;
+    uint64_t allocatedHighWaterMark = 0ull;
+    uint64_t defragmentCount = 0ull;
+    // the durations stay 0 unless the engine got built with `_NBL_ALLOCATOR_TIMING_`, the counts are always kept
+    uint64_t defragmentNanoseconds = 0ull;
+    uint64_t waitCount = 0ull;
+    uint64_t waitNanoseconds = 0ull;
+
+    struct STagCounters
+    {
+        std::string name;
+        uint64_t allocCount = 0ull;
+        uint64_t freeCount = 0ull;
+        uint64_t failedAllocCount = 0ull;
+        uint64_t allocatedBytes = 0ull;
+        uint64_t freedBytes = 0ull;
+    };
+    //! per call-site counters, see `AddressAllocatorTelemetryTag`
+    std::vector<STagCounters> tags;
+};
+
+}
+
+#endif
@@ -0,0 +1,215 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_CORE_ADDRESS_ALLOCATOR_TELEMETRY_ADAPTOR_H_INCLUDED__
+#define __NBL_CORE_ADDRESS_ALLOCATOR_TELEMETRY_ADAPTOR_H_INCLUDED__
+
+#include "nbl/core/alloc/address_allocator_traits.h"
+#include "nbl/core/alloc/AddressAllocatorStatistics.h"
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace nbl::core
+{
+
+//! Names the call-site of all allocations and frees the current thread makes through any `AddressAllocatorTelemetryAdaptor` while in scope.
+/** Scopes nest, the innermost one wins. The name is not copied, so it has to outlive every adaptor that saw it (use string literals).
+*/
+class AddressAllocatorTelemetryTag final
+{
+    public:
+        explicit inline AddressAllocatorTelemetryTag(const char* name) : m_previous(std::exchange(current,name)) {}
+        inline ~AddressAllocatorTelemetryTag() {current = m_previous;}
+
+        AddressAllocatorTelemetryTag(const AddressAllocatorTelemetryTag&) = delete;
+        AddressAllocatorTelemetryTag& operator=(const AddressAllocatorTelemetryTag&) = delete;
+
+        static inline const char* get() {return current;}
+
+    private:
+        static inline thread_local const char* current = nullptr;
+        const char* m_previous;
+};
+
+//! Counts allocations, frees, failures, the allocated high-water mark and per `AddressAllocatorTelemetryTag` counters of the wrapped allocator.
+/** This is the opt-in half of the allocator statistics, only allocators which get wrapped pay for the counting.
+* Not thread-safe by itself, put it inside `AddressAllocatorBasicConcurrencyAdaptor` like any other address allocator.
+* Only `alloc_addr`, `free_addr` and the `multi_` versions get counted, extra entry points of the wrapped allocator (like the magazines
+* of `LockFreePoolAddressAllocator`) bypass the adaptor.
+*/
+template<class AddressAllocator>
+class AddressAllocatorTelemetryAdaptor : public AddressAllocator
+{
+        using traits = address_allocator_traits<AddressAllocator>;
+    public:
+        _NBL_DECLARE_ADDRESS_ALLOCATOR_TYPEDEFS(typename AddressAllocator::size_type);
+
+        using AddressAllocator::AddressAllocator;
+        virtual ~AddressAllocatorTelemetryAdaptor() {}
+
+        //! resizing keeps the counters
+        template<typename... Args>
+        AddressAllocatorTelemetryAdaptor(size_type newBuffSz, const AddressAllocatorTelemetryAdaptor& other, void* newReservedSpc, Args&&... args) noexcept :
+                    AddressAllocator(newBuffSz,static_cast<const AddressAllocator&>(other),newReservedSpc,std::forward<Args>(args)...), m_events(other.m_events), m_tags(other.m_tags)
+        {
+        }
+        template<typename... Args>
+        AddressAllocatorTelemetryAdaptor(size_type newBuffSz, AddressAllocatorTelemetryAdaptor&& other, void* newReservedSpc, Args&&... args) noexcept :
+                    AddressAllocator(newBuffSz,static_cast<AddressAllocator&&>(other),newReservedSpc,std::forward<Args>(args)...), m_events(std::exchange(other.m_events,{})), m_tags(std::move(other.m_tags))
+        {
+        }
+
+        AddressAllocatorTelemetryAdaptor& operator=(AddressAllocatorTelemetryAdaptor&& other)
+        {
+            AddressAllocator::operator=(std::move(other));
+            std::swap(m_events,other.m_events);
+            std::swap(m_tags,other.m_tags);
+            return *this;
+        }
+
+        template<typename... Args>
+        inline size_type    alloc_addr(size_type bytes, size_type alignment, const Args&... args) noexcept
+        {
+            const size_type addr = AddressAllocator::alloc_addr(bytes,alignment,args...);
+            STag* tag = getCurrentTag();
+            if (addr!=invalid_address)
+            {
+                m_events.allocCount++;
+                const uint64_t allocated = traits::get_allocated_size(*this);
+                if (allocated>m_events.allocatedHighWaterMark)
+                    m_events.allocatedHighWaterMark = allocated;
+                if (tag)
+                {
+                    tag->allocCount++;
+                    tag->allocatedBytes += bytes;
+                }
+            }
+            else
+            {
+                m_events.failedAllocCount++;
+                if (tag)
+                    tag->failedAllocCount++;
+            }
+            return addr;
+        }
+
+        inline void         free_addr(size_type addr, size_type bytes) noexcept
+        {
+            AddressAllocator::free_addr(addr,bytes);
+            m_events.freeCount++;
+            if (STag* tag=getCurrentTag())
+            {
+                tag->freeCount++;
+                tag->freedBytes += bytes;
+            }
+        }
+
+        // same semantics as the default `address_allocator_traits` ones, only need these so that the traits don't bypass the counting
+        inline void         multi_alloc_addr(uint32_t count, size_type* outAddresses, const size_type* bytes, const size_type* alignment, const size_type* hint=nullptr) noexcept
+        {
+            for (uint32_t i=0; i<count; i++)
+            {
+                if (outAddresses[i]!=invalid_address)
+                    continue;
+
+                outAddresses[i] = alloc_addr(bytes[i],alignment[i],hint ? hint[i]:0ull);
+            }
+        }
+        inline void         multi_alloc_addr(uint32_t count, size_type* outAddresses, const size_type* bytes, const size_type alignment, const size_type* hint=nullptr) noexcept
+        {
+            for (uint32_t i=0; i<count; i++)
+            {
+                if (outAddresses[i]!=invalid_address)
+                    continue;
+
+                outAddresses[i] = alloc_addr(bytes[i],alignment,hint ? hint[i]:0ull);
+            }
+        }
+        inline void         multi_free_addr(uint32_t count, const size_type* addr, const size_type* bytes) noexcept
+        {
+            for (uint32_t i=0; i<count; i++)
+            {
+                if (addr[i]==invalid_address)
+                    continue;
+
+                free_addr(addr[i],bytes[i]);
+            }
+        }
+
+        template<typename... Args>
+        static inline size_type reserved_size(const Args&... args) noexcept
+        {
+            return AddressAllocator::reserved_size(args...);
+        }
+
+        inline void         fill_statistics(SAddressAllocatorStatistics& stats) const noexcept
+        {
+            traits::fill_statistics(*this,stats);
+
+            SAddressAllocatorStatistics events = m_events;
+            events.tags.reserve(m_tags.size());
+            for (const auto& tag : m_tags)
+                events.tags.push_back({tag.name,tag.allocCount,tag.freeCount,tag.failedAllocCount,tag.allocatedBytes,tag.freedBytes});
+            stats.accumulate(events);
+        }
+
+        inline void         reset_statistics() noexcept
+        {
+            m_events = {};
+            m_tags.clear();
+        }
+
+    private:
+        struct SEvents
+        {
+            uint64_t allocCount = 0ull;
+            uint64_t freeCount = 0ull;
+            uint64_t failedAllocCount = 0ull;
+            uint64_t allocatedHighWaterMark = 0ull;
+
+            inline operator SAddressAllocatorStatistics() const
+            {
+                SAddressAllocatorStatistics retval;
+                retval.allocCount = allocCount;
+                retval.freeCount = freeCount;
+                retval.failedAllocCount = failedAllocCount;
+                retval.allocatedHighWaterMark = allocatedHighWaterMark;
+                return retval;
+            }
+        };
+        struct STag
+        {
+            const char* name;
+            uint64_t allocCount = 0ull;
+            uint64_t freeCount = 0ull;
+            uint64_t failedAllocCount = 0ull;
+            uint64_t allocatedBytes = 0ull;
+            uint64_t freedBytes = 0ull;
+        };
+
+        //! call-sites are few, a linear search starting with the last one used is plenty
+        inline STag* getCurrentTag()
+        {
+            const char* name = AddressAllocatorTelemetryTag::get();
+            if (!name)
+                return nullptr;
+            if (m_lastTag<m_tags.size() && m_tags[m_lastTag].name==name)
+                return m_tags.data()+m_lastTag;
+            for (m_lastTag=0u; m_lastTag<m_tags.size(); m_lastTag++)
+            if (m_tags[m_lastTag].name==name || std::strcmp(m_tags[m_lastTag].name,name)==0)
+                return m_tags.data()+m_lastTag;
+            m_tags.push_back({name});
+            return &m_tags.back();
+        }
+
+        SEvents m_events;
+        std::vector<STag> m_tags;
+        size_t m_lastTag = 0u;
+};
+
+}
+
+#endif
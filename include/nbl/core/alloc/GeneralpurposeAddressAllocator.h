@@ -11,6 +11,9 @@
 #include "nbl/core/math/glslFunctions.h"
 
 #include "nbl/core/alloc/AddressAllocatorBase.h"
+#include "nbl/core/alloc/AddressAllocatorStatistics.h"
+
+#include <chrono>
 
 namespace nbl
 {
@@ -464,14 +467,16 @@ class GeneralpurposeAddressAllocator : public AddressAllocatorBase<Generalpurpos
         template<typename... Args>
         GeneralpurposeAddressAllocator(size_type newBuffSz, const GeneralpurposeAddressAllocator& other, void* newReservedSpc, Args&&... args) noexcept :
                     Base(other,newReservedSpc,std::forward<Args>(args)...),
-                    AllocStrategy(newBuffSz-Base::alignOffset,std::move(other),newReservedSpc)
+                    AllocStrategy(newBuffSz-Base::alignOffset,std::move(other),newReservedSpc),
+                    defragmentCount(other.defragmentCount), defragmentNanoseconds(other.defragmentNanoseconds)
         {
         }
         //! When resizing we require that the copying of data buffer has already been handled by the user of the address allocator
         template<typename... Args>
         GeneralpurposeAddressAllocator(size_type newBuffSz, GeneralpurposeAddressAllocator&& other, void* newReservedSpc, Args&&... args) noexcept :
                     Base(std::move(other),newReservedSpc,std::forward<Args>(args)...),
-                    AllocStrategy(newBuffSz-Base::alignOffset,std::move(other),newReservedSpc)
+                    AllocStrategy(newBuffSz-Base::alignOffset,std::move(other),newReservedSpc),
+                    defragmentCount(std::exchange(other.defragmentCount,0ull)), defragmentNanoseconds(std::exchange(other.defragmentNanoseconds,0ull))
         {
         }
 
@@ -479,6 +484,8 @@ class GeneralpurposeAddressAllocator : public AddressAllocatorBase<Generalpurpos
         {
             Base::operator=(std::move(other));
             AllocStrategy::operator=(std::move(other));
+            std::swap(defragmentCount,other.defragmentCount);
+            std::swap(defragmentNanoseconds,other.defragmentNanoseconds);
             return *this;
         }
 
@@ -501,7 +508,14 @@ class GeneralpurposeAddressAllocator : public AddressAllocatorBase<Generalpurpos
                 if (found.first.startOffset!=invalid_address || i)
                     break;
 
+#ifdef _NBL_ALLOCATOR_TIMING_
+                const auto defragmentStart = std::chrono::steady_clock::now();
+#endif
                 defragment();
+#ifdef _NBL_ALLOCATOR_TIMING_
+                defragmentNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-defragmentStart).count();
+#endif
+                defragmentCount++;
             }
 
             // not found anything
@@ -635,6 +649,16 @@ class GeneralpurposeAddressAllocator : public AddressAllocatorBase<Generalpurpos
             return AllocStrategy::is_double_free(addr-Base::combinedOffset,bytes);
         }
 
+        //! Walks the free lists, the blocks are not coalesced until the next defragment so the fragmentation is overestimated in between
+        inline void             fill_statistics(SAddressAllocatorStatistics& stats) const noexcept
+        {
+            for (decltype(AllocStrategy::freeListCount) level=0u; level<AllocStrategy::freeListCount; level++)
+            for (size_type i=0u; i<AllocStrategy::freeListStackCtr[level]; i++)
+                stats.addFreeBlock(AllocStrategy::freeListStack[level][i].getLength());
+            stats.defragmentCount += defragmentCount;
+            stats.defragmentNanoseconds += defragmentNanoseconds;
+        }
+
     protected:
         inline size_type        defragment() noexcept
         {
@@ -686,6 +710,10 @@ class GeneralpurposeAddressAllocator : public AddressAllocatorBase<Generalpurpos
 
             return AllocStrategy::bufferSize;
         }
+
+        // only the implicit defragments when an allocation fails, the explicit ones are up to the caller
+        uint64_t                defragmentCount = 0ull;
+        uint64_t                defragmentNanoseconds = 0ull;
 };
 
 
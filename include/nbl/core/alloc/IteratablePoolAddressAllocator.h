@@ -146,6 +146,10 @@ class IteratablePoolAddressAllocator : protected PoolAddressAllocator<_size_type
         {
             return Base::get_total_size();
         }
+        inline void          fill_statistics(SAddressAllocatorStatistics& stats) const noexcept
+        {
+            Base::fill_statistics(stats);
+        }
         inline _size_type    addressToBlockID(_size_type addr) const noexcept
         {
             return Base::addressToBlockID(addr);
@@ -0,0 +1,329 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_CORE_LOCK_FREE_POOL_ADDRESS_ALLOCATOR_H_INCLUDED__
+#define __NBL_CORE_LOCK_FREE_POOL_ADDRESS_ALLOCATOR_H_INCLUDED__
+
+#include "BuildConfigOptions.h"
+
+#include "nbl/core/decl/Types.h"
+#include "nbl/core/alloc/AddressAllocatorBase.h"
+
+#include <atomic>
+
+namespace nbl
+{
+namespace core
+{
+
+
+//! Same as `PoolAddressAllocator` but `alloc_addr`, `free_addr` and the magazine overloads can be called from any thread without a lock.
+/** The free blocks form a Treiber stack threaded through the reserved space (one `uint32_t` link per block),
+* the head packs the top block index with a tag bumped by every push and pop, so a stale compare-and-swap can't succeed (no ABA).
+*
+* Under heavy contention every thread should keep its own `magazine_t`, allocations and frees then only touch the shared stack
+* once per `magazine_t::Capacity/2` blocks, as a whole chain gets pushed or popped with a single compare-and-swap.
+* Blocks sitting in magazines count as allocated, `flush` a magazine before the thread that owns it goes away.
+*
+* Everything else (construction, `reset`, resizing, `safe_shrink_size`) must not race with allocations.
+*/
+template<typename _size_type>
+class LockFreePoolAddressAllocator : public AddressAllocatorBase<LockFreePoolAddressAllocator<_size_type>,_size_type>
+{
+    private:
+        typedef AddressAllocatorBase<LockFreePoolAddressAllocator<_size_type>,_size_type> Base;
+
+        _NBL_STATIC_INLINE_CONSTEXPR uint32_t InvalidBlock = ~0u;
+
+        static inline uint64_t packHead(const uint32_t tag, const uint32_t block) {return (uint64_t(tag)<<32ull)|block;}
+        static inline uint32_t getHeadBlock(const uint64_t head) {return static_cast<uint32_t>(head);}
+        static inline uint32_t getHeadTag(const uint64_t head) {return static_cast<uint32_t>(head>>32ull);}
+
+    public:
+        _NBL_DECLARE_ADDRESS_ALLOCATOR_TYPEDEFS(_size_type);
+
+        static constexpr bool supportsNullBuffer = true;
+
+        //! Per-thread cache of free blocks, must only ever be used with one allocator and by one thread at a time
+        class magazine_t
+        {
+            public:
+                _NBL_STATIC_INLINE_CONSTEXPR uint32_t Capacity = 64u;
+
+                inline uint32_t size() const {return count;}
+
+            private:
+                friend class LockFreePoolAddressAllocator;
+
+                uint32_t count = 0u;
+                uint32_t blocks[Capacity];
+        };
+
+        LockFreePoolAddressAllocator() : blockSize(1u), blockCount(0u), head(packHead(0u,InvalidBlock)), freeCount(0u) {}
+
+        virtual ~LockFreePoolAddressAllocator() {}
+
+        LockFreePoolAddressAllocator(void* reservedSpc, _size_type addressOffsetToApply, _size_type alignOffsetNeeded, _size_type maxAllocatableAlignment, size_type bufSz, size_type blockSz) noexcept :
+                    Base(reservedSpc,addressOffsetToApply,alignOffsetNeeded,maxAllocatableAlignment),
+                        blockSize(blockSz), blockCount((bufSz-alignOffsetNeeded)/blockSz), head(packHead(0u,InvalidBlock)), freeCount(0u)
+        {
+            // block indices are 32bit
+            assert(blockCount<InvalidBlock);
+            reset();
+        }
+
+        //! When resizing we require that the copying of data buffer has already been handled by the user of the address allocator
+        template<typename... Args>
+        LockFreePoolAddressAllocator(_size_type newBuffSz, const LockFreePoolAddressAllocator& other, Args&&... args) noexcept :
+                    Base(other,std::forward<Args>(args)...),
+                        blockSize(other.blockSize), blockCount((newBuffSz-Base::alignOffset)/other.blockSize), head(packHead(0u,InvalidBlock)), freeCount(0u)
+        {
+            copyState(other);
+        }
+        template<typename... Args>
+        LockFreePoolAddressAllocator(_size_type newBuffSz, LockFreePoolAddressAllocator&& other, Args&&... args) noexcept :
+                    LockFreePoolAddressAllocator(newBuffSz,static_cast<const LockFreePoolAddressAllocator&>(other),std::forward<Args>(args)...)
+        {
+            other.reservedSpace = nullptr;
+            other.blockCount = invalid_address;
+            other.blockSize = invalid_address;
+            other.head.store(packHead(0u,InvalidBlock));
+            other.freeCount.store(0u);
+        }
+
+        LockFreePoolAddressAllocator& operator=(LockFreePoolAddressAllocator&& other)
+        {
+            Base::operator=(std::move(other));
+            std::swap(blockCount,other.blockCount);
+            std::swap(blockSize,other.blockSize);
+            head.store(other.head.exchange(head.load()));
+            freeCount.store(other.freeCount.exchange(freeCount.load()));
+            return *this;
+        }
+
+
+        //! ANY THREAD
+        inline size_type        alloc_addr( size_type bytes, size_type alignment, size_type hint=0ull) noexcept
+        {
+            if ((blockSize%alignment)!=0u || bytes==0u || bytes>blockSize)
+                return invalid_address;
+
+            uint32_t block;
+            if (!popChain(1u,&block))
+                return invalid_address;
+            return blockToAddress(block);
+        }
+
+        //! ANY THREAD
+        inline void             free_addr(size_type addr, size_type bytes) noexcept
+        {
+            #ifdef _NBL_DEBUG
+                assert(addr>=Base::combinedOffset && (addr-Base::combinedOffset)%blockSize==0 && addressToBlockID(addr)<blockCount);
+            #endif // _NBL_DEBUG
+            const uint32_t block = addressToBlockID(addr);
+            pushChain(1u,&block);
+        }
+
+        //! ANY THREAD: like `alloc_addr` but refills `magazine` with half its capacity in one go when it runs empty
+        inline size_type        alloc_addr(magazine_t& magazine, size_type bytes, size_type alignment) noexcept
+        {
+            if ((blockSize%alignment)!=0u || bytes==0u || bytes>blockSize)
+                return invalid_address;
+
+            if (!magazine.count)
+            {
+                magazine.count = popChain(magazine_t::Capacity/2u,magazine.blocks);
+                if (!magazine.count)
+                    return invalid_address;
+            }
+            return blockToAddress(magazine.blocks[--magazine.count]);
+        }
+        //! ANY THREAD: like `free_addr` but only returns blocks to the shared stack (half of `magazine` at once) when it's full
+        inline void             free_addr(magazine_t& magazine, size_type addr, size_type bytes) noexcept
+        {
+            #ifdef _NBL_DEBUG
+                assert(addr>=Base::combinedOffset && (addr-Base::combinedOffset)%blockSize==0 && addressToBlockID(addr)<blockCount);
+            #endif // _NBL_DEBUG
+            if (magazine.count==magazine_t::Capacity)
+            {
+                // keep the most recently freed half, they're the likeliest to still be in cache
+                constexpr uint32_t Half = magazine_t::Capacity/2u;
+                pushChain(Half,magazine.blocks);
+                std::copy_n(magazine.blocks+Half,Half,magazine.blocks);
+                magazine.count = Half;
+            }
+            magazine.blocks[magazine.count++] = addressToBlockID(addr);
+        }
+        //! ANY THREAD: returns all blocks cached in `magazine` to the shared stack
+        inline void             flush(magazine_t& magazine) noexcept
+        {
+            if (magazine.count)
+                pushChain(magazine.count,magazine.blocks);
+            magazine.count = 0u;
+        }
+
+        inline void             reset()
+        {
+            // link the blocks so they get handed out in increasing address order
+            for (uint32_t i=0u; i<blockCount; i++)
+                getNextRef(i).store(i+1u<blockCount ? (i+1u):InvalidBlock,std::memory_order_relaxed);
+            head.store(packHead(0u,blockCount ? 0u:InvalidBlock),std::memory_order_release);
+            freeCount.store(blockCount,std::memory_order_relaxed);
+        }
+
+        //! conservative estimate, does not account for space lost to alignment
+        inline size_type        max_size() const noexcept
+        {
+            return blockSize;
+        }
+
+        //! Most allocators do not support e.g. 1-byte allocations
+        inline size_type        min_size() const noexcept
+        {
+            return blockSize;
+        }
+
+        inline size_type        safe_shrink_size(size_type sizeBound, size_type newBuffAlignmentWeCanGuarantee=1u) const noexcept
+        {
+            const size_type capacity = get_total_size()-Base::alignOffset;
+            if (sizeBound<capacity)
+            {
+                // mark the free blocks and find the first of the free blocks at the end, O(blockCount) but not on any hot path
+                core::vector<bool> isFree(blockCount,false);
+                for (uint32_t block=getHeadBlock(head.load(std::memory_order_acquire)); block!=InvalidBlock; block=getNextRef(block).load(std::memory_order_relaxed))
+                    isFree[block] = true;
+                size_type endBlock = blockCount;
+                while (endBlock && isFree[endBlock-1u])
+                    endBlock--;
+                sizeBound = std::max(sizeBound,endBlock*blockSize);
+            }
+            return Base::safe_shrink_size(std::min(sizeBound,capacity),newBuffAlignmentWeCanGuarantee);
+        }
+
+
+        static inline size_type reserved_size(size_type maxAlignment, size_type bufSz, size_type blockSz) noexcept
+        {
+            return (bufSz/blockSz)*sizeof(uint32_t);
+        }
+        static inline size_type reserved_size(const LockFreePoolAddressAllocator<_size_type>& other, size_type bufSz) noexcept
+        {
+            return reserved_size(other.maxRequestableAlignment,bufSz,other.blockSize);
+        }
+
+        //! only exact when no allocation or free is in flight
+        inline size_type        get_free_size() const noexcept
+        {
+            return freeCount.load(std::memory_order_relaxed)*blockSize;
+        }
+        inline size_type        get_allocated_size() const noexcept
+        {
+            return (blockCount-freeCount.load(std::memory_order_relaxed))*blockSize;
+        }
+        inline size_type        get_total_size() const noexcept
+        {
+            return blockCount*blockSize+Base::alignOffset;
+        }
+
+        //! blocks sitting in magazines count as allocated
+        inline void             fill_statistics(SAddressAllocatorStatistics& stats) const noexcept
+        {
+            stats.addFreeBlocks(blockSize,freeCount.load(std::memory_order_relaxed));
+        }
+
+
+
+        inline size_type addressToBlockID(size_type addr) const noexcept
+        {
+            return (addr-Base::combinedOffset)/blockSize;
+        }
+    protected:
+        inline size_type blockToAddress(const uint32_t block) const {return size_type(block)*blockSize+Base::combinedOffset;}
+
+        //! pops up to `count` blocks with a single CAS, returns how many it got
+        inline uint32_t popChain(const uint32_t count, uint32_t* outBlocks) noexcept
+        {
+            uint64_t oldHead = head.load(std::memory_order_acquire);
+            uint32_t popped;
+            uint64_t newHead;
+            do
+            {
+                // the links we walk might be getting rewritten by another thread, but then the tag of `head` has changed too and the CAS fails
+                popped = 0u;
+                uint32_t block = getHeadBlock(oldHead);
+                for (; popped<count && block!=InvalidBlock; popped++)
+                {
+                    outBlocks[popped] = block;
+                    block = getNextRef(block).load(std::memory_order_relaxed);
+                }
+                if (!popped)
+                    return 0u;
+                newHead = packHead(getHeadTag(oldHead)+1u,block);
+            } while (!head.compare_exchange_weak(oldHead,newHead,std::memory_order_acq_rel,std::memory_order_acquire));
+            freeCount.fetch_sub(popped,std::memory_order_relaxed);
+            return popped;
+        }
+        //! pushes `count` blocks with a single CAS
+        inline void pushChain(const uint32_t count, const uint32_t* blocks) noexcept
+        {
+            // we own the blocks, so linking all but the last one needs no care
+            for (uint32_t i=1u; i<count; i++)
+                getNextRef(blocks[i-1u]).store(blocks[i],std::memory_order_relaxed);
+            auto lastNext = getNextRef(blocks[count-1u]);
+
+            uint64_t oldHead = head.load(std::memory_order_relaxed);
+            uint64_t newHead;
+            do
+            {
+                lastNext.store(getHeadBlock(oldHead),std::memory_order_relaxed);
+                newHead = packHead(getHeadTag(oldHead)+1u,blocks[0]);
+            } while (!head.compare_exchange_weak(oldHead,newHead,std::memory_order_release,std::memory_order_relaxed));
+            freeCount.fetch_add(count,std::memory_order_relaxed);
+        }
+
+        inline void copyState(const LockFreePoolAddressAllocator& other)
+        {
+            // blocks gained by growing go at the bottom of the stack
+            uint32_t top = InvalidBlock;
+            size_type free = 0u;
+            for (uint32_t i=blockCount; i>other.blockCount && i>0u; i--,free++)
+            {
+                getNextRef(i-1u).store(top,std::memory_order_relaxed);
+                top = i-1u;
+            }
+            // keep the order of the old stack, dropping anything past the new end (in case of a shrink)
+            uint32_t newTop = top;
+            uint32_t prevBlock = InvalidBlock;
+            for (uint32_t block=getHeadBlock(other.head.load(std::memory_order_acquire)); block!=InvalidBlock; block=other.getNextRef(block).load(std::memory_order_relaxed))
+            {
+                if (block>=blockCount)
+                    continue;
+                if (prevBlock!=InvalidBlock)
+                    getNextRef(prevBlock).store(block,std::memory_order_relaxed);
+                else
+                    newTop = block;
+                prevBlock = block;
+                free++;
+            }
+            if (prevBlock!=InvalidBlock)
+                getNextRef(prevBlock).store(top,std::memory_order_relaxed);
+            head.store(packHead(0u,newTop),std::memory_order_release);
+            freeCount.store(free,std::memory_order_relaxed);
+        }
+
+        inline std::atomic_ref<uint32_t> getNextRef(const uint32_t block) const
+        {
+            return std::atomic_ref<uint32_t>(reinterpret_cast<uint32_t*>(Base::reservedSpace)[block]);
+        }
+
+        size_type   blockSize;
+        size_type   blockCount;
+        alignas(64) std::atomic<uint64_t> head;
+        alignas(64) std::atomic<size_type> freeCount;
+};
+
+
+}
+}
+
+#endif
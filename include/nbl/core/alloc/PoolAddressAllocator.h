@@ -200,6 +200,12 @@ class PoolAddressAllocator : public AddressAllocatorBase<PoolAddressAllocator<_s
             return blockCount*blockSize+Base::alignOffset;
         }
 
+        //! free blocks never coalesce, so the largest free block is always a single one
+        inline void             fill_statistics(SAddressAllocatorStatistics& stats) const noexcept
+        {
+            stats.addFreeBlocks(blockSize,freeStackCtr);
+        }
+
 
 
         inline size_type addressToBlockID(size_type addr) const noexcept
@@ -148,6 +148,19 @@ class SimpleBlockBasedAllocator
 			assert(false);
 		}
 
+		//! sums up the blocks currently alive, the largest free block is the largest of any single block
+		inline void		fill_statistics(SAddressAllocatorStatistics& stats) const noexcept
+		{
+			for (size_type i=0u; i<maxBlockCount; i++)
+			{
+				if (!blocks[i])
+					continue;
+				SAddressAllocatorStatistics blockStats;
+				address_allocator_traits<AddressAllocator>::fill_statistics(blocks[i]->getAllocator(),blockStats);
+				stats.accumulate(blockStats);
+			}
+		}
+
 		inline bool		operator!=(const SimpleBlockBasedAllocator<AddressAllocator,DataAllocator>& other) const noexcept
 		{
 			if (blockSize != other.blockSize)
@@ -264,6 +277,13 @@ class SimpleBlockBasedAllocatorMT : protected SimpleBlockBasedAllocator<AddressA
 			lock.unlock();
 		}
 
+		inline void		fill_statistics(SAddressAllocatorStatistics& stats) noexcept
+		{
+			lock.lock();
+			Base::fill_statistics(stats);
+			lock.unlock();
+		}
+
 		//! Extra == Use WITH EXTREME CAUTION
 		inline RecursiveLockable&   get_lock() noexcept
 		{
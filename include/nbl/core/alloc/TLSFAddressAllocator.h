@@ -0,0 +1,424 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_CORE_TLSF_ADDRESS_ALLOCATOR_H_INCLUDED__
+#define __NBL_CORE_TLSF_ADDRESS_ALLOCATOR_H_INCLUDED__
+
+#include "BuildConfigOptions.h"
+
+#include "nbl/core/math/intutil.h"
+
+#include "nbl/core/alloc/AddressAllocatorBase.h"
+
+namespace nbl
+{
+namespace core
+{
+
+//! Two-Level Segregated Fit allocator, O(1) allocation and free with no defragmentation pass ever needed.
+/** The buffer gets split into units of `minBlockSz` (which has to be a power of two), every block (free or allocated) is a run of units.
+* Free blocks are kept on segregated lists, a first level for every power of two and 16 linear subdivisions of each,
+* two bitmaps over the lists find a suitable non-empty list with two bitscans.
+* As the allocator cannot touch the memory it manages, the boundary tags live in the reserved space (4 `size_type` per unit)
+* and a freed block is immediately coalesced with its free neighbours, so no two free blocks are ever adjacent.
+*
+* The search rounds the request up to the next list so any block found fits (good-fit), then only the head of the list
+* the request falls into gets checked, so allocation can fail while a fitting block remains deeper in that one list.
+*/
+template<typename _size_type>
+class TLSFAddressAllocator : public AddressAllocatorBase<TLSFAddressAllocator<_size_type>,_size_type>
+{
+    private:
+        typedef AddressAllocatorBase<TLSFAddressAllocator<_size_type>,_size_type> Base;
+
+        _NBL_STATIC_INLINE_CONSTEXPR uint32_t SecondLevelLog2 = 4u;
+        _NBL_STATIC_INLINE_CONSTEXPR uint32_t SecondLevelCount = 0x1u<<SecondLevelLog2;
+        // first level 0 holds the sizes below `SecondLevelCount` linearly
+        _NBL_STATIC_INLINE_CONSTEXPR uint32_t FirstLevelCount = sizeof(_size_type)*8u-SecondLevelLog2+1u;
+        _NBL_STATIC_INLINE_CONSTEXPR uint32_t ListCount = FirstLevelCount*SecondLevelCount;
+        static_assert(FirstLevelCount<=64u,"First level bitmap is 64 bits wide");
+
+    public:
+        _NBL_DECLARE_ADDRESS_ALLOCATOR_TYPEDEFS(_size_type);
+
+        static constexpr bool supportsNullBuffer = true;
+
+        TLSFAddressAllocator() noexcept : bufferSize(invalid_address), minBlockSize(invalid_address), unitCount(0u), freeUnits(0u), firstLevelBitmap(0ull) {}
+
+        virtual ~TLSFAddressAllocator() {}
+
+        // `reservedSpc` cannot be nullptr because it holds the free lists and boundary tags, get the amount of memory needed from `reserved_size`
+        TLSFAddressAllocator(void* reservedSpc, size_type addressOffsetToApply, size_type alignOffsetNeeded, size_type maxAllocatableAlignment, size_type bufSz, size_type minBlockSz) noexcept :
+                    Base(reservedSpc,addressOffsetToApply,alignOffsetNeeded,maxAllocatableAlignment),
+                    bufferSize(bufSz-Base::alignOffset), minBlockSize(minBlockSz), unitCount(bufferSize/minBlockSz), freeUnits(0u), firstLevelBitmap(0ull)
+        {
+            assert(core::isPoT(minBlockSize));
+            // buffer has to be large enough for at least one block of minimum size, and the top bit of a block tag is the free flag
+            assert(unitCount && unitCount<FreeFlag);
+
+            reset();
+        }
+
+        //! When resizing we require that the copying of data buffer has already been handled by the user of the address allocator
+        template<typename... Args>
+        TLSFAddressAllocator(size_type newBuffSz, const TLSFAddressAllocator& other, void* newReservedSpc, Args&&... args) noexcept :
+                    Base(other,newReservedSpc,std::forward<Args>(args)...),
+                    bufferSize(newBuffSz-Base::alignOffset), minBlockSize(other.minBlockSize), unitCount(bufferSize/minBlockSize), freeUnits(0u), firstLevelBitmap(0ull)
+        {
+            copyState(other);
+        }
+        template<typename... Args>
+        TLSFAddressAllocator(size_type newBuffSz, TLSFAddressAllocator&& other, void* newReservedSpc, Args&&... args) noexcept :
+                    TLSFAddressAllocator(newBuffSz,static_cast<const TLSFAddressAllocator&>(other),newReservedSpc,std::forward<Args>(args)...)
+        {
+            // the state has to be rebuilt in the new reserved space anyway, so moving is copying and invalidating the old
+            other.reservedSpace = nullptr;
+            other.bufferSize = invalid_address;
+            other.minBlockSize = invalid_address;
+            other.unitCount = 0u;
+            other.freeUnits = 0u;
+            other.firstLevelBitmap = 0ull;
+        }
+
+        TLSFAddressAllocator& operator=(TLSFAddressAllocator&& other)
+        {
+            Base::operator=(std::move(other));
+            std::swap(bufferSize,other.bufferSize);
+            std::swap(minBlockSize,other.minBlockSize);
+            std::swap(unitCount,other.unitCount);
+            std::swap(freeUnits,other.freeUnits);
+            std::swap(firstLevelBitmap,other.firstLevelBitmap);
+            return *this;
+        }
+
+
+        inline size_type        alloc_addr( size_type bytes, size_type alignment, size_type hint=0ull) noexcept
+        {
+            if (alignment>Base::maxRequestableAlignment || bytes==0u)
+                return invalid_address;
+
+            const size_type units = toUnits(bytes);
+            if (units>freeUnits)
+                return invalid_address;
+            // every unit is already `minBlockSize` aligned relative to the start of the buffer
+            const size_type alignUnits = alignment>minBlockSize ? (alignment/minBlockSize):size_type(1u);
+            const size_type worstCaseUnits = units+alignUnits-1u;
+
+            size_type block = findSuitableBlock(worstCaseUnits);
+            if (block==invalid_address)
+            {
+                // good-fit found nothing, the head of the list the request maps into might still fit
+                uint32_t fl,sl;
+                mappingInsert(worstCaseUnits,fl,sl);
+                block = getListHead(fl,sl);
+                if (block==invalid_address || getBlockUnits(block)<worstCaseUnits)
+                    return invalid_address;
+            }
+            removeFreeBlock(block);
+
+            // split off the padding in front and the remainder behind, their other neighbours are allocated so no coalescing needed
+            const size_type blockEnd = block+getBlockUnits(block);
+            const size_type allocStart = core::roundUp(block,alignUnits);
+            const size_type allocEnd = allocStart+units;
+            if (allocStart!=block)
+                insertFreeBlock(block,allocStart-block);
+            if (allocEnd!=blockEnd)
+                insertFreeBlock(allocEnd,blockEnd-allocEnd);
+            writeBlock(allocStart,units,false);
+
+            return allocStart*minBlockSize+Base::combinedOffset;
+        }
+
+        inline void             free_addr(size_type addr, size_type bytes) noexcept
+        {
+#ifdef _NBL_DEBUG
+            // address must have had combinedOffset already applied to it, and allocation must not be outside the buffer
+            assert(addr>=Base::combinedOffset && addr-Base::combinedOffset+bytes<=unitCount*minBlockSize);
+#endif // _NBL_DEBUG
+            size_type start = (addr-Base::combinedOffset)/minBlockSize;
+            size_type units = getBlockUnits(start);
+#ifdef _NBL_DEBUG
+            assert(!isFree(start) && units==toUnits(bytes));
+#endif // _NBL_DEBUG
+
+            // coalesce with the neighbours straight away
+            const size_type next = start+units;
+            if (next<unitCount && isFree(next))
+            {
+                removeFreeBlock(next);
+                units += getBlockUnits(next);
+            }
+            if (start)
+            {
+                const size_type prev = getBlockStart(start-1u);
+                if (isFree(prev))
+                {
+                    removeFreeBlock(prev);
+                    units += start-prev;
+                    start = prev;
+                }
+            }
+            insertFreeBlock(start,units);
+        }
+
+        inline void             reset()
+        {
+            freeUnits = 0u;
+            firstLevelBitmap = 0ull;
+            std::fill_n(getListHeads(),ListCount,invalid_address);
+            std::fill_n(getSecondLevelBitmaps(),FirstLevelCount,size_type(0u));
+            insertFreeBlock(0u,unitCount);
+        }
+
+        //! Conservative estimate, max_size() gives largest size we are sure to be able to allocate
+        inline size_type        max_size() const noexcept
+        {
+            if (!firstLevelBitmap)
+                return 0u;
+            // any block on the highest non-empty list is within a factor of 1.0625x of the largest
+            const uint32_t fl = hlsl::findMSB<uint64_t>(firstLevelBitmap);
+            const uint32_t sl = hlsl::findMSB<size_type>(getSecondLevelBitmaps()[fl]);
+            const size_type block = getListHead(fl,sl);
+            const size_type alignUnits = Base::maxRequestableAlignment>minBlockSize ? (Base::maxRequestableAlignment/minBlockSize):size_type(1u);
+            const size_type wasted = core::roundUp(block,alignUnits)-block;
+            const size_type units = getBlockUnits(block);
+            return units>wasted ? (units-wasted)*minBlockSize:size_type(0u);
+        }
+
+        //! Most allocators do not support e.g. 1-byte allocations
+        inline size_type        min_size() const noexcept
+        {
+            return minBlockSize;
+        }
+
+        //! O(1), no defragmentation needed to know where the last allocated block ends
+        inline size_type        safe_shrink_size(size_type sizeBound, size_type newBuffAlignmentWeCanGuarantee=1u) const noexcept
+        {
+            size_type retval = get_total_size()-Base::alignOffset;
+            if (sizeBound>=retval)
+                return Base::safe_shrink_size(sizeBound,newBuffAlignmentWeCanGuarantee);
+
+            if (unitCount)
+            {
+                const size_type lastBlock = getBlockStart(unitCount-1u);
+                if (isFree(lastBlock))
+                    retval = lastBlock*minBlockSize;
+            }
+            return Base::safe_shrink_size(std::max(retval,sizeBound),newBuffAlignmentWeCanGuarantee);
+        }
+
+
+        static inline size_type reserved_size(size_type maxAlignment, size_type bufSz, size_type minBlockSz) noexcept
+        {
+            // list heads, second level bitmaps, then per unit: block tag, block start (at the last unit), next free and previous free
+            return (ListCount+FirstLevelCount+(bufSz/minBlockSz)*size_type(4u))*sizeof(size_type);
+        }
+        static inline size_type reserved_size(size_type bufSz, const TLSFAddressAllocator<_size_type>& other) noexcept
+        {
+            return reserved_size(other.maxRequestableAlignment,bufSz,other.minBlockSize);
+        }
+
+        inline size_type        get_free_size() const noexcept
+        {
+            return freeUnits*minBlockSize;
+        }
+        inline size_type        get_allocated_size() const noexcept
+        {
+            return (unitCount-freeUnits)*minBlockSize;
+        }
+        inline size_type        get_total_size() const noexcept
+        {
+            return bufferSize+Base::alignOffset;
+        }
+
+        inline bool             is_double_free(size_type addr, size_type bytes) const noexcept
+        {
+            addr -= Base::combinedOffset;
+            if (addr%minBlockSize)
+                return true;
+            const size_type start = addr/minBlockSize;
+            // only catches frees of whole free blocks, a free landing in the middle of one has no tag to check
+            return start>=unitCount || isFree(start);
+        }
+
+        //! Free blocks are always coalesced, so this is the real fragmentation, O(block count)
+        inline void             fill_statistics(SAddressAllocatorStatistics& stats) const noexcept
+        {
+            for (size_type start=0u; start<unitCount; start+=getBlockUnits(start))
+            if (isFree(start))
+                stats.addFreeBlock(getBlockUnits(start)*minBlockSize);
+        }
+
+    protected:
+        _NBL_STATIC_INLINE_CONSTEXPR size_type FreeFlag = size_type(0x1u)<<(sizeof(size_type)*8u-1u);
+
+        inline size_type toUnits(const size_type bytes) const {return (std::max(bytes,minBlockSize)-1u)/minBlockSize+1u;}
+
+        static inline void mappingInsert(const size_type units, uint32_t& fl, uint32_t& sl)
+        {
+            if (units<SecondLevelCount)
+            {
+                fl = 0u;
+                sl = units;
+            }
+            else
+            {
+                const uint32_t msb = hlsl::findMSB<size_type>(units);
+                fl = msb-SecondLevelLog2+1u;
+                sl = (units>>(msb-SecondLevelLog2))-SecondLevelCount;
+            }
+        }
+        //! rounds up to the next list, so every block on the lists found is large enough
+        inline size_type findSuitableBlock(size_type units) const
+        {
+            if (units>=SecondLevelCount)
+            {
+                const size_type roundUp = (size_type(0x1u)<<(hlsl::findMSB<size_type>(units)-SecondLevelLog2))-1u;
+                // `unitCount-roundUp` would wrap around for requests close to the whole range
+                if (roundUp>unitCount || units>unitCount-roundUp)
+                    return invalid_address;
+                units += roundUp;
+            }
+            uint32_t fl,sl;
+            mappingInsert(units,fl,sl);
+
+            size_type slMap = getSecondLevelBitmaps()[fl]&(~size_type(0u)<<sl);
+            if (!slMap)
+            {
+                const uint64_t flMap = fl+1u<FirstLevelCount ? (firstLevelBitmap&(~0ull<<(fl+1u))):0ull;
+                if (!flMap)
+                    return invalid_address;
+                fl = hlsl::findLSB<uint64_t>(flMap);
+                slMap = getSecondLevelBitmaps()[fl];
+            }
+            return getListHead(fl,hlsl::findLSB<size_type>(slMap));
+        }
+
+        inline void insertFreeBlock(const size_type start, const size_type units)
+        {
+            uint32_t fl,sl;
+            mappingInsert(units,fl,sl);
+            size_type& head = getListHeads()[fl*SecondLevelCount+sl];
+            getNextFree()[start] = head;
+            getPrevFree()[start] = invalid_address;
+            if (head!=invalid_address)
+                getPrevFree()[head] = start;
+            head = start;
+            getSecondLevelBitmaps()[fl] |= size_type(0x1u)<<sl;
+            firstLevelBitmap |= 0x1ull<<fl;
+
+            writeBlock(start,units,true);
+            freeUnits += units;
+        }
+        inline void removeFreeBlock(const size_type start)
+        {
+            const size_type units = getBlockUnits(start);
+            const size_type next = getNextFree()[start];
+            const size_type prev = getPrevFree()[start];
+            if (next!=invalid_address)
+                getPrevFree()[next] = prev;
+            if (prev!=invalid_address)
+                getNextFree()[prev] = next;
+            else
+            {
+                uint32_t fl,sl;
+                mappingInsert(units,fl,sl);
+                getListHeads()[fl*SecondLevelCount+sl] = next;
+                if (next==invalid_address)
+                {
+                    size_type& slMap = getSecondLevelBitmaps()[fl];
+                    slMap &= ~(size_type(0x1u)<<sl);
+                    if (!slMap)
+                        firstLevelBitmap &= ~(0x1ull<<fl);
+                }
+            }
+            getBlockTags()[start] &= ~FreeFlag;
+            freeUnits -= units;
+        }
+
+        inline void writeBlock(const size_type start, const size_type units, const bool free)
+        {
+            getBlockTags()[start] = free ? (units|FreeFlag):units;
+            getBlockStarts()[start+units-1u] = start;
+        }
+
+        //! rebuilds the block tags and lists from `other`, allocated blocks past the new end are not allowed
+        inline void copyState(const TLSFAddressAllocator& other)
+        {
+            freeUnits = 0u;
+            firstLevelBitmap = 0ull;
+            std::fill_n(getListHeads(),ListCount,invalid_address);
+            std::fill_n(getSecondLevelBitmaps(),FirstLevelCount,size_type(0u));
+
+            size_type freeStart = invalid_address;
+            for (size_type block=0u; block<other.unitCount && block<unitCount; block+=other.getBlockUnits(block))
+            {
+                if (other.isFree(block))
+                {
+                    if (freeStart==invalid_address)
+                        freeStart = block;
+                    continue;
+                }
+                assert(block+other.getBlockUnits(block)<=unitCount);
+                if (freeStart!=invalid_address)
+                {
+                    insertFreeBlock(freeStart,block-freeStart);
+                    freeStart = invalid_address;
+                }
+                writeBlock(block,other.getBlockUnits(block),false);
+            }
+            // whatever is left, including any growth, is one free block
+            const size_type lastEnd = other.unitCount<unitCount ? other.unitCount:unitCount;
+            if (freeStart==invalid_address)
+                freeStart = lastEnd;
+            if (freeStart<unitCount)
+                insertFreeBlock(freeStart,unitCount-freeStart);
+        }
+
+        inline bool isFree(const size_type start) const {return getBlockTags()[start]&FreeFlag;}
+        inline size_type getBlockUnits(const size_type start) const {return getBlockTags()[start]&(~FreeFlag);}
+        inline size_type getBlockStart(const size_type lastUnit) const {return getBlockStarts()[lastUnit];}
+        inline size_type getListHead(const uint32_t fl, const uint32_t sl) const {return getListHeads()[fl*SecondLevelCount+sl];}
+
+        // layout of the reserved space
+        inline size_type* getListHeads() {return reinterpret_cast<size_type*>(Base::reservedSpace);}
+        inline const size_type* getListHeads() const {return reinterpret_cast<const size_type*>(Base::reservedSpace);}
+        inline size_type* getSecondLevelBitmaps() {return getListHeads()+ListCount;}
+        inline const size_type* getSecondLevelBitmaps() const {return getListHeads()+ListCount;}
+        inline size_type* getBlockTags() {return getSecondLevelBitmaps()+FirstLevelCount;}
+        inline const size_type* getBlockTags() const {return getSecondLevelBitmaps()+FirstLevelCount;}
+        inline size_type* getBlockStarts() {return getBlockTags()+unitCount;}
+        inline const size_type* getBlockStarts() const {return getBlockTags()+unitCount;}
+        inline size_type* getNextFree() {return getBlockStarts()+unitCount;}
+        inline size_type* getPrevFree() {return getNextFree()+unitCount;}
+
+        size_type   bufferSize;
+        size_type   minBlockSize;
+        size_type   unitCount;
+        size_type   freeUnits;
+        uint64_t    firstLevelBitmap;
+};
+
+
+}
+}
+
+#include "nbl/core/alloc/AddressAllocatorConcurrencyAdaptors.h"
+
+namespace nbl
+{
+namespace core
+{
+
+// aliases
+template<typename size_type>
+using TLSFAddressAllocatorST = TLSFAddressAllocator<size_type>;
+
+template<typename size_type, class RecursiveLockable>
+using TLSFAddressAllocatorMT = AddressAllocatorBasicConcurrencyAdaptor<TLSFAddressAllocator<size_type>,RecursiveLockable>;
+
+}
+}
+
+#endif
@@ -9,6 +9,7 @@
 #include "stdint.h"
 #include "nbl/macros.h"
 #include "nbl/type_traits.h"
+#include "nbl/core/alloc/AddressAllocatorStatistics.h"
 
 namespace nbl::core
 {
@@ -141,6 +142,7 @@ namespace nbl::core
             template<class U> using func_multi_free_addr                = decltype(std::declval<U&>().multi_free_addr(0u,nullptr,nullptr));
 
             template<class U> using func_get_real_addr                  = decltype(std::declval<U&>().get_real_addr(0u));
+            template<class U> using func_fill_statistics                = decltype(std::declval<const U&>().fill_statistics(std::declval<SAddressAllocatorStatistics&>()));
         /// C++17 protected:
         public:
             template<class,class=void> struct resolve_supportsArbitraryOrderFrees  : std::true_type {};
@@ -150,6 +152,7 @@ namespace nbl::core
             template<class,class=void> struct has_func_multi_free_addr                 : std::false_type {};
 
             template<class,class=void> struct has_func_get_real_addr                     : std::false_type {};
+            template<class,class=void> struct has_func_fill_statistics                   : std::false_type {};
 
 
             template<class U> struct resolve_supportsArbitraryOrderFrees<U,std::void_t<cstexpr_supportsArbitraryOrderFrees<U> > >
@@ -163,6 +166,7 @@ namespace nbl::core
                                                                             : std::is_same<func_multi_free_addr<U>,void> {};
 
             template<class U> struct has_func_get_real_addr<U,std::void_t<func_get_real_addr<U> > >  : std::is_same<func_get_real_addr<U>,size_type> {};
+            template<class U> struct has_func_fill_statistics<U,std::void_t<func_fill_statistics<U> > >  : std::true_type {};
 
             _NBL_STATIC_INLINE_CONSTEXPR bool         supportsArbitraryOrderFrees = resolve_supportsArbitraryOrderFrees<AddressAlloc>::value;
             _NBL_STATIC_INLINE_CONSTEXPR uint32_t     maxMultiOps                 = resolve_maxMultiOps<AddressAlloc>::value;
@@ -173,6 +177,7 @@ namespace nbl::core
                 printf("has_func_multi_alloc_addr : %s\n",                  has_func_multi_alloc_addr<AddressAlloc>::value ? "true":"false");
                 printf("has_func_multi_free_addr : %s\n",                   has_func_multi_free_addr<AddressAlloc>::value ? "true":"false");
                 printf("has_func_get_real_addr : %s\n",                        has_func_get_real_addr<AddressAlloc>::value ? "true":"false");
+                printf("has_func_fill_statistics : %s\n",                      has_func_fill_statistics<AddressAlloc>::value ? "true":"false");
 
                 printf("supportsArbitraryOrderFrees == %d\n", supportsArbitraryOrderFrees);
                 printf("maxMultiOps == %d\n",                           maxMultiOps);
@@ -184,7 +189,7 @@ namespace nbl::core
 
             static inline size_type        get_real_addr(const AddressAlloc& alloc, size_type allocated_addr) noexcept
             {
-                return impl::address_allocator_traits_base<AddressAlloc,has_func_get_real_addr<AddressAlloc>::value>::get_real_addr(allocated_addr);
+                return impl::address_allocator_traits_base<AddressAlloc,has_func_get_real_addr<AddressAlloc>::value>::get_real_addr(alloc,allocated_addr);
             }
 
             //!
@@ -254,6 +259,22 @@ namespace nbl::core
                 return static_cast<const ConstGetter&>(alloc).get_total_size();
             }
 
+            //! Overwrites the state part of `stats`, allocators which can enumerate their free blocks fill in the rest (and their event counters),
+            //! for all others the free space is assumed to be a single block (true for the linear and stack allocators).
+            static inline void              fill_statistics(const AddressAlloc& alloc, SAddressAllocatorStatistics& stats) noexcept
+            {
+                stats.totalSize = get_total_size(alloc);
+                stats.allocatedSize = get_allocated_size(alloc);
+                stats.freeSize = get_free_size(alloc);
+                stats.largestFreeBlock = 0ull;
+                stats.freeBlockCount = 0ull;
+                std::fill_n(stats.freeBlockHistogram,SAddressAllocatorStatistics::HistogramBucketCount,0ull);
+                if constexpr (has_func_fill_statistics<AddressAlloc>::value)
+                    alloc.fill_statistics(stats);
+                else
+                    stats.addFreeBlock(stats.freeSize);
+            }
+
             // underlying allocator statics
             template<typename... Args>
             static inline size_type reserved_size(const Args&... args) noexcept
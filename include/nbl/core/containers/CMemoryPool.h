@@ -36,6 +36,12 @@ public:
         m_alctr.deallocate(_ptr, s);
     }
 
+    //! the blocks are summed up, the largest free block tells how big of an `emplace_n` is sure to succeed without a new block
+    void fill_statistics(SAddressAllocatorStatistics& stats)
+    {
+        m_alctr.fill_statistics(stats);
+    }
+
     template <typename T, typename... FuncArgs>
     T* emplace_n(uint32_t n, FuncArgs&&... args)
     {
@@ -0,0 +1,98 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_CORE_C_REFCTD_POINTER_SET_H_INCLUDED__
+#define __NBL_CORE_C_REFCTD_POINTER_SET_H_INCLUDED__
+
+
+#include "nbl/core/decl/Types.h"
+#include "nbl/core/IReferenceCounted.h"
+
+
+namespace nbl
+{
+namespace core
+{
+
+//! Open addressing set of reference counted objects, each one is grabbed once on insertion and dropped on `clear`
+class CRefctdPointerSet final
+{
+	public:
+		CRefctdPointerSet() = default;
+		CRefctdPointerSet(const CRefctdPointerSet&) = delete;
+		CRefctdPointerSet& operator=(const CRefctdPointerSet&) = delete;
+		inline ~CRefctdPointerSet() {clear();}
+
+		inline void insert(const IReferenceCounted* const object)
+		{
+			// consecutive insertions tend to be of the same object
+			if (object==m_lastInserted)
+				return;
+			m_lastInserted = object;
+			// keep the load factor under 3/4
+			if ((m_count+1u)*4u>m_slots.size()*3u)
+				grow();
+			if (insert_impl(object))
+			{
+				object->grab();
+				m_count++;
+			}
+		}
+
+		inline void clear()
+		{
+			// the slots stay allocated for the next round of insertions
+			if (m_count)
+			for (auto& slot : m_slots)
+			if (slot)
+			{
+				slot->drop();
+				slot = nullptr;
+			}
+			m_count = 0u;
+			m_lastInserted = nullptr;
+		}
+
+		inline size_t size() const {return m_count;}
+		inline size_t capacity() const {return m_slots.size();}
+
+	private:
+		inline bool insert_impl(const IReferenceCounted* const object)
+		{
+			// allocations come at a fixed stride, which plain Fibonacci hashing folds into a few clusters, so mix like the MurmurHash3 finalizer
+			uint64_t hash = reinterpret_cast<uintptr_t>(object);
+			hash ^= hash>>33u;
+			hash *= 0xff51afd7ed558ccdull;
+			hash ^= hash>>33u;
+			const size_t mask = m_slots.size()-1u;
+			for (size_t i=hash&mask; ; i=(i+1u)&mask)
+			{
+				if (m_slots[i]==object)
+					return false;
+				if (!m_slots[i])
+				{
+					m_slots[i] = object;
+					return true;
+				}
+			}
+		}
+
+		inline void grow()
+		{
+			auto old = std::move(m_slots);
+			m_slots.resize(old.empty() ? 64u:(old.size()<<1u),nullptr);
+			for (const auto* object : old)
+			if (object)
+				insert_impl(object);
+		}
+
+		vector<const IReferenceCounted*> m_slots;
+		size_t m_count = 0u;
+		const IReferenceCounted* m_lastInserted = nullptr;
+};
+
+}
+}
+
+#endif
@@ -142,8 +142,7 @@ class FixedCapacityDoublyLinkedList : private impl::FixedCapacityDoublyLinkedLis
 		{
 			assert(nodeAddr != invalid_iterator);
 			assert(nodeAddr < cap);
-			node_t* node = get(nodeAddr);
-			common_detach(node);
+			common_detach(nodeAddr);
 			common_delete(nodeAddr);
 		}
 
@@ -152,11 +151,11 @@ class FixedCapacityDoublyLinkedList : private impl::FixedCapacityDoublyLinkedLis
 		{
 			if (m_begin == nodeAddr || nodeAddr == invalid_iterator)
 				return;
-			
-			getBegin()->prev = nodeAddr;
 
+			common_detach(nodeAddr);
+			// not the first node, so the list still has a front to attach to
+			getBegin()->prev = nodeAddr;
 			auto node = get(nodeAddr);
-			common_detach(node);
 			node->next = m_begin;
 			node->prev = invalid_iterator;
 			m_begin = nodeAddr;
@@ -173,16 +172,9 @@ class FixedCapacityDoublyLinkedList : private impl::FixedCapacityDoublyLinkedLis
 		}
 		~FixedCapacityDoublyLinkedList()
 		{
-			if (m_dispose_f && m_begin != invalid_iterator)
-			{
-				auto* begin = getBegin();
-				auto* back = getBack();
-				do 
-				{
-					m_dispose_f(begin->data);
-					begin = get(begin->next);
-				} while (begin != back);
-			}
+			if (m_dispose_f)
+			for (auto addr=m_begin; addr!=invalid_iterator; addr=get(addr)->next)
+				m_dispose_f(get(addr)->data);
 			_NBL_ALIGNED_FREE(m_reservedSpace);
 		}
 
@@ -228,12 +220,24 @@ class FixedCapacityDoublyLinkedList : private impl::FixedCapacityDoublyLinkedLis
 			alloc.free_addr(address, 1u);
 		}
 
-		inline void common_detach(node_t* node)
+		// unlinks the node, repointing the front and back of the list if it was either of them
+		inline void common_detach(const uint32_t nodeAddr)
 		{
+			node_t* node = get(nodeAddr);
 			if (node->next != invalid_iterator)
 				get(node->next)->prev = node->prev;
+			else
+			{
+				assert(m_back == nodeAddr);
+				m_back = node->prev;
+			}
 			if (node->prev != invalid_iterator)
 				get(node->prev)->next = node->next;
+			else
+			{
+				assert(m_begin == nodeAddr);
+				m_begin = node->next;
+			}
 		}
 };
 
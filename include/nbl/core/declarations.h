@@ -20,6 +20,8 @@
 // allocator
 #include "nbl/core/alloc/AddressAllocatorBase.h"
 #include "nbl/core/alloc/AddressAllocatorConcurrencyAdaptors.h"
+#include "nbl/core/alloc/AddressAllocatorStatistics.h"
+#include "nbl/core/alloc/AddressAllocatorTelemetryAdaptor.h"
 #include "nbl/core/alloc/address_allocator_traits.h"
 #include "nbl/core/alloc/AlignedBase.h"
 #include "nbl/core/alloc/aligned_allocator.h"
@@ -32,8 +34,10 @@
 #include "nbl/core/alloc/null_allocator.h"
 #include "nbl/core/alloc/PoolAddressAllocator.h"
 #include "nbl/core/alloc/IteratablePoolAddressAllocator.h"
+#include "nbl/core/alloc/LockFreePoolAddressAllocator.h"
 #include "nbl/core/alloc/StackAddressAllocator.h"
 #include "nbl/core/alloc/SimpleBlockBasedAllocator.h"
+#include "nbl/core/alloc/TLSFAddressAllocator.h"
 // algorithm
 #include "nbl/core/algorithm/radix_sort.h"
 #include "nbl/core/algorithm/utility.h"
@@ -42,6 +46,7 @@
 #include "nbl/core/containers/refctd_dynamic_array.h"
 #include "nbl/core/containers/FixedCapacityDoublyLinkedList.h"
 #include "nbl/core/containers/LRUCache.h"
+#include "nbl/core/containers/CRefctdPointerSet.h"
 // math
 #include "nbl/core/math/intutil.h"
 #include "nbl/core/math/colorutil.h"
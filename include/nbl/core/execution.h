@@ -16,6 +16,7 @@
 #include "oneapi/dpl/pstl/glue_algorithm_defs.h"
 #include "oneapi/dpl/pstl/glue_algorithm_ranges_defs.h"
 #endif
+#include <type_traits>
 
 #define ALIAS_TEMPLATE_FUNCTION(highLevelF, lowLevelF) \
 template<typename... Args> \
@@ -61,5 +62,24 @@ ALIAS_TEMPLATE_FUNCTION(nth_element, oneapi::dpl::nth_element)
 
 #undef ALIAS_TEMPLATE_FUNCTION
 
+namespace nbl::core
+{
+//! Execution policies of our own (such as `system::CTaskScheduler::execution_policy`) are tagged with a nested `nbl_execution_policy_tag`
+//! and implement the algorithms as members, algorithms taking a policy should go through `core::` instead of `std::` to support them.
+template<class ExecutionPolicy>
+concept NablaExecutionPolicy = requires { typename std::remove_cvref_t<ExecutionPolicy>::nbl_execution_policy_tag; };
+
+template<class ExecutionPolicy, class RandomIt, class UnaryFunction> requires NablaExecutionPolicy<ExecutionPolicy>
+inline void for_each(ExecutionPolicy&& policy, RandomIt first, RandomIt last, UnaryFunction f)
+{
+    policy.for_each(first,last,f);
+}
+template<class ExecutionPolicy, class RandomIt, class Size, class UnaryFunction> requires NablaExecutionPolicy<ExecutionPolicy>
+inline RandomIt for_each_n(ExecutionPolicy&& policy, RandomIt first, Size n, UnaryFunction f)
+{
+    return policy.for_each_n(first,n,f);
+}
+}
+
 #endif
 
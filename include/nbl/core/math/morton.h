@@ -6,8 +6,15 @@
 #define __NBL_CORE_MORTON_H_INCLUDED__
 
 #include <cstdint>
+#include <type_traits>
 #include "nbl/macros.h"
 
+// BMI2 is implied by AVX2 on every CPU that has it, MSVC doesn't define `__BMI2__` on its own
+#if defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__))
+#   include <immintrin.h>
+#   define _NBL_MORTON_WITH_BMI2_
+#endif
+
 namespace nbl
 {
 namespace core
@@ -35,7 +42,7 @@ namespace impl
         {
             0x1249249249249249ull,
             0x10C30C30C30C30C3ull,
-            0x010F00F00F00F00Full,
+            0x100F00F00F00F00Full,
             0x001F0000FF0000FFull,
             0x001F00000000FFFFull
         };
@@ -70,7 +77,7 @@ namespace impl
         }
         if constexpr (bitDepth>32u)
         {
-            x = (x | (x >> 16));
+            x = (x | (x >> 16)) & static_cast<T>(0xFFFFFFFFull);
         }
         return x;
     }
@@ -135,17 +142,144 @@ namespace impl
 
         return x;
     }
+    //! Inverse of `separate_bits_3d`, gathers every third bit
+    template <typename T, uint32_t bitDepth>
+    inline T morton3d_decode(T x)
+    {
+        x = x & morton3d_mask<T>(0);
+        x = (x | (x >> 2)) & morton3d_mask<T>(1);
+        x = (x | (x >> 4)) & morton3d_mask<T>(2);
+        if constexpr (bitDepth>8u)
+        {
+            x = (x | (x >> 8)) & morton3d_mask<T>(3);
+        }
+        if constexpr (bitDepth>16u)
+        {
+            x = (x | (x >> 16)) & morton3d_mask<T>(4);
+        }
+        if constexpr (bitDepth>32u)
+        {
+            x = (x | (x >> 32)) & 0x1FFFFFull;
+        }
+        return x;
+    }
+
+    //! A `bitDepth` bit code holds `dims` coordinates of `bitDepth/dims` bits each, anything above gets dropped
+    //! so that the scalar and the BMI2 paths agree on every input, not just the ones in range
+    template <typename T, uint32_t bits>
+    constexpr T low_bits_mask()
+    {
+        if constexpr (bits>=sizeof(T)*8u)
+            return ~T(0);
+        else
+            return (T(1)<<bits)-T(1);
+    }
+    template <typename T, uint32_t dims, uint32_t bitDepth>
+    constexpr T morton_coord_mask() {return low_bits_mask<T,bitDepth/dims>();}
+    template <typename T, uint32_t dims, uint32_t bitDepth>
+    constexpr T morton_code_mask() {return low_bits_mask<T,bitDepth/dims*dims>();}
+
+#ifdef _NBL_MORTON_WITH_BMI2_
+    // `pdep` and `pext` do the whole spread or gather in one instruction (but microcoded and slow on AMD before Zen 3)
+    template <typename T>
+    constexpr bool bmi2_capable = std::is_same_v<T,uint32_t> || std::is_same_v<T,uint64_t>;
+
+    template <typename T>
+    inline T deposit_bits(T x, T mask)
+    {
+        if constexpr (std::is_same_v<T,uint64_t>)
+            return _pdep_u64(x,mask);
+        else
+            return _pdep_u32(x,mask);
+    }
+    template <typename T>
+    inline T extract_bits(T x, T mask)
+    {
+        if constexpr (std::is_same_v<T,uint64_t>)
+            return _pext_u64(x,mask);
+        else
+            return _pext_u32(x,mask);
+    }
+#endif
+}
+
+template<typename T, uint32_t bitDepth=sizeof(T)*8u>
+T morton2d_decode_x(T _morton)
+{
+    _morton &= impl::morton_code_mask<T,2u,bitDepth>();
+#ifdef _NBL_MORTON_WITH_BMI2_
+    if constexpr (impl::bmi2_capable<T>)
+        return impl::extract_bits<T>(_morton,impl::morton2d_mask<T>(0));
+#endif
+    return impl::morton2d_decode<T,bitDepth>(_morton);
+}
+template<typename T, uint32_t bitDepth=sizeof(T)*8u>
+T morton2d_decode_y(T _morton)
+{
+    _morton &= impl::morton_code_mask<T,2u,bitDepth>();
+#ifdef _NBL_MORTON_WITH_BMI2_
+    if constexpr (impl::bmi2_capable<T>)
+        return impl::extract_bits<T>(_morton,impl::morton2d_mask<T>(0)<<1);
+#endif
+    return impl::morton2d_decode<T,bitDepth>(_morton>>1);
 }
 
 template<typename T, uint32_t bitDepth=sizeof(T)*8u>
-T morton2d_decode_x(T _morton) { return impl::morton2d_decode<T,bitDepth>(_morton); }
+T morton3d_decode_x(T _morton)
+{
+    _morton &= impl::morton_code_mask<T,3u,bitDepth>();
+#ifdef _NBL_MORTON_WITH_BMI2_
+    if constexpr (impl::bmi2_capable<T>)
+        return impl::extract_bits<T>(_morton,impl::morton3d_mask<T>(0));
+#endif
+    return impl::morton3d_decode<T,bitDepth>(_morton);
+}
+template<typename T, uint32_t bitDepth=sizeof(T)*8u>
+T morton3d_decode_y(T _morton)
+{
+    _morton &= impl::morton_code_mask<T,3u,bitDepth>();
+#ifdef _NBL_MORTON_WITH_BMI2_
+    if constexpr (impl::bmi2_capable<T>)
+        return impl::extract_bits<T>(_morton,impl::morton3d_mask<T>(0)<<1);
+#endif
+    return impl::morton3d_decode<T,bitDepth>(_morton>>1);
+}
 template<typename T, uint32_t bitDepth=sizeof(T)*8u>
-T morton2d_decode_y(T _morton) { return impl::morton2d_decode<T,bitDepth>(_morton>>1); }
+T morton3d_decode_z(T _morton)
+{
+    _morton &= impl::morton_code_mask<T,3u,bitDepth>();
+#ifdef _NBL_MORTON_WITH_BMI2_
+    if constexpr (impl::bmi2_capable<T>)
+        return impl::extract_bits<T>(_morton,impl::morton3d_mask<T>(0)<<2);
+#endif
+    return impl::morton3d_decode<T,bitDepth>(_morton>>2);
+}
 
 template<typename T, uint32_t bitDepth=sizeof(T)*8u>
-T morton2d_encode(T x, T y) { return impl::separate_bits_2d<T,bitDepth>(x) | (impl::separate_bits_2d<T,bitDepth>(y)<<1); }
+T morton2d_encode(T x, T y)
+{
+    constexpr T coordMask = impl::morton_coord_mask<T,2u,bitDepth>();
+    x &= coordMask;
+    y &= coordMask;
+#ifdef _NBL_MORTON_WITH_BMI2_
+    if constexpr (impl::bmi2_capable<T>)
+        return impl::deposit_bits<T>(x,impl::morton2d_mask<T>(0)) | impl::deposit_bits<T>(y,impl::morton2d_mask<T>(0)<<1);
+#endif
+    return impl::separate_bits_2d<T,bitDepth>(x) | (impl::separate_bits_2d<T,bitDepth>(y)<<1);
+}
 template<typename T, uint32_t bitDepth=sizeof(T)*8u>
-T morton3d_encode(T x, T y, T z) { return impl::separate_bits_3d<T,bitDepth>(x) | (impl::separate_bits_3d<T,bitDepth>(y)<<1) | (impl::separate_bits_3d<T,bitDepth>(z)<<2); }
+T morton3d_encode(T x, T y, T z)
+{
+    constexpr T coordMask = impl::morton_coord_mask<T,3u,bitDepth>();
+    x &= coordMask;
+    y &= coordMask;
+    z &= coordMask;
+#ifdef _NBL_MORTON_WITH_BMI2_
+    if constexpr (impl::bmi2_capable<T>)
+        return impl::deposit_bits<T>(x,impl::morton3d_mask<T>(0)) | impl::deposit_bits<T>(y,impl::morton3d_mask<T>(0)<<1) | impl::deposit_bits<T>(z,impl::morton3d_mask<T>(0)<<2);
+#endif
+    return impl::separate_bits_3d<T,bitDepth>(x) | (impl::separate_bits_3d<T,bitDepth>(y)<<1) | (impl::separate_bits_3d<T,bitDepth>(z)<<2);
+}
 template<typename T, uint32_t bitDepth=sizeof(T)*8u>
 T morton4d_encode(T x, T y, T z, T w) { return impl::separate_bits_4d<T,bitDepth>(x) | (impl::separate_bits_4d<T,bitDepth>(y)<<1) | (impl::separate_bits_4d<T,bitDepth>(z)<<2) | (impl::separate_bits_4d<T,bitDepth>(w)<<3); }
 
@@ -0,0 +1,160 @@
+// Copyright (C) 2018-2022 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef _NBL_SCENE_C_ANIMATION_ENGINE_CPU_H_INCLUDED_
+#define _NBL_SCENE_C_ANIMATION_ENGINE_CPU_H_INCLUDED_
+
+#include "nbl/core/declarations.h"
+#include "nbl/core/execution.h"
+
+#include "nbl/asset/ICPUAnimationLibrary.h"
+#include "nbl/asset/ICPUSkeleton.h"
+
+#include <algorithm>
+
+namespace nbl::scene
+{
+
+//! CPU reference implementation of animation sampling, blending, joint hierarchy propagation and skinning.
+/** Every instance shares the same `ICPUSkeleton` and samples clips out of the same `ICPUAnimationLibrary`.
+* A clip is a run of `getJointCount()` consecutive `Animation` tracks starting at `SBlend::clip`, track `clip+j` drives joint `j`.
+* Joints whose tracks are empty (or not driven by any blend with non-zero weight) fall back to the skeleton's default transform.
+*
+* Instances get processed in batches of `BatchSize`, the hierarchy is propagated in Structure-of-Arrays form so that
+* one SSE lane holds one instance, batches are independent and get spread over the `ExecutionPolicy` passed to `update`.
+*/
+class CAnimationEngineCPU final : public core::IReferenceCounted
+{
+	public:
+		using library_t = asset::ICPUAnimationLibrary;
+		using skeleton_t = asset::ICPUSkeleton;
+		using joint_id_t = skeleton_t::joint_id_t;
+		using animation_t = library_t::animation_t;
+
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t MaxBlendsPerInstance = 4u;
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t BatchSize = 4u;
+		_NBL_STATIC_INLINE_CONSTEXPR animation_t InvalidClip = 0xffffffffu;
+
+		enum E_ROTATION_INTERPOLATION : uint8_t
+		{
+			//! normalized lerp, cheap and good enough for densely sampled clips
+			ERI_NLERP = 0u,
+			//! true spherical interpolation, for sparse keyframes
+			ERI_SLERP
+		};
+
+		struct SCreationParams
+		{
+			core::smart_refctd_ptr<const library_t> library;
+			core::smart_refctd_ptr<const skeleton_t> skeleton;
+			uint32_t instanceCount = 0u;
+			E_ROTATION_INTERPOLATION rotationInterpolation = ERI_NLERP;
+		};
+		static core::smart_refctd_ptr<CAnimationEngineCPU> create(SCreationParams&& params);
+
+		struct SBlend
+		{
+			animation_t clip = InvalidClip;
+			//! in the same units as the library's timestamps, clamped to the track's range
+			float time = 0.f;
+			float weight = 0.f;
+		};
+		struct SInstance
+		{
+			SBlend blends[MaxBlendsPerInstance] = {};
+		};
+
+		//
+		inline uint32_t getInstanceCount() const {return m_instances.size();}
+		inline joint_id_t getJointCount() const {return m_jointCount;}
+
+		inline SInstance& getInstance(const uint32_t instanceIx) {return m_instances[instanceIx];}
+		inline const SInstance& getInstance(const uint32_t instanceIx) const {return m_instances[instanceIx];}
+
+		//! Model-space (skeleton root relative) transforms of every joint of an instance, valid after `update`
+		inline const core::matrix3x4SIMD* getGlobalJointTransforms(const uint32_t instanceIx) const
+		{
+			return m_globalTransforms.data()+size_t(instanceIx)*m_jointCount;
+		}
+
+		//! Sample, blend and propagate all instances
+		template<class ExecutionPolicy>
+		inline void update(ExecutionPolicy&& policy)
+		{
+			core::for_each(std::forward<ExecutionPolicy>(policy),m_batchIndices.begin(),m_batchIndices.end(),[this](const uint32_t batchIx) -> void
+			{
+				updateBatch(batchIx);
+			});
+		}
+		inline void update()
+		{
+			update(core::execution::seq);
+		}
+
+		//! `out[i] = global[skinJoints[i]]*inverseBindPoses[i]`, `skinJoints` maps from the mesh's joint indices to the skeleton's
+		void computeSkinningMatrices(const uint32_t instanceIx, const joint_id_t* skinJoints, const core::matrix3x4SIMD* inverseBindPoses, const uint32_t count, core::matrix3x4SIMD* out) const;
+
+		//! Linear Blend Skinning over Structure-of-Arrays vertex streams
+		struct SSkinningParams
+		{
+			const core::matrix3x4SIMD* skinningMatrices = nullptr;
+			//! `jointsPerVertex` entries per vertex
+			const uint32_t* jointIDs = nullptr;
+			const float* jointWeights = nullptr;
+			uint32_t jointsPerVertex = 0u;
+			uint32_t vertexCount = 0u;
+			const float* inPositions[3] = {nullptr,nullptr,nullptr};
+			float* outPositions[3] = {nullptr,nullptr,nullptr};
+			//! optional, skipped if `inNormals[0]` is null
+			const float* inNormals[3] = {nullptr,nullptr,nullptr};
+			float* outNormals[3] = {nullptr,nullptr,nullptr};
+		};
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t SkinningChunkSize = 256u;
+		template<class ExecutionPolicy>
+		static inline void skin(ExecutionPolicy&& policy, const SSkinningParams& params)
+		{
+			const uint32_t chunkCount = (params.vertexCount+SkinningChunkSize-1u)/SkinningChunkSize;
+			core::vector<uint32_t> chunks(chunkCount);
+			std::iota(chunks.begin(),chunks.end(),0u);
+			core::for_each(std::forward<ExecutionPolicy>(policy),chunks.begin(),chunks.end(),[&params](const uint32_t chunkIx) -> void
+			{
+				const uint32_t begin = chunkIx*SkinningChunkSize;
+				skinRange(params,begin,core::min(begin+SkinningChunkSize,params.vertexCount));
+			});
+		}
+		static inline void skin(const SSkinningParams& params)
+		{
+			skin(core::execution::seq,params);
+		}
+
+	protected:
+		CAnimationEngineCPU(SCreationParams&& params, core::vector<joint_id_t>&& evaluationOrder);
+		~CAnimationEngineCPU() = default;
+
+		struct SSampledPose
+		{
+			core::vectorSIMDf rotation;
+			core::vectorSIMDf translation;
+		};
+		//! returns false if the track is empty
+		bool sampleTrack(const animation_t track, const float time, uint32_t& cursor, SSampledPose& out) const;
+		void updateBatch(const uint32_t batchIx);
+		static void skinRange(const SSkinningParams& params, const uint32_t begin, const uint32_t end);
+
+		core::smart_refctd_ptr<const library_t> m_library;
+		core::smart_refctd_ptr<const skeleton_t> m_skeleton;
+		const joint_id_t m_jointCount;
+		const E_ROTATION_INTERPOLATION m_rotationInterpolation;
+		//! parents always come before their children
+		const core::vector<joint_id_t> m_evaluationOrder;
+		core::vector<SInstance> m_instances;
+		//! last found keyframe per instance, blend and joint, makes the search O(1) for monotonic playback
+		core::vector<uint32_t> m_cursors;
+		core::vector<core::matrix3x4SIMD> m_globalTransforms;
+		core::vector<uint32_t> m_batchIndices;
+};
+
+}
+
+#endif
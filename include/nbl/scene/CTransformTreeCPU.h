@@ -0,0 +1,158 @@
+// Copyright (C) 2018-2022 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef _NBL_SCENE_C_TRANSFORM_TREE_CPU_H_INCLUDED_
+#define _NBL_SCENE_C_TRANSFORM_TREE_CPU_H_INCLUDED_
+
+#include "nbl/core/declarations.h"
+#include "nbl/core/execution.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace nbl::scene
+{
+
+//! CPU counterpart of `ITransformTree`, for hosts without a GPU.
+/** Keeps the same five properties (parent, relative transform, modified stamp, global transform, recomputed stamp),
+* each in its own array indexed by node. Nodes are bucketed by depth, `update` walks the levels top-down and
+* recomputes a node's global transform only if its own modified stamp or its parent's recomputed stamp is newer
+* than its recomputed stamp, so untouched subtrees cost a pair of integer compares. Nodes within a level are
+* independent and get spread over the `ExecutionPolicy`.
+*
+* Structural changes (adding, removing, reparenting) only flag the depth buckets for a rebuild, which happens lazily
+* on the next `update`.
+*/
+class CTransformTreeCPU final : public core::IReferenceCounted
+{
+	public:
+		using node_t = uint32_t;
+		_NBL_STATIC_INLINE_CONSTEXPR node_t invalid_node = 0xdeadbeefu;
+
+		using timestamp_t = uint32_t;
+		_NBL_STATIC_INLINE_CONSTEXPR timestamp_t min_timestamp = 0u;
+		_NBL_STATIC_INLINE_CONSTEXPR timestamp_t max_timestamp = 0xfffffffcu;
+
+		using parent_t = node_t;
+		using relative_transform_t = core::matrix3x4SIMD;
+		using modified_stamp_t = timestamp_t;
+		using global_transform_t = core::matrix3x4SIMD;
+		using recomputed_stamp_t = timestamp_t;
+
+		static inline core::smart_refctd_ptr<CTransformTreeCPU> create(const uint32_t initialCapacity=0u)
+		{
+			auto retval = core::smart_refctd_ptr<CTransformTreeCPU>(new CTransformTreeCPU(),core::dont_grab);
+			retval->reserve(initialCapacity);
+			return retval;
+		}
+
+		//
+		void reserve(const uint32_t capacity);
+		inline uint32_t getNodeCount() const {return m_parent.size()-m_freeNodes.size()-m_removedNodes.size();}
+		inline uint32_t getCapacity() const {return m_parent.size();}
+		inline bool isAlive(const node_t node) const {return node<m_alive.size() && m_alive[node];}
+
+		//! `parents` and `relativeTransforms` are optional, missing parents make roots and missing transforms are identity
+		void addNodes(node_t* outNodes, const uint32_t count, const parent_t* parents=nullptr, const relative_transform_t* relativeTransforms=nullptr);
+		//! Children of removed nodes become roots
+		void removeNodes(const node_t* begin, const node_t* end);
+		//! Removes all nodes
+		void clearNodes();
+
+		//
+		inline parent_t getParent(const node_t node) const {return m_parent[node];}
+		//! Returns false and leaves the parent unchanged if `parent` is dead or a descendant of `node` (would make a cycle)
+		bool setParent(const node_t node, const parent_t parent);
+
+		inline const relative_transform_t& getRelativeTransform(const node_t node) const {return m_relativeTransform[node];}
+		inline void setRelativeTransform(const node_t node, const relative_transform_t& transform)
+		{
+			m_relativeTransform[node] = transform;
+			m_modifiedStamp[node] = m_currentStamp;
+		}
+
+		//! Valid after `update`
+		inline const global_transform_t& getGlobalTransform(const node_t node) const {return m_globalTransform[node];}
+		inline const global_transform_t* getGlobalTransforms() const {return m_globalTransform.data();}
+
+		inline modified_stamp_t getModifiedStamp(const node_t node) const {return m_modifiedStamp[node];}
+		inline recomputed_stamp_t getRecomputedStamp(const node_t node) const {return m_recomputedStamp[node];}
+		//! Stamp that modifications made right now will get, all nodes with a smaller or equal recomputed stamp are dirty
+		inline timestamp_t getCurrentStamp() const {return m_currentStamp;}
+
+		//! Recompute the global transforms of all dirty nodes and their descendants, returns the number of nodes recomputed
+		/** A parent cycle which slipped in through `addNodes` (parents from the same batch) gets cut when the levels are rebuilt,
+		the node whose parent link closes it becomes a root. */
+		template<class ExecutionPolicy>
+		inline uint32_t update(ExecutionPolicy&& policy)
+		{
+			if (m_levelsDirty)
+				rebuildLevels();
+
+			std::atomic_uint32_t recomputed = 0u;
+			for (const auto& level : m_levels)
+			{
+				core::for_each(policy,level.begin(),level.end(),[&](const node_t node) -> void
+				{
+					if (recomputeNode(node))
+						recomputed.fetch_add(1u,std::memory_order_relaxed);
+				});
+			}
+			advanceStamp();
+			return recomputed;
+		}
+		inline uint32_t update()
+		{
+			return update(core::execution::seq);
+		}
+
+		//! Nodes bucketed by depth, valid after `update`
+		inline uint32_t getDepthCount() const {return m_levels.size();}
+		inline const core::vector<node_t>& getNodesAtDepth(const uint32_t depth) const {return m_levels[depth];}
+
+	protected:
+		CTransformTreeCPU() = default;
+		~CTransformTreeCPU() = default;
+
+		inline bool recomputeNode(const node_t node)
+		{
+			const auto parent = m_parent[node];
+			const auto lastRecomputed = m_recomputedStamp[node];
+			if (parent!=invalid_node)
+			{
+				if (m_modifiedStamp[node]<=lastRecomputed && m_recomputedStamp[parent]<=lastRecomputed)
+					return false;
+				m_globalTransform[node] = core::matrix3x4SIMD::concatenateBFollowedByA(m_globalTransform[parent],m_relativeTransform[node]);
+			}
+			else
+			{
+				if (m_modifiedStamp[node]<=lastRecomputed)
+					return false;
+				m_globalTransform[node] = m_relativeTransform[node];
+			}
+			m_recomputedStamp[node] = m_currentStamp;
+			return true;
+		}
+		void rebuildLevels();
+		void advanceStamp();
+
+		// properties
+		core::vector<parent_t> m_parent;
+		core::vector<relative_transform_t> m_relativeTransform;
+		core::vector<modified_stamp_t> m_modifiedStamp;
+		core::vector<global_transform_t> m_globalTransform;
+		core::vector<recomputed_stamp_t> m_recomputedStamp;
+		// bookkeeping
+		core::vector<uint8_t> m_alive;
+		core::vector<node_t> m_freeNodes;
+		//! only become free after the next level rebuild has orphaned their children, so a handle can't get reused under them
+		core::vector<node_t> m_removedNodes;
+		core::vector<core::vector<node_t>> m_levels;
+		timestamp_t m_currentStamp = min_timestamp+1u;
+		bool m_levelsDirty = false;
+};
+
+}
+
+#endif
@@ -9,6 +9,9 @@
 #include "nbl/scene/CLevelOfDetailLibrary.h"
 #include "nbl/scene/ITransformTreeManager.h"
 
+#include "nbl/scene/CAnimationEngineCPU.h"
+#include "nbl/scene/CTransformTreeCPU.h"
+
 #include "nbl/scene/ICullingLoDSelectionSystem.h"
 
 #if 0 // not buildable on criss/vulkan branch
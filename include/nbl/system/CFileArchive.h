@@ -77,9 +77,10 @@ class CFileArchive : public IFileArchive
 		inline CFileArchive(path&& _defaultAbsolutePath, system::logger_opt_smart_ptr&& logger, std::shared_ptr<core::vector<SFileList::SEntry>> _items) :
 			IFileArchive(std::move(_defaultAbsolutePath),std::move(logger))
 		{
+			// the list moves out of `_items`
+			const auto fileCount = _items->size();
 			setItemList(_items);
 
-			const auto fileCount = _items->size();
 			m_filesBuffer = (std::byte*)_NBL_ALIGNED_MALLOC(fileCount*SIZEOF_INNER_ARCHIVE_FILE, ALIGNOF_INNER_ARCHIVE_FILE);
 			m_fileFlags = (std::atomic_flag*)_NBL_ALIGNED_MALLOC(fileCount*sizeof(std::atomic_flag), alignof(std::atomic_flag));
 			for (size_t i=0u; i<fileCount; i++)
@@ -125,7 +126,7 @@ class CFileArchive : public IFileArchive
 			// which will also allow for changing the flags that a File View is created with.
 			if (flags.hasFlags(IFile::ECF_MAPPABLE))
 			{
-				m_logger.log("Overriding file flags for %s, creating it as mappable anyway.",ILogger::ELL_INFO,found->pathRelativeToArchive.c_str());
+				m_logger.log("Overriding file flags for %s, creating it as mappable anyway.",ILogger::ELL_INFO,found->getPathString().data());
 				flags |= IFile::ECF_MAPPABLE;
 			}
 			// IFileArchive should have already checked for this, stay like this until we allow write access to archived files
@@ -144,7 +145,7 @@ class CFileArchive : public IFileArchive
 				// coast is clear, do placement new
 				new (file, &m_fileFlags[found->ID]) CInnerArchiveFile<Allocator>(
 					m_fileFlags+found->ID,
-					getDefaultAbsolutePath()/found->pathRelativeToArchive,
+					getDefaultAbsolutePath()/found->getPath(),
 					flags,
 					fileBuffer.initialModified,
 					fileBuffer.buffer,
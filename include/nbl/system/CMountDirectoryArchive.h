@@ -30,7 +30,7 @@ class CMountDirectoryArchive : public IFileArchive
                 if (item.has_extension())
                 {
                     auto relpath = item.lexically_relative(m_defaultAbsolutePath);
-                    auto entry = SFileList::SEntry{ relpath, 0xdeadbeefu, 0xdeadbeefu, 0xdeadbeefu, EAT_NONE };
+                    auto entry = SFileList::SEntry{ CPathTable::get().internPath(relpath), 0xdeadbeefu, 0xdeadbeefu, 0xdeadbeefu, EAT_NONE };
                     new_entries->push_back(entry);
                 }
             }
@@ -43,7 +43,7 @@ class CMountDirectoryArchive : public IFileArchive
 		inline core::smart_refctd_ptr<IFile> getFile_impl(const SFileList::found_t& found, const core::bitflag<IFile::E_CREATE_FLAGS> flags, const std::string_view& password) override
 		{
             system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
-            m_system->createFile(future,m_defaultAbsolutePath/found->pathRelativeToArchive,flags);
+            m_system->createFile(future,m_defaultAbsolutePath/found->getPath(),flags);
             if (auto file=future.acquire())
                 return *file;
 
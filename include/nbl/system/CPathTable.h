@@ -0,0 +1,109 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_SYSTEM_C_PATH_TABLE_H_INCLUDED_
+#define _NBL_SYSTEM_C_PATH_TABLE_H_INCLUDED_
+
+
+#include "nbl/core/declarations.h"
+
+#include "nbl/system/path.h"
+
+#include <shared_mutex>
+#include <string_view>
+
+
+namespace nbl::system
+{
+
+//! Process wide table of interned strings, every distinct string is stored once next to its 64bit hash and never moves or goes away.
+/**
+	A `SHandle` is a 32bit ID, so copying, comparing and hashing archive entry paths and asset cache keys is an integer operation,
+	and finding out whether a string is known (and its handle) is one hash probe instead of a binary search parsing `system::path`s.
+	Interning takes an exclusive lock, `find` a shared one, and getting the string or hash of a handle takes none at all.
+
+	Archive entries get `canonicalize`d before being interned (see `internPath`), asset cache keys are interned verbatim as they needn't be paths.
+	Nothing is ever freed, so memory grows with every distinct archive path and asset cache key until the process exits (the string plus a few dozen bytes),
+	mind that when generating unique cache keys (e.g. from content hashes or counters) in a long running process.
+	The table holds up to 2^26 strings, past that `intern` gives invalid handles which the archives and asset caches treat as unknown keys.
+*/
+class NBL_API2 CPathTable final
+{
+	public:
+		struct SHandle
+		{
+			static inline constexpr uint32_t Invalid = ~0u;
+
+			inline bool isValid() const {return id!=Invalid;}
+
+			inline bool operator==(const SHandle& other) const = default;
+			//! The order of interning, not lexicographical, compare `getString`s for that
+			inline bool operator<(const SHandle& other) const {return id<other.id;}
+
+			// the empty string is always interned first
+			uint32_t id = 0u;
+		};
+
+		//
+		static CPathTable& get();
+
+		//! Generic separators and no `.`, `..`, repeated or trailing separators, so that equivalent relative paths intern to the same handle
+		static std::string canonicalize(const path& p);
+
+		//! Adds `str` if it's not there already, the handle is invalid if the table is full
+		SHandle intern(const std::string_view str);
+		inline SHandle internPath(const path& p) {return intern(canonicalize(p));}
+		//! Never adds anything, the handle is invalid if `str` was never interned
+		SHandle find(const std::string_view str) const;
+		inline SHandle findPath(const path& p) const {return find(canonicalize(p));}
+
+		//! Null terminated and valid until the process exits, empty for an invalid handle
+		inline std::string_view getString(const SHandle handle) const
+		{
+			if (!handle.isValid())
+				return {};
+			const auto& record = getRecord(handle);
+			return {record.str,record.length};
+		}
+		inline uint64_t getHash(const SHandle handle) const {return handle.isValid() ? getRecord(handle).hash:0ull;}
+
+		inline uint32_t getCount() const {return m_count.load(std::memory_order_acquire);}
+
+	private:
+		struct SRecord
+		{
+			const char* str;
+			uint64_t hash;
+			uint32_t length;
+		};
+		static inline constexpr uint32_t RecordBlockLog2 = 12u;
+		static inline constexpr uint32_t MaxRecordBlocks = 0x1u<<14u;
+		static inline constexpr size_t ArenaBlockSize = 0x1u<<16u;
+
+		CPathTable();
+		~CPathTable();
+
+		// records never move, so a handle can be resolved without taking the lock
+		inline const SRecord& getRecord(const SHandle handle) const
+		{
+			assert(handle.isValid() && handle.id<getCount());
+			return m_records[handle.id>>RecordBlockLog2].load(std::memory_order_acquire)[handle.id&((0x1u<<RecordBlockLog2)-1u)];
+		}
+		// slot holding `str`'s handle or the empty slot where it would go, needs the lock held
+		uint32_t probe(const std::string_view str, const uint64_t hash) const;
+		SHandle insert(const std::string_view str, const uint64_t hash);
+
+		mutable std::shared_mutex m_mutex;
+		// open addressing with linear probing, the load factor is kept under 1/2
+		core::vector<uint32_t> m_slots;
+		std::atomic<SRecord*> m_records[MaxRecordBlocks];
+		std::atomic_uint32_t m_count = 0u;
+		// the characters of all the strings, never reallocated
+		core::vector<std::unique_ptr<char[]>> m_arenaBlocks;
+		char* m_arenaCursor = nullptr;
+		size_t m_arenaRemaining = 0ull;
+};
+
+}
+
+#endif
@@ -0,0 +1,251 @@
+// Copyright (C) 2018-2022 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef _NBL_SYSTEM_C_TASK_SCHEDULER_H_INCLUDED_
+#define _NBL_SYSTEM_C_TASK_SCHEDULER_H_INCLUDED_
+
+#include "nbl/core/declarations.h"
+#include "nbl/core/execution.h"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+namespace nbl::system
+{
+
+//! Bounded pool of worker threads with work stealing, meant to be shared by loaders, image filters and mesh processing.
+/** Every worker owns a Chase-Lev deque, it pushes and pops its own tasks at the bottom (LIFO, so the data is still in cache)
+* while idle workers steal from the top (FIFO, so they take the oldest and usually biggest pieces of work).
+* Tasks submitted from threads outside the pool go through a shared injection queue.
+*
+* Tasks can depend on other tasks, a task with unfinished prerequisites only gets queued once the last of them completes.
+* Threads that `wait` (also inside `parallel_for`) keep executing queued tasks instead of blocking, so nested parallelism
+* neither deadlocks nor spawns more threads than the pool was created with.
+*
+* Pass `policy()` wherever a `core::execution` policy is accepted (every `IImageFilter::execute`, the scene utilities, etc.)
+* to run the algorithm on this pool instead of the standard library's parallel backend.
+*/
+class NBL_API2 CTaskScheduler final : public core::IReferenceCounted
+{
+	public:
+		class CTask final : public core::IReferenceCounted
+		{
+			public:
+				inline bool isDone() const {return m_done.load(std::memory_order_acquire);}
+
+			private:
+				friend class CTaskScheduler;
+
+				template<typename F>
+				explicit inline CTask(F&& work) : m_work(std::forward<F>(work)) {}
+				~CTask() = default;
+
+				std::function<void()> m_work;
+				//! unfinished prerequisites plus one which `submit` releases
+				std::atomic_uint32_t m_pending = 1u;
+				std::atomic_bool m_done = false;
+				std::mutex m_continuationLock;
+				core::vector<core::smart_refctd_ptr<CTask>> m_continuations;
+		};
+
+		//! 0 workers means one less than the hardware threads, so the thread that creates the pool and waits on it has a core too
+		static core::smart_refctd_ptr<CTaskScheduler> create(uint32_t workerCount=0u);
+
+		inline uint32_t getWorkerCount() const {return m_workers.size();}
+		//! Index of the pool's worker running the calling thread, or ~0u for threads outside the pool
+		uint32_t getCurrentWorkerIndex() const;
+
+		//! The task does not run until it gets `submit`ted
+		template<typename F>
+		inline core::smart_refctd_ptr<CTask> createTask(F&& work)
+		{
+			return core::smart_refctd_ptr<CTask>(new CTask(std::forward<F>(work)),core::dont_grab);
+		}
+		//! `task` will only start after `prerequisite` completes, must be called before `task` gets submitted
+		void addDependency(CTask* task, CTask* prerequisite);
+		//! Queues the task, or defers it until all its prerequisites complete
+		void submit(CTask* task);
+		template<typename F>
+		inline core::smart_refctd_ptr<CTask> run(F&& work)
+		{
+			auto task = createTask(std::forward<F>(work));
+			submit(task.get());
+			return task;
+		}
+
+		//! Executes other queued tasks until `task` completes
+		void wait(const CTask* task);
+
+		//! Calls `f(rangeBegin,rangeEnd)` over `[begin,end)` split into pieces of `grainSize` (0 picks one), returns when all are done.
+		/** The pieces get claimed dynamically by at most one helper task per worker and the calling thread, so uneven work balances out.
+		*/
+		template<typename F>
+		inline void parallel_for(const size_t begin, const size_t end, size_t grainSize, F&& f)
+		{
+			if (begin>=end)
+				return;
+
+			const size_t count = end-begin;
+			if (!grainSize)
+				grainSize = getDefaultGrainSize(count);
+			const size_t chunkCount = (count-1u)/grainSize+1u;
+			if (chunkCount==1u)
+			{
+				f(begin,end);
+				return;
+			}
+
+			std::atomic<size_t> nextChunk = 0u;
+			auto claimChunks = [&]() -> void
+			{
+				for (size_t chunk; (chunk=nextChunk.fetch_add(1u,std::memory_order_relaxed))<chunkCount;)
+				{
+					const size_t chunkBegin = begin+chunk*grainSize;
+					f(chunkBegin,core::min(chunkBegin+grainSize,end));
+				}
+			};
+			// helpers reference this stack frame, so all of them need to finish (even the ones that find nothing left to claim)
+			const size_t helperCount = core::min<size_t>(chunkCount-1u,m_workers.size());
+			core::vector<core::smart_refctd_ptr<CTask>> helpers(helperCount);
+			for (auto& helper : helpers)
+				helper = run(claimChunks);
+			claimChunks();
+			for (const auto& helper : helpers)
+				wait(helper.get());
+		}
+
+		//! Lets the pool drive algorithms taking a `core::execution` policy, through `core::for_each` and `core::for_each_n`
+		struct execution_policy
+		{
+			using nbl_execution_policy_tag = void;
+
+			template<class RandomIt, class UnaryFunction>
+			inline void for_each(RandomIt first, RandomIt last, UnaryFunction f) const
+			{
+				scheduler->parallel_for(0u,last-first,grainSize,[&first,&f](const size_t begin, const size_t end) -> void
+				{
+					const RandomIt rangeEnd = first+end;
+					for (RandomIt it=first+begin; it!=rangeEnd; ++it)
+						f(*it);
+				});
+			}
+			template<class RandomIt, class Size, class UnaryFunction>
+			inline RandomIt for_each_n(RandomIt first, Size n, UnaryFunction f) const
+			{
+				const RandomIt last = first+n;
+				for_each(first,last,f);
+				return last;
+			}
+
+			CTaskScheduler* scheduler;
+			//! elements per task, 0 picks one so that every worker gets a few pieces
+			size_t grainSize;
+		};
+		//! Same as `core::execution::par_unseq` the filters expect to get it as a const lvalue, so bind custom grain size policies to a const variable first
+		inline const execution_policy& policy() const {return m_policy;}
+		inline execution_policy makePolicy(const size_t grainSize) {return {this,grainSize};}
+
+	protected:
+		//! Fixed size Chase-Lev deque, only the owner pushes and pops, anyone can steal
+		class CWorkerDeque final
+		{
+			public:
+				_NBL_STATIC_INLINE_CONSTEXPR int64_t Capacity = 4096;
+
+				//! owner only, fails when full
+				inline bool push(CTask* task)
+				{
+					const int64_t b = m_bottom.load(std::memory_order_relaxed);
+					const int64_t t = m_top.load(std::memory_order_acquire);
+					if (b-t>=Capacity)
+						return false;
+					m_tasks[b&(Capacity-1)].store(task,std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_release);
+					m_bottom.store(b+1,std::memory_order_relaxed);
+					return true;
+				}
+				//! owner only
+				inline CTask* pop()
+				{
+					const int64_t b = m_bottom.load(std::memory_order_relaxed)-1;
+					m_bottom.store(b,std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+					int64_t t = m_top.load(std::memory_order_relaxed);
+					if (t>b)
+					{
+						m_bottom.store(b+1,std::memory_order_relaxed);
+						return nullptr;
+					}
+					CTask* task = m_tasks[b&(Capacity-1)].load(std::memory_order_relaxed);
+					if (t==b)
+					{
+						// last task, race the thieves for it
+						if (!m_top.compare_exchange_strong(t,t+1,std::memory_order_seq_cst,std::memory_order_relaxed))
+							task = nullptr;
+						m_bottom.store(b+1,std::memory_order_relaxed);
+					}
+					return task;
+				}
+				inline CTask* steal()
+				{
+					int64_t t = m_top.load(std::memory_order_acquire);
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+					const int64_t b = m_bottom.load(std::memory_order_acquire);
+					if (t>=b)
+						return nullptr;
+					CTask* task = m_tasks[t&(Capacity-1)].load(std::memory_order_relaxed);
+					if (!m_top.compare_exchange_strong(t,t+1,std::memory_order_seq_cst,std::memory_order_relaxed))
+						return nullptr;
+					return task;
+				}
+
+			private:
+				alignas(64) std::atomic<int64_t> m_top = 0;
+				alignas(64) std::atomic<int64_t> m_bottom = 0;
+				alignas(64) std::atomic<CTask*> m_tasks[Capacity] = {};
+		};
+		struct SWorker
+		{
+			CWorkerDeque deque;
+			std::thread thread;
+		};
+
+		explicit CTaskScheduler(const uint32_t workerCount);
+		~CTaskScheduler();
+
+		inline size_t getDefaultGrainSize(const size_t count) const
+		{
+			// 4 pieces per thread taking part
+			return core::max<size_t>(count/((m_workers.size()+1u)*4u),1u);
+		}
+
+		void workerLoop(const uint32_t workerIx);
+		//! pops, takes from the injection queue or steals one task and runs it, returns false if nothing was found
+		bool tryRunOneTask();
+		void execute(CTask* task);
+		void releaseDependency(CTask* task);
+		void schedule(CTask* task);
+		void wakeOne();
+
+		core::vector<std::unique_ptr<SWorker>> m_workers;
+		const execution_policy m_policy;
+
+		std::mutex m_injectionLock;
+		std::deque<CTask*> m_injectedTasks;
+
+		//! tasks sitting in any of the queues, sleeping workers wait for it to become non-zero
+		std::atomic_uint32_t m_queuedTaskCount = 0u;
+		std::atomic_uint32_t m_sleepingWorkerCount = 0u;
+		std::mutex m_sleepLock;
+		std::condition_variable m_wakeup;
+		std::atomic_bool m_exit = false;
+};
+
+}
+
+#endif
@@ -11,6 +11,13 @@ namespace nbl::system
 
 namespace impl
 {
+//! Gets called by whichever thread makes a future ready, lets coroutines get resumed instead of blocking in `wait`
+struct future_ready_callback_t
+{
+    void(*func)(void*) = nullptr;
+    void* userData = nullptr;
+};
+
 class IAsyncQueueDispatcherBase
 {
     protected:
@@ -93,6 +100,13 @@ class IAsyncQueueDispatcherBase
                     LOCKED=4
                 };
 
+                //! ANY THREAD: `callback` must stay alive until called, returns false if the future is already (being made) ready, then the callback won't get called
+                inline bool setReadyCallback(future_ready_callback_t* callback)
+                {
+                    future_ready_callback_t* expected = nullptr;
+                    return readyCallback.compare_exchange_strong(expected,callback);
+                }
+
             protected:
                 friend struct request_base_t;
                 //! REQUESTING THREAD: done as part of filling out the request
@@ -111,7 +125,12 @@ class IAsyncQueueDispatcherBase
                 //! WORKER THREAD: done as part of execution at the very end, after object is constructed
                 inline void notify()
                 {
+                    // claim the callback before becoming ready, as afterwards whoever waits can destroy the future
+                    future_ready_callback_t* callback = readyCallback.exchange(&callbackFired);
                     state.exchangeNotify<true>(STATE::READY,STATE::EXECUTING);
+                    // whoever registered the callback is suspended and can't destroy the future until we call it
+                    if (callback && callback!=&callbackFired)
+                        callback->func(callback->userData);
                 }
 
                 // the base class is not directly usable
@@ -130,6 +149,9 @@ class IAsyncQueueDispatcherBase
                 // this tells us whether an object with a lifetime has been constructed over the memory backing the future
                 // also acts as a lock
                 atomic_state_t<STATE,STATE::INITIAL> state = {};
+                // reset whenever the future goes back to INITIAL, `callbackFired` once the result is ready
+                std::atomic<future_ready_callback_t*> readyCallback = nullptr;
+                static inline future_ready_callback_t callbackFired = {};
         };
 
         // not meant for direct usage
@@ -266,6 +288,7 @@ class IAsyncQueueDispatcherBase
                         {
                             assert(m_future);
                             m_future->destruct();
+                            m_future->readyCallback.store(nullptr);
                             m_future->state.template exchangeNotify<true>(state_enum::INITIAL,state_enum::LOCKED);
                             m_future = nullptr;
                         }
@@ -327,6 +350,7 @@ class IAsyncQueueDispatcherBase
                         // 3. EXECUTING but before returning from `base_t::disassociate_request` cause there's a spinlock there
                         
                         request.exchange(nullptr)->cancel();
+                        base_t::readyCallback.store(nullptr);
 
                         // after doing everything, we can mark ourselves as cleaned up
                         base_t::state.template exchangeNotify<false>(base_t::STATE::INITIAL, base_t::STATE::EXECUTING);
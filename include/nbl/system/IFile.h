@@ -2,6 +2,7 @@
 #define _NBL_SYSTEM_I_FILE_H_INCLUDED_
 
 #include "nbl/system/ISystem.h"
+#include "nbl/system/coroutine.h"
 
 namespace nbl::system
 {
@@ -90,6 +91,44 @@ class IFile : public IFileBase, private ISystem::IFutureManipulator
 			fut.sizeToProcess = sizeToWrite;
 		}
 
+		//! For coroutines, `co_await file->readAsync(...)` suspends instead of blocking until the read completes and evaluates to the bytes read
+		class read_awaitable_t final : impl::future_resumer_t
+		{
+			public:
+				// the read gets issued when awaited
+				inline bool await_ready()
+				{
+					m_file->read(m_future,m_buffer,m_offset,m_size);
+					return m_future.ready();
+				}
+				inline bool await_suspend(std::coroutine_handle<> handle) {return suspendUntilReady(m_future,handle);}
+				inline size_t await_resume()
+				{
+					auto lock = m_future.acquire();
+					return lock ? *lock:0ull;
+				}
+
+			private:
+				friend IFile;
+				inline read_awaitable_t(IFile* file, void* buffer, size_t offset, size_t size, CTaskScheduler* scheduler)
+					: future_resumer_t(scheduler), m_file(file), m_buffer(buffer), m_offset(offset), m_size(size) {}
+				// the future cannot move in memory
+				read_awaitable_t(const read_awaitable_t&) = delete;
+				read_awaitable_t(read_awaitable_t&&) = delete;
+
+				IFile* m_file;
+				void* m_buffer;
+				size_t m_offset;
+				size_t m_size;
+				ISystem::future_t<size_t> m_future;
+		};
+		//! The coroutine resumes as a task on `scheduler`, it can't continue on the `ISystem` thread as any further (blocking) file operation would deadlock it
+		inline read_awaitable_t readAsync(void* buffer, size_t offset, size_t sizeToRead, CTaskScheduler* scheduler)
+		{
+			assert(scheduler);
+			return read_awaitable_t(this,buffer,offset,sizeToRead,scheduler);
+		}
+
 	protected:
 		// this is an abstract interface class so this stays protected
 		using IFileBase::IFileBase;
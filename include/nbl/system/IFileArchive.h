@@ -9,6 +9,7 @@
 #include "nbl/core/SRange.h"
 
 #include "nbl/system/path.h"
+#include "nbl/system/CPathTable.h"
 #include "nbl/system/ILogger.h"
 #include "nbl/system/IFileBase.h"
 
@@ -40,8 +41,8 @@ class IFileArchive : public core::IReferenceCounted
 				struct SEntry
 				{
 					//same stuff as `SListEntry` right now
-					//! The name of the file including the path relative to archive root
-					system::path pathRelativeToArchive;
+					//! The name of the file including the path relative to archive root, canonicalized and interned in `CPathTable`
+					CPathTable::SHandle pathRelativeToArchive;
 
 					//! The size of the file in bytes
 					size_t size;
@@ -55,26 +56,36 @@ class IFileArchive : public core::IReferenceCounted
 					// `EAT_NONE` for directories
 					IFileArchive::E_ALLOCATOR_TYPE allocatorType;
 
-					//! The == operator is provided so that CFileList can slowly search the list!
+					inline std::string_view getPathString() const {return CPathTable::get().getString(pathRelativeToArchive);}
+					inline system::path getPath() const {return getPathString();}
+					inline void setPath(const system::path& _pathRelativeToArchive) {pathRelativeToArchive = CPathTable::get().internPath(_pathRelativeToArchive);}
+
+					//! Paths are interned, so this is an integer compare
 					inline bool operator==(const struct SEntry& other) const
 					{
-						return pathRelativeToArchive.string() == other.pathRelativeToArchive.string();
+						return pathRelativeToArchive == other.pathRelativeToArchive;
 					}
 
-					//! The < operator is provided so that CFileList can sort and quickly search the list.
+					//! The < operator is provided so that CFileList can sort and search for all the entries in a directory, compares the canonical path strings
 					inline bool operator<(const struct SEntry& other) const
 					{
-						return pathRelativeToArchive < other.pathRelativeToArchive;
+						return getPathString() < other.getPathString();
 					}
 				};
-				using refctd_storage_t = std::shared_ptr<const core::vector<SEntry>>;
+				//! The entries sorted by path, with a hash index from the interned paths to the entries
+				struct SStorage
+				{
+					core::vector<SEntry> entries;
+					core::unordered_map<uint32_t,uint32_t> index;
+				};
+				using refctd_storage_t = std::shared_ptr<const SStorage>;
 
 				class found_t final
 				{
 						refctd_storage_t m_backingStorage = nullptr;
 
 					public:
-						using type = refctd_storage_t::element_type::const_pointer;
+						using type = const SEntry*;
 
 						inline found_t() = default;
 						inline found_t(refctd_storage_t&& _storage, type _iter) :	m_backingStorage(_storage), m_iter(_iter) {}
@@ -98,7 +109,7 @@ class IFileArchive : public core::IReferenceCounted
 
 			private:
 				// default ctor full range
-				inline SFileList(refctd_storage_t _data) : m_data(_data), m_span(m_data->data(),m_data->data()+m_data->size()) {}
+				inline SFileList(refctd_storage_t _data) : m_data(_data), m_span(m_data->entries.data(),m_data->entries.data()+m_data->entries.size()) {}
 
 				friend class IFileArchive;
 				refctd_storage_t m_data;
@@ -129,6 +140,12 @@ class IFileArchive : public core::IReferenceCounted
 			return getFile_impl(item,flags,password);
 		}
 
+		//! Whether there's an entry for the path, a hash probe rather than a search
+		inline bool contains(const path& pathRelativeToArchive) const
+		{
+			return bool(getItemFromPath(pathRelativeToArchive));
+		}
+
 		//
 		inline const path& getDefaultAbsolutePath() const {return m_defaultAbsolutePath;}
 
@@ -140,16 +157,21 @@ class IFileArchive : public core::IReferenceCounted
 		//
 		virtual core::smart_refctd_ptr<IFile> getFile_impl(const SFileList::found_t& found, const core::bitflag<IFileBase::E_CREATE_FLAGS> flags, const std::string_view& password) = 0;
 
+		//! One hash probe of the archive's index
 		inline const SFileList::found_t getItemFromPath(const system::path& pathRelativeToArchive) const
 		{
-            const SFileList::SEntry itemToFind = { pathRelativeToArchive };
 			// calling `listAssets` makes sure any "update list" overload can kick in
 			auto items = listAssets();
-			const auto span = SFileList::span_t(items);
-			const auto found = std::lower_bound(span.begin(),span.end(),itemToFind);
-			if (found==span.end() || found->pathRelativeToArchive!=pathRelativeToArchive)
+			// a path which was never interned can't be in any archive
+			const auto handle = CPathTable::get().findPath(pathRelativeToArchive);
+			if (!handle.isValid())
+				return {};
+			const auto& storage = *items.m_data;
+			const auto found = storage.index.find(handle.id);
+			if (found==storage.index.end())
 				return {};
-			return SFileList::found_t(std::move(items.m_data),&(*found));
+			const auto* const entry = storage.entries.data()+found->second;
+			return SFileList::found_t(std::move(items.m_data),entry);
 		}
 
 		const path m_defaultAbsolutePath;
@@ -157,8 +179,20 @@ class IFileArchive : public core::IReferenceCounted
 
 		inline void setItemList(std::shared_ptr<core::vector<SFileList::SEntry>> _items) const
 		{	
-			std::sort(_items->begin(),_items->end());
-			m_items.store(_items);
+			auto storage = std::make_shared<SFileList::SStorage>();
+			storage->entries = std::move(*_items);
+			// paths which couldn't be interned (full `CPathTable`) would all share one invalid handle, leave them out of the index
+			const auto validEnd = std::remove_if(storage->entries.begin(),storage->entries.end(),[](const SFileList::SEntry& entry)->bool{return !entry.pathRelativeToArchive.isValid();});
+			if (validEnd!=storage->entries.end())
+			{
+				m_logger.log("Path table is full, %d entries of the archive won't be accessible",ILogger::ELL_ERROR,int(std::distance(validEnd,storage->entries.end())));
+				storage->entries.erase(validEnd,storage->entries.end());
+			}
+			std::sort(storage->entries.begin(),storage->entries.end());
+			storage->index.reserve(storage->entries.size());
+			for (uint32_t i=0u; i<storage->entries.size(); i++)
+				storage->index.emplace(storage->entries[i].pathRelativeToArchive.id,i);
+			m_items.store(std::move(storage));
 		}
 
 	private:
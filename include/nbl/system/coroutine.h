@@ -0,0 +1,274 @@
+// Copyright (C) 2018-2022 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef _NBL_SYSTEM_COROUTINE_H_INCLUDED_
+#define _NBL_SYSTEM_COROUTINE_H_INCLUDED_
+
+#include "nbl/system/IAsyncQueueDispatcher.h"
+#include "nbl/system/CTaskScheduler.h"
+
+#include <coroutine>
+#include <optional>
+#include <exception>
+
+namespace nbl::system
+{
+
+//! Lazily started coroutine returning `T`, `co_await` it from another coroutine or block on it with `get`.
+/** The body does not run until awaited or `start`ed, after `co_return` the awaiting coroutine gets resumed on the same thread
+* (symmetric transfer, so long chains of coroutines don't grow the stack).
+* A `start`ed coroutine can still be awaited (once) to overlap several of them, see `when_all`.
+* Every `co_await` on a future suspends instead of blocking, so a thread (or `CTaskScheduler` worker) can run something else meanwhile.
+*/
+template<typename T=void>
+class coroutine_t;
+
+namespace impl
+{
+class coroutine_promise_base
+{
+	public:
+		struct final_awaiter_t
+		{
+			inline bool await_ready() const noexcept {return false;}
+			template<class Promise>
+			inline std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+			{
+				auto& promise = handle.promise();
+				// races with a late `co_await` on a `start`ed coroutine, whoever comes second resumes the awaiter
+				void* const continuation = promise.m_continuation.exchange(finishedMarker(),std::memory_order_acq_rel);
+				if (continuation)
+					return std::coroutine_handle<>::from_address(continuation);
+				// nobody awaits, someone might be blocked in `get`
+				promise.m_done.store(true,std::memory_order_release);
+				promise.m_done.notify_all();
+				return std::noop_coroutine();
+			}
+			inline void await_resume() const noexcept {}
+		};
+
+		inline std::suspend_always initial_suspend() const noexcept {return {};}
+		inline final_awaiter_t final_suspend() const noexcept {return {};}
+		// the engine does not propagate exceptions across threads
+		inline void unhandled_exception() const noexcept {std::terminate();}
+
+	protected:
+		template<typename> friend class nbl::system::coroutine_t;
+
+		// address of the awaiting coroutine's frame, `finishedMarker()` once the body has returned
+		inline static void* finishedMarker() {return &m_finished;}
+		//! returns false if the coroutine has already returned, then `awaiting` must be resumed by the caller
+		inline bool setContinuation(std::coroutine_handle<> awaiting)
+		{
+			void* expected = nullptr;
+			return m_continuation.compare_exchange_strong(expected,awaiting.address(),std::memory_order_acq_rel);
+		}
+
+		std::atomic<void*> m_continuation = nullptr;
+		std::atomic_bool m_done = false;
+		static inline char m_finished = 0;
+};
+template<typename T>
+class coroutine_promise : public coroutine_promise_base
+{
+	public:
+		inline void return_value(T value) {m_value.emplace(std::move(value));}
+
+	protected:
+		template<typename> friend class nbl::system::coroutine_t;
+
+		inline T take() {return std::move(*m_value);}
+
+		std::optional<T> m_value;
+};
+template<>
+class coroutine_promise<void> : public coroutine_promise_base
+{
+	public:
+		inline void return_void() const {}
+
+	protected:
+		template<typename> friend class nbl::system::coroutine_t;
+
+		inline void take() const {}
+};
+}
+
+template<typename T>
+class coroutine_t final
+{
+	public:
+		struct promise_type : impl::coroutine_promise<T>
+		{
+			inline coroutine_t get_return_object() {return coroutine_t(std::coroutine_handle<promise_type>::from_promise(*this));}
+		};
+
+		coroutine_t() = default;
+		coroutine_t(const coroutine_t&) = delete;
+		inline coroutine_t(coroutine_t&& other) : m_handle(std::exchange(other.m_handle,nullptr)), m_started(other.m_started) {}
+		coroutine_t& operator=(const coroutine_t&) = delete;
+		inline coroutine_t& operator=(coroutine_t&& other)
+		{
+			std::swap(m_handle,other.m_handle);
+			std::swap(m_started,other.m_started);
+			return *this;
+		}
+		//! must not be destroyed while running, `get` the result first if you `start`ed it
+		inline ~coroutine_t()
+		{
+			if (m_handle)
+				m_handle.destroy();
+		}
+
+		inline explicit operator bool() const {return bool(m_handle);}
+
+		//! Runs the coroutine on the calling thread until it first suspends, without anyone waiting for it
+		inline void start()
+		{
+			assert(m_handle && !m_started);
+			m_started = true;
+			m_handle.resume();
+		}
+		//! Starts the coroutine if needed and blocks until it returns, can only be called once
+		inline T get()
+		{
+			if (!m_started)
+				start();
+			auto& promise = m_handle.promise();
+			promise.m_done.wait(false,std::memory_order_acquire);
+			return promise.take();
+		}
+
+		// awaiting starts the coroutine if it wasn't `start`ed yet, the awaiter gets resumed when it returns
+		inline auto operator co_await() &&
+		{
+			struct awaiter_t
+			{
+				inline bool await_ready() const noexcept {return false;}
+				inline std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+				{
+					const bool registered = handle.promise().setContinuation(awaiting);
+					if (!started)
+					{
+						assert(registered);
+						return handle;
+					}
+					// already running elsewhere, if it has finished meanwhile carry on right away
+					return registered ? std::noop_coroutine():awaiting;
+				}
+				inline T await_resume() {return handle.promise().take();}
+
+				std::coroutine_handle<promise_type> handle;
+				bool started;
+			};
+			assert(m_handle);
+			const bool started = std::exchange(m_started,true);
+			return awaiter_t{m_handle,started};
+		}
+		inline auto operator co_await() & {return std::move(*this).operator co_await();}
+
+	private:
+		explicit inline coroutine_t(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+		std::coroutine_handle<promise_type> m_handle = nullptr;
+		bool m_started = false;
+};
+
+//! Starts all `tasks` so they overlap, then awaits them in order and gathers their results
+template<typename T>
+inline coroutine_t<core::vector<T>> when_all(core::vector<coroutine_t<T>> tasks)
+{
+	for (auto& task : tasks)
+		task.start();
+	core::vector<T> results;
+	results.reserve(tasks.size());
+	for (auto& task : tasks)
+		results.push_back(co_await task);
+	co_return results;
+}
+inline coroutine_t<void> when_all(core::vector<coroutine_t<void>> tasks)
+{
+	for (auto& task : tasks)
+		task.start();
+	for (auto& task : tasks)
+		co_await task;
+}
+
+namespace impl
+{
+//! Common part of future awaitables, hooks resuming the coroutine onto the future becoming ready
+class future_resumer_t
+{
+	protected:
+		explicit inline future_resumer_t(CTaskScheduler* scheduler) : m_scheduler(scheduler) {}
+
+		//! returns false if the future got ready in the meantime, then the coroutine must not suspend
+		template<class Future>
+		inline bool suspendUntilReady(Future& future, std::coroutine_handle<> handle)
+		{
+			m_handle = handle;
+			m_callback = {&resume,this};
+			return future.setReadyCallback(&m_callback);
+		}
+
+	private:
+		static inline void resume(void* userData)
+		{
+			auto* self = reinterpret_cast<future_resumer_t*>(userData);
+			// without a scheduler the coroutine continues on the dispatcher thread which made the future ready, see `awaitFuture`
+			if (self->m_scheduler)
+				self->m_scheduler->run([handle=self->m_handle]() -> void {handle.resume();});
+			else
+				self->m_handle.resume();
+		}
+
+		CTaskScheduler* m_scheduler;
+		std::coroutine_handle<> m_handle = nullptr;
+		future_ready_callback_t m_callback = {};
+};
+}
+
+//! `co_await awaitFuture(future)` suspends until the future is ready and evaluates to its `storage_lock_t` (empty if the request got cancelled).
+/** The coroutine resumes as a task on `scheduler` or, if null, on the dispatcher thread which made the future ready.
+* Only pass null if the rest of the coroutine never waits on a request to that same dispatcher, it would deadlock its only thread.
+* Careful: a cancelled request never makes its future ready, so don't cancel what a coroutine awaits.
+*/
+template<typename T>
+class future_awaiter_t final : impl::future_resumer_t
+{
+		using future_t = impl::IAsyncQueueDispatcherBase::future_t<T>;
+
+	public:
+		inline future_awaiter_t(future_t& future, CTaskScheduler* scheduler) : future_resumer_t(scheduler), m_future(future) {}
+
+		inline bool await_ready() const {return m_future.ready();}
+		inline bool await_suspend(std::coroutine_handle<> handle) {return suspendUntilReady(m_future,handle);}
+		inline typename future_t::storage_lock_t await_resume() {return m_future.acquire();}
+
+	private:
+		future_t& m_future;
+};
+template<typename T>
+inline future_awaiter_t<T> awaitFuture(impl::IAsyncQueueDispatcherBase::future_t<T>& future, CTaskScheduler* scheduler=nullptr)
+{
+	return future_awaiter_t<T>(future,scheduler);
+}
+
+//! `co_await resumeOn(scheduler)` moves the rest of the coroutine onto one of the `scheduler`'s workers (no-op for a null scheduler)
+inline auto resumeOn(CTaskScheduler* scheduler)
+{
+	struct awaiter_t
+	{
+		inline bool await_ready() const {return !scheduler;}
+		inline void await_suspend(std::coroutine_handle<> handle) const {scheduler->run([handle]() -> void {handle.resume();});}
+		inline void await_resume() const {}
+
+		CTaskScheduler* scheduler;
+	};
+	return awaiter_t{scheduler};
+}
+
+}
+
+#endif
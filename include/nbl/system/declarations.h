@@ -13,6 +13,10 @@
 #include "nbl/system/DynamicFunctionCaller.h"
 #include "nbl/system/SReadWriteSpinLock.h"
 
+// threading
+#include "nbl/system/CTaskScheduler.h"
+#include "nbl/system/coroutine.h"
+
 // files
 #include "nbl/system/IFile.h"
 
@@ -88,6 +88,26 @@ class NBL_API2 IGPUCommandBuffer : public IBackendObject
         };
         inline core::bitflag<USAGE> getRecordingFlags() const { return m_recordingFlags; }
 
+        //! How the resources used by the recorded commands are kept alive until the command buffer gets reset, begun again or destroyed
+        enum class RESOURCE_TRACKING : uint8_t
+        {
+            //! every command holds its own references, an atomic increment and decrement per resource per command
+            PER_COMMAND,
+            //! each resource gets referenced once per recording, no matter how many commands use it
+            DEDUPLICATED,
+            //! nothing gets referenced, the caller guarantees every resource outlives the execution of the command buffer
+            NONE
+        };
+        inline RESOURCE_TRACKING getResourceTracking() const { return m_resourceTracking; }
+        //! Can't be changed in the middle of a recording
+        inline bool setResourceTracking(const RESOURCE_TRACKING mode)
+        {
+            if (m_state==STATE::RECORDING)
+                return false;
+            m_resourceTracking = mode;
+            return true;
+        }
+
         enum class QUERY_CONTROL_FLAGS : uint8_t
         {
             NONE = 0x00u,
@@ -654,6 +674,8 @@ class NBL_API2 IGPUCommandBuffer : public IBackendObject
             m_state = STATE::INITIAL;
 
             m_boundDescriptorSetsRecord.clear();
+            // the pool's reset destroyed the commands, but not what we track outside of them
+            m_trackedResources.clear();
 
             m_commandList.head = nullptr;
             m_commandList.tail = nullptr;
@@ -666,10 +688,44 @@ class NBL_API2 IGPUCommandBuffer : public IBackendObject
         inline void releaseResourcesBackToPool()
         {
             deleteCommandList();
+            m_trackedResources.clear();
             m_boundDescriptorSetsRecord.clear();
             releaseResourcesBackToPool_impl();
         }
 
+        //! What the command itself should hold on to, depends on the tracking mode
+        template<typename T>
+        inline core::smart_refctd_ptr<const T> trackResource(const T* const resource)
+        {
+            switch (m_resourceTracking)
+            {
+                case RESOURCE_TRACKING::PER_COMMAND:
+                    return core::smart_refctd_ptr<const T>(resource);
+                case RESOURCE_TRACKING::DEDUPLICATED:
+                    if (resource)
+                        m_trackedResources.insert(resource);
+                    break;
+                default:
+                    break;
+            }
+            return nullptr;
+        }
+        template<typename T, typename U>
+        inline core::smart_refctd_ptr<const T> trackResource(const core::smart_refctd_ptr<U>& resource)
+        {
+            return trackResource<T>(resource.get());
+        }
+        //! Returns how many of the `resources` the command has to hold references to itself
+        template<typename T>
+        inline uint32_t trackResources(const uint32_t count, const T* const* const resources)
+        {
+            if (m_resourceTracking==RESOURCE_TRACKING::PER_COMMAND)
+                return count;
+            for (uint32_t i=0u; i<count; i++)
+                trackResource<T>(resources[i]);
+            return 0u;
+        }
+
         inline void deleteCommandList()
         {
             m_cmdpool->m_commandListPool.deleteList(m_commandList.head);
@@ -784,6 +840,9 @@ class NBL_API2 IGPUCommandBuffer : public IBackendObject
         core::unordered_map<const IGPUDescriptorSet*,uint64_t> m_boundDescriptorSetsRecord;
     
         IGPUCommandPool::CCommandSegmentListPool::SCommandSegmentList m_commandList = {};
+        //! the resources the current recording references, in `RESOURCE_TRACKING::DEDUPLICATED` mode
+        core::CRefctdPointerSet m_trackedResources;
+        RESOURCE_TRACKING m_resourceTracking = RESOURCE_TRACKING::PER_COMMAND;
 
         uint64_t m_resetCheckedStamp;
         STATE m_state = STATE::INITIAL;
@@ -28,6 +28,8 @@ class IGPUPipelineCache : public IBackendObject
 		}
 
 		virtual core::smart_refctd_ptr<asset::ICPUPipelineCache> convertToCPUCache() const = 0;
+		//! Size of what `convertToCPUCache` would return, growing means something new got compiled into the cache
+		virtual size_t getDataSize() const = 0;
 		
 	protected:
 		explicit IGPUPipelineCache(core::smart_refctd_ptr<const ILogicalDevice>&& dev) : IBackendObject(std::move(dev)) {}
@@ -6,6 +6,7 @@
 
 
 #include "nbl/core/alloc/GeneralpurposeAddressAllocator.h"
+#include "nbl/core/alloc/TLSFAddressAllocator.h"
 #include "nbl/video/alloc/CSingleBufferSubAllocator.h"
 #include "nbl/video/TimelineEventHandlers.h"
 
@@ -176,16 +177,33 @@ class CAsyncSingleBufferSubAllocator
             // then try to wait at least once and allocate
             do
             {
+                #ifdef _NBL_ALLOCATOR_TIMING_
+                const auto waitStart = std::chrono::steady_clock::now();
+                #endif
                 deferredFrees.wait(maxWaitPoint,unallocatedSize);
+                #ifdef _NBL_ALLOCATOR_TIMING_
+                m_waitNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-waitStart).count();
+                #endif
+                m_waitCount++;
 
                 unallocatedSize = try_multi_alloc(args...);
                 if (!unallocatedSize)
                     return 0u;
             } while(Clock::now()<maxWaitPoint);
 
+            m_failedAllocCount++;
             return unallocatedSize;
         }
 
+        //! Only the waits for deferred frees and the allocations which timed out get counted here, the rest comes from the `AddressAllocator`
+        inline void fill_statistics(core::SAddressAllocatorStatistics& stats) const noexcept
+        {
+            core::address_allocator_traits<AddressAllocator>::fill_statistics(getAddressAllocator(),stats);
+            stats.failedAllocCount += m_failedAllocCount;
+            stats.waitCount += m_waitCount;
+            stats.waitNanoseconds += m_waitNanoseconds;
+        }
+
         //!
         inline void multi_deallocate(const ISemaphore::SWaitInfo& futureWait, DeferredFreeFunctor&& functor) noexcept
         {
@@ -216,6 +234,9 @@ class CAsyncSingleBufferSubAllocator
     protected:
         Composed m_composed;
         MultiTimelineEventHandlerST<DeferredFreeFunctor> deferredFrees;
+        uint64_t m_failedAllocCount = 0ull;
+        uint64_t m_waitCount = 0ull;
+        uint64_t m_waitNanoseconds = 0ull;
 
         template<typename... Args>
         inline value_type try_multi_alloc(uint32_t count, value_type* outAddresses, const size_type* byteSizes, const Args&... args) noexcept
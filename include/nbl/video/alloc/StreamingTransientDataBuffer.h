@@ -15,16 +15,17 @@
 namespace nbl::video
 {
 
-template<class HostAllocator=core::allocator<uint8_t>, class RecursiveLockable=std::recursive_mutex>
+template<class HostAllocator=core::allocator<uint8_t>, class RecursiveLockable=std::recursive_mutex, class AddressAllocator=core::GeneralpurposeAddressAllocator<uint32_t>>
 class StreamingTransientDataBufferMT;
 
 namespace impl
 {
-template<class HostAllocator>
+// `AddressAllocator` can be swapped for `core::TLSFAddressAllocator<uint32_t>` to get O(1) allocations with no defragmentation stalls
+template<class HostAllocator, class AddressAllocator=core::GeneralpurposeAddressAllocator<uint32_t>>
 class StreamingTransientDataBuffer
 {
-        using ThisType = StreamingTransientDataBuffer<HostAllocator>;
-        using Composed = impl::CAsyncSingleBufferSubAllocator<core::GeneralpurposeAddressAllocator<uint32_t>,HostAllocator>;
+        using ThisType = StreamingTransientDataBuffer<HostAllocator,AddressAllocator>;
+        using Composed = impl::CAsyncSingleBufferSubAllocator<AddressAllocator,HostAllocator>;
 
     protected:
         Composed m_composed;
@@ -67,6 +68,9 @@ class StreamingTransientDataBuffer
         //
         inline size_type max_size() noexcept {return m_composed.max_size();}
 
+        //! fragmentation of the ring plus time spent waiting on deferred frees, see `core::SAddressAllocatorStatistics`
+        inline void fill_statistics(core::SAddressAllocatorStatistics& stats) const noexcept {m_composed.fill_statistics(stats);}
+
         // perfect forward to `Composed` method
         template<typename... Args>
         inline value_type multi_allocate(Args&&... args) noexcept
@@ -107,10 +111,10 @@ class StreamingTransientDataBuffer
 };
 }
 
-template<class HostAllocator=core::allocator<uint8_t>>
-class StreamingTransientDataBufferST : public core::IReferenceCounted, public impl::StreamingTransientDataBuffer<HostAllocator>
+template<class HostAllocator=core::allocator<uint8_t>, class AddressAllocator=core::GeneralpurposeAddressAllocator<uint32_t>>
+class StreamingTransientDataBufferST : public core::IReferenceCounted, public impl::StreamingTransientDataBuffer<HostAllocator,AddressAllocator>
 {
-        using Base = impl::StreamingTransientDataBuffer<HostAllocator>;
+        using Base = impl::StreamingTransientDataBuffer<HostAllocator,AddressAllocator>;
 
     protected:
         ~StreamingTransientDataBufferST() = default;
@@ -120,10 +124,10 @@ class StreamingTransientDataBufferST : public core::IReferenceCounted, public im
         StreamingTransientDataBufferST(Args&&... args) : Base(std::forward<Args>(args)...) {}
 };
 
-template<class HostAllocator, class RecursiveLockable>
+template<class HostAllocator, class RecursiveLockable, class AddressAllocator>
 class StreamingTransientDataBufferMT : public core::IReferenceCounted
 {
-        using Composed = impl::StreamingTransientDataBuffer<HostAllocator>;
+        using Composed = impl::StreamingTransientDataBuffer<HostAllocator,AddressAllocator>;
 
     protected:
         Composed m_composed;
@@ -178,6 +182,13 @@ class StreamingTransientDataBufferMT : public core::IReferenceCounted
             return retval;
         }
 
+        inline void fill_statistics(core::SAddressAllocatorStatistics& stats) noexcept
+        {
+            lock.lock();
+            m_composed.fill_statistics(stats);
+            lock.unlock();
+        }
+
 
         template<typename... Args>
         inline size_type multi_allocate(Args&&... args) noexcept
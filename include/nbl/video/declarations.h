@@ -33,7 +33,11 @@
 #include "nbl/video/utilities/CDrawIndirectAllocator.h"
 #include "nbl/video/utilities/CSubpassKiln.h"
 #include "nbl/video/utilities/IUtilities.h"
+#include "nbl/video/utilities/CBufferUploadBatcher.h"
+#include "nbl/video/utilities/CAsyncReadbackQueue.h"
+#include "nbl/video/utilities/CPersistentPipelineCache.h"
 #include "nbl/video/utilities/IGPUObjectFromAssetConverter.h"
+#include "nbl/video/utilities/CGPUObjectCreationCache.h"
 #include "nbl/video/utilities/SPhysicalDeviceFilter.h"
 #include "nbl/video/utilities/CSimpleResizeSurface.h"
 #include "nbl/video/utilities/CSmoothResizeSurface.h"
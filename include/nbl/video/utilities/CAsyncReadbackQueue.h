@@ -0,0 +1,115 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_VIDEO_C_ASYNC_READBACK_QUEUE_H_INCLUDED_
+#define _NBL_VIDEO_C_ASYNC_READBACK_QUEUE_H_INCLUDED_
+
+
+#include "nbl/system/CTaskScheduler.h"
+
+#include "nbl/video/utilities/IUtilities.h"
+
+
+namespace nbl::video
+{
+
+//! Reads buffers back every frame without the render thread ever waiting for the copies, unlike `IUtilities::downloadBufferRangeViaStagingBufferAutoSubmit`.
+/**
+	The downloads recorded between two `submit`s make up a frame, which gets copied into the `IUtilities`' down-streaming buffer on its own queue
+	(usually a transfer queue) and signals a timeline semaphore. Once `poll` sees a frame done, its consumers get run on the `CTaskScheduler`
+	straight from the mapped staging memory, which is only freed when the consumer returns, so encoding a screenshot overlaps the next frames.
+
+	There's backpressure in two places: recording into a frame slot which is still in flight waits for it, and when the down-streaming buffer
+	is full a download waits for the oldest submitted frame to finish, then for the consumers still holding staging memory.
+
+	The buffers read from must be usable by the queue's family (concurrent sharing or an ownership transfer done by you) and the writes to them
+	must be made visible by the semaphores passed to `submit`. Not threadsafe, the consumers however can run concurrently with each other.
+*/
+class NBL_API2 CAsyncReadbackQueue final : public core::IReferenceCounted
+{
+	public:
+		//! Gets called once per download with a `dstOffset` of 0 and the whole range, unlike the `IUtilities` downloads a range is never split
+		using consumer_t = std::function<IUtilities::data_consumption_callback_t>;
+
+		struct SCreationParams
+		{
+			core::smart_refctd_ptr<IUtilities> utilities;
+			IQueue* queue = nullptr;
+			// without one the consumers run on the thread calling `poll`
+			core::smart_refctd_ptr<system::CTaskScheduler> scheduler = nullptr;
+			uint32_t framesInFlight = 3u;
+		};
+		static core::smart_refctd_ptr<CAsyncReadbackQueue> create(SCreationParams&& params);
+
+		//
+		struct SStatistics
+		{
+			uint64_t downloadCount = 0ull;
+			uint64_t downloadedBytes = 0ull;
+			uint64_t submitCount = 0ull;
+			// how many times recording had to block on the GPU or the consumers
+			uint64_t stallCount = 0ull;
+		};
+		inline const SStatistics& getStatistics() const {return m_stats;}
+
+		//
+		inline IQueue* getQueue() const {return m_queue;}
+		inline ISemaphore* getSemaphore() const {return m_semaphore.get();}
+		//! The value the semaphore will reach once everything submitted so far is copied
+		inline uint64_t getLastSignalValue() const {return m_lastSignalValue;}
+
+		//! Records a copy of `srcBufferRange` into the frame being recorded, the `consumer` runs once it has arrived.
+		//! Fails if the range can never fit in the down-streaming buffer, or the current frame alone fills it (`submit` more often then).
+		bool download(const asset::SBufferRange<IGPUBuffer>& srcBufferRange, consumer_t&& consumer);
+
+		//! Submits the frame recorded since the last call, its copies start after the `waitSemaphores` (for example the frame's render submit) signal
+		IQueue::RESULT submit(const std::span<const IQueue::SSubmitInfo::SSemaphoreInfo> waitSemaphores={});
+
+		//! Non-blocking, hands the downloads of all completed frames to their consumers and returns how many there were, call once a frame
+		uint32_t poll();
+		//! Blocks until everything submitted has been consumed, the downloads recorded but not submitted yet are left alone
+		void wait();
+
+	protected:
+		struct SDownload
+		{
+			consumer_t consumer;
+			size_t size;
+			uint32_t offset;
+			uint32_t allocationSize;
+		};
+		struct SFrame
+		{
+			core::smart_refctd_ptr<IGPUCommandBuffer> cmdbuf;
+			core::vector<SDownload> downloads;
+			// 0 when not submitted
+			uint64_t signalValue = 0ull;
+		};
+
+		CAsyncReadbackQueue(SCreationParams&& params, core::smart_refctd_ptr<ISemaphore>&& semaphore, core::smart_refctd_ptr<IGPUCommandPool>&& pool, core::vector<SFrame>&& frames);
+		~CAsyncReadbackQueue();
+
+		bool beginFrame();
+		// runs or schedules the consumers of a completed frame
+		void retire(SFrame& frame);
+		// waits for something holding down-streaming buffer memory to let go of it, false if there's nothing to wait for
+		bool makeRoom();
+		void consume(const SDownload& download) const;
+
+		const core::smart_refctd_ptr<IUtilities> m_utilities;
+		IQueue* const m_queue;
+		const core::smart_refctd_ptr<system::CTaskScheduler> m_scheduler;
+		const core::smart_refctd_ptr<ISemaphore> m_semaphore;
+		const core::smart_refctd_ptr<IGPUCommandPool> m_pool;
+		core::vector<SFrame> m_frames;
+		// consumers running on the scheduler, in the order they got started
+		core::vector<core::smart_refctd_ptr<system::CTaskScheduler::CTask>> m_consumerTasks;
+		uint64_t m_lastSignalValue = 0ull;
+		uint32_t m_currentFrame = 0u;
+		bool m_recording = false;
+		SStatistics m_stats;
+};
+
+}
+
+#endif
@@ -0,0 +1,111 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_VIDEO_C_BUFFER_UPLOAD_BATCHER_H_INCLUDED_
+#define _NBL_VIDEO_C_BUFFER_UPLOAD_BATCHER_H_INCLUDED_
+
+
+#include "nbl/video/utilities/IUtilities.h"
+
+
+namespace nbl::video
+{
+
+//! Collects many small buffer updates over a frame and uploads them through the `IUtilities`' streaming buffer in one go.
+/**
+	Calling `IUtilities::updateBufferRangeViaStagingBuffer` for every transform or property change costs a streaming buffer allocation
+	and a `copyBuffer` command each. This class instead keeps a host side copy of the updates until `flush`, then sorts them by destination,
+	merges the ranges which touch or overlap, packs as many of them as fit into a single staging allocation and records one `copyBuffer`
+	with many regions per destination buffer.
+	Overlapping updates to the same buffer keep their order, the one which came last wins.
+	Not threadsafe, use one per recording thread.
+*/
+class NBL_API2 CBufferUploadBatcher final : public core::IReferenceCounted
+{
+	public:
+		//! Ranges merged from the updates which are larger than `1/LargeRangeDivisor`th of the streaming buffer don't get packed with others,
+		//! they go through `IUtilities::updateBufferRangeViaStagingBuffer` which can split them over multiple allocations.
+		constexpr static inline uint32_t LargeRangeDivisor = 4u;
+		//! Packed ranges start at offsets aligned to this within the staging allocation
+		constexpr static inline uint32_t RangeAlignment = 16u;
+
+		static inline core::smart_refctd_ptr<CBufferUploadBatcher> create(core::smart_refctd_ptr<IUtilities>&& utilities)
+		{
+			if (!utilities || !utilities->getDefaultUpStreamingBuffer())
+				return nullptr;
+			return core::smart_refctd_ptr<CBufferUploadBatcher>(new CBufferUploadBatcher(std::move(utilities)),core::dont_grab);
+		}
+
+		//
+		struct SStatistics
+		{
+			// updates queued up before the flush, each would have taken at least one `copyBuffer` on its own
+			uint32_t updateCount = 0u;
+			// what was left after merging adjacent and overlapping ones
+			uint32_t rangeCount = 0u;
+			// the `copyBuffer` commands actually recorded, not counting the ones of the large ranges
+			uint32_t copyCommandCount = 0u;
+			uint32_t stagingAllocationCount = 0u;
+			// ranges which went through `IUtilities::updateBufferRangeViaStagingBuffer` on their own
+			uint32_t largeRangeCount = 0u;
+			uint64_t uploadedBytes = 0ull;
+		};
+		//! Of the last `flush`
+		inline const SStatistics& getStatistics() const {return m_stats;}
+
+		//
+		inline IUtilities* getUtilities() const {return m_utilities.get();}
+		inline size_t getPendingUpdateCount() const {return m_pending.size();}
+
+		//! Copies the `data` away, so it can be reused as soon as this returns. Same valid usage as `IUtilities::updateBufferRangeViaStagingBuffer`.
+		bool update(const asset::SBufferRange<IGPUBuffer>& bufferRange, const void* data);
+
+		//! Records the copies of everything queued up since the last flush into `nextSubmit`, which may get overflow submitted on the way.
+		//! The updates are cleared even on failure.
+		bool flush(SIntendedSubmitInfo& nextSubmit);
+		//! Drops the queued up updates without uploading them
+		inline void clear()
+		{
+			m_pending.clear();
+			m_hostData.clear();
+		}
+
+	protected:
+		inline CBufferUploadBatcher(core::smart_refctd_ptr<IUtilities>&& utilities) : m_utilities(std::move(utilities)) {}
+		inline ~CBufferUploadBatcher() = default;
+
+		struct SPendingUpdate
+		{
+			core::smart_refctd_ptr<IGPUBuffer> buffer;
+			size_t dstOffset;
+			size_t size;
+			// into `m_hostData`
+			size_t dataOffset;
+		};
+		// a run of merged updates
+		struct SRange
+		{
+			IGPUBuffer* buffer;
+			size_t dstOffset;
+			size_t size;
+			// the run's updates in `m_order`
+			uint32_t firstUpdate;
+			uint32_t updateCount;
+		};
+		// writes the range's updates in the order they came in
+		void compose(const SRange& range, uint8_t* dst) const;
+
+		core::smart_refctd_ptr<IUtilities> m_utilities;
+		core::vector<SPendingUpdate> m_pending;
+		core::vector<uint8_t> m_hostData;
+		// scratch kept around between flushes to not reallocate every frame
+		core::vector<uint32_t> m_order;
+		core::vector<SRange> m_ranges;
+		core::vector<IGPUCommandBuffer::SBufferCopy> m_regions;
+		core::vector<uint8_t> m_largeRangeScratch;
+		SStatistics m_stats;
+};
+
+}
+
+#endif
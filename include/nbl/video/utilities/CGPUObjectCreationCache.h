@@ -0,0 +1,151 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_VIDEO_C_GPU_OBJECT_CREATION_CACHE_H_INCLUDED_
+#define _NBL_VIDEO_C_GPU_OBJECT_CREATION_CACHE_H_INCLUDED_
+
+
+#include "nbl/asset/asset.h"
+#include "nbl/core/xxHash256.h"
+#include "nbl/system/CTaskScheduler.h"
+
+#include "nbl/video/utilities/IUtilities.h"
+#include "nbl/video/utilities/CPersistentPipelineCache.h"
+
+#include <mutex>
+
+
+namespace nbl::video
+{
+
+//! Remembers the GPU objects made from CPU assets by the `XXHash_256` of their contents, so identical buffers, images and shaders
+//! coming from different files (or different loads of the same level) only get created and uploaded once.
+/**
+	The cache holds strong references to everything inserted into it until `clear()`, so it's meant to be kept around between conversions.
+	All methods are threadsafe, the hashing and creation helpers spread their work over a `system::CTaskScheduler` when given one.
+*/
+class NBL_API2 CGPUObjectCreationCache final : public core::IReferenceCounted
+{
+	public:
+		struct SContentHash
+		{
+			inline bool operator==(const SContentHash& other) const = default;
+
+			uint64_t value[4] = {};
+		};
+
+		//! Contents above this size get split into pieces hashed independently, the result doesn't depend on whether there's a scheduler or not
+		constexpr static inline size_t HashPieceSize = 1ull<<20ull;
+
+		// Usage flags are part of the hash, identical contents with different usages don't get merged
+		static SContentHash hash(const asset::ICPUBuffer* buffer, system::CTaskScheduler* scheduler=nullptr);
+		// Covers the creation parameters, the regions and the contents of the backing buffer
+		static SContentHash hash(const asset::ICPUImage* image, system::CTaskScheduler* scheduler=nullptr);
+		// Non-SPIR-V sources get the filepath hint hashed too, because includes get resolved relative to it,
+		// and so do the `optimizer`'s passes, the same source optimized differently is a different module
+		static SContentHash hash(const asset::ICPUShader* shader, const asset::ISPIRVOptimizer* optimizer=nullptr);
+
+		//! The `pipelineCache` is what `createPipelines` uses when not given an explicit `IGPUPipelineCache`
+		static inline core::smart_refctd_ptr<CGPUObjectCreationCache> create(core::smart_refctd_ptr<ILogicalDevice>&& device, core::smart_refctd_ptr<CPersistentPipelineCache>&& pipelineCache=nullptr)
+		{
+			if (!device)
+				return nullptr;
+			return core::smart_refctd_ptr<CGPUObjectCreationCache>(new CGPUObjectCreationCache(std::move(device),std::move(pipelineCache)),core::dont_grab);
+		}
+
+		//
+		inline ILogicalDevice* getDevice() const {return m_device.get();}
+		inline CPersistentPipelineCache* getPersistentPipelineCache() const {return m_pipelineCache.get();}
+
+		//
+		template<class GPUObjectType>
+		inline core::smart_refctd_ptr<GPUObjectType> find(const asset::IAsset::E_TYPE type, const SContentHash& contentHash) const
+		{
+			std::lock_guard lock(m_mutex);
+			auto found = m_cache.find({contentHash,type});
+			if (found!=m_cache.end())
+				return core::smart_refctd_ptr_dynamic_cast<GPUObjectType>(found->second);
+			return nullptr;
+		}
+		//! Returns what ends up in the cache, which is a different object than `gpuObject` if someone inserted one with the same hash in the meantime
+		template<class GPUObjectType>
+		inline core::smart_refctd_ptr<GPUObjectType> insert(const asset::IAsset::E_TYPE type, const SContentHash& contentHash, core::smart_refctd_ptr<GPUObjectType>&& gpuObject)
+		{
+			if (!gpuObject)
+				return nullptr;
+			std::lock_guard lock(m_mutex);
+			auto inserted = m_cache.emplace(SKey{contentHash,type},std::move(gpuObject));
+			return core::smart_refctd_ptr_dynamic_cast<GPUObjectType>(inserted.first->second);
+		}
+
+		//
+		inline size_t size() const
+		{
+			std::lock_guard lock(m_mutex);
+			return m_cache.size();
+		}
+		inline void clear()
+		{
+			std::lock_guard lock(m_mutex);
+			m_cache.clear();
+		}
+
+		//! Compiles (if needed, one at a time) and creates the shaders that aren't in the cache yet concurrently, `output` has to have room for `shaders.size()` elements
+		bool createShaders(const std::span<const asset::ICPUShader* const> shaders, core::smart_refctd_ptr<IGPUShader>* const output, system::CTaskScheduler* scheduler=nullptr, const asset::ISPIRVOptimizer* optimizer=nullptr);
+
+		//! Creates device local buffers for the ones that aren't in the cache yet and records their uploads through the `utilities`' streaming buffer into `nextSubmit`.
+		//! The buffers in `output` are only usable after `nextSubmit` gets submitted (which may have already happened a few times if the streaming buffer overflowed).
+		bool createBuffers(IUtilities* utilities, SIntendedSubmitInfo& nextSubmit, const std::span<const asset::ICPUBuffer* const> buffers, core::smart_refctd_ptr<IGPUBuffer>* const output, system::CTaskScheduler* scheduler=nullptr);
+
+		//! Splits the creation of pipelines over the `scheduler`'s threads, Vulkan pipeline caches are internally synchronized unless created as not threadsafe.
+		//! Passing a null `pipelineCache` uses the persistent one given at creation, if any.
+		template<class PipelineType>
+		inline bool createPipelines(IGPUPipelineCache* const pipelineCache, const std::span<const typename PipelineType::SCreationParams> params, core::smart_refctd_ptr<PipelineType>* const output, system::CTaskScheduler* scheduler=nullptr)
+		{
+			std::atomic_bool success = true;
+			auto createRange = [&](const size_t begin, const size_t end) -> void
+			{
+				bool ok;
+				if (!pipelineCache && m_pipelineCache)
+					ok = m_pipelineCache->createPipelines<PipelineType>(params.subspan(begin,end-begin),output+begin);
+				else if constexpr (std::is_same_v<PipelineType,IGPUComputePipeline>)
+					ok = m_device->createComputePipelines(pipelineCache,params.subspan(begin,end-begin),output+begin);
+				else
+					ok = m_device->createGraphicsPipelines(pipelineCache,params.subspan(begin,end-begin),output+begin);
+				if (!ok)
+					success.store(false,std::memory_order_relaxed);
+			};
+			if (scheduler)
+				scheduler->parallel_for(0u,params.size(),0u,createRange);
+			else
+				createRange(0u,params.size());
+			return success.load(std::memory_order_relaxed);
+		}
+
+	protected:
+		inline CGPUObjectCreationCache(core::smart_refctd_ptr<ILogicalDevice>&& device, core::smart_refctd_ptr<CPersistentPipelineCache>&& pipelineCache) :
+			m_device(std::move(device)), m_pipelineCache(std::move(pipelineCache)) {}
+		inline ~CGPUObjectCreationCache() = default;
+
+		struct SKey
+		{
+			inline bool operator==(const SKey& other) const = default;
+
+			SContentHash contentHash;
+			asset::IAsset::E_TYPE type;
+		};
+		struct SKeyHash
+		{
+			// the content hash is already well mixed
+			inline size_t operator()(const SKey& key) const {return key.contentHash.value[0]^key.type;}
+		};
+
+		core::smart_refctd_ptr<ILogicalDevice> m_device;
+		core::smart_refctd_ptr<CPersistentPipelineCache> m_pipelineCache;
+		mutable std::mutex m_mutex;
+		core::unordered_map<SKey,core::smart_refctd_ptr<core::IReferenceCounted>,SKeyHash> m_cache;
+};
+
+}
+
+#endif
@@ -0,0 +1,144 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_VIDEO_C_PERSISTENT_PIPELINE_CACHE_H_INCLUDED_
+#define _NBL_VIDEO_C_PERSISTENT_PIPELINE_CACHE_H_INCLUDED_
+
+
+#include "nbl/system/ISystem.h"
+
+#include "nbl/video/ILogicalDevice.h"
+
+#include <chrono>
+#include <mutex>
+
+
+namespace nbl::video
+{
+
+//! Keeps an `IGPUPipelineCache` on disk between runs, so only the first launch on a given device and driver pays for the driver's pipeline compilation.
+/**
+	The file gets loaded when the object is created, and written back by `save()`, by `poll()` once the save interval has passed, and on destruction,
+	but only if something new got compiled into the cache in the meantime. Writes go to a temporary file which then gets renamed over the old one,
+	so a crash mid-write never leaves a truncated cache behind.
+	A file made for a different device, driver or Nabla version, or one which got corrupted, is ignored and overwritten on the next save.
+*/
+class NBL_API2 CPersistentPipelineCache final : public core::IReferenceCounted
+{
+	public:
+		struct SCreationParams
+		{
+			core::smart_refctd_ptr<ILogicalDevice> device;
+			core::smart_refctd_ptr<system::ISystem> system;
+			system::path filePath;
+			// how often `poll()` writes the cache back to disk
+			std::chrono::steady_clock::duration saveInterval = std::chrono::minutes(1);
+			system::logger_opt_smart_ptr logger = nullptr;
+		};
+		static core::smart_refctd_ptr<CPersistentPipelineCache> create(SCreationParams&& params);
+
+		//
+		struct SStatistics
+		{
+			// bytes of usable pipeline cache data found on disk at creation
+			size_t loadedBytes = 0ull;
+			// pipelines created through this object
+			uint64_t createdPipelines = 0ull;
+			// pipelines created by calls which didn't add anything to the cache, i.e. the driver found all of them already compiled
+			uint64_t cacheHits = 0ull;
+			// wallclock time spent in those calls
+			std::chrono::nanoseconds creationTime = {};
+			uint32_t saveCount = 0u;
+		};
+		inline SStatistics getStatistics() const
+		{
+			std::lock_guard lock(m_statsMutex);
+			return m_stats;
+		}
+
+		//
+		inline IGPUPipelineCache* getPipelineCache() const {return m_cache.get();}
+
+		//! Pulls in the pipelines other caches (for example from worker threads which used their own) compiled
+		inline bool merge(const std::span<const IGPUPipelineCache* const> srcCaches)
+		{
+			if (!m_cache->merge(srcCaches))
+				return false;
+			m_dirty.store(true);
+			return true;
+		}
+
+		//! Same as the `ILogicalDevice` methods, but goes through the persistent cache and keeps the statistics.
+		/** The hits are counted per call, creating the pipelines in big batches or from many threads at once makes the count less precise. */
+		template<class PipelineType>
+		inline bool createPipelines(const std::span<const typename PipelineType::SCreationParams> params, core::smart_refctd_ptr<PipelineType>* const output)
+		{
+			const size_t sizeBefore = m_cache->getDataSize();
+			const auto start = std::chrono::steady_clock::now();
+			bool retval;
+			if constexpr (std::is_same_v<PipelineType,IGPUComputePipeline>)
+				retval = m_device->createComputePipelines(m_cache.get(),params,output);
+			else
+				retval = m_device->createGraphicsPipelines(m_cache.get(),params,output);
+			const auto elapsed = std::chrono::steady_clock::now()-start;
+			const bool grew = m_cache->getDataSize()!=sizeBefore;
+			if (grew)
+				m_dirty.store(true);
+
+			std::lock_guard lock(m_statsMutex);
+			m_stats.createdPipelines += params.size();
+			if (!grew)
+				m_stats.cacheHits += params.size();
+			m_stats.creationTime += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+			return retval;
+		}
+
+		//! Writes the cache out if anything new got compiled into it since the last save, returns false only if writing failed
+		bool save();
+		//! Call every now and then (once a frame is fine), saves when the `saveInterval` has passed since the last save
+		inline bool poll()
+		{
+			{
+				std::lock_guard lock(m_saveMutex);
+				if (std::chrono::steady_clock::now()-m_lastSave<m_saveInterval)
+					return true;
+			}
+			return save();
+		}
+
+	protected:
+		CPersistentPipelineCache(SCreationParams&& params, core::smart_refctd_ptr<IGPUPipelineCache>&& cache, const size_t loadedBytes);
+		~CPersistentPipelineCache();
+
+		// the Vulkan cache data already starts with a header the driver checks, but we'd rather not feed a corrupted or foreign file to it at all
+		struct SFileHeader
+		{
+			constexpr static inline uint32_t Magic = 0x4350424Eu; // 'NBPC'
+			constexpr static inline uint32_t Version = 1u;
+
+			uint32_t magic = Magic;
+			uint32_t version = Version;
+			uint64_t keySize = 0ull;
+			uint64_t dataSize = 0ull;
+			uint64_t dataHash[4] = {};
+		};
+		static core::vector<uint8_t> load(const SCreationParams& params, const asset::ICPUPipelineCache::SCacheKey& key);
+
+		const core::smart_refctd_ptr<ILogicalDevice> m_device;
+		const core::smart_refctd_ptr<system::ISystem> m_system;
+		const system::path m_filePath;
+		const std::chrono::steady_clock::duration m_saveInterval;
+		const system::logger_opt_smart_ptr m_logger;
+		const core::smart_refctd_ptr<IGPUPipelineCache> m_cache;
+
+		std::mutex m_saveMutex;
+		std::chrono::steady_clock::time_point m_lastSave;
+		std::atomic_bool m_dirty = false;
+
+		mutable std::mutex m_statsMutex;
+		SStatistics m_stats;
+};
+
+}
+
+#endif
@@ -7,6 +7,9 @@
 
 #include "nbl/video/SPhysicalDeviceLimits.h"
 #include "nbl/video/utilities/IDrawIndirectAllocator.h"
+#include "nbl/video/utilities/ICommandPoolCache.h"
+
+#include "nbl/system/CTaskScheduler.h"
 
 #include <functional>
 
@@ -186,26 +189,173 @@ class CSubpassKiln
         void bake(IGPUCommandBuffer* cmdbuf, const IGPURenderpass* renderpass, const uint32_t subpassIndex, const IGPUBuffer* drawIndirectBuffer, const IGPUBuffer* drawCountBuffer)
         {
             assert(cmdbuf&&renderpass&&subpassIndex<renderpass->getSubpassCount() && drawIndirectBuffer);
-            if (m_needsSorting!=draw_call_order_t::typeID)
-            {
-                std::sort(m_drawCallMetadataStorage.begin(),m_drawCallMetadataStorage.end(), typename draw_call_order_t::less());
-                m_needsSorting = draw_call_order_t::typeID;
-            }
-
-            const SearchObject searchObj = {renderpass,subpassIndex};
-            const auto begin = std::lower_bound(m_drawCallMetadataStorage.begin(),m_drawCallMetadataStorage.end(),searchObj, typename draw_call_order_t::renderpass_subpass_comp());
-            const auto end = std::upper_bound(m_drawCallMetadataStorage.begin(),m_drawCallMetadataStorage.end(),searchObj, typename draw_call_order_t::renderpass_subpass_comp());
+            const auto [begin,end] = getSubpassDrawcalls<draw_call_order_t>(renderpass,subpassIndex);
             if (begin==end)
                 return;
 
             bake_impl(cmdbuf->getOriginDevice()->getPhysicalDevice()->getLimits().indirectDrawCount, drawIndirectBuffer, drawCountBuffer)(cmdbuf, begin, end);
         }
 
+        // Rough relative CPU cost of recording a drawcall, given the one recorded before it in the same command buffer (`prev==nullptr` for the first)
+        struct DefaultCostEstimate
+        {
+            inline uint32_t operator()(const DrawcallInfo* prev, const DrawcallInfo& current) const
+            {
+                if (!prev || prev->pipeline!=current.pipeline)
+                    return 16u;
+                uint32_t cost = 1u;
+                if (!std::equal(current.descriptorSets,current.descriptorSets+IGPUPipelineLayout::DESCRIPTOR_SET_COUNT,prev->descriptorSets))
+                    cost += 4u;
+                if (!std::equal(current.vertexBufferBindings,current.vertexBufferBindings+asset::SVertexInputParams::MAX_ATTR_BUF_BINDING_COUNT,prev->vertexBufferBindings,[](const auto& lhs, const auto& rhs)->bool{return lhs.buffer==rhs.buffer&&lhs.offset==rhs.offset;}))
+                    cost += 2u;
+                if (current.indexBufferBinding!=prev->indexBufferBinding || current.indexType!=prev->indexType)
+                    cost += 1u;
+                return cost;
+            }
+        };
+        //
+        struct SParallelBakeParams
+        {
+            // must have the subpass already begun with `SUBPASS_CONTENTS::SECONDARY_COMMAND_BUFFERS`, and must track its resources since nothing else keeps the secondaries alive
+            IGPUCommandBuffer* primary;
+            // optional, forwarded to the secondaries' inheritance info
+            const IGPUFramebuffer* framebuffer = nullptr;
+            // must be for the primary's queue family, every secondary gets recorded from a pool of its own
+            ICommandPoolCache* poolCache;
+            // if nullptr all the secondaries get recorded on the calling thread
+            system::CTaskScheduler* scheduler = nullptr;
+            // required, the pools only get reset after this gets signalled, so it should be the signal of the submit of `primary`
+            ISemaphore::SWaitInfo poolReleaseWait = {};
+            // 0 means one per worker of the `scheduler` plus the calling thread
+            uint32_t maxSecondaryCount = 0u;
+            // splitting up the drawcalls further would cost more than it saves
+            uint32_t minDrawcallsPerSecondary = 64u;
+            // dynamic state doesn't get inherited by secondaries, so these get set in every one of them right after `begin`, skipped if empty
+            std::span<const asset::SViewport> viewports = {};
+            std::span<const VkRect2D> scissors = {};
+            // optional, for any other state the pipelines need (push constants, depth bias, etc.), gets called concurrently with a different secondary each time
+            std::function<bool(IGPUCommandBuffer*)> prologue = {};
+        };
+        // Same as `bake` but splits the subpass' drawcalls into contiguous ranges of similar `cost_estimate_t` cost, records each into its own secondary commandbuffer
+        // concurrently and then executes them in the primary in the same order as the drawcalls, so the result is the same no matter how the work got scheduled.
+        // The `ICommandPoolCache` isn't threadsafe, so the pools are acquired and released on the calling thread only.
+        template<typename draw_call_order_t=DefaultOrder, typename cost_estimate_t=DefaultCostEstimate>
+        bool bakeParallel(const SParallelBakeParams& params, const IGPURenderpass* renderpass, const uint32_t subpassIndex, const IGPUBuffer* drawIndirectBuffer, const IGPUBuffer* drawCountBuffer, cost_estimate_t costEstimate={})
+        {
+            assert(params.primary&&params.poolCache&&renderpass&&subpassIndex<renderpass->getSubpassCount() && drawIndirectBuffer);
+            assert(params.primary->getLevel()==IGPUCommandPool::BUFFER_LEVEL::PRIMARY && params.primary->getResourceTracking()!=IGPUCommandBuffer::RESOURCE_TRACKING::NONE);
+            // without it the pools would get reset while the secondaries are still referenced by the primary
+            if (!params.poolReleaseWait.semaphore)
+                return false;
+            const auto [begin,end] = getSubpassDrawcalls<draw_call_order_t>(renderpass,subpassIndex);
+            if (begin==end)
+                return true;
+            const size_t drawcallCount = std::distance(begin,end);
+
+            uint32_t secondaryCount = params.maxSecondaryCount ? params.maxSecondaryCount:((params.scheduler ? params.scheduler->getWorkerCount():0u)+1u);
+            secondaryCount = core::min<size_t>(secondaryCount,(drawcallCount-1u)/core::max(params.minDrawcallsPerSecondary,1u)+1u);
+            // acquire whatever we can, we'll make do with fewer secondaries if the cache is running low
+            core::vector<uint32_t> poolIndices;
+            poolIndices.reserve(secondaryCount);
+            for (auto i=0u; i<secondaryCount; i++)
+            {
+                const uint32_t poolIx = params.poolCache->acquirePool();
+                if (poolIx==ICommandPoolCache::invalid_index)
+                    break;
+                poolIndices.push_back(poolIx);
+            }
+            secondaryCount = poolIndices.size();
+            if (!secondaryCount)
+                return false;
+
+            // split the prefix sum of the costs as evenly as possible
+            core::vector<call_iterator> rangeBegins(secondaryCount+1u,end);
+            {
+                core::vector<uint64_t> inclusiveCosts(drawcallCount);
+                uint64_t totalCost = 0ull;
+                const DrawcallInfo* prev = nullptr;
+                for (auto it=begin; it!=end; prev=&(*it), it++)
+                    inclusiveCosts[std::distance(begin,it)] = totalCost += costEstimate(prev,*it);
+                rangeBegins[0] = begin;
+                for (auto i=1u; i<secondaryCount; i++)
+                {
+                    const uint64_t target = (totalCost*i)/secondaryCount;
+                    const auto found = std::upper_bound(inclusiveCosts.begin(),inclusiveCosts.end(),target)-inclusiveCosts.begin();
+                    // never hand out an empty range
+                    rangeBegins[i] = begin+core::max<ptrdiff_t>(found,std::distance(begin,rangeBegins[i-1u])+1);
+                    if (rangeBegins[i]>=end)
+                    {
+                        for (auto j=i; j<secondaryCount; j++)
+                            params.poolCache->releasePool({},poolIndices[j]);
+                        poolIndices.resize(i);
+                        secondaryCount = i;
+                        break;
+                    }
+                }
+                rangeBegins[secondaryCount] = end;
+            }
+
+            const IGPUCommandBuffer::SInheritanceInfo inheritance = {.renderpass=renderpass,.subpass=subpassIndex,.framebuffer=params.framebuffer};
+            const bool drawCountEnabled = params.primary->getOriginDevice()->getPhysicalDevice()->getLimits().indirectDrawCount;
+            core::vector<core::smart_refctd_ptr<IGPUCommandBuffer>> secondaries(secondaryCount);
+            std::atomic_bool success = true;
+            auto record = [&](const size_t first, const size_t last) -> void
+            {
+                for (auto i=first; i<last; i++)
+                {
+                    auto pool = params.poolCache->getPool(poolIndices[i]);
+                    auto& cmdbuf = secondaries[i];
+                    if (!pool->createCommandBuffers(IGPUCommandPool::BUFFER_LEVEL::SECONDARY,{&cmdbuf,1}) || !cmdbuf->begin(IGPUCommandBuffer::USAGE::ONE_TIME_SUBMIT_BIT|IGPUCommandBuffer::USAGE::RENDER_PASS_CONTINUE_BIT,&inheritance))
+                    {
+                        success.store(false,std::memory_order_relaxed);
+                        continue;
+                    }
+                    if ((!params.viewports.empty() && !cmdbuf->setViewport(params.viewports)) ||
+                        (!params.scissors.empty() && !cmdbuf->setScissor(params.scissors)) ||
+                        (params.prologue && !params.prologue(cmdbuf.get())))
+                        success.store(false,std::memory_order_relaxed);
+                    bake_impl(drawCountEnabled,drawIndirectBuffer,drawCountBuffer)(cmdbuf.get(),rangeBegins[i],rangeBegins[i+1u]);
+                    if (!cmdbuf->end())
+                        success.store(false,std::memory_order_relaxed);
+                }
+            };
+            if (params.scheduler)
+                params.scheduler->parallel_for(0u,secondaryCount,1u,record);
+            else
+                record(0u,secondaryCount);
+
+            bool retval = success.load(std::memory_order_relaxed);
+            if (retval)
+            {
+                core::vector<IGPUCommandBuffer*> executeList(secondaryCount);
+                std::transform(secondaries.begin(),secondaries.end(),executeList.begin(),[](const auto& cmdbuf)->IGPUCommandBuffer*{return cmdbuf.get();});
+                retval = params.primary->executeCommands(secondaryCount,executeList.data());
+            }
+            // even a failed `executeCommands` might have left references to the secondaries in the primary, so always wait for it
+            for (const auto poolIx : poolIndices)
+                params.poolCache->releasePool(params.poolReleaseWait,poolIx);
+            return retval;
+        }
+
     protected:
         core::vector<DrawcallInfo> m_drawCallMetadataStorage;
         uint64_t m_needsSorting = DefaultOrder::invalidTypeID;
 
         using call_iterator = typename decltype(m_drawCallMetadataStorage)::const_iterator;
+        template<typename draw_call_order_t>
+        inline std::pair<call_iterator,call_iterator> getSubpassDrawcalls(const IGPURenderpass* renderpass, const uint32_t subpassIndex)
+        {
+            if (m_needsSorting!=draw_call_order_t::typeID)
+            {
+                std::sort(m_drawCallMetadataStorage.begin(),m_drawCallMetadataStorage.end(), typename draw_call_order_t::less());
+                m_needsSorting = draw_call_order_t::typeID;
+            }
+
+            const SearchObject searchObj = {renderpass,subpassIndex};
+            const auto begin = std::lower_bound(m_drawCallMetadataStorage.cbegin(),m_drawCallMetadataStorage.cend(),searchObj, typename draw_call_order_t::renderpass_subpass_comp());
+            const auto end = std::upper_bound(m_drawCallMetadataStorage.cbegin(),m_drawCallMetadataStorage.cend(),searchObj, typename draw_call_order_t::renderpass_subpass_comp());
+            return {begin,end};
+        }
         struct bake_impl
         {
             public:
@@ -51,6 +51,14 @@
 #include "nbl/asset/interchange/CImageLoaderOpenEXR.h"
 #endif
 
+#ifdef _NBL_COMPILE_WITH_DDS_LOADER_
+#include "nbl/asset/interchange/CImageLoaderDDS.h"
+#endif
+
+#ifdef _NBL_COMPILE_WITH_KTX2_LOADER_
+#include "nbl/asset/interchange/CImageLoaderKTX2.h"
+#endif
+
 #ifdef _NBL_COMPILE_WITH_GLI_LOADER_
 #include "nbl/asset/interchange/CGLILoader.h"
 #endif
@@ -168,6 +176,13 @@ void IAssetManager::addLoadersAndWriters()
 #ifdef _NBL_COMPILE_WITH_OPENEXR_LOADER_
 	addAssetLoader(core::make_smart_refctd_ptr<asset::CImageLoaderOpenEXR>(this));
 #endif
+// the native loaders go first, GLI picks up the DDS pixel formats they don't handle
+#ifdef _NBL_COMPILE_WITH_DDS_LOADER_
+	addAssetLoader(core::make_smart_refctd_ptr<asset::CImageLoaderDDS>());
+#endif
+#ifdef _NBL_COMPILE_WITH_KTX2_LOADER_
+	addAssetLoader(core::make_smart_refctd_ptr<asset::CImageLoaderKTX2>());
+#endif
 #ifdef  _NBL_COMPILE_WITH_GLI_LOADER_
 	addAssetLoader(core::make_smart_refctd_ptr<asset::CGLILoader>());
 #endif 
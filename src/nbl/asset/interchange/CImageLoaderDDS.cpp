@@ -0,0 +1,553 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "CImageLoaderDDS.h"
+
+#ifdef _NBL_COMPILE_WITH_DDS_LOADER_
+
+#include "nbl/system/IFile.h"
+
+namespace nbl::asset
+{
+
+namespace
+{
+constexpr uint32_t makeFourCC(const char a, const char b, const char c, const char d)
+{
+	return uint32_t(uint8_t(a))|(uint32_t(uint8_t(b))<<8u)|(uint32_t(uint8_t(c))<<16u)|(uint32_t(uint8_t(d))<<24u);
+}
+constexpr uint32_t DDSMagic = makeFourCC('D','D','S',' ');
+
+struct SDDSPixelFormat
+{
+	uint32_t size;
+	uint32_t flags;
+	uint32_t fourCC;
+	uint32_t rgbBitCount;
+	uint32_t rBitMask;
+	uint32_t gBitMask;
+	uint32_t bBitMask;
+	uint32_t aBitMask;
+};
+struct SDDSHeader
+{
+	uint32_t size;
+	uint32_t flags;
+	uint32_t height;
+	uint32_t width;
+	uint32_t pitchOrLinearSize;
+	uint32_t depth;
+	uint32_t mipMapCount;
+	uint32_t reserved1[11];
+	SDDSPixelFormat pixelFormat;
+	uint32_t caps;
+	uint32_t caps2;
+	uint32_t caps3;
+	uint32_t caps4;
+	uint32_t reserved2;
+};
+static_assert(sizeof(SDDSHeader)==124u);
+struct SDDSHeaderDX10
+{
+	uint32_t dxgiFormat;
+	uint32_t resourceDimension;
+	uint32_t miscFlag;
+	uint32_t arraySize;
+	uint32_t miscFlags2;
+};
+static_assert(sizeof(SDDSHeaderDX10)==20u);
+
+enum E_DDS_PIXEL_FORMAT_FLAGS : uint32_t
+{
+	EDPFF_ALPHAPIXELS = 0x1u,
+	EDPFF_ALPHA = 0x2u,
+	EDPFF_FOURCC = 0x4u,
+	EDPFF_RGB = 0x40u,
+	EDPFF_LUMINANCE = 0x20000u
+};
+enum E_DDS_HEADER_FLAGS : uint32_t
+{
+	EDHF_DEPTH = 0x800000u
+};
+enum E_DDS_CAPS2 : uint32_t
+{
+	EDC2_CUBEMAP = 0x200u,
+	EDC2_CUBEMAP_ALL_FACES = 0xFC00u,
+	EDC2_VOLUME = 0x200000u
+};
+enum E_DX10_RESOURCE_DIMENSION : uint32_t
+{
+	EDRD_TEXTURE1D = 2u,
+	EDRD_TEXTURE2D = 3u,
+	EDRD_TEXTURE3D = 4u
+};
+constexpr uint32_t DX10MiscTextureCube = 0x4u;
+
+//! The subset of the colour `DXGI_FORMAT`s we have an `E_FORMAT` for
+enum E_DXGI_FORMAT : uint32_t
+{
+	EDF_R32G32B32A32_FLOAT = 2u,
+	EDF_R32G32B32A32_UINT = 3u,
+	EDF_R32G32B32A32_SINT = 4u,
+	EDF_R32G32B32_FLOAT = 6u,
+	EDF_R32G32B32_UINT = 7u,
+	EDF_R32G32B32_SINT = 8u,
+	EDF_R16G16B16A16_FLOAT = 10u,
+	EDF_R16G16B16A16_UNORM = 11u,
+	EDF_R16G16B16A16_UINT = 12u,
+	EDF_R16G16B16A16_SNORM = 13u,
+	EDF_R16G16B16A16_SINT = 14u,
+	EDF_R32G32_FLOAT = 16u,
+	EDF_R32G32_UINT = 17u,
+	EDF_R32G32_SINT = 18u,
+	EDF_R10G10B10A2_UNORM = 24u,
+	EDF_R10G10B10A2_UINT = 25u,
+	EDF_R11G11B10_FLOAT = 26u,
+	EDF_R8G8B8A8_UNORM = 28u,
+	EDF_R8G8B8A8_UNORM_SRGB = 29u,
+	EDF_R8G8B8A8_UINT = 30u,
+	EDF_R8G8B8A8_SNORM = 31u,
+	EDF_R8G8B8A8_SINT = 32u,
+	EDF_R16G16_FLOAT = 34u,
+	EDF_R16G16_UNORM = 35u,
+	EDF_R16G16_UINT = 36u,
+	EDF_R16G16_SNORM = 37u,
+	EDF_R16G16_SINT = 38u,
+	EDF_R32_FLOAT = 41u,
+	EDF_R32_UINT = 42u,
+	EDF_R32_SINT = 43u,
+	EDF_R8G8_UNORM = 49u,
+	EDF_R8G8_UINT = 50u,
+	EDF_R8G8_SNORM = 51u,
+	EDF_R8G8_SINT = 52u,
+	EDF_R16_FLOAT = 54u,
+	EDF_R16_UNORM = 56u,
+	EDF_R16_UINT = 57u,
+	EDF_R16_SNORM = 58u,
+	EDF_R16_SINT = 59u,
+	EDF_R8_UNORM = 61u,
+	EDF_R8_UINT = 62u,
+	EDF_R8_SNORM = 63u,
+	EDF_R8_SINT = 64u,
+	EDF_R9G9B9E5_SHAREDEXP = 67u,
+	EDF_BC1_UNORM = 71u,
+	EDF_BC1_UNORM_SRGB = 72u,
+	EDF_BC2_UNORM = 74u,
+	EDF_BC2_UNORM_SRGB = 75u,
+	EDF_BC3_UNORM = 77u,
+	EDF_BC3_UNORM_SRGB = 78u,
+	EDF_BC4_UNORM = 80u,
+	EDF_BC4_SNORM = 81u,
+	EDF_BC5_UNORM = 83u,
+	EDF_BC5_SNORM = 84u,
+	EDF_B5G6R5_UNORM = 85u,
+	EDF_B5G5R5A1_UNORM = 86u,
+	EDF_B8G8R8A8_UNORM = 87u,
+	EDF_B8G8R8X8_UNORM = 88u,
+	EDF_B8G8R8A8_UNORM_SRGB = 91u,
+	EDF_B8G8R8X8_UNORM_SRGB = 93u,
+	EDF_BC6H_UF16 = 95u,
+	EDF_BC6H_SF16 = 96u,
+	EDF_BC7_UNORM = 98u,
+	EDF_BC7_UNORM_SRGB = 99u
+};
+
+struct STranslatedFormat
+{
+	E_FORMAT format = EF_UNKNOWN;
+	ICPUImageView::SComponentMapping components = {};
+};
+
+STranslatedFormat translateDXGIFormat(const uint32_t dxgiFormat)
+{
+	STranslatedFormat retval;
+	switch (dxgiFormat)
+	{
+		case EDF_R32G32B32A32_FLOAT: retval.format = EF_R32G32B32A32_SFLOAT; break;
+		case EDF_R32G32B32A32_UINT: retval.format = EF_R32G32B32A32_UINT; break;
+		case EDF_R32G32B32A32_SINT: retval.format = EF_R32G32B32A32_SINT; break;
+		case EDF_R32G32B32_FLOAT: retval.format = EF_R32G32B32_SFLOAT; break;
+		case EDF_R32G32B32_UINT: retval.format = EF_R32G32B32_UINT; break;
+		case EDF_R32G32B32_SINT: retval.format = EF_R32G32B32_SINT; break;
+		case EDF_R16G16B16A16_FLOAT: retval.format = EF_R16G16B16A16_SFLOAT; break;
+		case EDF_R16G16B16A16_UNORM: retval.format = EF_R16G16B16A16_UNORM; break;
+		case EDF_R16G16B16A16_UINT: retval.format = EF_R16G16B16A16_UINT; break;
+		case EDF_R16G16B16A16_SNORM: retval.format = EF_R16G16B16A16_SNORM; break;
+		case EDF_R16G16B16A16_SINT: retval.format = EF_R16G16B16A16_SINT; break;
+		case EDF_R32G32_FLOAT: retval.format = EF_R32G32_SFLOAT; break;
+		case EDF_R32G32_UINT: retval.format = EF_R32G32_UINT; break;
+		case EDF_R32G32_SINT: retval.format = EF_R32G32_SINT; break;
+		// DXGI lists channels from the least significant bits, Vulkan's packed formats from the most significant ones
+		case EDF_R10G10B10A2_UNORM: retval.format = EF_A2B10G10R10_UNORM_PACK32; break;
+		case EDF_R10G10B10A2_UINT: retval.format = EF_A2B10G10R10_UINT_PACK32; break;
+		case EDF_R11G11B10_FLOAT: retval.format = EF_B10G11R11_UFLOAT_PACK32; break;
+		case EDF_R8G8B8A8_UNORM: retval.format = EF_R8G8B8A8_UNORM; break;
+		case EDF_R8G8B8A8_UNORM_SRGB: retval.format = EF_R8G8B8A8_SRGB; break;
+		case EDF_R8G8B8A8_UINT: retval.format = EF_R8G8B8A8_UINT; break;
+		case EDF_R8G8B8A8_SNORM: retval.format = EF_R8G8B8A8_SNORM; break;
+		case EDF_R8G8B8A8_SINT: retval.format = EF_R8G8B8A8_SINT; break;
+		case EDF_R16G16_FLOAT: retval.format = EF_R16G16_SFLOAT; break;
+		case EDF_R16G16_UNORM: retval.format = EF_R16G16_UNORM; break;
+		case EDF_R16G16_UINT: retval.format = EF_R16G16_UINT; break;
+		case EDF_R16G16_SNORM: retval.format = EF_R16G16_SNORM; break;
+		case EDF_R16G16_SINT: retval.format = EF_R16G16_SINT; break;
+		case EDF_R32_FLOAT: retval.format = EF_R32_SFLOAT; break;
+		case EDF_R32_UINT: retval.format = EF_R32_UINT; break;
+		case EDF_R32_SINT: retval.format = EF_R32_SINT; break;
+		case EDF_R8G8_UNORM: retval.format = EF_R8G8_UNORM; break;
+		case EDF_R8G8_UINT: retval.format = EF_R8G8_UINT; break;
+		case EDF_R8G8_SNORM: retval.format = EF_R8G8_SNORM; break;
+		case EDF_R8G8_SINT: retval.format = EF_R8G8_SINT; break;
+		case EDF_R16_FLOAT: retval.format = EF_R16_SFLOAT; break;
+		case EDF_R16_UNORM: retval.format = EF_R16_UNORM; break;
+		case EDF_R16_UINT: retval.format = EF_R16_UINT; break;
+		case EDF_R16_SNORM: retval.format = EF_R16_SNORM; break;
+		case EDF_R16_SINT: retval.format = EF_R16_SINT; break;
+		case EDF_R8_UNORM: retval.format = EF_R8_UNORM; break;
+		case EDF_R8_UINT: retval.format = EF_R8_UINT; break;
+		case EDF_R8_SNORM: retval.format = EF_R8_SNORM; break;
+		case EDF_R8_SINT: retval.format = EF_R8_SINT; break;
+		case EDF_R9G9B9E5_SHAREDEXP: retval.format = EF_E5B9G9R9_UFLOAT_PACK32; break;
+		case EDF_BC1_UNORM: retval.format = EF_BC1_RGBA_UNORM_BLOCK; break;
+		case EDF_BC1_UNORM_SRGB: retval.format = EF_BC1_RGBA_SRGB_BLOCK; break;
+		case EDF_BC2_UNORM: retval.format = EF_BC2_UNORM_BLOCK; break;
+		case EDF_BC2_UNORM_SRGB: retval.format = EF_BC2_SRGB_BLOCK; break;
+		case EDF_BC3_UNORM: retval.format = EF_BC3_UNORM_BLOCK; break;
+		case EDF_BC3_UNORM_SRGB: retval.format = EF_BC3_SRGB_BLOCK; break;
+		case EDF_BC4_UNORM: retval.format = EF_BC4_UNORM_BLOCK; break;
+		case EDF_BC4_SNORM: retval.format = EF_BC4_SNORM_BLOCK; break;
+		case EDF_BC5_UNORM: retval.format = EF_BC5_UNORM_BLOCK; break;
+		case EDF_BC5_SNORM: retval.format = EF_BC5_SNORM_BLOCK; break;
+		case EDF_B5G6R5_UNORM: retval.format = EF_R5G6B5_UNORM_PACK16; break;
+		case EDF_B5G5R5A1_UNORM: retval.format = EF_A1R5G5B5_UNORM_PACK16; break;
+		case EDF_B8G8R8A8_UNORM: retval.format = EF_B8G8R8A8_UNORM; break;
+		case EDF_B8G8R8A8_UNORM_SRGB: retval.format = EF_B8G8R8A8_SRGB; break;
+		case EDF_B8G8R8X8_UNORM:
+			retval.format = EF_B8G8R8A8_UNORM;
+			retval.components.a = ICPUImageView::SComponentMapping::ES_ONE;
+			break;
+		case EDF_B8G8R8X8_UNORM_SRGB:
+			retval.format = EF_B8G8R8A8_SRGB;
+			retval.components.a = ICPUImageView::SComponentMapping::ES_ONE;
+			break;
+		case EDF_BC6H_UF16: retval.format = EF_BC6H_UFLOAT_BLOCK; break;
+		case EDF_BC6H_SF16: retval.format = EF_BC6H_SFLOAT_BLOCK; break;
+		case EDF_BC7_UNORM: retval.format = EF_BC7_UNORM_BLOCK; break;
+		case EDF_BC7_UNORM_SRGB: retval.format = EF_BC7_SRGB_BLOCK; break;
+		default: break;
+	}
+	return retval;
+}
+
+STranslatedFormat translateLegacyFormat(const SDDSPixelFormat& pixelFormat)
+{
+	using swizzle_t = ICPUImageView::SComponentMapping;
+
+	STranslatedFormat retval;
+	if (pixelFormat.flags&EDPFF_FOURCC)
+	{
+		switch (pixelFormat.fourCC)
+		{
+			case makeFourCC('D','X','T','1'):
+				retval.format = (pixelFormat.flags&EDPFF_ALPHAPIXELS) ? EF_BC1_RGBA_UNORM_BLOCK:EF_BC1_RGB_UNORM_BLOCK;
+				break;
+			// DXT2 and DXT4 only differ by having the alpha premultiplied
+			case makeFourCC('D','X','T','2'): [[fallthrough]];
+			case makeFourCC('D','X','T','3'):
+				retval.format = EF_BC2_UNORM_BLOCK;
+				break;
+			case makeFourCC('D','X','T','4'): [[fallthrough]];
+			case makeFourCC('D','X','T','5'):
+				retval.format = EF_BC3_UNORM_BLOCK;
+				break;
+			case makeFourCC('A','T','I','1'): [[fallthrough]];
+			case makeFourCC('B','C','4','U'):
+				retval.format = EF_BC4_UNORM_BLOCK;
+				break;
+			case makeFourCC('B','C','4','S'):
+				retval.format = EF_BC4_SNORM_BLOCK;
+				break;
+			case makeFourCC('A','T','I','2'): [[fallthrough]];
+			case makeFourCC('B','C','5','U'):
+				retval.format = EF_BC5_UNORM_BLOCK;
+				break;
+			case makeFourCC('B','C','5','S'):
+				retval.format = EF_BC5_SNORM_BLOCK;
+				break;
+			// D3DFORMAT values stored in place of a FourCC
+			case 36u: retval.format = EF_R16G16B16A16_UNORM; break;
+			case 110u: retval.format = EF_R16G16B16A16_SNORM; break;
+			case 111u: retval.format = EF_R16_SFLOAT; break;
+			case 112u: retval.format = EF_R16G16_SFLOAT; break;
+			case 113u: retval.format = EF_R16G16B16A16_SFLOAT; break;
+			case 114u: retval.format = EF_R32_SFLOAT; break;
+			case 115u: retval.format = EF_R32G32_SFLOAT; break;
+			case 116u: retval.format = EF_R32G32B32A32_SFLOAT; break;
+			default: break;
+		}
+		return retval;
+	}
+
+	const auto& pf = pixelFormat;
+	const uint32_t alphaMask = (pf.flags&(EDPFF_ALPHAPIXELS|EDPFF_ALPHA)) ? pf.aBitMask:0u;
+	auto masksAre = [&pf,alphaMask](const uint32_t r, const uint32_t g, const uint32_t b, const uint32_t a) -> bool
+	{
+		return pf.rBitMask==r && pf.gBitMask==g && pf.bBitMask==b && alphaMask==a;
+	};
+	// formats without the alpha channel get read as ones through the view
+	auto noAlpha = [&retval](const E_FORMAT format) -> void
+	{
+		retval.format = format;
+		retval.components.a = swizzle_t::ES_ONE;
+	};
+	if (pf.flags&EDPFF_RGB)
+	switch (pf.rgbBitCount)
+	{
+		case 32u:
+			if (masksAre(0xffu,0xff00u,0xff0000u,0xff000000u))
+				retval.format = EF_R8G8B8A8_UNORM;
+			else if (masksAre(0xffu,0xff00u,0xff0000u,0u))
+				noAlpha(EF_R8G8B8A8_UNORM);
+			else if (masksAre(0xff0000u,0xff00u,0xffu,0xff000000u))
+				retval.format = EF_B8G8R8A8_UNORM;
+			else if (masksAre(0xff0000u,0xff00u,0xffu,0u))
+				noAlpha(EF_B8G8R8A8_UNORM);
+			else if (masksAre(0x3ffu,0xffc00u,0x3ff00000u,0xc0000000u))
+				retval.format = EF_A2B10G10R10_UNORM_PACK32;
+			else if (masksAre(0x3ff00000u,0xffc00u,0x3ffu,0xc0000000u))
+				retval.format = EF_A2R10G10B10_UNORM_PACK32;
+			else if (masksAre(0xffffu,0xffff0000u,0u,0u))
+				retval.format = EF_R16G16_UNORM;
+			break;
+		case 24u:
+			if (masksAre(0xff0000u,0xff00u,0xffu,0u))
+				noAlpha(EF_B8G8R8_UNORM);
+			else if (masksAre(0xffu,0xff00u,0xff0000u,0u))
+				noAlpha(EF_R8G8B8_UNORM);
+			break;
+		case 16u:
+			if (masksAre(0xf800u,0x7e0u,0x1fu,0u))
+				noAlpha(EF_R5G6B5_UNORM_PACK16);
+			else if (masksAre(0x7c00u,0x3e0u,0x1fu,0x8000u))
+				retval.format = EF_A1R5G5B5_UNORM_PACK16;
+			else if (masksAre(0x7c00u,0x3e0u,0x1fu,0u))
+				noAlpha(EF_A1R5G5B5_UNORM_PACK16);
+			break;
+		default:
+			break;
+	}
+	else if (pf.flags&EDPFF_LUMINANCE)
+	{
+		const swizzle_t luminance = {swizzle_t::ES_R,swizzle_t::ES_R,swizzle_t::ES_R,swizzle_t::ES_ONE};
+		if (pf.rgbBitCount==8u && masksAre(0xffu,0u,0u,0u))
+			retval = {EF_R8_UNORM,luminance};
+		else if (pf.rgbBitCount==16u && masksAre(0xffffu,0u,0u,0u))
+			retval = {EF_R16_UNORM,luminance};
+		else if (pf.rgbBitCount==16u && masksAre(0xffu,0u,0u,0xff00u))
+			retval = {EF_R8G8_UNORM,{swizzle_t::ES_R,swizzle_t::ES_R,swizzle_t::ES_R,swizzle_t::ES_G}};
+	}
+	else if ((pf.flags&EDPFF_ALPHA) && pf.rgbBitCount==8u && alphaMask==0xffu)
+		retval = {EF_R8_UNORM,{swizzle_t::ES_ZERO,swizzle_t::ES_ZERO,swizzle_t::ES_ZERO,swizzle_t::ES_R}};
+	return retval;
+}
+}
+
+bool CImageLoaderDDS::isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const
+{
+	uint32_t magic = 0u;
+	system::IFile::success_t success;
+	_file->read(success, &magic, 0, sizeof(magic));
+	return success && magic==DDSMagic;
+}
+
+asset::SAssetBundle CImageLoaderDDS::loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
+{
+	if (!_file)
+		return {};
+	const auto fileName = _file->getFileName().string();
+
+	SDDSHeader header;
+	{
+		system::IFile::success_t success;
+		_file->read(success, &header, sizeof(DDSMagic), sizeof(header));
+		if (!success || header.size!=sizeof(header) || header.pixelFormat.size!=sizeof(SDDSPixelFormat))
+		{
+			_params.logger.log("LOAD DDS: corrupt header in %s", system::ILogger::ELL_ERROR, fileName.c_str());
+			return {};
+		}
+	}
+	size_t dataOffset = sizeof(DDSMagic)+sizeof(header);
+
+	ICPUImage::SCreationParams imageInfo = {};
+	imageInfo.samples = ICPUImage::ESCF_1_BIT;
+	imageInfo.extent = {header.width,core::max(header.height,1u),1u};
+	imageInfo.mipLevels = core::max(header.mipMapCount,1u);
+	imageInfo.arrayLayers = 1u;
+	imageInfo.usage = IImage::EUF_SAMPLED_BIT;
+	STranslatedFormat format;
+	bool isItACubemap = false;
+	bool isItAnArray = false;
+	if (header.pixelFormat.flags&EDPFF_FOURCC && header.pixelFormat.fourCC==makeFourCC('D','X','1','0'))
+	{
+		SDDSHeaderDX10 headerDX10;
+		{
+			system::IFile::success_t success;
+			_file->read(success, &headerDX10, dataOffset, sizeof(headerDX10));
+			if (!success)
+				return {};
+		}
+		dataOffset += sizeof(headerDX10);
+
+		format = translateDXGIFormat(headerDX10.dxgiFormat);
+		isItACubemap = headerDX10.miscFlag&DX10MiscTextureCube;
+		isItAnArray = headerDX10.arraySize>1u;
+		// 6 faces per cube must not wrap the layer count around
+		if (headerDX10.arraySize>std::numeric_limits<uint32_t>::max()/6u)
+		{
+			_params.logger.log("LOAD DDS: corrupt header in %s", system::ILogger::ELL_ERROR, fileName.c_str());
+			return {};
+		}
+		imageInfo.arrayLayers = core::max(headerDX10.arraySize,1u)*(isItACubemap ? 6u:1u);
+		switch (headerDX10.resourceDimension)
+		{
+			case EDRD_TEXTURE1D:
+				imageInfo.type = IImage::ET_1D;
+				break;
+			case EDRD_TEXTURE2D:
+				imageInfo.type = IImage::ET_2D;
+				break;
+			case EDRD_TEXTURE3D:
+				imageInfo.type = IImage::ET_3D;
+				imageInfo.extent.depth = core::max(header.depth,1u);
+				break;
+			default:
+				return {};
+		}
+	}
+	else
+	{
+		format = translateLegacyFormat(header.pixelFormat);
+		if (header.caps2&EDC2_CUBEMAP)
+		{
+			// cubemaps with some of the faces missing have no equivalent
+			if ((header.caps2&EDC2_CUBEMAP_ALL_FACES)!=EDC2_CUBEMAP_ALL_FACES)
+				return {};
+			isItACubemap = true;
+			imageInfo.arrayLayers = 6u;
+		}
+		const bool isItAVolume = (header.caps2&EDC2_VOLUME) && (header.flags&EDHF_DEPTH) && header.depth>1u;
+		imageInfo.type = isItAVolume ? IImage::ET_3D:IImage::ET_2D;
+		if (isItAVolume)
+			imageInfo.extent.depth = header.depth;
+	}
+	// not an error, GLI might know the format
+	if (format.format==EF_UNKNOWN)
+	{
+		_params.logger.log("LOAD DDS: %s has a pixel format the native loader doesn't handle", system::ILogger::ELL_DEBUG, fileName.c_str());
+		return {};
+	}
+	imageInfo.format = format.format;
+	if (isItACubemap)
+	{
+		if (imageInfo.type!=IImage::ET_2D || imageInfo.extent.width!=imageInfo.extent.height)
+			return {};
+		imageInfo.flags = ICPUImage::ECF_CUBE_COMPATIBLE_BIT;
+	}
+	if (imageInfo.extent.width==0u || imageInfo.mipLevels>1u+hlsl::findMSB(core::max(core::max(imageInfo.extent.width,imageInfo.extent.height),imageInfo.extent.depth)))
+		return {};
+
+	// every array layer (cube face) stores its whole mip chain before the next one starts
+	// the sizes are checked for wrapping around, so that a forged header can't pass the truncation check below with a tiny `dataSize`
+	core::vector<size_t> levelOffsets(imageInfo.mipLevels+1u,0ull);
+	bool sizeOverflow = false;
+	for (uint32_t level=0u; level<imageInfo.mipLevels && !sizeOverflow; level++)
+	{
+		const auto width = core::max(imageInfo.extent.width>>level,1u);
+		const auto height = core::max(imageInfo.extent.height>>level,1u);
+		const auto depth = core::max(imageInfo.extent.depth>>level,1u);
+		const size_t levelSize = getLevelByteSize(imageInfo.format,width,height,depth,1u);
+		levelOffsets[level+1u] = levelOffsets[level];
+		sizeOverflow = !levelSize || !checkedAdd(levelOffsets[level+1u],levelSize);
+	}
+	const size_t layerSize = levelOffsets.back();
+	size_t dataSize = layerSize;
+	sizeOverflow = sizeOverflow || !checkedMul(dataSize,imageInfo.arrayLayers);
+	if (sizeOverflow)
+	{
+		_params.logger.log("LOAD DDS: %s declares an image too big to address", system::ILogger::ELL_ERROR, fileName.c_str());
+		return {};
+	}
+	if (dataSize>_file->getSize() || dataOffset>_file->getSize()-dataSize)
+	{
+		_params.logger.log("LOAD DDS: %s is truncated", system::ILogger::ELL_ERROR, fileName.c_str());
+		return {};
+	}
+
+	// the buffer starts at the first texel so every region offset is a multiple of the block size, no matter how long the headers were
+	auto texelBuffer = createBufferOverFileMapping(_params,_file,dataOffset,dataSize);
+	if (!texelBuffer)
+	{
+		texelBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(dataSize);
+		system::IFile::success_t success;
+		_file->read(success, texelBuffer->getPointer(), dataOffset, dataSize);
+		if (!success)
+			return {};
+	}
+
+	auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(imageInfo.arrayLayers*imageInfo.mipLevels);
+	{
+		auto region = regions->begin();
+		for (uint32_t layer=0u; layer<imageInfo.arrayLayers; layer++)
+		for (uint32_t level=0u; level<imageInfo.mipLevels; level++,region++)
+		{
+			region->bufferOffset = layer*layerSize+levelOffsets[level];
+			region->bufferRowLength = 0u;
+			region->bufferImageHeight = 0u;
+			region->imageSubresource.aspectMask = IImage::EAF_COLOR_BIT;
+			region->imageSubresource.mipLevel = level;
+			region->imageSubresource.baseArrayLayer = layer;
+			region->imageSubresource.layerCount = 1u;
+			region->imageOffset = {0u,0u,0u};
+			region->imageExtent = {core::max(imageInfo.extent.width>>level,1u),core::max(imageInfo.extent.height>>level,1u),core::max(imageInfo.extent.depth>>level,1u)};
+		}
+	}
+
+	auto image = ICPUImage::create(std::move(imageInfo));
+	if (!image)
+		return {};
+	image->setBufferAndRegions(std::move(texelBuffer),regions);
+
+	ICPUImageView::SCreationParams imageViewInfo = {};
+	const auto& params = image->getCreationParameters();
+	switch (params.type)
+	{
+		case IImage::ET_1D:
+			imageViewInfo.viewType = isItAnArray ? ICPUImageView::ET_1D_ARRAY:ICPUImageView::ET_1D;
+			break;
+		case IImage::ET_3D:
+			imageViewInfo.viewType = ICPUImageView::ET_3D;
+			break;
+		default:
+			if (isItACubemap)
+				imageViewInfo.viewType = isItAnArray ? ICPUImageView::ET_CUBE_MAP_ARRAY:ICPUImageView::ET_CUBE_MAP;
+			else
+				imageViewInfo.viewType = isItAnArray ? ICPUImageView::ET_2D_ARRAY:ICPUImageView::ET_2D;
+			break;
+	}
+	imageViewInfo.format = params.format;
+	imageViewInfo.components = format.components;
+	imageViewInfo.flags = static_cast<ICPUImageView::E_CREATE_FLAGS>(0u);
+	imageViewInfo.subresourceRange.aspectMask = IImage::EAF_COLOR_BIT;
+	imageViewInfo.subresourceRange.baseArrayLayer = 0u;
+	imageViewInfo.subresourceRange.baseMipLevel = 0u;
+	imageViewInfo.subresourceRange.layerCount = params.arrayLayers;
+	imageViewInfo.subresourceRange.levelCount = params.mipLevels;
+	imageViewInfo.image = std::move(image);
+
+	return SAssetBundle(nullptr,{ICPUImageView::create(std::move(imageViewInfo))});
+}
+
+}
+
+#endif // _NBL_COMPILE_WITH_DDS_LOADER_
@@ -0,0 +1,43 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_ASSET_C_IMAGE_LOADER_DDS_H_INCLUDED__
+#define __NBL_ASSET_C_IMAGE_LOADER_DDS_H_INCLUDED__
+
+#include "BuildConfigOptions.h"
+
+#ifdef _NBL_COMPILE_WITH_DDS_LOADER_
+
+#include "nbl/asset/interchange/IImageLoader.h"
+
+namespace nbl::asset
+{
+
+//! Native DirectDraw Surface loader, the regions of the image it returns point straight into the file's mapping
+/**
+	Handles the DX10 extended header and the common legacy pixel formats (DXTn, ATI1/2, BC4/5 and the plain RGB(A)/luminance masks),
+	anything else yields an empty bundle so that the asset manager falls back to the GLI loader.
+*/
+class CImageLoaderDDS final : public IImageLoader
+{
+	public:
+		CImageLoaderDDS() = default;
+
+		bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const override;
+
+		const char** getAssociatedFileExtensions() const override
+		{
+			static const char* extensions[]{ "dds", nullptr };
+			return extensions;
+		}
+
+		uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_IMAGE_VIEW; }
+
+		asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
+};
+
+}
+
+#endif // _NBL_COMPILE_WITH_DDS_LOADER_
+#endif
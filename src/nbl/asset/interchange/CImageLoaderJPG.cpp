@@ -17,6 +17,8 @@
 #include "nbl/asset/interchange/IImageAssetHandlerBase.h"
 
 #include <string>
+#include <numeric>
+#include <atomic>
 
 #include <stdio.h> // required for jpeglib.h
 #ifdef _NBL_COMPILE_WITH_LIBJPEG_
@@ -144,6 +146,102 @@ namespace jpeg
 		// DO NOTHING
 	}
 
+	void setMemorySource(jpeg_decompress_struct& cinfo, jpeg_source_mgr& jsrc, const uint8_t* data, const size_t size)
+	{
+		jsrc.bytes_in_buffer = size;
+		jsrc.next_input_byte = reinterpret_cast<const JOCTET*>(data);
+		jsrc.init_source = init_source;
+		jsrc.fill_input_buffer = fill_input_buffer;
+		jsrc.skip_input_data = skip_input_data;
+		jsrc.resync_to_restart = jpeg_resync_to_restart;
+		jsrc.term_source = term_source;
+		cinfo.src = &jsrc;
+	}
+
+	//! Decompresses a whole in-memory stream, row `i` of it gets written to `rowPointers[i]`
+	/** Lives in its own function so that the `setjmp` has a frame of its own, pieces of one image decode on several threads at once. */
+	bool decompress(CImageLoaderJPG::SContext& ctx, const uint8_t* data, const size_t size, uint8_t** rowPointers, const uint32_t rowCount)
+	{
+		jpeg_decompress_struct cinfo;
+		irr_jpeg_error_mgr jerr;
+		cinfo.err = jpeg_std_error(&jerr.pub);
+		cinfo.err->error_exit = error_exit;
+		cinfo.err->output_message = output_message;
+		cinfo.client_data = &ctx;
+		if (setjmp(jerr.setjmp_buffer))
+		{
+			jpeg_destroy_decompress(&cinfo);
+			return false;
+		}
+		jpeg_create_decompress(&cinfo);
+
+		jpeg_source_mgr jsrc;
+		setMemorySource(cinfo,jsrc,data,size);
+		jpeg_read_header(&cinfo, TRUE);
+		cinfo.do_fancy_upsampling = TRUE;
+		jpeg_start_decompress(&cinfo);
+		if (cinfo.output_height!=rowCount)
+		{
+			jpeg_destroy_decompress(&cinfo);
+			return false;
+		}
+
+		// ask for all the remaining rows every time, libjpeg-turbo then hands back whole row groups converted and upsampled with SIMD
+		while (cinfo.output_scanline < cinfo.output_height)
+			jpeg_read_scanlines(&cinfo, rowPointers+cinfo.output_scanline, cinfo.output_height-cinfo.output_scanline);
+
+		jpeg_finish_decompress(&cinfo);
+		jpeg_destroy_decompress(&cinfo);
+		return true;
+	}
+
+	//! Offset of the image height in the frame header, 0 if the stream isn't baseline or extended sequential Huffman coded
+	size_t findFrameHeightOffset(const uint8_t* data, const size_t size)
+	{
+		for (size_t offset=2u; offset+4u<=size;)
+		{
+			if (data[offset]!=0xFFu)
+				return 0u;
+			const uint8_t marker = data[offset+1u];
+			if (marker==0xFFu) // fill byte
+			{
+				offset++;
+				continue;
+			}
+			if (marker==0xC0u || marker==0xC1u)
+				return offset+7u<=size ? (offset+5u):0u;
+			// any other SOFn, or a scan without a frame before it
+			if ((marker>=0xC2u && marker<=0xCFu && marker!=0xC4u && marker!=0xC8u && marker!=0xCCu) || marker==0xDAu)
+				return 0u;
+			offset += 2u+((size_t(data[offset+2u])<<8u)|data[offset+3u]);
+		}
+		return 0u;
+	}
+
+	//! Collects the offsets of the RSTn markers in the entropy coded data starting at `offset`, returns the offset of the marker ending it
+	size_t findRestartMarkers(const uint8_t* data, const size_t size, size_t offset, core::vector<size_t>& markers)
+	{
+		while (offset+1u<size)
+		{
+			const auto* found = reinterpret_cast<const uint8_t*>(memchr(data+offset,0xFF,size-1u-offset));
+			if (!found)
+				break;
+			offset = found-data;
+			const uint8_t next = data[offset+1u];
+			if (next==0xFFu) // fill byte
+			{
+				offset++;
+				continue;
+			}
+			if (next>=0xD0u && next<=0xD7u)
+				markers.push_back(offset);
+			else if (next!=0x00u) // not a stuffed byte
+				return offset;
+			offset += 2u;
+		}
+		return size;
+	}
+
 }
 #endif // _NBL_COMPILE_WITH_LIBJPEG_
 
@@ -173,16 +271,21 @@ asset::SAssetBundle CImageLoaderJPG::loadAsset(system::IFile* _file, const asset
 	if (!_file || _file->getSize()>0xffffffffull)
         return {};
 
-	const std::filesystem::path& Filename = _file->getFileName();
-
-	uint8_t* input = new uint8_t[_file->getSize()];
-
-	system::IFile::success_t success;
-	_file->read(success, input, 0, _file->getSize());
-	if (!success)
-		return {};
+	const size_t fileSize = _file->getSize();
+	// decode straight out of the mapping if the file has one, otherwise read it whole once
+	core::vector<uint8_t> fileContents;
+	const uint8_t* input = reinterpret_cast<const uint8_t*>(static_cast<const system::IFile*>(_file)->getMappedPointer());
+	if (!input)
+	{
+		fileContents.resize(fileSize);
+		system::IFile::success_t success;
+		_file->read(success, fileContents.data(), 0, fileSize);
+		if (!success)
+			return {};
+		input = fileContents.data();
+	}
 
-	// allocate and initialize JPEG decompression object
+	// allocate and initialize JPEG decompression object, this one only reads the header, `jpeg::decompress` does the decoding
 	struct jpeg_decompress_struct cinfo;
 	struct jpeg::irr_jpeg_error_mgr jerr;
 
@@ -191,7 +294,7 @@ asset::SAssetBundle CImageLoaderJPG::loadAsset(system::IFile* _file, const asset
 	//This routine fills in the contents of struct jerr, and returns jerr's
 	//address which we place into the link field in cinfo.
 	SContext ctx;
-	ctx.filename = const_cast<char*>(Filename.string().c_str());
+	ctx.filename = _file->getFileName().string();
 	ctx.logger = _params.logger;
 	cinfo.err = jpeg_std_error(&jerr.pub);
 	cinfo.err->error_exit = jpeg::error_exit;
@@ -201,7 +304,6 @@ asset::SAssetBundle CImageLoaderJPG::loadAsset(system::IFile* _file, const asset
 
 	auto exitRoutine = [&] {
 		jpeg_destroy_decompress(&cinfo);
-		delete[] input;
 	};
 	auto exiter = core::makeRAIIExiter(exitRoutine);
 	// compatibility fudge:
@@ -219,22 +321,7 @@ asset::SAssetBundle CImageLoaderJPG::loadAsset(system::IFile* _file, const asset
 
 	// specify data source
 	jpeg_source_mgr jsrc;
-
-	// Set up data pointer
-	jsrc.bytes_in_buffer = _file->getSize();
-	jsrc.next_input_byte = (JOCTET*)input;
-	cinfo.src = &jsrc;
-
-	jsrc.init_source = jpeg::init_source;
-	jsrc.fill_input_buffer = jpeg::fill_input_buffer;
-	jsrc.skip_input_data = jpeg::skip_input_data;
-	jsrc.resync_to_restart = jpeg_resync_to_restart;
-	jsrc.term_source = jpeg::term_source;
-
-	// Decodes JPG input from whatever source
-	// Does everything AFTER jpeg_create_decompress
-	// and BEFORE jpeg_destroy_decompress
-	// Caller is responsible for arranging these + setting up cinfo
+	jpeg::setMemorySource(cinfo,jsrc,input,fileSize);
 
 	// read _file parameters with jpeg_read_header()
 	jpeg_read_header(&cinfo, TRUE);
@@ -256,18 +343,12 @@ asset::SAssetBundle CImageLoaderJPG::loadAsset(system::IFile* _file, const asset
 	switch (cinfo.jpeg_color_space)
 	{
 		case JCS_GRAYSCALE:
-			cinfo.out_color_components = 1;
-			cinfo.output_gamma = 1.0; // output_gamma is a dead variable in libjpegturbo and jpeglib
             imgInfo.format = EF_R8_SRGB;
 			break;
 		case JCS_RGB:
-			cinfo.out_color_components = 3;
-			cinfo.output_gamma = 2.2333333; // output_gamma is a dead variable in libjpegturbo and jpeglib
             imgInfo.format = EF_R8G8B8_SRGB;
 			break;
 		case JCS_YCbCr:
-			cinfo.out_color_components = 3;
-			cinfo.output_gamma = 2.2333333; // output_gamma is a dead variable in libjpegturbo and jpeglib
             imgInfo.format = EF_R8G8B8_SRGB;
 			// it seems that libjpeg does Y'UV to R'G'B'conversion automagically
 			// however be prepared that the colors might be a bit "off"
@@ -286,10 +367,6 @@ asset::SAssetBundle CImageLoaderJPG::loadAsset(system::IFile* _file, const asset
 			return {};
 			break;
 	}
-	cinfo.do_fancy_upsampling = TRUE;
-	
-	// Start decompressor
-	jpeg_start_decompress(&cinfo);
 
 	auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(1u);
 	ICPUImage::SBufferCopy& region = regions->front();
@@ -302,28 +379,121 @@ asset::SAssetBundle CImageLoaderJPG::loadAsset(system::IFile* _file, const asset
 	region.bufferImageHeight = 0u; //tightly packed
 	region.imageOffset = { 0u, 0u, 0u };
 	region.imageExtent = imgInfo.extent;
-	
+
 	// Get image data
-	uint32_t rowspan = region.bufferRowLength * cinfo.out_color_components;
+	const uint32_t rowspan = region.bufferRowLength * getTexelOrBlockBytesize(imgInfo.format);
 
-	// Allocate memory for buffer
+	// Allocate memory for buffer, the rows get decoded straight into it
 	auto buffer = core::make_smart_refctd_ptr<asset::ICPUBuffer>(rowspan*height);
+	uint8_t* const outPtr = reinterpret_cast<uint8_t*>(buffer->getPointer());
+
+	/*
+		A sequential baseline JPEG with restart markers can be cut at the MCU rows where a restart interval begins, the DC predictions
+		reset there so every piece decodes on its own. Each piece becomes a small JPEG of its own: the original header with the frame
+		height patched, its entropy coded data with the RSTn renumbered from 0 and an EOI. Pieces decode `overlapMcuRows` more on both
+		sides than they keep, so that fancy upsampling sees the same neighbouring chroma rows as a decode of the whole image would.
+	*/
+	struct SSplit
+	{
+		size_t frameHeightOffset = 0u;
+		size_t entropyBegin = 0u;
+		size_t entropyEnd = 0u;
+		core::vector<size_t> restartMarkers;
+		uint32_t mcusPerRow = 0u;
+		uint32_t mcuRows = 0u;
+		uint32_t mcuHeight = 0u;
+		uint32_t restartInterval = 0u;
+		uint32_t overlapMcuRows = 0u;
+		uint32_t chunkMcuRows = 0u;
+		uint32_t chunkCount = 0u;
+	} split;
+	// not worth the header copies and overlap below this
+	constexpr uint64_t MinParallelTexelCount = 512u*512u;
+	if (_params.scheduler && uint64_t(width)*height>=MinParallelTexelCount && !cinfo.progressive_mode && !cinfo.arith_code && cinfo.restart_interval && cinfo.comps_in_scan==cinfo.num_components)
+	{
+		split.frameHeightOffset = jpeg::findFrameHeightOffset(input,fileSize);
+		split.entropyBegin = reinterpret_cast<const uint8_t*>(jsrc.next_input_byte)-input;
+		split.entropyEnd = jpeg::findRestartMarkers(input,fileSize,split.entropyBegin,split.restartMarkers);
+		// the scan's MCU layout only gets computed by `jpeg_start_decompress`, this is the same math
+		const uint32_t mcuWidth = DCTSIZE*cinfo.max_h_samp_factor/(cinfo.comps_in_scan>1 ? 1:cinfo.cur_comp_info[0]->h_samp_factor);
+		split.mcuHeight = DCTSIZE*cinfo.max_v_samp_factor/(cinfo.comps_in_scan>1 ? 1:cinfo.cur_comp_info[0]->v_samp_factor);
+		split.mcusPerRow = (width-1u)/mcuWidth+1u;
+		split.mcuRows = (height-1u)/split.mcuHeight+1u;
+		split.restartInterval = cinfo.restart_interval;
+
+		const uint64_t restartIntervalCount = (uint64_t(split.mcusPerRow)*split.mcuRows-1u)/split.restartInterval+1u;
+		if (split.frameHeightOffset && split.entropyEnd<fileSize && split.restartMarkers.size()+1u==restartIntervalCount)
+		{
+			// the pieces need to start at MCU rows which also start a restart interval
+			split.overlapMcuRows = split.restartInterval/std::gcd(split.restartInterval,split.mcusPerRow);
+			const uint32_t pieceCount = (_params.scheduler->getWorkerCount()+1u)*2u;
+			split.chunkMcuRows = core::max((split.mcuRows-1u)/pieceCount+1u,split.overlapMcuRows*4u);
+			split.chunkMcuRows = (split.chunkMcuRows-1u)/split.overlapMcuRows*split.overlapMcuRows+split.overlapMcuRows;
+			split.chunkCount = (split.mcuRows-1u)/split.chunkMcuRows+1u;
+		}
+	}
 
-	// Here we use the library's state variable cinfo.output_scanline as the
-	// loop counter, so that we don't have to keep track ourselves.
-	// Create array of row pointers for lib
-	constexpr uint32_t MaxJPEGResolution = 65535u;
-	uint8_t* rowPtr[MaxJPEGResolution];
-	for (uint32_t i = 0; i < height; ++i)
-		rowPtr[i] = &reinterpret_cast<uint8_t*>(buffer->getPointer())[i*rowspan];
-
-	// Read rows from bottom order to match OpenGL coords
-	uint32_t rowsRead = 0;
-	while (cinfo.output_scanline < cinfo.output_height)
-		rowsRead += jpeg_read_scanlines(&cinfo, &rowPtr[rowsRead], 1);
-	
-	// Finish decompression
-	jpeg_finish_decompress(&cinfo);
+	bool success = true;
+	if (split.chunkCount>1u)
+	{
+		std::atomic_bool failed = false;
+		_params.scheduler->parallel_for(0u,split.chunkCount,1u,[&](const size_t begin, const size_t end) -> void
+		{
+			core::vector<uint8_t> stream;
+			core::vector<uint8_t*> rowPointers;
+			core::vector<uint8_t> discardedRow(rowspan);
+			for (size_t chunk=begin; chunk<end; chunk++)
+			{
+				const uint32_t keepBegin = chunk*split.chunkMcuRows;
+				const uint32_t keepEnd = core::min(keepBegin+split.chunkMcuRows,split.mcuRows);
+				const uint32_t decodeBegin = keepBegin ? (keepBegin-split.overlapMcuRows):0u;
+				const uint32_t decodeEnd = core::min(keepEnd+split.overlapMcuRows,split.mcuRows);
+
+				// restart interval `i` is preceded by marker `i-1` and followed by marker `i`
+				const size_t firstInterval = size_t(decodeBegin)*split.mcusPerRow/split.restartInterval;
+				const size_t endInterval = decodeEnd<split.mcuRows ? (size_t(decodeEnd)*split.mcusPerRow/split.restartInterval):(split.restartMarkers.size()+1u);
+				const size_t dataBegin = firstInterval ? (split.restartMarkers[firstInterval-1u]+2u):split.entropyBegin;
+				const size_t dataEnd = endInterval<=split.restartMarkers.size() ? split.restartMarkers[endInterval-1u]:split.entropyEnd;
+
+				const uint32_t rowBegin = decodeBegin*split.mcuHeight;
+				const uint32_t rowEnd = core::min(decodeEnd*split.mcuHeight,height);
+				const uint32_t rowCount = rowEnd-rowBegin;
+
+				stream.resize(split.entropyBegin+(dataEnd-dataBegin)+2u);
+				memcpy(stream.data(),input,split.entropyBegin);
+				stream[split.frameHeightOffset] = rowCount>>8u;
+				stream[split.frameHeightOffset+1u] = rowCount&0xffu;
+				memcpy(stream.data()+split.entropyBegin,input+dataBegin,dataEnd-dataBegin);
+				for (size_t marker=firstInterval; marker+1u<endInterval; marker++)
+					stream[split.entropyBegin+(split.restartMarkers[marker]-dataBegin)+1u] = 0xD0u+((marker-firstInterval)&0x7u);
+				stream[stream.size()-2u] = 0xFFu;
+				stream[stream.size()-1u] = 0xD9u;
+
+				const uint32_t keptRowBegin = keepBegin*split.mcuHeight;
+				const uint32_t keptRowEnd = core::min(keepEnd*split.mcuHeight,height);
+				rowPointers.resize(rowCount);
+				for (uint32_t row=rowBegin; row<rowEnd; row++)
+					rowPointers[row-rowBegin] = row>=keptRowBegin && row<keptRowEnd ? (outPtr+size_t(row)*rowspan):discardedRow.data();
+
+				if (!jpeg::decompress(ctx,stream.data(),stream.size(),rowPointers.data(),rowCount))
+					failed.store(true,std::memory_order_relaxed);
+			}
+		});
+		success = !failed.load();
+	}
+	else
+	{
+		core::vector<uint8_t*> rowPointers(height);
+		for (uint32_t i = 0; i < height; ++i)
+			rowPointers[i] = outPtr+size_t(i)*rowspan;
+		success = jpeg::decompress(ctx,input,fileSize,rowPointers.data(),height);
+	}
+
+	if (!success)
+	{
+		_params.logger.log("Can't load libjpeg threw an error: %s", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
+		return {};
+	}
 
 	core::smart_refctd_ptr<ICPUImage> image = ICPUImage::create(std::move(imgInfo));
 	image->setBufferAndRegions(std::move(buffer), regions);
@@ -336,4 +506,4 @@ asset::SAssetBundle CImageLoaderJPG::loadAsset(system::IFile* _file, const asset
 } // end namespace video
 } // end namespace nbl
 
-#endif
\ No newline at end of file
+#endif
@@ -24,7 +24,7 @@ class CImageLoaderJPG : public asset::IAssetLoader
 public:
     struct SContext
     {
-        char* filename = nullptr;
+        std::string filename;
         system::logger_opt_ptr logger = nullptr;
     };
 private:
@@ -0,0 +1,311 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "CImageLoaderKTX2.h"
+
+#ifdef _NBL_COMPILE_WITH_KTX2_LOADER_
+
+#include <atomic>
+
+#include "nbl/system/IFile.h"
+
+#include <zlib/zlib.h>
+
+namespace nbl::asset
+{
+
+namespace
+{
+constexpr std::array<uint8_t,12> KTX2Identifier = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+struct SKTX2Header
+{
+	std::array<uint8_t,12> identifier;
+	uint32_t vkFormat;
+	uint32_t typeSize;
+	uint32_t pixelWidth;
+	uint32_t pixelHeight;
+	uint32_t pixelDepth;
+	uint32_t layerCount;
+	uint32_t faceCount;
+	uint32_t levelCount;
+	uint32_t supercompressionScheme;
+	uint32_t dfdByteOffset;
+	uint32_t dfdByteLength;
+	uint32_t kvdByteOffset;
+	uint32_t kvdByteLength;
+	uint64_t sgdByteOffset;
+	uint64_t sgdByteLength;
+};
+static_assert(sizeof(SKTX2Header)==80u);
+struct SKTX2LevelIndex
+{
+	uint64_t byteOffset;
+	uint64_t byteLength;
+	uint64_t uncompressedByteLength;
+};
+static_assert(sizeof(SKTX2LevelIndex)==24u);
+
+enum E_SUPERCOMPRESSION_SCHEME : uint32_t
+{
+	ESS_NONE = 0u,
+	ESS_BASIS_LZ,
+	ESS_ZSTANDARD,
+	ESS_ZLIB
+};
+
+//! Colour `VkFormat`s to `E_FORMAT`, apart from the offsets the ranges in both enums are in the same order
+E_FORMAT translateVkFormat(const uint32_t vkFormat)
+{
+	static_assert(EF_R4G4_UNORM_PACK8==7u && EF_E5B9G9R9_UFLOAT_PACK32==129u);
+	static_assert(EF_BC1_RGB_UNORM_BLOCK==130u && EF_BC7_SRGB_BLOCK==145u);
+	static_assert(EF_ASTC_4x4_UNORM_BLOCK==146u && EF_ASTC_12x12_SRGB_BLOCK==173u);
+	static_assert(EF_ETC2_R8G8B8_UNORM_BLOCK==174u && EF_EAC_R11G11_SNORM_BLOCK==183u);
+	static_assert(EF_PVRTC1_2BPP_UNORM_BLOCK_IMG==184u && EF_PVRTC2_4BPP_SRGB_BLOCK_IMG==191u);
+	// VK_FORMAT_R4G4_UNORM_PACK8 to VK_FORMAT_E5B9G9R9_UFLOAT_PACK32
+	if (vkFormat>=1u && vkFormat<=123u)
+		return static_cast<E_FORMAT>(vkFormat+6u);
+	// VK_FORMAT_BC1_RGB_UNORM_BLOCK to VK_FORMAT_BC7_SRGB_BLOCK
+	if (vkFormat>=131u && vkFormat<=146u)
+		return static_cast<E_FORMAT>(vkFormat-1u);
+	// VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK to VK_FORMAT_EAC_R11G11_SNORM_BLOCK
+	if (vkFormat>=147u && vkFormat<=156u)
+		return static_cast<E_FORMAT>(vkFormat+27u);
+	// VK_FORMAT_ASTC_4x4_UNORM_BLOCK to VK_FORMAT_ASTC_12x12_SRGB_BLOCK
+	if (vkFormat>=157u && vkFormat<=184u)
+		return static_cast<E_FORMAT>(vkFormat-11u);
+	// VK_FORMAT_PVRTC1_2BPP_UNORM_BLOCK_IMG to VK_FORMAT_PVRTC2_4BPP_SRGB_BLOCK_IMG
+	if (vkFormat>=1000054000u && vkFormat<=1000054007u)
+		return static_cast<E_FORMAT>(vkFormat-1000054000u+EF_PVRTC1_2BPP_UNORM_BLOCK_IMG);
+	// depth-stencil (124 to 130), planar and all other extension formats
+	return EF_UNKNOWN;
+}
+}
+
+bool CImageLoaderKTX2::isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const
+{
+	std::remove_const_t<decltype(KTX2Identifier)> identifier;
+	system::IFile::success_t success;
+	_file->read(success, identifier.data(), 0, identifier.size());
+	return success && identifier==KTX2Identifier;
+}
+
+asset::SAssetBundle CImageLoaderKTX2::loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
+{
+	if (!_file)
+		return {};
+	const auto fileName = _file->getFileName().string();
+
+	SKTX2Header header;
+	{
+		system::IFile::success_t success;
+		_file->read(success, &header, 0, sizeof(header));
+		if (!success || header.identifier!=KTX2Identifier)
+			return {};
+	}
+	if (header.vkFormat==0u)
+	{
+		_params.logger.log("LOAD KTX2: %s has a format defined only by its Data Format Descriptor, which isn't supported", system::ILogger::ELL_ERROR, fileName.c_str());
+		return {};
+	}
+	if (header.supercompressionScheme!=ESS_NONE && header.supercompressionScheme!=ESS_ZLIB)
+	{
+		_params.logger.log("LOAD KTX2: %s uses unsupported supercompression scheme %d", system::ILogger::ELL_ERROR, fileName.c_str(), header.supercompressionScheme);
+		return {};
+	}
+
+	ICPUImage::SCreationParams imageInfo = {};
+	imageInfo.format = translateVkFormat(header.vkFormat);
+	if (imageInfo.format==EF_UNKNOWN)
+	{
+		_params.logger.log("LOAD KTX2: %s has unsupported VkFormat %d", system::ILogger::ELL_ERROR, fileName.c_str(), header.vkFormat);
+		return {};
+	}
+	const bool isItACubemap = header.faceCount==6u;
+	const bool isItAnArray = header.layerCount>0u;
+	if (header.pixelWidth==0u || (header.faceCount!=1u && !isItACubemap) || (isItACubemap && (header.pixelWidth!=header.pixelHeight || header.pixelDepth)))
+	{
+		_params.logger.log("LOAD KTX2: corrupt header in %s", system::ILogger::ELL_ERROR, fileName.c_str());
+		return {};
+	}
+	imageInfo.type = header.pixelDepth ? IImage::ET_3D:(header.pixelHeight ? IImage::ET_2D:IImage::ET_1D);
+	imageInfo.samples = ICPUImage::ESCF_1_BIT;
+	imageInfo.extent = {header.pixelWidth,core::max(header.pixelHeight,1u),core::max(header.pixelDepth,1u)};
+	// a level count of 0 asks for the mip chain to be generated at load time, only the base level is stored
+	imageInfo.mipLevels = core::max(header.levelCount,1u);
+	// 6 faces per cube must not wrap the layer count around
+	if (header.layerCount>std::numeric_limits<uint32_t>::max()/6u)
+	{
+		_params.logger.log("LOAD KTX2: corrupt header in %s", system::ILogger::ELL_ERROR, fileName.c_str());
+		return {};
+	}
+	imageInfo.arrayLayers = core::max(header.layerCount,1u)*header.faceCount;
+	imageInfo.flags = isItACubemap ? ICPUImage::ECF_CUBE_COMPATIBLE_BIT:static_cast<ICPUImage::E_CREATE_FLAGS>(0u);
+	imageInfo.usage = IImage::EUF_SAMPLED_BIT;
+	if (imageInfo.mipLevels>1u+hlsl::findMSB(core::max(core::max(imageInfo.extent.width,imageInfo.extent.height),imageInfo.extent.depth)))
+	{
+		_params.logger.log("LOAD KTX2: corrupt header in %s", system::ILogger::ELL_ERROR, fileName.c_str());
+		return {};
+	}
+
+	core::vector<SKTX2LevelIndex> levelIndex(imageInfo.mipLevels);
+	{
+		system::IFile::success_t success;
+		_file->read(success, levelIndex.data(), sizeof(header), sizeof(SKTX2LevelIndex)*levelIndex.size());
+		if (!success)
+			return {};
+	}
+
+	// within a level the layers, then faces, then depth slices are tightly packed, so one region covers all layers of a level
+	const auto blockByteSize = asset::getTexelOrBlockBytesize(imageInfo.format);
+	auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(imageInfo.mipLevels);
+	core::vector<size_t> levelSizes(imageInfo.mipLevels);
+	// levels are stored from the smallest, the data of all of them spans from the last entry's offset to the end of the first one's
+	size_t dataBegin = ~0ull, dataEnd = 0ull;
+	for (uint32_t level=0u; level<imageInfo.mipLevels; level++)
+	{
+		auto& region = regions->operator[](level);
+		region.bufferRowLength = 0u;
+		region.bufferImageHeight = 0u;
+		region.imageSubresource.aspectMask = IImage::EAF_COLOR_BIT;
+		region.imageSubresource.mipLevel = level;
+		region.imageSubresource.baseArrayLayer = 0u;
+		region.imageSubresource.layerCount = imageInfo.arrayLayers;
+		region.imageOffset = {0u,0u,0u};
+		region.imageExtent = {core::max(imageInfo.extent.width>>level,1u),core::max(imageInfo.extent.height>>level,1u),core::max(imageInfo.extent.depth>>level,1u)};
+
+		const auto& extent = region.imageExtent;
+		// a size which wrapped around could match a forged level index and get a tiny buffer that the regions then overrun
+		levelSizes[level] = getLevelByteSize(imageInfo.format,extent.width,extent.height,extent.depth,imageInfo.arrayLayers);
+		if (!levelSizes[level] || (header.supercompressionScheme!=ESS_NONE && levelSizes[level]>std::numeric_limits<uLongf>::max()))
+		{
+			_params.logger.log("LOAD KTX2: %s declares an image too big to address", system::ILogger::ELL_ERROR, fileName.c_str());
+			return {};
+		}
+
+		const auto& entry = levelIndex[level];
+		const bool badLength = header.supercompressionScheme==ESS_NONE ? (entry.byteLength!=levelSizes[level]):(entry.uncompressedByteLength!=levelSizes[level]);
+		if (badLength || entry.byteOffset+entry.byteLength>_file->getSize() || entry.byteOffset+entry.byteLength<entry.byteOffset)
+		{
+			_params.logger.log("LOAD KTX2: corrupt level index in %s", system::ILogger::ELL_ERROR, fileName.c_str());
+			return {};
+		}
+		dataBegin = core::min<size_t>(dataBegin,entry.byteOffset);
+		dataEnd = core::max<size_t>(dataEnd,entry.byteOffset+entry.byteLength);
+	}
+
+	core::smart_refctd_ptr<ICPUBuffer> texelBuffer;
+	if (header.supercompressionScheme==ESS_NONE)
+	{
+		// the format guarantees level offsets aligned to the texel block size, so are the region offsets relative to the first level stored
+		for (uint32_t level=0u; level<imageInfo.mipLevels; level++)
+		{
+			regions->operator[](level).bufferOffset = levelIndex[level].byteOffset-dataBegin;
+			if (regions->operator[](level).bufferOffset%blockByteSize)
+			{
+				_params.logger.log("LOAD KTX2: misaligned level %d in %s", system::ILogger::ELL_ERROR, level, fileName.c_str());
+				return {};
+			}
+		}
+
+		texelBuffer = createBufferOverFileMapping(_params,_file,dataBegin,dataEnd-dataBegin);
+		if (!texelBuffer)
+		{
+			texelBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(dataEnd-dataBegin);
+			system::IFile::success_t success;
+			_file->read(success, texelBuffer->getPointer(), dataBegin, dataEnd-dataBegin);
+			if (!success)
+				return {};
+		}
+	}
+	else
+	{
+		const uint8_t* compressed = reinterpret_cast<const uint8_t*>(static_cast<const system::IFile*>(_file)->getMappedPointer());
+		core::vector<uint8_t> compressedStorage;
+		if (compressed)
+			compressed += dataBegin;
+		else
+		{
+			compressedStorage.resize(dataEnd-dataBegin);
+			system::IFile::success_t success;
+			_file->read(success, compressedStorage.data(), dataBegin, compressedStorage.size());
+			if (!success)
+				return {};
+			compressed = compressedStorage.data();
+		}
+
+		// inflated levels get laid out from the largest, every level's size is a multiple of the block size
+		size_t offset = 0ull;
+		for (uint32_t level=0u; level<imageInfo.mipLevels; level++)
+		{
+			regions->operator[](level).bufferOffset = offset;
+			if (!checkedAdd(offset,levelSizes[level]))
+			{
+				_params.logger.log("LOAD KTX2: %s declares an image too big to address", system::ILogger::ELL_ERROR, fileName.c_str());
+				return {};
+			}
+		}
+		texelBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(offset);
+
+		std::atomic_bool failed = false;
+		auto inflateLevels = [&](const size_t begin, const size_t end) -> void
+		{
+			auto* const out = reinterpret_cast<uint8_t*>(texelBuffer->getPointer());
+			for (size_t level=begin; level<end; level++)
+			{
+				const auto& entry = levelIndex[level];
+				uLongf inflatedSize = levelSizes[level];
+				const auto result = uncompress(out+regions->operator[](level).bufferOffset,&inflatedSize,compressed+(entry.byteOffset-dataBegin),entry.byteLength);
+				if (result!=Z_OK || inflatedSize!=levelSizes[level])
+					failed.store(true,std::memory_order_relaxed);
+			}
+		};
+		if (_params.scheduler)
+			_params.scheduler->parallel_for(0u,imageInfo.mipLevels,1u,inflateLevels);
+		else
+			inflateLevels(0u,imageInfo.mipLevels);
+		if (failed.load(std::memory_order_relaxed))
+		{
+			_params.logger.log("LOAD KTX2: failed to inflate the levels of %s", system::ILogger::ELL_ERROR, fileName.c_str());
+			return {};
+		}
+	}
+
+	auto image = ICPUImage::create(std::move(imageInfo));
+	if (!image)
+		return {};
+	image->setBufferAndRegions(std::move(texelBuffer),regions);
+
+	ICPUImageView::SCreationParams imageViewInfo = {};
+	const auto& params = image->getCreationParameters();
+	switch (params.type)
+	{
+		case IImage::ET_1D:
+			imageViewInfo.viewType = isItAnArray ? ICPUImageView::ET_1D_ARRAY:ICPUImageView::ET_1D;
+			break;
+		case IImage::ET_3D:
+			imageViewInfo.viewType = ICPUImageView::ET_3D;
+			break;
+		default:
+			if (isItACubemap)
+				imageViewInfo.viewType = isItAnArray ? ICPUImageView::ET_CUBE_MAP_ARRAY:ICPUImageView::ET_CUBE_MAP;
+			else
+				imageViewInfo.viewType = isItAnArray ? ICPUImageView::ET_2D_ARRAY:ICPUImageView::ET_2D;
+			break;
+	}
+	imageViewInfo.format = params.format;
+	imageViewInfo.flags = static_cast<ICPUImageView::E_CREATE_FLAGS>(0u);
+	imageViewInfo.subresourceRange.aspectMask = IImage::EAF_COLOR_BIT;
+	imageViewInfo.subresourceRange.baseArrayLayer = 0u;
+	imageViewInfo.subresourceRange.baseMipLevel = 0u;
+	imageViewInfo.subresourceRange.layerCount = params.arrayLayers;
+	imageViewInfo.subresourceRange.levelCount = params.mipLevels;
+	imageViewInfo.image = std::move(image);
+
+	return SAssetBundle(nullptr,{ICPUImageView::create(std::move(imageViewInfo))});
+}
+
+}
+
+#endif // _NBL_COMPILE_WITH_KTX2_LOADER_
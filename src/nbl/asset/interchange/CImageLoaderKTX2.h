@@ -0,0 +1,44 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_ASSET_C_IMAGE_LOADER_KTX2_H_INCLUDED__
+#define __NBL_ASSET_C_IMAGE_LOADER_KTX2_H_INCLUDED__
+
+#include "BuildConfigOptions.h"
+
+#ifdef _NBL_COMPILE_WITH_KTX2_LOADER_
+
+#include "nbl/asset/interchange/IImageLoader.h"
+
+namespace nbl::asset
+{
+
+//! Native Khronos Texture 2.0 loader
+/**
+	Without supercompression the regions of the image it returns point straight into the file's mapping.
+	ZLIB supercompressed levels get inflated into a single buffer, one level per task on `SAssetLoadParams::scheduler` if there is one.
+	Zstandard and BasisLZ supercompression, as well as `VK_FORMAT_UNDEFINED` payloads, aren't supported.
+*/
+class CImageLoaderKTX2 final : public IImageLoader
+{
+	public:
+		CImageLoaderKTX2() = default;
+
+		bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const override;
+
+		const char** getAssociatedFileExtensions() const override
+		{
+			static const char* extensions[]{ "ktx2", nullptr };
+			return extensions;
+		}
+
+		uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_IMAGE_VIEW; }
+
+		asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
+};
+
+}
+
+#endif // _NBL_COMPILE_WITH_KTX2_LOADER_
+#endif
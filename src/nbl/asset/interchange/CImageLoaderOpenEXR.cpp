@@ -6,24 +6,26 @@
 #include <algorithm>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
 #include "nbl/asset/IAssetManager.h"
 
 #ifdef _NBL_COMPILE_WITH_OPENEXR_LOADER_
 
-#include "nbl/asset/filters/CRegionBlockFunctorFilter.h"
 #include "nbl/asset/metadata/COpenEXRMetadata.h"
 
 #include "CImageLoaderOpenEXR.h"
 
 #include "ImfRgbaFile.h"
 #include "ImfInputFile.h"
+#include "ImfTiledInputFile.h"
 #include "ImfChannelList.h"
 #include "ImfChannelListAttribute.h"
 #include "ImfStringAttribute.h"
 #include "ImfMatrixAttribute.h"
-#include "ImfArray.h"
+#include "ImfThreading.h"
+#include "ImfVersion.h"
 
 #include "ImfNamespace.h"
 namespace IMF = Imf;
@@ -125,8 +127,6 @@ using mapOfChannels = std::unordered_map<channelName, Channel>;				// suffix.cha
 class SContext;
 bool readVersionField(IMF::IStream* nblIStream, SContext& ctx, const system::logger_opt_ptr);
 bool readHeader(IMF::IStream* nblIStream, SContext& ctx);
-template<typename rgbaFormat>
-void readRgba(InputFile& file, std::array<Array2D<rgbaFormat>, 4>& pixelRgbaMapArray, int& width, int& height, E_FORMAT& format, const suffixOfChannelBundle suffixOfChannels);
 E_FORMAT specifyIrrlichtEndFormat(const mapOfChannels& mapOfChannels, const suffixOfChannelBundle suffixName, const std::string fileName, const system::logger_opt_ptr logger);
 
 //! A helpful struct for handling OpenEXR layout
@@ -212,40 +212,69 @@ struct SContext
 };
 
 constexpr uint8_t availableChannels = 4;
-struct PerImageData
+
+//! Inserts the RGBA slices of a channel bundle so that the pixel `(origin.x,origin.y)` lands at `base` and the rest follows with the given pitches
+void insertSlices(FrameBuffer& frameBuffer, const suffixOfChannelBundle& suffixOfChannels, const PixelType pixelType, uint8_t* const base, const V2i origin, const size_t texelSize, const size_t rowPitch)
 {
-	ICPUImage::SCreationParams params;
-	std::array<Array2D<half>, availableChannels> halfPixelMapArray;
-	std::array<Array2D<float>, availableChannels> fullFloatPixelMapArray;
-	std::array<Array2D<uint32_t>, availableChannels> uint32_tPixelMapArray;
-};
-template<typename IlmType>
-struct ReadTexels
+	constexpr const char* rgbaSignatureAsText[] = {"R", "G", "B", "A"};
+	const size_t channelSize = texelSize/availableChannels;
+	for (uint8_t rgbaChannelIndex = 0; rgbaChannelIndex < availableChannels; ++rgbaChannelIndex)
+	{
+		std::string name = suffixOfChannels.empty() ? rgbaSignatureAsText[rgbaChannelIndex] : suffixOfChannels + "." + rgbaSignatureAsText[rgbaChannelIndex];
+		// OpenEXR addresses pixels as `base+x*xStride+y*yStride` with data window coordinates, so the base has to be offset back by the origin
+		char* const slicePtr = reinterpret_cast<char*>(base+rgbaChannelIndex*channelSize)-ptrdiff_t(origin.x)*ptrdiff_t(texelSize)-ptrdiff_t(origin.y)*ptrdiff_t(rowPitch);
+		frameBuffer.insert
+		(
+			name.c_str(),
+			Slice(pixelType,slicePtr,texelSize,rowPitch,
+				1, 1,										// x/y sampling
+				rgbaChannelIndex == 3 ? 1 : 0				// default fillValue for channels that aren't present in file - 1 for alpha, otherwise 0
+			)
+		);
+	}
+}
+
+//! Decodes the `window` (data window coordinates, inclusive) of one resolution level of a scanline or tiled file straight into the image's buffer
+/*
+	OpenEXR always decodes whole scanlines (or whole tiles) and writes all of their pixels into the frame buffer, so when the window
+	doesn't line up with those the pixels get decoded in horizontal bands into a scratch buffer and only the window gets copied out.
+	`getBand(y)` returns the decoded extent `{x0,y0,x1,y1}` of the band holding row `y`, `readBand(band)` decodes it with the current frame buffer.
+*/
+template<class ExrFile, typename GetBand, typename ReadBand>
+void decodeWindow(
+	ExrFile& file, const suffixOfChannelBundle& suffixOfChannels, const PixelType pixelType, const Box2i& window,
+	uint8_t* const dst, const size_t texelSize, const size_t dstRowPitch,
+	GetBand&& getBand, ReadBand&& readBand)
 {
-		ReadTexels(ICPUImage* image, const std::array<Array2D<IlmType>, availableChannels>& _pixelMapArray) :
-			data(reinterpret_cast<uint8_t*>(image->getBuffer()->getPointer())), pixelMapArray(_pixelMapArray)
-		{
-			using StreamFromEXR = CRegionBlockFunctorFilter<ReadTexels<IlmType>,false>;
-			typename StreamFromEXR::state_type state(*this,image,image->getRegions().begin());
-			StreamFromEXR::execute(core::execution::par_unseq,&state);
-		}
+	const Box2i first = getBand(window.min.y);
+	const Box2i last = getBand(window.max.y);
+	// the common case, the whole image or a window aligned to tiles
+	if (first.min.x==window.min.x && first.max.x==window.max.x && first.min.y==window.min.y && last.max.y==window.max.y)
+	{
+		FrameBuffer frameBuffer;
+		insertSlices(frameBuffer,suffixOfChannels,pixelType,dst,window.min,texelSize,dstRowPitch);
+		file.setFrameBuffer(frameBuffer);
+		readBand(Box2i(first.min,last.max));
+		return;
+	}
 
-		inline void operator()(uint32_t ptrOffset, const core::vectorSIMDu32& texelCoord)
-		{
-			assert(texelCoord.w==0u && texelCoord.z==0u);
+	const size_t scratchRowPitch = size_t(first.max.x-first.min.x+1)*texelSize;
+	core::vector<uint8_t> scratch;
+	for (int32_t y=window.min.y; y<=window.max.y; )
+	{
+		const Box2i band = getBand(y);
+		scratch.resize(scratchRowPitch*size_t(band.max.y-band.min.y+1));
 
-			uint8_t* texelPtr = data+ptrOffset;
-			for (auto channelIndex=0; channelIndex<availableChannels; channelIndex++)
-			{
-				const auto& element = pixelMapArray[channelIndex][texelCoord.y][texelCoord.x];
-				reinterpret_cast<typename std::decay<decltype(element)>::type*>(texelPtr)[channelIndex] = element;
-			}
-		}
+		FrameBuffer frameBuffer;
+		insertSlices(frameBuffer,suffixOfChannels,pixelType,scratch.data(),band.min,texelSize,scratchRowPitch);
+		file.setFrameBuffer(frameBuffer);
+		readBand(band);
 
-	private:
-		uint8_t* const data;
-		const std::array<Array2D<IlmType>, availableChannels>& pixelMapArray;
-};
+		const int32_t bandEnd = std::min(band.max.y,window.max.y);
+		for (; y<=bandEnd; y++)
+			memcpy(dst+size_t(y-window.min.y)*dstRowPitch,scratch.data()+size_t(y-band.min.y)*scratchRowPitch+size_t(window.min.x-band.min.x)*texelSize,size_t(window.max.x-window.min.x+1)*texelSize);
+	}
+}
 
 auto getChannels(const InputFile& file)
 {
@@ -282,6 +311,13 @@ auto doesTheChannelExist(const std::string channelName, const mapOfChannels& map
 		return false;
 }
 
+void CImageLoaderOpenEXR::initialize()
+{
+	// OpenEXR decodes line buffers and tiles in parallel on its global thread pool, which is disabled unless someone sizes it
+	if (IMF::globalThreadCount()==0)
+		IMF::setGlobalThreadCount(std::max<int>(std::thread::hardware_concurrency(),1));
+}
+
 SAssetBundle CImageLoaderOpenEXR::loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
 {
 	if (!_file)
@@ -290,7 +326,7 @@ SAssetBundle CImageLoaderOpenEXR::loadAsset(system::IFile* _file, const asset::I
 	SContext ctx;
 
 	IMF::IStream* nblIStream = _NBL_NEW(impl::nblIStream, _file); // TODO: THIS NEEDS TESTING
-	InputFile file(*nblIStream);
+	InputFile file(*nblIStream, IMF::globalThreadCount());
 
 	if (file.isComplete())
 		static_cast<impl::nblIStream*>(nblIStream)->resetFileOffset();
@@ -316,6 +352,28 @@ SAssetBundle CImageLoaderOpenEXR::loadAsset(system::IFile* _file, const asset::I
 		return {};
 	}
 
+	// tiled files can hold mip (or rip) levels, those need the tiled API, the scanline one only sees the highest resolution
+	impl::nblIStream tiledIStream(_file);
+	std::unique_ptr<TiledInputFile> tiledFile;
+	if (isTiled(file.version()))
+		tiledFile = std::make_unique<TiledInputFile>(tiledIStream, IMF::globalThreadCount());
+	uint32_t fileLevelCount = 1u;
+	if (tiledFile)
+	switch (tiledFile->levelMode())
+	{
+		case MIPMAP_LEVELS:
+			fileLevelCount = tiledFile->numLevels();
+			break;
+		case RIPMAP_LEVELS: // only the levels scaled the same in both directions make a mip chain
+			fileLevelCount = std::min(tiledFile->numXLevels(),tiledFile->numYLevels());
+			break;
+		default:
+			break;
+	}
+
+	const Box2i dataWindow = file.header().dataWindow();
+	const IAssetLoader::SAssetLoadContext loadContext(_params,_file);
+
 	core::vector<core::smart_refctd_ptr<ICPUImage>> images;
 	const auto channelsData = getChannels(file);
 	auto meta = core::make_smart_refctd_ptr<COpenEXRMetadata>(channelsData.size());
@@ -325,12 +383,8 @@ SAssetBundle CImageLoaderOpenEXR::loadAsset(system::IFile* _file, const asset::I
 		{
 			const auto suffixOfChannels = data.first;
 			const auto mapOfChannels = data.second;
-			PerImageData perImageData;
-
-			int width;
-			int height;
 
-			auto params = perImageData.params;
+			ICPUImage::SCreationParams params = {};
 			params.format = specifyIrrlichtEndFormat(mapOfChannels, suffixOfChannels, file.fileName(), _params.logger);
 			params.type = ICPUImage::ET_2D;;
 			params.flags = static_cast<ICPUImage::E_CREATE_FLAGS>(0u);
@@ -347,47 +401,128 @@ SAssetBundle CImageLoaderOpenEXR::loadAsset(system::IFile* _file, const asset::I
 				continue;
 			}
 
+			PixelType pixelType;
 			if (params.format == EF_R16G16B16A16_SFLOAT)
-				readRgba(file, perImageData.halfPixelMapArray, width, height, params.format, suffixOfChannels);
+				pixelType = PixelType::HALF;
 			else if (params.format == EF_R32G32B32A32_SFLOAT)
-				readRgba(file, perImageData.fullFloatPixelMapArray, width, height, params.format, suffixOfChannels);
-			else if (params.format == EF_R32G32B32A32_UINT)
-				readRgba(file, perImageData.uint32_tPixelMapArray, width, height, params.format, suffixOfChannels);
+				pixelType = PixelType::FLOAT;
+			else
+				pixelType = PixelType::UINT;
+
+			// let the override pick a sub-rectangle of the data window, relative to its corner
+			VkOffset3D windowOffset = {0u,0u,0u};
+			VkExtent3D windowExtent = {uint32_t(dataWindow.max.x-dataWindow.min.x+1),uint32_t(dataWindow.max.y-dataWindow.min.y+1),1u};
+			const VkExtent3D fullExtent = windowExtent;
+			if (_override)
+				_override->getImageDecodeWindow(windowOffset,windowExtent,suffixOfChannels,_file,loadContext,_hierarchyLevel);
+			if (windowOffset.x>=fullExtent.width || windowOffset.y>=fullExtent.height || !windowExtent.width || !windowExtent.height)
+			{
+				#ifndef  _NBL_PLATFORM_ANDROID_
+				_params.logger.log("LOAD EXR: the requested window of " + suffixOfChannels + " channels is empty - skipping it in the file %s", system::ILogger::ELL_INFO, file.fileName());
+				#endif // ! _NBL_PLATFORM_ANDROID_
+				continue;
+			}
+			windowExtent.width = std::min(windowExtent.width,fullExtent.width-windowOffset.x);
+			windowExtent.height = std::min(windowExtent.height,fullExtent.height-windowOffset.y);
+			params.extent.width = windowExtent.width;
+			params.extent.height = windowExtent.height;
 
-			params.extent.width = width;
-			params.extent.height = height;
+			// level `l` of the file becomes mip `l` as long as the window maps onto it exactly with the usual halving
+			for (; params.mipLevels<fileLevelCount; params.mipLevels++)
+			{
+				const uint32_t level = params.mipLevels;
+				const uint32_t levelWidth = tiledFile->levelWidth(level);
+				const uint32_t levelHeight = tiledFile->levelHeight(level);
+				const uint32_t mask = (0x1u<<level)-1u;
+				if ((windowOffset.x&mask) || (windowOffset.y&mask))
+					break;
+				const uint32_t offsetX = windowOffset.x>>level, offsetY = windowOffset.y>>level;
+				const uint32_t extentX = std::max(windowExtent.width>>level,1u), extentY = std::max(windowExtent.height>>level,1u);
+				// windows touching the far edge have to keep touching it, this stops the chain of files rounding the level sizes up
+				const bool reachesX = windowOffset.x+windowExtent.width==fullExtent.width, reachesY = windowOffset.y+windowExtent.height==fullExtent.height;
+				if (offsetX+extentX>levelWidth || offsetY+extentY>levelHeight || (reachesX && offsetX+extentX!=levelWidth) || (reachesY && offsetY+extentY!=levelHeight))
+					break;
+			}
 
 			auto image = ICPUImage::create(std::move(params));
+			const auto& creationParams = image->getCreationParameters();
+			const uint32_t texelFormatByteSize = getTexelOrBlockBytesize(creationParams.format);
 			{ // create image and buffer that backs it
-				const uint32_t texelFormatByteSize = getTexelOrBlockBytesize(image->getCreationParameters().format);
-				auto texelBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(image->getImageDataSizeInBytes());
-				auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(1u);
-				ICPUImage::SBufferCopy& region = regions->front();
-				region.imageSubresource.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT;
-				region.imageSubresource.mipLevel = 0u;
-				region.imageSubresource.baseArrayLayer = 0u;
-				region.imageSubresource.layerCount = 1u;
-				region.bufferOffset = 0u;
-				region.bufferRowLength = calcPitchInBlocks(width, texelFormatByteSize);
-				region.bufferImageHeight = 0u;
-				region.imageOffset = { 0u, 0u, 0u };
-				region.imageExtent = image->getCreationParameters().extent;
-
-				image->setBufferAndRegions(std::move(texelBuffer), regions);
+				auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(creationParams.mipLevels);
+				size_t bufferSize = 0ull;
+				for (uint32_t level=0u; level<creationParams.mipLevels; level++)
+				{
+					const auto mipSize = image->getMipSize(level);
+					ICPUImage::SBufferCopy& region = regions->operator[](level);
+					region.imageSubresource.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT;
+					region.imageSubresource.mipLevel = level;
+					region.imageSubresource.baseArrayLayer = 0u;
+					region.imageSubresource.layerCount = 1u;
+					region.bufferOffset = bufferSize;
+					region.bufferRowLength = calcPitchInBlocks(mipSize.x, texelFormatByteSize);
+					region.bufferImageHeight = 0u;
+					region.imageOffset = { 0u, 0u, 0u };
+					region.imageExtent = { mipSize.x, mipSize.y, 1u };
+					bufferSize += size_t(region.bufferRowLength)*mipSize.y*texelFormatByteSize;
+				}
+
+				image->setBufferAndRegions(core::make_smart_refctd_ptr<ICPUBuffer>(bufferSize), regions);
 			}
 
-			if (params.format == EF_R16G16B16A16_SFLOAT)
-				ReadTexels(image.get(),perImageData.halfPixelMapArray);
-			else if (params.format == EF_R32G32B32A32_SFLOAT)
-				ReadTexels(image.get(), perImageData.fullFloatPixelMapArray);
-			else if (params.format == EF_R32G32B32A32_UINT)
-				ReadTexels(image.get(), perImageData.uint32_tPixelMapArray);
+			uint8_t* const bufferPtr = reinterpret_cast<uint8_t*>(image->getBuffer()->getPointer());
+			for (const auto& region : image->getRegions())
+			{
+				const uint32_t level = region.imageSubresource.mipLevel;
+				uint8_t* const dst = bufferPtr+region.bufferOffset;
+				const size_t dstRowPitch = size_t(region.bufferRowLength)*texelFormatByteSize;
+
+				Box2i window;
+				window.min = dataWindow.min+V2i(windowOffset.x>>level,windowOffset.y>>level);
+				window.max = window.min+V2i(region.imageExtent.width-1u,region.imageExtent.height-1u);
+				if (tiledFile)
+				{
+					const int32_t tileWidth = tiledFile->tileXSize(), tileHeight = tiledFile->tileYSize();
+					const Box2i levelWindow = tiledFile->dataWindowForLevel(level,level);
+					const int32_t tileX0 = (window.min.x-levelWindow.min.x)/tileWidth;
+					const int32_t tileX1 = (window.max.x-levelWindow.min.x)/tileWidth;
+					auto getBand = [&](const int32_t y) -> Box2i
+					{
+						const int32_t tileY = (y-levelWindow.min.y)/tileHeight;
+						const Box2i first = tiledFile->dataWindowForTile(tileX0,tileY,level,level);
+						const Box2i last = tiledFile->dataWindowForTile(tileX1,tileY,level,level);
+						return Box2i(first.min,last.max);
+					};
+					auto readBand = [&](const Box2i& band) -> void
+					{
+						const int32_t tileY0 = (band.min.y-levelWindow.min.y)/tileHeight;
+						const int32_t tileY1 = (band.max.y-levelWindow.min.y)/tileHeight;
+						tiledFile->readTiles(tileX0,tileX1,tileY0,tileY1,level,level);
+					};
+					decodeWindow(*tiledFile,suffixOfChannels,pixelType,window,dst,texelFormatByteSize,dstRowPitch,getBand,readBand);
+				}
+				else
+				{
+					// big enough for the thread pool to have plenty of line buffers to decode in parallel
+					const int32_t bandHeight = std::max(IMF::globalThreadCount(),1)*32;
+					auto getBand = [&](const int32_t y) -> Box2i
+					{
+						const int32_t bandY = window.min.y+(y-window.min.y)/bandHeight*bandHeight;
+						return Box2i(V2i(dataWindow.min.x,bandY),V2i(dataWindow.max.x,std::min(bandY+bandHeight-1,window.max.y)));
+					};
+					auto readBand = [&](const Box2i& band) -> void
+					{
+						file.readPixels(band.min.y,band.max.y);
+					};
+					decodeWindow(file,suffixOfChannels,pixelType,window,dst,texelFormatByteSize,dstRowPitch,getBand,readBand);
+				}
+			}
 
 			meta->placeMeta(metaOffset++,image.get(),std::string(suffixOfChannels),IImageMetadata::ColorSemantic{ ECP_SRGB,EOTF_IDENTITY });
 
 			images.push_back(std::move(image));
 		}
-	}	
+	}
+	tiledFile = nullptr;
 	_NBL_DELETE(nblIStream);
 	return SAssetBundle(std::move(meta),std::move(images));
 }
@@ -405,46 +540,6 @@ bool CImageLoaderOpenEXR::isALoadableFileFormat(system::IFile* _file, const syst
 	return success && isImfMagic(magicNumberBuffer);
 }
 
-template<typename rgbaFormat>
-void readRgba(InputFile& file, std::array<Array2D<rgbaFormat>, 4>& pixelRgbaMapArray, int& width, int& height, E_FORMAT& format, const suffixOfChannelBundle suffixOfChannels)
-{
-	Box2i dw = file.header().dataWindow();
-	width = dw.max.x - dw.min.x + 1;
-	height = dw.max.y - dw.min.y + 1;
-
-	constexpr const char* rgbaSignatureAsText[] = {"R", "G", "B", "A"};
-	for (auto& pixelChannelBuffer : pixelRgbaMapArray)
-		pixelChannelBuffer.resizeErase(height, width);
-
-	FrameBuffer frameBuffer;
-	PixelType pixelType;
-
-	if (format == EF_R16G16B16A16_SFLOAT)
-		pixelType = PixelType::HALF;
-	else if (format == EF_R32G32B32A32_SFLOAT)
-		pixelType = PixelType::FLOAT;
-	else if (format == EF_R32G32B32A32_UINT)
-		pixelType = PixelType::UINT;
-
-	for (uint8_t rgbaChannelIndex = 0; rgbaChannelIndex < availableChannels; ++rgbaChannelIndex)
-	{
-		std::string name = suffixOfChannels.empty() ? rgbaSignatureAsText[rgbaChannelIndex] : suffixOfChannels + "." + rgbaSignatureAsText[rgbaChannelIndex];
-		frameBuffer.insert
-		(
-			name.c_str(),																					// name
-			Slice(pixelType,																				// type
-			(char*)(&(pixelRgbaMapArray[rgbaChannelIndex])[0][0] - dw.min.x - dw.min.y * width),			// base
-				sizeof((pixelRgbaMapArray[rgbaChannelIndex])[0][0]) * 1,                                    // xStride
-				sizeof((pixelRgbaMapArray[rgbaChannelIndex])[0][0]) * width,                                // yStride
-				1, 1,                                                                                       // x/y sampling
-				rgbaChannelIndex == 3 ? 1 : 0                                                               // default fillValue for channels that aren't present in file - 1 for alpha, otherwise 0
-			));
-	}
-
-	file.setFrameBuffer(frameBuffer);
-	file.readPixels(dw.min.y, dw.max.y);
-}
-
 E_FORMAT specifyIrrlichtEndFormat(const mapOfChannels& mapOfChannels, const suffixOfChannelBundle suffixName, const std::string fileName, const system::logger_opt_ptr logger)
 {
 	E_FORMAT retVal;
@@ -512,13 +607,7 @@ bool readVersionField(IMF::IStream* nblIStream, SContext& ctx, const system::log
 		versionField.Compoment.type = SContext::VersionField::Compoment::SINGLE_PART_FILE;
 
 		if (isTheBitActive(9))
-		{
 			versionField.Compoment.singlePartFileCompomentSubTypes = SContext::VersionField::Compoment::TILES;
-			#ifndef _NBL_PLATFORM_ANDROID_
-			logger.log("LOAD EXR: the file consist of not supported tiles %s", system::ILogger::ELL_ERROR, file.fileName());
-			#endif // !_NBL_PLATFORM_ANDROID_
-			return false;
-		}
 		else
 			versionField.Compoment.singlePartFileCompomentSubTypes = SContext::VersionField::Compoment::SCAN_LINES;
 	}
@@ -35,6 +35,9 @@ class CImageLoaderOpenEXR final : public IImageLoader
 
 		uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_IMAGE; }
 
+		//! sizes OpenEXR's global thread pool to the hardware concurrency, unless the application already did
+		void initialize() override;
+
 		asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
 
 	private:
@@ -31,12 +31,6 @@ namespace asset
 #ifdef _NBL_COMPILE_WITH_LIBPNG_
 // PNG function for error handling
 
-void updateFilePos(png_structp png_pt, size_t new_file_pos)
-{
-	auto ptr = (CImageLoaderPng::SContext*)png_get_user_chunk_ptr(png_pt);
-	ptr->file_pos = new_file_pos;
-	png_set_read_user_chunk_fn(png_pt, ptr, nullptr);
-}
 static void png_cpexcept_error(png_structp png_ptr, png_const_charp msg)
 {
 	auto ctx = (CImageLoaderPng::SContext*)png_get_user_chunk_ptr(png_ptr);
@@ -57,19 +51,52 @@ void PNGAPI user_read_data_fcn(png_structp png_pt, png_bytep data, png_size_t le
 	png_size_t check;
 
 	auto* userData = (CImageLoaderPng::SContext*)png_get_user_chunk_ptr(png_pt);
-	size_t file_pos = userData->file_pos;
+	const size_t file_pos = userData->file_pos;
 
 	system::IFile* file=(system::IFile*)png_get_io_ptr(png_pt);
 
-	system::IFile::success_t success;
-	file->read(success, data, file_pos, length);
-	check = success.getBytesProcessed();
-	file_pos += length;
-	updateFilePos(png_pt, file_pos);
+	if (userData->mappedFile)
+	{
+		check = file_pos<file->getSize() ? core::min<size_t>(length,file->getSize()-file_pos):0ull;
+		memcpy(data, userData->mappedFile+file_pos, check);
+	}
+	else
+	{
+		system::IFile::success_t success;
+		file->read(success, data, file_pos, length);
+		check = success.getBytesProcessed();
+	}
+	userData->file_pos = file_pos+length;
 
 	if (check != length)
 		png_error(png_pt, "Read Error");
 }
+
+//! Expands a row of `LA` texels to `LLLA` in place, back to front so that no texel gets overwritten before it's read
+static void expandLumaAlpha(uint8_t* const row, const uint32_t width)
+{
+	uint32_t x = width;
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+	const __m128i lowHalf = _mm_setr_epi8(0,0,0,1, 2,2,2,3, 4,4,4,5, 6,6,6,7);
+	const __m128i highHalf = _mm_setr_epi8(8,8,8,9, 10,10,10,11, 12,12,12,13, 14,14,14,15);
+	for (; x>=8u; x-=8u)
+	{
+		// 8 texels in, 32 bytes out at twice the offset, which is never below the texels still waiting to be read
+		const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row+(x-8u)*2u));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row+(x-8u)*4u+16u),_mm_shuffle_epi8(in,highHalf));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row+(x-8u)*4u),_mm_shuffle_epi8(in,lowHalf));
+	}
+#endif
+	while (x--)
+	{
+		const uint8_t luma = row[x*2u];
+		const uint8_t alpha = row[x*2u+1u];
+		row[x*4u+0u] = luma;
+		row[x*4u+1u] = luma;
+		row[x*4u+2u] = luma;
+		row[x*4u+3u] = alpha;
+	}
+}
 #endif // _NBL_COMPILE_WITH_LIBPNG_
 
 
@@ -155,6 +182,7 @@ asset::SAssetBundle CImageLoaderPng::loadAsset(system::IFile* _file, const asset
         return {};
 	}
 	SContext usrData(_params.logger);
+	usrData.mappedFile = reinterpret_cast<const uint8_t*>(static_cast<const system::IFile*>(_file)->getMappedPointer());
 	png_set_read_user_chunk_fn(png_ptr, &usrData, nullptr);
 
 	png_set_read_fn(png_ptr, _file, user_read_data_fcn);
@@ -313,15 +341,7 @@ asset::SAssetBundle CImageLoaderPng::loadAsset(system::IFile* _file, const asset
 	{
 		assert(imgInfo.format==asset::EF_R8G8B8A8_SRGB);
 		for (uint32_t i=0u; i<Height; ++i)
-		for (uint32_t j=0u; j<Width;)
-		{
-			uint32_t in = reinterpret_cast<uint16_t*>(RowPointers[i])[j];
-			j++;
-			auto& out = reinterpret_cast<uint32_t*>(RowPointers[i])[Width-j];
-			out = in|(in << 16u); // LXLA
-			out &= 0xffff00ffu;
-			out |= (in&0xffu) << 8u;
-		}
+			expandLumaAlpha(RowPointers[i],Width);
 	}
     _NBL_DELETE_ARRAY(RowPointers, Height);
 	png_destroy_read_struct(&png_ptr,&info_ptr, 0); // Clean up memory
@@ -30,6 +30,8 @@ public:
         // Made file_pos initial value 8 cause it's first set to 8 in CImageLoaderPng::loadAsset
         // and set to 8 but you cannot access this struct from there
         size_t file_pos = 8;
+        //! libpng asks for a few bytes at a time (chunk headers, CRCs), those get copied straight out of the mapping when the file has one
+        const uint8_t* mappedFile = nullptr;
         system::logger_opt_ptr logger;
     };
     explicit CImageLoaderPng() {}
@@ -4,10 +4,55 @@
 
 #include "nbl/asset/interchange/IImageLoader.h"
 
+#include "nbl/system/IFile.h"
+
 using namespace nbl;
 using namespace asset;
 
 IImageLoader::~IImageLoader()
 {
 
-}
\ No newline at end of file
+}
+
+namespace
+{
+//! Doesn't own the memory it "frees", only keeps alive the file whose mapping the memory belongs to
+struct SFileMappingAllocator
+{
+	using value_type = uint8_t;
+	using pointer = uint8_t*;
+
+	inline void deallocate(pointer, const size_t) {file = nullptr;}
+
+	core::smart_refctd_ptr<system::IFile> file;
+};
+}
+
+core::smart_refctd_ptr<ICPUBuffer> IImageLoader::createBufferOverFileMapping(const SAssetLoadParams& params, system::IFile* file, const size_t offset, const size_t size)
+{
+	if (!(params.loaderFlags&ELPF_ALIAS_FILE_MAPPING))
+		return nullptr;
+	const auto* mapped = reinterpret_cast<const uint8_t*>(static_cast<const system::IFile*>(file)->getMappedPointer());
+	if (!mapped || offset+size>file->getSize())
+		return nullptr;
+	// the buffer interface hands out mutable pointers, the memory itself is only writable if the file was opened for writing
+	auto* data = const_cast<uint8_t*>(mapped)+offset;
+	return core::make_smart_refctd_ptr<CCustomAllocatorCPUBuffer<SFileMappingAllocator,true>>(size,data,core::adopt_memory,SFileMappingAllocator{core::smart_refctd_ptr<system::IFile>(file)});
+}
+
+size_t IImageLoader::getLevelByteSize(const E_FORMAT format, const uint32_t width, const uint32_t height, const uint32_t depth, const uint32_t layers)
+{
+	const auto blockDims = asset::getBlockDimensions(format);
+	size_t retval = asset::getTexelOrBlockBytesize(format);
+	// rounding up to whole blocks in 64 bits, a dimension close to 2^32 would wrap in 32
+	const size_t factors[] = {
+		(size_t(width)+blockDims.x-1u)/blockDims.x,
+		(size_t(height)+blockDims.y-1u)/blockDims.y,
+		(size_t(depth)+blockDims.z-1u)/blockDims.z,
+		layers
+	};
+	for (const auto factor : factors)
+	if (!checkedMul(retval,factor))
+		return 0ull;
+	return retval;
+}
@@ -1207,8 +1207,27 @@ auto CMaterialCompilerGLSLBackendCommon::compile(SContext* _ctx, IR* _ir, E_GENE
 	res.usedRegisterCount = 0u;
 	res.globalPrefetchRegCountFlags = 0u;
 
-	for (const IR::INode* root : _ir->roots)
+	// hash-cons the IR first, so that materials with identical BxDF trees compile only once and share bsdfData
+	res.dedupReport.ir = _ir->deduplicate();
+	core::unordered_map<const IR::INode*, result_t::instr_streams_t> canonicalRootStreams;
+	// identical instruction ranges emitted by different trees also get shared
+	core::unordered_multimap<size_t, result_t::instr_streams_t> emittedInstrRanges;
+	core::unordered_multimap<size_t, uint32_t> emittedPrefetchRanges;
+
+	for (const IR::INode* _root : _ir->roots)
 	{
+		const IR::INode* root = _ir->getCanonicalNode(_root);
+		if (auto found = canonicalRootStreams.find(root); found != canonicalRootStreams.end())
+		{
+			const auto& streams = found->second;
+			res.streams.insert({_root,streams});
+			res.dedupReport.sharedMaterials++;
+			res.dedupReport.instructionCountBefore += streams.rem_and_pdf_count+streams.gen_choice_count+streams.norm_precomp_count;
+			res.dedupReport.prefetchCountBefore += streams.tex_prefetch_count;
+			continue;
+		}
+		res.dedupReport.compiledMaterials++;
+
 		uint32_t remainingRegisters = instr_stream::MAX_REGISTER_COUNT;
 
 		const size_t interm_bsdf_data_begin_ix = _ctx->bsdfData.size();
@@ -1328,23 +1347,58 @@ auto CMaterialCompilerGLSLBackendCommon::compile(SContext* _ctx, IR* _ir, E_GENE
 
 		result_t::instr_streams_t streams;
 		{
-			streams.offset = res.instructions.size();
-
 			streams.rem_and_pdf_count = rem_pdf_stream.size();
-			res.instructions.insert(res.instructions.end(), rem_pdf_stream.begin(), rem_pdf_stream.end());
-
 			streams.gen_choice_count = gen_choice_stream.size();
-			res.instructions.insert(res.instructions.end(), gen_choice_stream.begin(), gen_choice_stream.end());
-
 			streams.norm_precomp_count = normal_precomp_stream.size();
-			res.instructions.insert(res.instructions.end(), normal_precomp_stream.begin(), normal_precomp_stream.end());
+			traversal_t instructions;
+			instructions.reserve(streams.rem_and_pdf_count+streams.gen_choice_count+streams.norm_precomp_count);
+			instructions.insert(instructions.end(), rem_pdf_stream.begin(), rem_pdf_stream.end());
+			instructions.insert(instructions.end(), gen_choice_stream.begin(), gen_choice_stream.end());
+			instructions.insert(instructions.end(), normal_precomp_stream.begin(), normal_precomp_stream.end());
+			res.dedupReport.instructionCountBefore += instructions.size();
+
+			// all instruction fields are either relative to the start of the range or index global data (bsdfData), so equal ranges are interchangeable
+			const size_t instrHash = std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char*>(instructions.data()),instructions.size()*sizeof(instr_t)));
+			auto sameInstructions = [&](const result_t::instr_streams_t& other) -> bool
+			{
+				return other.rem_and_pdf_count==streams.rem_and_pdf_count && other.gen_choice_count==streams.gen_choice_count && other.norm_precomp_count==streams.norm_precomp_count &&
+					std::equal(instructions.begin(),instructions.end(),res.instructions.begin()+other.offset);
+			};
+			streams.offset = res.instructions.size();
+			{
+				auto range = emittedInstrRanges.equal_range(instrHash);
+				auto found = std::find_if(range.first,range.second,[&](const auto& item){return sameInstructions(item.second);});
+				if (found!=range.second)
+					streams.offset = found->second.offset;
+				else
+				{
+					res.instructions.insert(res.instructions.end(), instructions.begin(), instructions.end());
+					emittedInstrRanges.insert({instrHash,streams});
+				}
+			}
 
-			streams.prefetch_offset = res.prefetch_stream.size();
 			streams.tex_prefetch_count = tex_prefetch_stream.size();
-			res.prefetch_stream.insert(res.prefetch_stream.end(), tex_prefetch_stream.begin(), tex_prefetch_stream.end());
+			res.dedupReport.prefetchCountBefore += streams.tex_prefetch_count;
+			const size_t prefetchHash = std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char*>(tex_prefetch_stream.data()),tex_prefetch_stream.size()*sizeof(instr_stream::tex_prefetch::prefetch_instr_t)));
+			streams.prefetch_offset = res.prefetch_stream.size();
+			{
+				auto range = emittedPrefetchRanges.equal_range(prefetchHash);
+				auto found = std::find_if(range.first,range.second,[&](const auto& item) -> bool
+				{
+					return streams.tex_prefetch_count && memcmp(tex_prefetch_stream.data(),res.prefetch_stream.data()+item.second,streams.tex_prefetch_count*sizeof(instr_stream::tex_prefetch::prefetch_instr_t))==0;
+				});
+				if (found!=range.second)
+					streams.prefetch_offset = found->second;
+				else
+				{
+					res.prefetch_stream.insert(res.prefetch_stream.end(), tex_prefetch_stream.begin(), tex_prefetch_stream.end());
+					emittedPrefetchRanges.insert({prefetchHash,streams.prefetch_offset});
+				}
+			}
 		}
 
-		res.streams.insert({root,streams});
+		res.streams.insert({_root,streams});
+		canonicalRootStreams.insert({root,streams});
 
 		res.noNormPrecompStream = res.noNormPrecompStream && (streams.norm_precomp_count==0u);
 		res.noPrefetchStream = res.noPrefetchStream && (streams.tex_prefetch_count==0u);
@@ -1352,6 +1406,8 @@ auto CMaterialCompilerGLSLBackendCommon::compile(SContext* _ctx, IR* _ir, E_GENE
 	}
 
 	_ir->deinitTmpNodes();
+	res.dedupReport.instructionCountAfter = res.instructions.size();
+	res.dedupReport.prefetchCountAfter = res.prefetch_stream.size();
 
 	auto isAniso = [&res](instr_t _i) -> bool {
 		const instr_stream::E_OPCODE op = instr_stream::getOpcode(_i);
@@ -1437,6 +1493,20 @@ R"(
 	return res;
 }
 
+}
+void material_compiler::CMaterialCompilerGLSLBackendCommon::result_t::SDeduplicationReport::print(std::ostream& _out) const
+{
+	_out << "####### material compiler deduplication\n";
+	_out << "IR nodes: " << ir.nodeCountBefore << " -> " << ir.nodeCountAfter << "\n";
+	_out << "materials compiled: " << compiledMaterials << ", shared: " << sharedMaterials << "\n";
+	_out << "instructions: " << instructionCountBefore << " -> " << instructionCountAfter << "\n";
+	_out << "texture prefetch instructions: " << prefetchCountBefore << " -> " << prefetchCountAfter << "\n";
+	const size_t before = getBytesBefore();
+	const size_t after = getBytesAfter();
+	_out << "instruction buffer bytes: " << before << " -> " << after;
+	if (before)
+		_out << " (" << 100.0*double(before-after)/double(before) << "% smaller)";
+	_out << "\n";
 }
 void material_compiler::CMaterialCompilerGLSLBackendCommon::debugPrint(std::ostream& _out, const result_t::instr_streams_t& _streams, const result_t& _res, const SContext* _ctx) const
 {
@@ -435,8 +435,8 @@ core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::calculateSmoothNormals(
 	return outbuffer;
 }
 
-// Used by createMeshBufferWelded only
-static bool cmpVertices(ICPUMeshBuffer* _inbuf, const void* _va, const void* _vb, size_t _vsize, const IMeshManipulator::SErrorMetric* _errMetrics)
+// Used by createMeshBufferWelded only, `_decoded[i]` holds the floating point attribute `i` of all the vertices decoded in SoA form (see `getAttributes`)
+static bool cmpVertices(ICPUMeshBuffer* _inbuf, const void* _va, const void* _vb, const uint32_t _ia, const uint32_t _ib, const core::vector<float>* _decoded, const uint32_t _vertexCount, const IMeshManipulator::SErrorMetric* _errMetrics)
 {
     auto cmpInteger = [](uint32_t* _a, uint32_t* _b, size_t _n) -> bool {
         return !memcmp(_a, _b, _n*4);
@@ -463,10 +463,10 @@ static bool cmpVertices(ICPUMeshBuffer* _inbuf, const void* _va, const void* _vb
         }
         else
         {
-            core::vectorSIMDf attr[2];
-            ICPUMeshBuffer::getAttribute(attr[0], va, atype);
-            ICPUMeshBuffer::getAttribute(attr[1], vb, atype);
-            if (!IMeshManipulator::compareFloatingPointAttribute(attr[0], attr[1], cpa, _errMetrics[i]))
+            const float* soa = _decoded[i].data();
+            const core::vectorSIMDf attrA(soa[_ia],soa[_vertexCount+_ia],soa[2u*_vertexCount+_ia],soa[3u*_vertexCount+_ia]);
+            const core::vectorSIMDf attrB(soa[_ib],soa[_vertexCount+_ib],soa[2u*_vertexCount+_ib],soa[3u*_vertexCount+_ib]);
+            if (!IMeshManipulator::compareFloatingPointAttribute(attrA, attrB, cpa, _errMetrics[i]))
                 return false;
         }
 
@@ -502,16 +502,39 @@ core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createMeshBufferWelded(
         }
     }
 
-    auto cmpfunc = [&, inbuffer, vertexSize, _errMetrics](const void* _va, const void* _vb) {
-        return cmpVertices(inbuffer, _va, _vb, vertexSize, _errMetrics);
-    };
-
     const uint32_t vertexCount = IMeshManipulator::upperBoundVertexID(inbuffer);
     const E_INDEX_TYPE oldIndexType = inbuffer->getIndexType();
 
     if (!vertexCount)
         return nullptr;
 
+    // every vertex gets compared against all the others, so decode the floating point attributes once up front instead of twice per comparison
+    core::vector<float> decoded[MAX_ATTRIBS];
+    for (uint32_t k=0u; k<MAX_ATTRIBS; k++)
+    {
+        if (!bufferPresent[k])
+            continue;
+        const auto atype = inbuffer->getAttribFormat(k);
+        if (isIntegerFormat(atype) || isScaledFormat(atype))
+            continue;
+        decoded[k].resize(size_t(vertexCount)*4u);
+        if (inbuffer->getAttributes(k,0u,vertexCount,decoded[k].data()))
+            continue;
+        // formats the batch decode doesn't handle
+        core::vectorSIMDf attr;
+        for (uint32_t i=0u; i<vertexCount; i++)
+        {
+            attr.set(0.f,0.f,0.f,1.f);
+            inbuffer->getAttribute(attr,k,i);
+            for (uint32_t c=0u; c<4u; c++)
+                decoded[k][c*vertexCount+i] = attr[c];
+        }
+    }
+
+    auto cmpfunc = [&, inbuffer, vertexCount, _errMetrics](const uint8_t* _va, const uint8_t* _vb, const uint32_t _ia, const uint32_t _ib) {
+        return cmpVertices(inbuffer, _va, _vb, _ia, _ib, decoded, vertexCount, _errMetrics);
+    };
+
     // reset redirect list
     uint32_t* redirects = new uint32_t[vertexCount];
 
@@ -540,7 +563,7 @@ core::smart_refctd_ptr<ICPUMeshBuffer> IMeshManipulator::createMeshBufferWelded(
         {
             if (i == j)
                 continue;
-            if (cmpfunc(epicData+vertexSize*i, epicData+vertexSize*j))
+            if (cmpfunc(epicData+vertexSize*i, epicData+vertexSize*j, i, j))
             {
                 redir = j;
                 break;
@@ -858,11 +881,13 @@ void IMeshManipulator::requantizeMeshBuffer(ICPUMeshBuffer* _meshbuffer, const S
 		if (itf != attribsF.end())
 		{
 			const core::vector<core::vectorSIMDf>& attrVec = itf->second;
-			for (size_t ai = 0u; ai < attrVec.size(); ++ai)
-			{
-				const bool check = _meshbuffer->setAttribute(attrVec[ai], newAttribs[i].vaid, ai);
-				_NBL_DEBUG_BREAK_IF(!check)
-			}
+			const size_t cnt = attrVec.size();
+			core::vector<float> attrSoA(cnt*4u);
+			for (size_t ai = 0u; ai < cnt; ++ai)
+			for (uint32_t c = 0u; c < 4u; ++c)
+				attrSoA[c*cnt+ai] = attrVec[ai].pointer[c];
+			const bool check = _meshbuffer->setAttributes(newAttribs[i].vaid, 0u, cnt, attrSoA.data());
+			_NBL_DEBUG_BREAK_IF(!check)
 		}
 	}
 }
@@ -938,18 +963,38 @@ core::vector<core::vectorSIMDf> CMeshManipulator::findBetterFormatF(E_FORMAT* _o
 	float min[4]{ FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
 	float max[4]{ -FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX };
 
-	core::vectorSIMDf attr;
     const uint32_t cnt = IMeshManipulator::upperBoundVertexID(_meshbuffer);
-    for (uint32_t idx = 0u; idx < cnt; ++idx)
+	core::vector<float> attribsSoA(size_t(cnt)*4u);
+	if (_meshbuffer->getAttributes(_attrId, 0u, cnt, attribsSoA.data()))
 	{
-        _meshbuffer->getAttribute(attr, _attrId, idx);
-		attribs.push_back(attr);
-		for (uint32_t i = 0; i < cpa ; ++i)
+		// the ranges are found per channel over contiguous arrays
+		for (uint32_t i = 0; i < cpa; ++i)
+		{
+			const float* channel = attribsSoA.data() + size_t(i)*cnt;
+			for (uint32_t idx = 0u; idx < cnt; ++idx)
+			{
+				min[i] = core::min(min[i], channel[idx]);
+				max[i] = core::max(max[i], channel[idx]);
+			}
+		}
+		attribs.resize(cnt);
+		for (uint32_t idx = 0u; idx < cnt; ++idx)
+			attribs[idx].set(attribsSoA[idx], attribsSoA[cnt+idx], attribsSoA[2u*cnt+idx], attribsSoA[3u*cnt+idx]);
+	}
+	else
+	{
+		core::vectorSIMDf attr;
+		for (uint32_t idx = 0u; idx < cnt; ++idx)
 		{
-			if (attr.pointer[i] < min[i])
-				min[i] = attr.pointer[i];
-			if (attr.pointer[i] > max[i])
-				max[i] = attr.pointer[i];
+			_meshbuffer->getAttribute(attr, _attrId, idx);
+			attribs.push_back(attr);
+			for (uint32_t i = 0; i < cpa ; ++i)
+			{
+				if (attr.pointer[i] < min[i])
+					min[i] = attr.pointer[i];
+				if (attr.pointer[i] > max[i])
+					max[i] = attr.pointer[i];
+			}
 		}
 	}
 
@@ -54,8 +54,15 @@ void COverdrawMeshOptimizer::createOptimized(asset::ICPUMeshBuffer* _outbuffer,
 
 	const uint32_t vertexCount = IMeshManipulator::upperBoundVertexID(_inbuffer);
 	core::vector<core::vectorSIMDf> vertexPositions(vertexCount);
-	for (uint32_t i=0u; i<vertexCount; ++i)
-		_inbuffer->getAttribute(vertexPositions[i],_inbuffer->getPositionAttributeIx(),i);
+	{
+		core::vector<float> positionsSoA(size_t(vertexCount)*4u);
+		if (_inbuffer->getAttributes(_inbuffer->getPositionAttributeIx(),0u,vertexCount,positionsSoA.data()))
+		for (uint32_t i=0u; i<vertexCount; ++i)
+			vertexPositions[i].set(positionsSoA[i],positionsSoA[vertexCount+i],positionsSoA[2u*vertexCount+i],positionsSoA[3u*vertexCount+i]);
+		else // formats the batch decode doesn't handle
+		for (uint32_t i=0u; i<vertexCount; ++i)
+			_inbuffer->getAttribute(vertexPositions[i],_inbuffer->getPositionAttributeIx(),i);
+	}
 
 	uint32_t* const hardClusters = reinterpret_cast<uint32_t*>(_NBL_ALIGNED_MALLOC((idxCount/3)*sizeof(uint32_t),_NBL_SIMD_ALIGNMENT));
 	const size_t hardClusterCount = indexType == asset::EIT_16BIT ?
@@ -167,6 +167,17 @@ CSmoothNormalGenerator::VertexHashMap CSmoothNormalGenerator::setupData(const as
 
 	core::vector3df_SIMD faceNormal;
 
+	//decode all positions up front
+	const uint32_t vertexCount = IMeshManipulator::upperBoundVertexID(buffer);
+	core::vector<float> positions(size_t(vertexCount) * 4u);
+	const bool batched = buffer->getAttributes(buffer->getPositionAttributeIx(), 0u, vertexCount, positions.data());
+	auto getPosition = [&](const uint32_t ix) -> core::vectorSIMDf
+	{
+		if (!batched)
+			return buffer->getPosition(ix);
+		return core::vectorSIMDf(positions[ix], positions[vertexCount + ix], positions[2u * vertexCount + ix], positions[3u * vertexCount + ix]);
+	};
+
 	for (uint32_t i = 0; i < idxCount; i += 3)
 	{
 		const uint32_t ix[3]{
@@ -175,9 +186,9 @@ CSmoothNormalGenerator::VertexHashMap CSmoothNormalGenerator::setupData(const as
 			buffer->getIndexValue(i + 2)
 		};
 		//calculate face normal of parent triangle
-		core::vectorSIMDf v1 = buffer->getPosition(ix[0]);
-		core::vectorSIMDf v2 = buffer->getPosition(ix[1]);
-		core::vectorSIMDf v3 = buffer->getPosition(ix[2]);
+		core::vectorSIMDf v1 = getPosition(ix[0]);
+		core::vectorSIMDf v2 = getPosition(ix[1]);
+		core::vectorSIMDf v3 = getPosition(ix[2]);
 
 		faceNormal = core::cross(v2 - v1, v3 - v1);
 		faceNormal = core::normalize(faceNormal);
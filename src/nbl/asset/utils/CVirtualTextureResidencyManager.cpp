@@ -0,0 +1,333 @@
+// Copyright (C) 2018-2022 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/asset/utils/CVirtualTextureResidencyManager.h"
+
+
+using namespace nbl;
+using namespace asset;
+
+
+bool CVirtualTextureResidencyManager::CImageTileSource::readTile(const uint32_t mip, const uint32_t x, const uint32_t y, const uint32_t pageExtent, const uint32_t padding, const uint32_t texelBytes, void* dst) const
+{
+	if (mip>=m_image->getCreationParameters().mipLevels)
+		return false;
+
+	const ISampler::E_TEXTURE_CLAMP wraps[3] = {m_wrapU,m_wrapV,ISampler::ETC_CLAMP_TO_EDGE};
+	const int32_t paddedExtent = pageExtent+2u*padding;
+	const core::vectorSIMDi32 tileOrigin(int32_t(x*pageExtent)-int32_t(padding),int32_t(y*pageExtent)-int32_t(padding),0,0);
+	const int32_t mipWidth = m_image->getMipSize(mip).x;
+
+	auto* out = reinterpret_cast<uint8_t*>(dst);
+	core::vectorSIMDu32 dummy;
+	for (int32_t row=0; row<paddedExtent; row++)
+	{
+		const int32_t firstInside = core::max(-tileOrigin.x,0);
+		int32_t lastInside = core::min(mipWidth-tileOrigin.x,paddedExtent)-1;
+		// the run of texels that needs no wrapping can be copied in one go if it doesn't straddle regions
+		if (firstInside<=lastInside)
+		{
+			const auto first = m_image->wrapTextureCoordinate(mip,tileOrigin+core::vectorSIMDi32(firstInside,row,0,0),wraps);
+			const auto last = m_image->wrapTextureCoordinate(mip,tileOrigin+core::vectorSIMDi32(lastInside,row,0,0),wraps);
+			const auto* firstPtr = reinterpret_cast<const uint8_t*>(m_image->getTexelBlockData(mip,first,dummy));
+			const auto* lastPtr = reinterpret_cast<const uint8_t*>(m_image->getTexelBlockData(mip,last,dummy));
+			const size_t runBytes = size_t(lastInside-firstInside)*texelBytes;
+			if (firstPtr && lastPtr && lastPtr==firstPtr+runBytes)
+				memcpy(out+size_t(firstInside)*texelBytes,firstPtr,runBytes+texelBytes);
+			else
+				firstPtr = nullptr;
+			if (!firstPtr)
+				lastInside = firstInside-1; // fall through to the per-texel path for the whole row
+		}
+		for (int32_t col=0; col<paddedExtent; col++)
+		{
+			if (col>=firstInside && col<=lastInside)
+				continue;
+			const auto coord = m_image->wrapTextureCoordinate(mip,tileOrigin+core::vectorSIMDi32(col,row,0,0),wraps);
+			const void* texel = m_image->getTexelBlockData(mip,coord,dummy);
+			if (!texel)
+				return false;
+			memcpy(out+size_t(col)*texelBytes,texel,texelBytes);
+		}
+		out += size_t(paddedExtent)*texelBytes;
+	}
+	return true;
+}
+
+
+CVirtualTextureResidencyManager::CFileTileSource::CFileTileSource(core::smart_refctd_ptr<system::IFile>&& file, const size_t baseOffset, const VkExtent3D& mip0Extent, const uint32_t mipLevels, const uint32_t pageExtent) :
+	m_file(std::move(file)), m_baseOffset(baseOffset)
+{
+	uint32_t firstTile = 0u;
+	for (uint32_t i=0u; i<mipLevels; i++)
+	{
+		const uint32_t tilesX = (core::max(mip0Extent.width>>i,1u)+pageExtent-1u)/pageExtent;
+		const uint32_t tilesY = (core::max(mip0Extent.height>>i,1u)+pageExtent-1u)/pageExtent;
+		m_mipLayout.emplace_back(firstTile,tilesX);
+		firstTile += tilesX*tilesY;
+	}
+}
+
+bool CVirtualTextureResidencyManager::CFileTileSource::readTile(const uint32_t mip, const uint32_t x, const uint32_t y, const uint32_t pageExtent, const uint32_t padding, const uint32_t texelBytes, void* dst) const
+{
+	if (mip>=m_mipLayout.size())
+		return false;
+
+	const size_t paddedExtent = pageExtent+2u*padding;
+	const size_t tileBytes = paddedExtent*paddedExtent*texelBytes;
+	const size_t tileIndex = m_mipLayout[mip].first+y*m_mipLayout[mip].second+x;
+
+	system::IFile::success_t success;
+	m_file->read(success,dst,m_baseOffset+tileIndex*tileBytes,tileBytes);
+	return bool(success);
+}
+
+
+void CVirtualTextureResidencyManager::CTileLoader::process_request(base_t::future_base_t* _future_base, SLoadRequest& req)
+{
+	const bool success = req.source->readTile(req.tile.getMipLevel(),req.tile.getX(),req.tile.getY(),req.pageExtent,req.padding,req.texelBytes,req.dst);
+	base_t::future_storage_cast<bool>(_future_base)->construct(success);
+}
+
+
+core::smart_refctd_ptr<CVirtualTextureResidencyManager> CVirtualTextureResidencyManager::create(SCreationParams&& params)
+{
+	if (!params.virtualTexture || params.loaderThreadCount==0u || params.maxTilesInFlight==0u)
+		return nullptr;
+
+	auto* storage = static_cast<ICPUVirtualTexture::ICPUVTResidentStorage*>(params.virtualTexture->getStorageForFormatClass(params.formatClass));
+	if (!storage || !storage->image || isBlockCompressionFormat(storage->imageFormat))
+		return nullptr;
+
+	const uint32_t freeTiles = storage->tileAlctr.get_free_size();
+	const uint32_t budget = params.residentTileBudget ? core::min(params.residentTileBudget,freeTiles):freeTiles;
+	if (budget<2u) // `core::LRUCache` needs a capacity of at least 2
+		return nullptr;
+
+	return core::smart_refctd_ptr<CVirtualTextureResidencyManager>(new CVirtualTextureResidencyManager(std::move(params),storage,budget),core::dont_grab);
+}
+
+CVirtualTextureResidencyManager::CVirtualTextureResidencyManager(SCreationParams&& params, ICPUVirtualTexture::ICPUVTResidentStorage* storage, const uint32_t residentTileBudget) :
+	m_vt(std::move(params.virtualTexture)), m_storage(storage), m_formatClass(params.formatClass), m_texelBytes(getTexelOrBlockBytesize(storage->imageFormat)),
+	m_residentTileBudget(residentTileBudget), m_residentTiles(residentTileBudget,[this](tile_cache_t::assoc_t& entry) -> void {evictTile(entry.first,entry.second);})
+{
+	m_slots.resize(params.maxTilesInFlight);
+	for (auto& slot : m_slots)
+		slot = std::make_unique<SLoadSlot>();
+	m_loaders.resize(params.loaderThreadCount);
+	for (auto& loader : m_loaders)
+		loader = std::make_unique<CTileLoader>();
+}
+
+CVirtualTextureResidencyManager::~CVirtualTextureResidencyManager()
+{
+	// loader threads write into the staging memory of the slots
+	for (auto& slot : m_slots)
+	if (slot->inFlight)
+		slot->future.wait();
+	// give back all physical tiles and leave the page table consistent
+	for (const auto& texture : m_textures)
+		evictAllTiles(texture.first,texture.second);
+	m_textures.clear();
+	flushPageTableUpdates();
+}
+
+
+bool CVirtualTextureResidencyManager::registerTexture(const texture_data_t& texture, core::smart_refctd_ptr<ITileSource>&& source)
+{
+	if (!source || texture_data_t::is_invalid(texture))
+		return false;
+	if (getFormatClass(m_vt->getFormatInLayer(texture.pgTab_layer))!=m_formatClass)
+		return false;
+
+	SRegisteredTexture registered;
+	registered.source = std::move(source);
+	registered.extent = {static_cast<uint32_t>(texture.origsize_x),static_cast<uint32_t>(texture.origsize_y),1u};
+	registered.managedLevels = m_vt->countLevelsTakingAtLeastOnePage(registered.extent);
+	return m_textures.emplace(getTextureKey(texture),std::move(registered)).second;
+}
+
+void CVirtualTextureResidencyManager::unregisterTexture(const texture_data_t& texture)
+{
+	const uint32_t key = getTextureKey(texture);
+	auto found = m_textures.find(key);
+	if (found==m_textures.end())
+		return;
+
+	evictAllTiles(key,found->second);
+	// queued and in-flight loads get dropped once they notice the texture is gone
+	m_textures.erase(found);
+}
+
+void CVirtualTextureResidencyManager::evictAllTiles(const uint32_t textureKey, const SRegisteredTexture& texture)
+{
+	for (uint32_t mip=0u; mip<texture.managedLevels; mip++)
+	{
+		const uint32_t w = m_vt->neededPageCountForSide(texture.extent.width,mip);
+		const uint32_t h = m_vt->neededPageCountForSide(texture.extent.height,mip);
+		for (uint32_t y=0u; y<h; y++)
+		for (uint32_t x=0u; x<w; x++)
+			m_residentTiles.erase(STileID(textureKey,mip,x,y));
+	}
+}
+
+const CVirtualTextureResidencyManager::SRegisteredTexture* CVirtualTextureResidencyManager::getRegisteredTexture(const STileID tile) const
+{
+	auto found = m_textures.find(tile.getTextureKey());
+	if (found==m_textures.end())
+		return nullptr;
+
+	const auto& registered = found->second;
+	const uint32_t mip = tile.getMipLevel();
+	if (mip>=registered.managedLevels)
+		return nullptr;
+	if (tile.getX()>=m_vt->neededPageCountForSide(registered.extent.width,mip) || tile.getY()>=m_vt->neededPageCountForSide(registered.extent.height,mip))
+		return nullptr;
+	return &registered;
+}
+
+
+void CVirtualTextureResidencyManager::processFeedback(const STileID* requests, const uint32_t count)
+{
+	// the new feedback supersedes whatever didn't get dispatched yet
+	for (const auto& tile : m_queuedTiles)
+		m_pendingTiles.erase(tile);
+	m_queuedTiles.clear();
+
+	for (uint32_t i=0u; i<count; i++)
+	{
+		const auto& tile = requests[i];
+		if (tile.packed==STileID::invalid || !getRegisteredTexture(tile))
+			continue;
+		if (m_residentTiles.get(tile)) // marks as most recently used
+			continue;
+		if (m_pendingTiles.insert(tile).second)
+			m_queuedTiles.push_back(tile);
+	}
+	// coarser levels first, they cover more of the screen and make a better fallback
+	std::stable_sort(m_queuedTiles.begin(),m_queuedTiles.end(),[](const STileID& lhs, const STileID& rhs) -> bool
+	{
+		return lhs.getMipLevel()>rhs.getMipLevel();
+	});
+}
+
+uint32_t CVirtualTextureResidencyManager::commitLoadedTiles(const uint32_t maxTileUploads)
+{
+	uint32_t uploaded = 0u;
+	for (auto& slot : m_slots)
+	{
+		if (!slot->inFlight || uploaded>=maxTileUploads)
+			continue;
+		auto lock = slot->future.try_acquire();
+		if (!lock)
+			continue;
+		const bool success = *lock;
+		lock.discard();
+
+		slot->inFlight = false;
+		m_tilesInFlight--;
+		m_pendingTiles.erase(slot->tile);
+		const auto* registered = getRegisteredTexture(slot->tile);
+		if (success && registered && registered->source.get()==slot->source.get())
+		{
+			uploadTile(slot->tile,slot->staging.data());
+			uploaded++;
+		}
+		slot->source = nullptr;
+	}
+
+	// hand the queued tiles to the loaders
+	const uint32_t paddedExtent = m_vt->getPageExtent()+2u*m_vt->getTilePadding();
+	auto queued = m_queuedTiles.begin();
+	for (auto& slot : m_slots)
+	{
+		if (slot->inFlight)
+			continue;
+		const SRegisteredTexture* registered = nullptr;
+		for (; queued!=m_queuedTiles.end() && !(registered=getRegisteredTexture(*queued)); queued++)
+			m_pendingTiles.erase(*queued);
+		if (queued==m_queuedTiles.end())
+			break;
+
+		slot->tile = *(queued++);
+		slot->source = registered->source;
+		slot->staging.resize(size_t(paddedExtent)*paddedExtent*m_texelBytes);
+		slot->inFlight = true;
+		m_tilesInFlight++;
+		auto& loader = m_loaders[m_nextLoader++%m_loaders.size()];
+		loader->request(&slot->future,slot->source.get(),slot->tile,m_vt->getPageExtent(),m_vt->getTilePadding(),m_texelBytes,slot->staging.data());
+	}
+	m_queuedTiles.erase(m_queuedTiles.begin(),queued);
+	return uploaded;
+}
+
+void CVirtualTextureResidencyManager::uploadTile(const STileID tile, const uint8_t* texels)
+{
+	// insert a placeholder first, if the cache is full this evicts the least recently used tile and frees up its physical page
+	m_residentTiles.insert(tile,phys_pg_addr_alctr_t::invalid_address);
+	uint32_t addr = phys_pg_addr_alctr_t::invalid_address;
+	const uint32_t szAndAlignment = 1u;
+	core::address_allocator_traits<phys_pg_addr_alctr_t>::multi_alloc_addr(m_storage->tileAlctr,1u,&addr,&szAndAlignment,&szAndAlignment,nullptr);
+	if (addr==phys_pg_addr_alctr_t::invalid_address)
+	{
+		m_residentTiles.erase(tile);
+		return;
+	}
+	*m_residentTiles.peek(tile) = addr;
+	m_residentTileCount++;
+
+	const uint32_t pgAddr = m_storage->encodePageAddress(addr);
+	const uint32_t padding = m_vt->getTilePadding();
+	const uint32_t paddedExtent = m_vt->getPageExtent()+2u*padding;
+	core::vector3du32_SIMD physPg = ICPUVirtualTexture::ICPUVTResidentStorage::pageCoords(pgAddr,m_vt->getPageExtent(),padding);
+	physPg -= core::vector2du32_SIMD(padding,padding);
+
+	const size_t rowBytes = size_t(paddedExtent)*m_texelBytes;
+	core::vectorSIMDu32 dummy;
+	for (uint32_t row=0u; row<paddedExtent; row++)
+	{
+		void* dst = m_storage->image->getTexelBlockData(0u,core::vectorSIMDu32(physPg.x,physPg.y+row,0u,physPg.z),dummy);
+		memcpy(dst,texels+row*rowBytes,rowBytes);
+	}
+	queuePageTableUpdate(tile,pgAddr);
+}
+
+void CVirtualTextureResidencyManager::evictTile(const STileID tile, const uint32_t physAddr)
+{
+	if (physAddr==phys_pg_addr_alctr_t::invalid_address) // placeholder
+		return;
+	const uint32_t sz = 1u;
+	core::address_allocator_traits<phys_pg_addr_alctr_t>::multi_free_addr(m_storage->tileAlctr,1u,&physAddr,&sz);
+	m_residentTileCount--;
+	queuePageTableUpdate(tile,ICPUVirtualTexture::SPhysPgOffset::invalid_addr);
+}
+
+
+const core::vector<CVirtualTextureResidencyManager::SPageTableUpdate>& CVirtualTextureResidencyManager::flushPageTableUpdates()
+{
+	m_flushedPageTableUpdates.clear();
+	// stable, so that for repeated writes to the same texel the last one stays last
+	std::stable_sort(m_pageTableUpdates.begin(),m_pageTableUpdates.end(),[](const SPageTableUpdate& lhs, const SPageTableUpdate& rhs) -> bool
+	{
+		return std::tie(lhs.pageTableLayer,lhs.mipLevel,lhs.y,lhs.x)<std::tie(rhs.pageTableLayer,rhs.mipLevel,rhs.y,rhs.x);
+	});
+
+	using SPhysPgOffset = ICPUVirtualTexture::SPhysPgOffset;
+	auto* pageTable = m_vt->getPageTable();
+	core::vectorSIMDu32 dummy;
+	for (auto it=m_pageTableUpdates.begin(); it!=m_pageTableUpdates.end(); it++)
+	{
+		const auto next = it+1;
+		if (next!=m_pageTableUpdates.end() && next->pageTableLayer==it->pageTableLayer && next->mipLevel==it->mipLevel && next->x==it->x && next->y==it->y)
+			continue;
+
+		auto* texel = reinterpret_cast<uint32_t*>(pageTable->getTexelBlockData(it->mipLevel,core::vectorSIMDu32(it->x,it->y,0u,it->pageTableLayer),dummy));
+		// keep the mip-tail address in the upper bits
+		*texel = ((*texel)&~SPhysPgOffset::PAGE_ADDR_MASK)|(it->value&SPhysPgOffset::PAGE_ADDR_MASK);
+		auto& flushed = m_flushedPageTableUpdates.emplace_back(*it);
+		flushed.value = *texel;
+	}
+	m_pageTableUpdates.clear();
+	return m_flushedPageTableUpdates;
+}
@@ -0,0 +1,18 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/core/alloc/PoolAddressAllocator.h"
+#include "nbl/core/alloc/TLSFAddressAllocator.h"
+#include "nbl/core/alloc/GeneralpurposeAddressAllocator.h"
+
+#include <mutex>
+
+// The adaptors are header-only templates, so their members only get compiled when something calls them.
+// Instantiate the common ones in full so that every member (the const queries and `fill_statistics` especially) keeps compiling.
+namespace nbl::core
+{
+template class AddressAllocatorBasicConcurrencyAdaptor<PoolAddressAllocator<uint32_t>,std::recursive_mutex>;
+template class AddressAllocatorBasicConcurrencyAdaptor<TLSFAddressAllocator<uint32_t>,std::recursive_mutex>;
+template class AddressAllocatorBasicConcurrencyAdaptor<GeneralpurposeAddressAllocator<uint32_t>,std::recursive_mutex>;
+}
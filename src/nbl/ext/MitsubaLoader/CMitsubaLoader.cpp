@@ -1234,6 +1234,7 @@ inline core::smart_refctd_ptr<asset::ICPUDescriptorSet> CMitsubaLoader::createDS
 
 #ifdef DEBUG_MITSUBA_LOADER
 	std::ofstream ofile("log.txt");
+	_compResult.dedupReport.print(ofile);
 #endif
 	core::vector<nbl_glsl_ext_Mitsuba_Loader_instance_data_t> instanceData;
 	for (auto it=meshBegin; it != meshEnd; ++it)
@@ -0,0 +1,283 @@
+// Copyright (C) 2018-2022 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/scene/CAnimationEngineCPU.h"
+
+
+using namespace nbl;
+using namespace scene;
+
+
+core::smart_refctd_ptr<CAnimationEngineCPU> CAnimationEngineCPU::create(SCreationParams&& params)
+{
+	if (!params.library || !params.skeleton)
+		return nullptr;
+
+	const joint_id_t jointCount = params.skeleton->getJointCount();
+	// order joints so that parents always get evaluated before children, loaders usually already produce this order
+	core::vector<joint_id_t> evaluationOrder;
+	evaluationOrder.reserve(jointCount);
+	{
+		core::vector<uint8_t> visited(jointCount,0u);
+		core::stack<joint_id_t> chain;
+		for (joint_id_t j=0u; j<jointCount; j++)
+		{
+			// range check before `visited` gets indexed, a malformed parent ID is exactly what this rejects
+			for (auto k=j; k!=skeleton_t::invalid_joint_id; k=params.skeleton->getParentJointID(k))
+			{
+				if (k>=jointCount || chain.size()>=jointCount) // out of range parent or a cycle
+					return nullptr;
+				if (visited[k])
+					break;
+				chain.push(k);
+			}
+			for (; !chain.empty(); chain.pop())
+			{
+				visited[chain.top()] = 1u;
+				evaluationOrder.push_back(chain.top());
+			}
+		}
+	}
+	return core::smart_refctd_ptr<CAnimationEngineCPU>(new CAnimationEngineCPU(std::move(params),std::move(evaluationOrder)),core::dont_grab);
+}
+
+CAnimationEngineCPU::CAnimationEngineCPU(SCreationParams&& params, core::vector<joint_id_t>&& evaluationOrder) :
+	m_library(std::move(params.library)), m_skeleton(std::move(params.skeleton)), m_jointCount(m_skeleton->getJointCount()),
+	m_rotationInterpolation(params.rotationInterpolation), m_evaluationOrder(std::move(evaluationOrder)),
+	m_instances(params.instanceCount), m_cursors(size_t(params.instanceCount)*MaxBlendsPerInstance*m_jointCount,0u),
+	m_globalTransforms(size_t(params.instanceCount)*m_jointCount), m_batchIndices((params.instanceCount+BatchSize-1u)/BatchSize)
+{
+	std::iota(m_batchIndices.begin(),m_batchIndices.end(),0u);
+}
+
+
+bool CAnimationEngineCPU::sampleTrack(const animation_t track, const float time, uint32_t& cursor, SSampledPose& out) const
+{
+	const auto& animation = m_library->getAnimation(track);
+	const auto keyframeOffset = animation.getKeyframeOffset();
+	const uint32_t keyframeCount = animation.getKeyframeCount();
+	if (keyframeOffset==0xffffffffu || keyframeCount==0u)
+		return false;
+
+	const auto* timestamps = &m_library->getTimestamp(animation.getTimestampOffset());
+	auto sampleAt = [&](const uint32_t k) -> void
+	{
+		const auto& keyframe = m_library->getKeyframe(keyframeOffset+k);
+		out.rotation = core::normalize(keyframe.getRotationUnnormalized());
+		out.translation = keyframe.getTranslation();
+	};
+	// clamp to the ends of the track
+	if (keyframeCount==1u || time<=float(timestamps[0]))
+	{
+		cursor = 0u;
+		sampleAt(0u);
+		return true;
+	}
+	const uint32_t lastKeyframe = keyframeCount-1u;
+	if (time>=float(timestamps[lastKeyframe]))
+	{
+		cursor = lastKeyframe;
+		sampleAt(lastKeyframe);
+		return true;
+	}
+
+	// find `k` such that `timestamps[k]<=time<timestamps[k+1]`, try the cached cursor and its successor before searching
+	auto brackets = [&](const uint32_t k) -> bool
+	{
+		return k<lastKeyframe && float(timestamps[k])<=time && time<float(timestamps[k+1u]);
+	};
+	uint32_t k = cursor;
+	if (!brackets(k))
+	{
+		if (brackets(k+1u))
+			k++;
+		else
+			k = std::upper_bound(timestamps,timestamps+keyframeCount,time,[](const float t, const uint32_t stamp) -> bool {return t<float(stamp);})-timestamps-1u;
+	}
+	cursor = k;
+
+	const float t0 = timestamps[k];
+	float alpha = (time-t0)/(float(timestamps[k+1u])-t0);
+	switch (animation.getInterpolationMode())
+	{
+		case library_t::Animation::EIM_NEAREST:
+			sampleAt(alpha<0.5f ? k:(k+1u));
+			return true;
+		default: // TODO: cubic tangents are not stored in the library yet, fall back to linear
+			break;
+	}
+
+	const auto& first = m_library->getKeyframe(keyframeOffset+k);
+	const auto& second = m_library->getKeyframe(keyframeOffset+k+1u);
+	out.translation = core::mix(first.getTranslation(),second.getTranslation(),core::vectorSIMDf(alpha));
+	if (m_rotationInterpolation==ERI_SLERP)
+	{
+		const auto q = core::quaternion::slerp(first.getRotation(),second.getRotation(),alpha);
+		out.rotation = reinterpret_cast<const core::vectorSIMDf&>(q);
+	}
+	else
+	{
+		const auto q0 = first.getRotationUnnormalized();
+		auto q1 = second.getRotationUnnormalized();
+		if (core::dot(q0,q1).x<0.f)
+			q1 = -q1;
+		out.rotation = core::normalize(core::mix(q0,q1,core::vectorSIMDf(alpha)));
+	}
+	return true;
+}
+
+
+namespace
+{
+// one 3x4 matrix with every element holding `BatchSize` instances
+struct SSoAMatrix
+{
+	core::vectorSIMDf m[3][4];
+};
+}
+
+void CAnimationEngineCPU::updateBatch(const uint32_t batchIx)
+{
+	static_assert(BatchSize==4u,"SoA propagation assumes one instance per SSE lane");
+	const uint32_t firstInstance = batchIx*BatchSize;
+	const uint32_t laneCount = core::min(BatchSize,getInstanceCount()-firstInstance);
+
+	thread_local core::vector<SSoAMatrix> globals;
+	globals.resize(m_jointCount);
+	for (const auto j : m_evaluationOrder)
+	{
+		// sample and blend the local pose of every lane
+		core::vectorSIMDf rotation[4]; // SoA x,y,z,w
+		core::vectorSIMDf translation[3];
+		bool usesDefault[BatchSize] = {true,true,true,true};
+		for (uint32_t lane=0u; lane<laneCount; lane++)
+		{
+			const uint32_t instanceIx = firstInstance+lane;
+			const auto& instance = m_instances[instanceIx];
+			core::vectorSIMDf rotationAcc(0.f), translationAcc(0.f);
+			float weightSum = 0.f;
+			for (uint32_t b=0u; b<MaxBlendsPerInstance; b++)
+			{
+				const auto& blend = instance.blends[b];
+				if (blend.clip==InvalidClip || blend.weight<=0.f)
+					continue;
+				SSampledPose pose;
+				auto& cursor = m_cursors[(size_t(instanceIx)*MaxBlendsPerInstance+b)*m_jointCount+j];
+				if (!sampleTrack(blend.clip+j,blend.time,cursor,pose))
+					continue;
+				// keep all contributions in the same hemisphere as the accumulator
+				if (core::dot(rotationAcc,pose.rotation).x<0.f)
+					pose.rotation = -pose.rotation;
+				rotationAcc += pose.rotation*blend.weight;
+				translationAcc += pose.translation*blend.weight;
+				weightSum += blend.weight;
+			}
+			if (weightSum<=0.f)
+			{
+				rotation[0].pointer[lane] = rotation[1].pointer[lane] = rotation[2].pointer[lane] = 0.f;
+				rotation[3].pointer[lane] = 1.f;
+				translation[0].pointer[lane] = translation[1].pointer[lane] = translation[2].pointer[lane] = 0.f;
+				continue;
+			}
+			usesDefault[lane] = false;
+			rotationAcc = core::normalize(rotationAcc);
+			translationAcc /= weightSum;
+			for (uint32_t c=0u; c<4u; c++)
+				rotation[c].pointer[lane] = rotationAcc.pointer[c];
+			for (uint32_t c=0u; c<3u; c++)
+				translation[c].pointer[lane] = translationAcc.pointer[c];
+		}
+
+		// quaternion and translation to 3x4 matrix, 4 instances at a time
+		SSoAMatrix local;
+		{
+			const auto& x = rotation[0]; const auto& y = rotation[1]; const auto& z = rotation[2]; const auto& w = rotation[3];
+			const core::vectorSIMDf one(1.f), two(2.f);
+			const auto xx = x*x, yy = y*y, zz = z*z;
+			const auto xy = x*y, xz = x*z, yz = y*z;
+			const auto wx = w*x, wy = w*y, wz = w*z;
+			local.m[0][0] = one-two*(yy+zz); local.m[0][1] = two*(xy-wz); local.m[0][2] = two*(xz+wy); local.m[0][3] = translation[0];
+			local.m[1][0] = two*(xy+wz); local.m[1][1] = one-two*(xx+zz); local.m[1][2] = two*(yz-wx); local.m[1][3] = translation[1];
+			local.m[2][0] = two*(xz-wy); local.m[2][1] = two*(yz+wx); local.m[2][2] = one-two*(xx+yy); local.m[2][3] = translation[2];
+		}
+		// TODO: apply scale once `Keyframe::getScale` decodes RGB18E7S3
+		const auto& defaultTransform = m_skeleton->getDefaultTransformMatrix(j);
+		for (uint32_t lane=0u; lane<BatchSize; lane++)
+		if (usesDefault[lane])
+		{
+			for (uint32_t r=0u; r<3u; r++)
+			for (uint32_t c=0u; c<4u; c++)
+				local.m[r][c].pointer[lane] = defaultTransform.rows[r].pointer[c];
+		}
+
+		// global = parent*local
+		auto& global = globals[j];
+		const auto parent = m_skeleton->getParentJointID(j);
+		if (parent==skeleton_t::invalid_joint_id)
+			global = local;
+		else
+		{
+			const auto& p = globals[parent];
+			for (uint32_t r=0u; r<3u; r++)
+			{
+				for (uint32_t c=0u; c<4u; c++)
+					global.m[r][c] = p.m[r][0]*local.m[0][c]+p.m[r][1]*local.m[1][c]+p.m[r][2]*local.m[2][c];
+				global.m[r][3] += p.m[r][3];
+			}
+		}
+
+		// scatter back to Array-of-Structures for consumers
+		for (uint32_t lane=0u; lane<laneCount; lane++)
+		{
+			auto& out = m_globalTransforms[size_t(firstInstance+lane)*m_jointCount+j];
+			for (uint32_t r=0u; r<3u; r++)
+			for (uint32_t c=0u; c<4u; c++)
+				out.rows[r].pointer[c] = global.m[r][c].pointer[lane];
+		}
+	}
+}
+
+
+void CAnimationEngineCPU::computeSkinningMatrices(const uint32_t instanceIx, const joint_id_t* skinJoints, const core::matrix3x4SIMD* inverseBindPoses, const uint32_t count, core::matrix3x4SIMD* out) const
+{
+	const auto* globals = getGlobalJointTransforms(instanceIx);
+	for (uint32_t i=0u; i<count; i++)
+		out[i] = core::matrix3x4SIMD::concatenateBFollowedByA(globals[skinJoints[i]],inverseBindPoses[i]);
+}
+
+void CAnimationEngineCPU::skinRange(const SSkinningParams& params, const uint32_t begin, const uint32_t end)
+{
+	const bool hasNormals = params.inNormals[0];
+	for (uint32_t v=begin; v<end; v++)
+	{
+		const auto* jointIDs = params.jointIDs+size_t(v)*params.jointsPerVertex;
+		const auto* weights = params.jointWeights+size_t(v)*params.jointsPerVertex;
+		// blend the matrices first, then transform once
+		core::matrix3x4SIMD blended;
+		for (uint32_t r=0u; r<3u; r++)
+			blended.rows[r] = core::vectorSIMDf(0.f);
+		for (uint32_t i=0u; i<params.jointsPerVertex; i++)
+		{
+			if (weights[i]==0.f)
+				continue;
+			const core::vectorSIMDf weight(weights[i]);
+			const auto& joint = params.skinningMatrices[jointIDs[i]];
+			for (uint32_t r=0u; r<3u; r++)
+				blended.rows[r] += joint.rows[r]*weight;
+		}
+
+		core::vectorSIMDf position(params.inPositions[0][v],params.inPositions[1][v],params.inPositions[2][v],1.f);
+		blended.transformVect(position);
+		for (uint32_t c=0u; c<3u; c++)
+			params.outPositions[c][v] = position.pointer[c];
+		if (hasNormals)
+		{
+			core::vectorSIMDf normal(params.inNormals[0][v],params.inNormals[1][v],params.inNormals[2][v],0.f);
+			blended.mulSub3x3WithNx1(normal);
+			normal = core::normalize(normal);
+			for (uint32_t c=0u; c<3u; c++)
+				params.outNormals[c][v] = normal.pointer[c];
+		}
+	}
+}
@@ -0,0 +1,170 @@
+// Copyright (C) 2018-2022 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/scene/CTransformTreeCPU.h"
+
+
+using namespace nbl;
+using namespace scene;
+
+
+void CTransformTreeCPU::reserve(const uint32_t capacity)
+{
+	m_parent.reserve(capacity);
+	m_relativeTransform.reserve(capacity);
+	m_modifiedStamp.reserve(capacity);
+	m_globalTransform.reserve(capacity);
+	m_recomputedStamp.reserve(capacity);
+	m_alive.reserve(capacity);
+}
+
+void CTransformTreeCPU::addNodes(node_t* outNodes, const uint32_t count, const parent_t* parents, const relative_transform_t* relativeTransforms)
+{
+	for (uint32_t i=0u; i<count; i++)
+	{
+		node_t node;
+		if (m_freeNodes.empty())
+		{
+			node = m_parent.size();
+			m_parent.emplace_back();
+			m_relativeTransform.emplace_back();
+			m_modifiedStamp.emplace_back();
+			m_globalTransform.emplace_back();
+			m_recomputedStamp.emplace_back();
+			m_alive.emplace_back();
+		}
+		else
+		{
+			node = m_freeNodes.back();
+			m_freeNodes.pop_back();
+		}
+		m_parent[node] = parents ? parents[i]:invalid_node;
+		m_relativeTransform[node] = relativeTransforms ? relativeTransforms[i]:core::matrix3x4SIMD();
+		m_modifiedStamp[node] = m_currentStamp;
+		m_recomputedStamp[node] = min_timestamp;
+		m_alive[node] = 1u;
+		outNodes[i] = node;
+	}
+	m_levelsDirty = m_levelsDirty || count;
+}
+
+void CTransformTreeCPU::removeNodes(const node_t* begin, const node_t* end)
+{
+	for (auto it=begin; it!=end; it++)
+	{
+		const auto node = *it;
+		if (!isAlive(node))
+			continue;
+		m_alive[node] = 0u;
+		m_parent[node] = invalid_node;
+		m_removedNodes.push_back(node);
+	}
+	m_levelsDirty = m_levelsDirty || begin!=end;
+}
+
+void CTransformTreeCPU::clearNodes()
+{
+	m_parent.clear();
+	m_relativeTransform.clear();
+	m_modifiedStamp.clear();
+	m_globalTransform.clear();
+	m_recomputedStamp.clear();
+	m_alive.clear();
+	m_freeNodes.clear();
+	m_removedNodes.clear();
+	m_levels.clear();
+	m_levelsDirty = false;
+}
+
+bool CTransformTreeCPU::setParent(const node_t node, const parent_t parent)
+{
+	if (parent!=invalid_node)
+	{
+		if (!isAlive(parent))
+			return false;
+		// reject if `node` is an ancestor of (or is) `parent`, bounded in case a cycle from `addNodes` is still waiting to get cut
+		uint32_t steps = 0u;
+		for (auto k=parent; k!=invalid_node && steps<=m_parent.size(); k=m_parent[k],steps++)
+		if (k==node)
+			return false;
+	}
+	if (m_parent[node]==parent)
+		return true;
+	m_parent[node] = parent;
+	m_modifiedStamp[node] = m_currentStamp;
+	m_levelsDirty = true;
+	return true;
+}
+
+
+void CTransformTreeCPU::rebuildLevels()
+{
+	constexpr uint32_t UnknownDepth = ~0u;
+	constexpr uint32_t InChain = UnknownDepth-1u;
+	const uint32_t capacity = m_parent.size();
+	core::vector<uint32_t> depth(capacity,UnknownDepth);
+	core::vector<node_t> chain;
+	for (node_t n=0u; n<capacity; n++)
+	{
+		if (!m_alive[n] || depth[n]!=UnknownDepth)
+			continue;
+		// walk up until a node of known depth or a root, then assign depths on the way back down
+		uint32_t baseDepth = 0u;
+		for (node_t k=n; ; )
+		{
+			const auto parent = m_parent[k];
+			if (parent!=invalid_node && !isAlive(parent))
+			{
+				// parent got removed, orphan becomes a root and needs its global transform recomputed
+				m_parent[k] = invalid_node;
+				m_modifiedStamp[k] = m_currentStamp;
+			}
+			chain.push_back(k);
+			depth[k] = InChain;
+			if (m_parent[k]==invalid_node)
+				break;
+			k = m_parent[k];
+			if (depth[k]==InChain)
+			{
+				// walked into our own chain, cut the cycle by making the last node a root
+				m_parent[chain.back()] = invalid_node;
+				m_modifiedStamp[chain.back()] = m_currentStamp;
+				break;
+			}
+			if (depth[k]!=UnknownDepth)
+			{
+				baseDepth = depth[k]+1u;
+				break;
+			}
+		}
+		for (auto it=chain.rbegin(); it!=chain.rend(); it++)
+			depth[*it] = baseDepth++;
+		chain.clear();
+	}
+
+	for (auto& level : m_levels)
+		level.clear();
+	for (node_t n=0u; n<capacity; n++)
+	if (m_alive[n])
+	{
+		if (depth[n]>=m_levels.size())
+			m_levels.resize(depth[n]+1u);
+		m_levels[depth[n]].push_back(n);
+	}
+	while (!m_levels.empty() && m_levels.back().empty())
+		m_levels.pop_back();
+	m_freeNodes.insert(m_freeNodes.end(),m_removedNodes.begin(),m_removedNodes.end());
+	m_removedNodes.clear();
+	m_levelsDirty = false;
+}
+
+void CTransformTreeCPU::advanceStamp()
+{
+	if (++m_currentStamp<max_timestamp)
+		return;
+	// everything is clean right after an update, so stamps can be rebased without losing information
+	std::fill(m_modifiedStamp.begin(),m_modifiedStamp.end(),min_timestamp);
+	std::fill(m_recomputedStamp.begin(),m_recomputedStamp.end(),min_timestamp);
+	m_currentStamp = min_timestamp+1u;
+}
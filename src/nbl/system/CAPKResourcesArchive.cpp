@@ -36,7 +36,7 @@ core::vector<IFileArchive::SFileList::SEntry> CAPKResourcesArchive::computeItems
 		if (filename != nullptr)
 		{
 			auto& item = result.emplace_back();
-			item.pathRelativeToArchive = filename;
+			item.setPath(filename);
 			{
 				AAsset* asset = AAssetManager_open(activity->assetManager,filename,AASSET_MODE_STREAMING);
 				item.size = AAsset_getLength(asset);
@@ -56,7 +56,7 @@ core::vector<IFileArchive::SFileList::SEntry> CAPKResourcesArchive::computeItems
 
 CFileArchive::file_buffer_t CAPKResourcesArchive::getFileBuffer(const IFileArchive::SFileList::SEntry* item)
 {
-	AAsset* asset = AAssetManager_open(m_mgr,item->pathRelativeToArchive.string().c_str(),AASSET_MODE_BUFFER);
+	AAsset* asset = AAssetManager_open(m_mgr,item->getPathString().data(),AASSET_MODE_BUFFER);
 	return {const_cast<void*>(AAsset_getBuffer(asset)),static_cast<size_t>(AAsset_getLength(asset)),asset};
 }
 
@@ -160,7 +160,7 @@ core::smart_refctd_ptr<IFileArchive> CArchiveLoaderTar::createArchive_impl(core:
 
 				// add file to list
 				auto& item = items->emplace_back();
-				item.pathRelativeToArchive = fullPath;
+				item.setPath(fullPath);
 				item.size = size;
 				item.offset = offset;
 				item.ID = items->size()-1u;
@@ -120,7 +120,7 @@ core::smart_refctd_ptr<IFileArchive> CArchiveLoaderZip::createArchive_impl(core:
 				return;
 
 			auto& item = items->emplace_back();
-			item.pathRelativeToArchive = _path;
+			item.setPath(_path);
 			item.size = meta.DataDescriptor.UncompressedSize;
 			item.offset = offset;
 			item.ID = itemsMetadata.size();
@@ -492,7 +492,7 @@ CFileArchive::file_buffer_t CArchiveLoaderZip::CArchive::getFileBuffer(const IFi
 		decompressed = VirtualMemoryAllocator(nullptr).alloc(item->size);
 		if (!decompressed)
 		{
-			m_logger.log("Not enough memory for decompressing %s",ILogger::ELL_ERROR,item->pathRelativeToArchive.string().c_str());
+			m_logger.log("Not enough memory for decompressing %s",ILogger::ELL_ERROR,item->getPathString().data());
 			return retval;
 		}
 	}
@@ -602,9 +602,9 @@ CFileArchive::file_buffer_t CArchiveLoaderZip::CArchive::getFileBuffer(const IFi
 	if (!retval.buffer)
 	{
 		if (actualCompressionMethod)
-			m_logger.log("Error decompressing %s",ILogger::ELL_ERROR,item->pathRelativeToArchive.string().c_str());
+			m_logger.log("Error decompressing %s",ILogger::ELL_ERROR,item->getPathString().data());
 		else
-			m_logger.log("Unknown error opening file %s from ZIP archive",ILogger::ELL_ERROR,item->pathRelativeToArchive.string().c_str());
+			m_logger.log("Unknown error opening file %s from ZIP archive",ILogger::ELL_ERROR,item->getPathString().data());
 	}
 
 	return retval;
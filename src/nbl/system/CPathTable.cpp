@@ -0,0 +1,132 @@
+#include "nbl/system/CPathTable.h"
+
+#include <mutex>
+
+using namespace nbl;
+using namespace nbl::system;
+
+
+CPathTable& CPathTable::get()
+{
+	static CPathTable table;
+	return table;
+}
+
+CPathTable::CPathTable()
+{
+	for (auto& block : m_records)
+		block.store(nullptr,std::memory_order_relaxed);
+	m_slots.resize(0x1u<<RecordBlockLog2,SHandle::Invalid);
+	// so that a default constructed handle is the empty string
+	const std::string_view empty;
+	insert(empty,std::hash<std::string_view>()(empty));
+}
+
+CPathTable::~CPathTable()
+{
+	for (auto& block : m_records)
+		delete[] block.load(std::memory_order_relaxed);
+}
+
+std::string CPathTable::canonicalize(const path& p)
+{
+	auto retval = p.lexically_normal().generic_string();
+	while (retval.size()>1ull && retval.back()=='/')
+		retval.pop_back();
+	if (retval==".")
+		retval.clear();
+	return retval;
+}
+
+uint32_t CPathTable::probe(const std::string_view str, const uint64_t hash) const
+{
+	const uint32_t mask = m_slots.size()-1u;
+	for (uint32_t slot=hash&mask; true; slot=(slot+1u)&mask)
+	{
+		const uint32_t id = m_slots[slot];
+		if (id==SHandle::Invalid)
+			return slot;
+		const auto& record = getRecord({id});
+		if (record.hash==hash && std::string_view(record.str,record.length)==str)
+			return slot;
+	}
+}
+
+CPathTable::SHandle CPathTable::find(const std::string_view str) const
+{
+	const uint64_t hash = std::hash<std::string_view>()(str);
+	std::shared_lock lock(m_mutex);
+	return {m_slots[probe(str,hash)]};
+}
+
+CPathTable::SHandle CPathTable::intern(const std::string_view str)
+{
+	const uint64_t hash = std::hash<std::string_view>()(str);
+	{
+		std::shared_lock lock(m_mutex);
+		const uint32_t id = m_slots[probe(str,hash)];
+		if (id!=SHandle::Invalid)
+			return {id};
+	}
+	std::unique_lock lock(m_mutex);
+	return insert(str,hash);
+}
+
+CPathTable::SHandle CPathTable::insert(const std::string_view str, const uint64_t hash)
+{
+	// someone could have interned it between the locks
+	uint32_t slot = probe(str,hash);
+	if (m_slots[slot]!=SHandle::Invalid)
+		return {m_slots[slot]};
+
+	const uint32_t id = m_count.load(std::memory_order_relaxed);
+	// full, callers have to treat the string as unknown (handing out any valid handle would alias it with another string)
+	if ((id>>RecordBlockLog2)>=MaxRecordBlocks)
+		return {SHandle::Invalid};
+
+	// copy the characters into the arena, oversized strings get a block of their own
+	const size_t size = str.size()+1ull;
+	char* dst;
+	if (size>ArenaBlockSize/4ull)
+		dst = m_arenaBlocks.emplace_back(std::make_unique<char[]>(size)).get();
+	else
+	{
+		if (size>m_arenaRemaining)
+		{
+			m_arenaCursor = m_arenaBlocks.emplace_back(std::make_unique<char[]>(ArenaBlockSize)).get();
+			m_arenaRemaining = ArenaBlockSize;
+		}
+		dst = m_arenaCursor;
+		m_arenaCursor += size;
+		m_arenaRemaining -= size;
+	}
+	memcpy(dst,str.data(),str.size());
+	dst[str.size()] = '\0';
+
+	auto& block = m_records[id>>RecordBlockLog2];
+	SRecord* records = block.load(std::memory_order_relaxed);
+	if (!records)
+	{
+		records = new SRecord[0x1u<<RecordBlockLog2];
+		block.store(records,std::memory_order_release);
+	}
+	records[id&((0x1u<<RecordBlockLog2)-1u)] = {dst,hash,static_cast<uint32_t>(str.size())};
+	m_count.store(id+1u,std::memory_order_release);
+
+	m_slots[slot] = id;
+	if ((id+1u)*2u>m_slots.size())
+	{
+		core::vector<uint32_t> oldSlots(m_slots.size()*2u,SHandle::Invalid);
+		m_slots.swap(oldSlots);
+		const uint32_t mask = m_slots.size()-1u;
+		for (const uint32_t oldID : oldSlots)
+		if (oldID!=SHandle::Invalid)
+		{
+			slot = getRecord({oldID}).hash&mask;
+			while (m_slots[slot]!=SHandle::Invalid)
+				slot = (slot+1u)&mask;
+			m_slots[slot] = oldID;
+		}
+	}
+	return {id};
+}
@@ -0,0 +1,200 @@
+// Copyright (C) 2018-2022 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/system/CTaskScheduler.h"
+
+using namespace nbl;
+using namespace nbl::system;
+
+namespace
+{
+// which pool (if any) the calling thread works for
+thread_local const CTaskScheduler* t_scheduler = nullptr;
+thread_local uint32_t t_workerIx = ~0u;
+// victim selection for stealing
+thread_local uint32_t t_stealSeed = 0u;
+}
+
+core::smart_refctd_ptr<CTaskScheduler> CTaskScheduler::create(uint32_t workerCount)
+{
+	if (!workerCount)
+		workerCount = core::max(std::thread::hardware_concurrency(),2u)-1u;
+	return core::smart_refctd_ptr<CTaskScheduler>(new CTaskScheduler(workerCount),core::dont_grab);
+}
+
+CTaskScheduler::CTaskScheduler(const uint32_t workerCount) : m_policy{this,0u}
+{
+	// all deques need to exist before any worker can try to steal from them
+	m_workers.resize(workerCount);
+	for (auto& worker : m_workers)
+		worker = std::make_unique<SWorker>();
+	for (uint32_t i=0u; i<workerCount; i++)
+		m_workers[i]->thread = std::thread(&CTaskScheduler::workerLoop,this,i);
+}
+
+CTaskScheduler::~CTaskScheduler()
+{
+	{
+		std::unique_lock lock(m_sleepLock);
+		m_exit.store(true);
+	}
+	m_wakeup.notify_all();
+	for (auto& worker : m_workers)
+		worker->thread.join();
+
+	// tasks nobody waited for never run, but their references need releasing
+	for (auto& worker : m_workers)
+	while (CTask* task=worker->deque.pop())
+		task->drop();
+	for (CTask* task : m_injectedTasks)
+		task->drop();
+}
+
+uint32_t CTaskScheduler::getCurrentWorkerIndex() const
+{
+	return t_scheduler==this ? t_workerIx:~0u;
+}
+
+void CTaskScheduler::addDependency(CTask* task, CTask* prerequisite)
+{
+	std::lock_guard lock(prerequisite->m_continuationLock);
+	if (prerequisite->m_done.load(std::memory_order_relaxed))
+		return;
+	task->m_pending.fetch_add(1u,std::memory_order_relaxed);
+	prerequisite->m_continuations.push_back(core::smart_refctd_ptr<CTask>(task));
+}
+
+void CTaskScheduler::submit(CTask* task)
+{
+	releaseDependency(task);
+}
+
+void CTaskScheduler::wait(const CTask* task)
+{
+	while (!task->isDone())
+	if (!tryRunOneTask())
+		std::this_thread::yield();
+}
+
+void CTaskScheduler::workerLoop(const uint32_t workerIx)
+{
+	t_scheduler = this;
+	t_workerIx = workerIx;
+	t_stealSeed = workerIx;
+
+	constexpr uint32_t SpinsBeforeSleep = 64u;
+	uint32_t idleSpins = 0u;
+	while (!m_exit.load(std::memory_order_relaxed))
+	{
+		if (tryRunOneTask())
+		{
+			idleSpins = 0u;
+			continue;
+		}
+		if (++idleSpins<SpinsBeforeSleep)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock lock(m_sleepLock);
+		m_sleepingWorkerCount++;
+		m_wakeup.wait(lock,[this]() -> bool {return m_exit.load() || m_queuedTaskCount.load()!=0u;});
+		m_sleepingWorkerCount--;
+		idleSpins = 0u;
+	}
+}
+
+bool CTaskScheduler::tryRunOneTask()
+{
+	const bool isWorker = t_scheduler==this;
+
+	CTask* task = nullptr;
+	if (isWorker)
+		task = m_workers[t_workerIx]->deque.pop();
+	if (!task)
+	{
+		std::lock_guard lock(m_injectionLock);
+		if (!m_injectedTasks.empty())
+		{
+			task = m_injectedTasks.front();
+			m_injectedTasks.pop_front();
+		}
+	}
+	if (!task)
+	{
+		const uint32_t workerCount = m_workers.size();
+		t_stealSeed = t_stealSeed*1664525u+1013904223u;
+		const uint32_t firstVictim = t_stealSeed%workerCount;
+		for (uint32_t i=0u; i<workerCount && !task; i++)
+		{
+			const uint32_t victim = (firstVictim+i)%workerCount;
+			if (!isWorker || victim!=t_workerIx)
+				task = m_workers[victim]->deque.steal();
+		}
+	}
+	if (!task)
+		return false;
+
+	m_queuedTaskCount.fetch_sub(1u);
+	execute(task);
+	return true;
+}
+
+void CTaskScheduler::execute(CTask* task)
+{
+	task->m_work();
+	// release whatever the work captured as soon as possible
+	task->m_work = nullptr;
+
+	decltype(task->m_continuations) continuations;
+	{
+		std::lock_guard lock(task->m_continuationLock);
+		task->m_done.store(true,std::memory_order_release);
+		continuations = std::move(task->m_continuations);
+	}
+	for (auto& continuation : continuations)
+		releaseDependency(continuation.get());
+	// the reference `schedule` took
+	task->drop();
+}
+
+void CTaskScheduler::releaseDependency(CTask* task)
+{
+	if (task->m_pending.fetch_sub(1u,std::memory_order_acq_rel)==1u)
+		schedule(task);
+}
+
+void CTaskScheduler::schedule(CTask* task)
+{
+	task->grab();
+	// counted before it becomes visible, so a thief can't decrement first
+	m_queuedTaskCount.fetch_add(1u);
+	if (t_scheduler==this)
+	{
+		if (!m_workers[t_workerIx]->deque.push(task))
+		{
+			// deque full, no point queueing more work than we can hold
+			m_queuedTaskCount.fetch_sub(1u);
+			execute(task);
+			return;
+		}
+	}
+	else
+	{
+		std::lock_guard lock(m_injectionLock);
+		m_injectedTasks.push_back(task);
+	}
+	wakeOne();
+}
+
+void CTaskScheduler::wakeOne()
+{
+	// pairs with the check of `m_queuedTaskCount` under the lock in `workerLoop`, so the wakeup can't get lost
+	if (m_sleepingWorkerCount.load()!=0u)
+	{
+		std::lock_guard lock(m_sleepLock);
+		m_wakeup.notify_one();
+	}
+}
@@ -10,37 +10,23 @@ IFileArchive::SFileList IFileArchive::listAssets(path pathRelativeToArchive) con
 {
 		auto trimmedList = listAssets();
 		{
-			// remove trailing slash chars from pathRelativeToArchive
-			auto pathstr = pathRelativeToArchive.string();
-			while (pathstr.ends_with("/") || pathstr.ends_with("\\"))
-			{
-				pathstr= pathstr.substr(0, pathstr.length() - 1);
-			}
-			pathRelativeToArchive = pathstr;
+			// same form as the entries, no trailing slashes
+			const auto prefix = CPathTable::canonicalize(pathRelativeToArchive);
+			if (prefix.empty())
+				return trimmedList;
 
 			const auto begin = trimmedList.m_span.begin();
 			const auto end = trimmedList.m_span.end();
 
-			// finding paths with pathRelativeToArchive prefixes
-			// SEntry::operator> is equivalent to comparing strings lexicographically, in other words compares ascii codes of chars in paths, and shorter path is always lesser 
-			// std::lower_bound finds first element >= SEntry arg
-			// 
-			// we want to find all matches that meet this criteria (> is lexicographical string comparing)
-			// pathRelativeToArchive < match < pathRelativeToArchive+1
-			//
-			// lower bound
-			// by appending slash and char with code 1, we essentially make sure that all matches will be lexicographically greater, and start with pathRelativeToArchive/
-			const auto lower = std::lower_bound(begin,end, SFileList::SEntry{pathRelativeToArchive/"\1"});
-			if (lower!=end)
+			// the entries are sorted by their canonical path strings, so everything inside the directory is in
+			// [prefix/, prefix0) because '0' is the character right after '/'
+			auto lessThan = [](const SFileList::SEntry& entry, const std::string& str) -> bool
 			{
-				// upper bound
-				// we cannot do std::upper_bound, because any value longer than pathRelativeToArchive is greater, thus the only matches between std::lower_bound and std::upper_bound would be ones exactly matching pathRelativeToArchive
-				// by appending char with code 1 and taking the lower bound, we can find the first element with prefix greater than pathRelativeToArchive, thus the upper bound
-				auto upper = std::lower_bound(lower,end,SFileList::SEntry{pathRelativeToArchive.string()+"\1"});
-				trimmedList.m_span = {lower,upper};
-			}
-			else
-				trimmedList.m_span = {end,end};
+				return entry.getPathString()<str;
+			};
+			const auto lower = std::lower_bound(begin,end,prefix+'/',lessThan);
+			const auto upper = std::lower_bound(lower,end,prefix+'0',lessThan);
+			trimmedList.m_span = {lower,upper};
 		}
 		return trimmedList;
 }
@@ -74,7 +74,7 @@ core::vector<system::path> ISystem::listItemsInDirectory(const system::path& p)
         {
             const auto assets = static_cast<IFileArchive::SFileList::range_t>(arch.second->listAssets(std::filesystem::relative(dirPath,archPath)));
             for (auto& item : assets)
-                res.push_back(archPath/item.pathRelativeToArchive);
+                res.push_back(archPath/item.getPath());
         }
     };
 
@@ -254,11 +254,7 @@ ISystem::FoundArchiveFile ISystem::findFileInArchive(const system::path& absolut
         for (auto& archive : archives)
         {
             const auto relative = std::filesystem::relative(absolutePath,path);
-            const auto items = static_cast<IFileArchive::SFileList::range_t>(archive.second->listAssets());
-
-            const IFileArchive::SFileList::SEntry itemToFind = { relative };
-            auto found = std::lower_bound(items.begin(), items.end(), itemToFind);
-            if (found!=items.end() && found->pathRelativeToArchive==relative)
+            if (archive.second->contains(relative))
                 return {archive.second.get(),relative};
         }
         path = path.parent_path();
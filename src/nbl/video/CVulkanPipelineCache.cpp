@@ -41,6 +41,17 @@ core::smart_refctd_ptr<asset::ICPUPipelineCache> CVulkanPipelineCache::convertTo
     return core::make_smart_refctd_ptr<asset::ICPUPipelineCache>(std::move(entries));
 }
 
+size_t CVulkanPipelineCache::getDataSize() const
+{
+    const CVulkanLogicalDevice* vulkanDevice = static_cast<const CVulkanLogicalDevice*>(getOriginDevice());
+    auto* vk = vulkanDevice->getFunctionTable();
+
+    size_t dataSize = 0;
+    if (vk->vk.vkGetPipelineCacheData(vulkanDevice->getInternalObject(),m_pipelineCache,&dataSize,nullptr)!=VK_SUCCESS)
+        return 0ull;
+    return dataSize;
+}
+
 void CVulkanPipelineCache::setObjectDebugName(const char* label) const
 {
     IBackendObject::setObjectDebugName(label);
@@ -18,6 +18,7 @@ class CVulkanPipelineCache final : public IGPUPipelineCache
             : IGPUPipelineCache(std::move(dev)), m_pipelineCache(pipelineCache) {}
 
         core::smart_refctd_ptr<asset::ICPUPipelineCache> convertToCPUCache() const override;
+        size_t getDataSize() const override;
 
         void setObjectDebugName(const char* label) const override;
 
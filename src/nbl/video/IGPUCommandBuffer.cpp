@@ -143,7 +143,7 @@ bool IGPUCommandBuffer::begin(const core::bitflag<USAGE> flags, const SInheritan
     {
         if (inheritanceInfo->framebuffer && !inheritanceInfo->framebuffer->getCreationParameters().renderpass->compatible(inheritanceInfo->renderpass))
             return false;
-        if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBeginRenderPassCmd>(m_commandList,core::smart_refctd_ptr<const IGPURenderpass>(inheritanceInfo->renderpass),core::smart_refctd_ptr<const IGPUFramebuffer>(inheritanceInfo->framebuffer)))
+        if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBeginRenderPassCmd>(m_commandList,trackResource<IGPURenderpass>(inheritanceInfo->renderpass),trackResource<IGPUFramebuffer>(inheritanceInfo->framebuffer)))
             return false;
         m_cachedInheritanceInfo = *inheritanceInfo;
     }
@@ -236,7 +236,7 @@ bool IGPUCommandBuffer::setEvent(IEvent* _event, const SEventDependencyInfo& dep
     if (invalidDependency(depInfo))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CSetEventCmd>(m_commandList, core::smart_refctd_ptr<const IEvent>(_event)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CSetEventCmd>(m_commandList, trackResource<IEvent>(_event)))
         return false;
 
     return setEvent_impl(_event,depInfo);
@@ -264,7 +264,7 @@ bool IGPUCommandBuffer::resetEvent(IEvent* _event, const core::bitflag<stage_fla
     if (!getOriginDevice()->supportsMask(m_cmdpool->getQueueFamilyIndex(),stageMask))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CResetEventCmd>(m_commandList,core::smart_refctd_ptr<const IEvent>(_event)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CResetEventCmd>(m_commandList,trackResource<IEvent>(_event)))
         return false;
 
     return resetEvent_impl(_event,stageMask);
@@ -296,7 +296,8 @@ bool IGPUCommandBuffer::waitEvents(const std::span<IEvent*> events, const SEvent
         totalImageCount += depInfo.imgBarriers.size();
     }
 
-    auto* cmd = m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CWaitEventsCmd>(m_commandList,events.size(),events.data(),totalBufferCount,totalImageCount);
+    const bool perCommand = m_resourceTracking==RESOURCE_TRACKING::PER_COMMAND;
+    auto* cmd = m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CWaitEventsCmd>(m_commandList,trackResources<IEvent>(events.size(),events.data()),events.data(),perCommand ? totalBufferCount:0u,perCommand ? totalImageCount:0u);
     if (!cmd)
         return false;
 
@@ -304,10 +305,20 @@ bool IGPUCommandBuffer::waitEvents(const std::span<IEvent*> events, const SEvent
     for (auto i=0u; i<events.size(); ++i)
     {
         const auto& depInfo = depInfos[i];
-        for (const auto& barrier : depInfo.bufBarriers)
-            *(outIt++) = barrier.range.buffer;
-        for (const auto& barrier : depInfo.imgBarriers)
-            *(outIt++) = core::smart_refctd_ptr<const IGPUImage>(barrier.image);
+        if (perCommand)
+        {
+            for (const auto& barrier : depInfo.bufBarriers)
+                *(outIt++) = barrier.range.buffer;
+            for (const auto& barrier : depInfo.imgBarriers)
+                *(outIt++) = core::smart_refctd_ptr<const IGPUImage>(barrier.image);
+        }
+        else
+        {
+            for (const auto& barrier : depInfo.bufBarriers)
+                trackResource<IGPUBuffer>(barrier.range.buffer);
+            for (const auto& barrier : depInfo.imgBarriers)
+                trackResource<IGPUImage>(barrier.image);
+        }
     }
     return waitEvents_impl(events,depInfos);
 }
@@ -378,15 +389,26 @@ bool IGPUCommandBuffer::pipelineBarrier(const core::bitflag<asset::E_DEPENDENCY_
     else if (dependencyFlags.hasFlags(asset::EDF_VIEW_LOCAL_BIT))
         return false;
 
-    auto* cmd = m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CPipelineBarrierCmd>(m_commandList,depInfo.bufBarriers.size(),depInfo.imgBarriers.size());
+    const bool perCommand = m_resourceTracking==RESOURCE_TRACKING::PER_COMMAND;
+    auto* cmd = m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CPipelineBarrierCmd>(m_commandList,perCommand ? depInfo.bufBarriers.size():0u,perCommand ? depInfo.imgBarriers.size():0u);
     if (!cmd)
         return false;
 
-    auto outIt = cmd->getVariableCountResources();
-    for (const auto& barrier : depInfo.bufBarriers)
-        *(outIt++) = barrier.range.buffer;
-    for (const auto& barrier : depInfo.imgBarriers)
-        *(outIt++) = core::smart_refctd_ptr<const IGPUImage>(barrier.image);
+    if (perCommand)
+    {
+        auto outIt = cmd->getVariableCountResources();
+        for (const auto& barrier : depInfo.bufBarriers)
+            *(outIt++) = barrier.range.buffer;
+        for (const auto& barrier : depInfo.imgBarriers)
+            *(outIt++) = core::smart_refctd_ptr<const IGPUImage>(barrier.image);
+    }
+    else
+    {
+        for (const auto& barrier : depInfo.bufBarriers)
+            trackResource<IGPUBuffer>(barrier.range.buffer);
+        for (const auto& barrier : depInfo.imgBarriers)
+            trackResource<IGPUImage>(barrier.image);
+    }
     return pipelineBarrier_impl(dependencyFlags,depInfo);
 }
 
@@ -402,7 +424,7 @@ bool IGPUCommandBuffer::fillBuffer(const asset::SBufferRange<IGPUBuffer>& range,
         return false;
     }
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CFillBufferCmd>(m_commandList,core::smart_refctd_ptr<const IGPUBuffer>(range.buffer)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CFillBufferCmd>(m_commandList,trackResource<IGPUBuffer>(range.buffer)))
         return false;
     return fillBuffer_impl(range,data);
 }
@@ -423,7 +445,7 @@ bool IGPUCommandBuffer::updateBuffer(const asset::SBufferRange<IGPUBuffer>& rang
         return false;
     }
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CUpdateBufferCmd>(m_commandList,core::smart_refctd_ptr<const IGPUBuffer>(range.buffer)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CUpdateBufferCmd>(m_commandList,trackResource<IGPUBuffer>(range.buffer)))
         return false;
     return updateBuffer_impl(range,pData);
 }
@@ -448,7 +470,7 @@ bool IGPUCommandBuffer::copyBuffer(const IGPUBuffer* const srcBuffer, IGPUBuffer
 
     // pRegions is too expensive to validate
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CCopyBufferCmd>(m_commandList,core::smart_refctd_ptr<const IGPUBuffer>(srcBuffer),core::smart_refctd_ptr<const IGPUBuffer>(dstBuffer)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CCopyBufferCmd>(m_commandList,trackResource<IGPUBuffer>(srcBuffer),trackResource<IGPUBuffer>(dstBuffer)))
         return false;
     return copyBuffer_impl(srcBuffer, dstBuffer, regionCount, pRegions);
 }
@@ -465,7 +487,7 @@ bool IGPUCommandBuffer::clearColorImage(IGPUImage* const image, const IGPUImage:
     if (asset::isDepthOrStencilFormat(format) || asset::isBlockCompressionFormat(format))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CClearColorImageCmd>(m_commandList,core::smart_refctd_ptr<const IGPUImage>(image)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CClearColorImageCmd>(m_commandList,trackResource<IGPUImage>(image)))
         return false;
     return clearColorImage_impl(image, imageLayout, pColor, rangeCount, pRanges);
 }
@@ -481,7 +503,7 @@ bool IGPUCommandBuffer::clearDepthStencilImage(IGPUImage* const image, const IGP
     if (!asset::isDepthOrStencilFormat(format))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CClearDepthStencilImageCmd>(m_commandList,core::smart_refctd_ptr<const IGPUImage>(image)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CClearDepthStencilImageCmd>(m_commandList,trackResource<IGPUImage>(image)))
         return false;
     return clearDepthStencilImage_impl(image, imageLayout, pDepthStencil, rangeCount, pRanges);
 }
@@ -500,7 +522,7 @@ bool IGPUCommandBuffer::copyBufferToImage(const IGPUBuffer* const srcBuffer, IGP
 
     // pRegions is too expensive to validate
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CCopyBufferToImageCmd>(m_commandList, core::smart_refctd_ptr<const IGPUBuffer>(srcBuffer), core::smart_refctd_ptr<const IGPUImage>(dstImage)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CCopyBufferToImageCmd>(m_commandList, trackResource<IGPUBuffer>(srcBuffer), trackResource<IGPUImage>(dstImage)))
         return false;
 
     return copyBufferToImage_impl(srcBuffer, dstImage, dstImageLayout, regionCount, pRegions);
@@ -520,7 +542,7 @@ bool IGPUCommandBuffer::copyImageToBuffer(const IGPUImage* const srcImage, const
 
     // pRegions is too expensive to validate
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CCopyImageToBufferCmd>(m_commandList, core::smart_refctd_ptr<const IGPUImage>(srcImage), core::smart_refctd_ptr<const IGPUBuffer>(dstBuffer)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CCopyImageToBufferCmd>(m_commandList, trackResource<IGPUImage>(srcImage), trackResource<IGPUBuffer>(dstBuffer)))
         return false;
 
     return copyImageToBuffer_impl(srcImage, srcImageLayout, dstBuffer, regionCount, pRegions);
@@ -549,7 +571,7 @@ bool IGPUCommandBuffer::copyImage(const IGPUImage* const srcImage, const IGPUIma
     if (!dstImage->validateCopies(pRegions,pRegions+regionCount,srcImage))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CCopyImageCmd>(m_commandList, core::smart_refctd_ptr<const IGPUImage>(srcImage), core::smart_refctd_ptr<const IGPUImage>(dstImage)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CCopyImageCmd>(m_commandList, trackResource<IGPUImage>(srcImage), trackResource<IGPUImage>(dstImage)))
         return false;
 
     return copyImage_impl(srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions);
@@ -590,6 +612,7 @@ uint32_t IGPUCommandBuffer::buildAccelerationStructures_common(const std::span<c
         resourcesToTrack++;
     }
             
+    // builds are rare and `fillTracking` writes the references out itself, so they hold their own whatever the `m_resourceTracking`
     auto cmd = m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBuildAccelerationStructuresCmd>(m_commandList,resourcesToTrack);
     if (!cmd)
         return false;
@@ -626,7 +649,7 @@ bool IGPUCommandBuffer::copyAccelerationStructure(const IGPUAccelerationStructur
     if (!copyInfo.dst || !this->isCompatibleDevicewise(copyInfo.dst))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CCopyAccelerationStructureCmd>(m_commandList, core::smart_refctd_ptr<const IGPUAccelerationStructure>(copyInfo.src), core::smart_refctd_ptr<const IGPUAccelerationStructure>(copyInfo.dst)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CCopyAccelerationStructureCmd>(m_commandList, trackResource<IGPUAccelerationStructure>(copyInfo.src), trackResource<IGPUAccelerationStructure>(copyInfo.dst)))
         return false;
 
     return copyAccelerationStructure_impl(copyInfo);
@@ -642,7 +665,7 @@ bool IGPUCommandBuffer::copyAccelerationStructureToMemory(const IGPUAcceleration
     if (invalidBufferBinding(copyInfo.dst,256u,IGPUBuffer::EUF_TRANSFER_DST_BIT))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CCopyAccelerationStructureToOrFromMemoryCmd>(m_commandList, core::smart_refctd_ptr<const IGPUAccelerationStructure>(copyInfo.src), core::smart_refctd_ptr<const IGPUBuffer>(copyInfo.dst.buffer)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CCopyAccelerationStructureToOrFromMemoryCmd>(m_commandList, trackResource<IGPUAccelerationStructure>(copyInfo.src), trackResource<IGPUBuffer>(copyInfo.dst.buffer)))
         return false;
 
     return copyAccelerationStructureToMemory_impl(copyInfo);
@@ -658,7 +681,7 @@ bool IGPUCommandBuffer::copyAccelerationStructureFromMemory(const IGPUAccelerati
     if (!copyInfo.dst || !this->isCompatibleDevicewise(copyInfo.dst))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CCopyAccelerationStructureToOrFromMemoryCmd>(m_commandList, core::smart_refctd_ptr<const IGPUAccelerationStructure>(copyInfo.dst), core::smart_refctd_ptr<const IGPUBuffer>(copyInfo.src.buffer)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CCopyAccelerationStructureToOrFromMemoryCmd>(m_commandList, trackResource<IGPUAccelerationStructure>(copyInfo.dst), trackResource<IGPUBuffer>(copyInfo.src.buffer)))
         return false;
 
     return copyAccelerationStructureFromMemory_impl(copyInfo);
@@ -673,7 +696,7 @@ bool IGPUCommandBuffer::bindComputePipeline(const IGPUComputePipeline* const pip
     if (!this->isCompatibleDevicewise(pipeline))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBindComputePipelineCmd>(m_commandList, core::smart_refctd_ptr<const IGPUComputePipeline>(pipeline)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBindComputePipelineCmd>(m_commandList, trackResource<IGPUComputePipeline>(pipeline)))
         return false;
 
     bindComputePipeline_impl(pipeline);
@@ -692,7 +715,7 @@ bool IGPUCommandBuffer::bindGraphicsPipeline(const IGPUGraphicsPipeline* const p
     if (!pipeline || !this->isCompatibleDevicewise(pipeline))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBindGraphicsPipelineCmd>(m_commandList, core::smart_refctd_ptr<const IGPUGraphicsPipeline>(pipeline)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBindGraphicsPipelineCmd>(m_commandList, trackResource<IGPUGraphicsPipeline>(pipeline)))
         return false;
 
     return bindGraphicsPipeline_impl(pipeline);
@@ -724,7 +747,7 @@ bool IGPUCommandBuffer::bindDescriptorSets(
         }
     }
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBindDescriptorSetsCmd>(m_commandList,core::smart_refctd_ptr<const IGPUPipelineLayout>(layout),descriptorSetCount,pDescriptorSets))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBindDescriptorSetsCmd>(m_commandList,trackResource<IGPUPipelineLayout>(layout),trackResources<IGPUDescriptorSet>(descriptorSetCount,pDescriptorSets),pDescriptorSets))
         return false;
 
     for (uint32_t i=0u; i<descriptorSetCount; ++i)
@@ -763,7 +786,7 @@ bool IGPUCommandBuffer::pushConstants(const IGPUPipelineLayout* const layout, co
     if (!layout || !this->isCompatibleDevicewise(layout))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CPushConstantsCmd>(m_commandList, core::smart_refctd_ptr<const IGPUPipelineLayout>(layout)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CPushConstantsCmd>(m_commandList, trackResource<IGPUPipelineLayout>(layout)))
         return false;
 
     return pushConstants_impl(layout, stageFlags, offset, size, pValues);
@@ -780,7 +803,14 @@ bool IGPUCommandBuffer::bindVertexBuffers(const uint32_t firstBinding, const uin
     if (pBindings[i].buffer && invalidBufferBinding(pBindings[i],4u/*or should we derive from component format?*/,IGPUBuffer::EUF_VERTEX_BUFFER_BIT))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBindVertexBuffersCmd>(m_commandList,bindingCount,pBindings))
+    uint32_t heldCount = bindingCount;
+    if (m_resourceTracking!=RESOURCE_TRACKING::PER_COMMAND)
+    {
+        for (uint32_t i=0u; i<bindingCount; ++i)
+            trackResource<IGPUBuffer>(pBindings[i].buffer);
+        heldCount = 0u;
+    }
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBindVertexBuffersCmd>(m_commandList,heldCount,pBindings))
         return false;
 
     return bindVertexBuffers_impl(firstBinding, bindingCount, pBindings);
@@ -809,7 +839,7 @@ bool IGPUCommandBuffer::bindIndexBuffer(const asset::SBufferBinding<const IGPUBu
             return false;
     }
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBindIndexBufferCmd>(m_commandList, core::smart_refctd_ptr<const IGPUBuffer>(binding.buffer)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBindIndexBufferCmd>(m_commandList, trackResource<IGPUBuffer>(binding.buffer)))
         return false;
 
     return bindIndexBuffer_impl(binding,indexType);
@@ -872,7 +902,7 @@ bool IGPUCommandBuffer::resetQueryPool(IQueryPool* const queryPool, const uint32
     if (!queryPool || !this->isCompatibleDevicewise(queryPool))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CResetQueryPoolCmd>(m_commandList, core::smart_refctd_ptr<const IQueryPool>(queryPool)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CResetQueryPoolCmd>(m_commandList, trackResource<IQueryPool>(queryPool)))
         return false;
 
     return resetQueryPool_impl(queryPool, firstQuery, queryCount);
@@ -887,7 +917,7 @@ bool IGPUCommandBuffer::beginQuery(IQueryPool* const queryPool, const uint32_t q
     if (!queryPool || !this->isCompatibleDevicewise(queryPool))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBeginQueryCmd>(m_commandList, core::smart_refctd_ptr<const IQueryPool>(queryPool)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBeginQueryCmd>(m_commandList, trackResource<IQueryPool>(queryPool)))
         return false;
 
     return beginQuery_impl(queryPool, query, flags);
@@ -902,7 +932,7 @@ bool IGPUCommandBuffer::endQuery(IQueryPool* const queryPool, const uint32_t que
     if (!queryPool || !this->isCompatibleDevicewise(queryPool))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CEndQueryCmd>(m_commandList, core::smart_refctd_ptr<const IQueryPool>(queryPool)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CEndQueryCmd>(m_commandList, trackResource<IQueryPool>(queryPool)))
         return false;
 
     return endQuery_impl(queryPool, query);
@@ -922,7 +952,7 @@ bool IGPUCommandBuffer::writeTimestamp(const stage_flags_t pipelineStage, IQuery
 
     assert(core::isPoT(static_cast<uint32_t>(pipelineStage))); // should only be 1 stage (1 bit set)
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CWriteTimestampCmd>(m_commandList, core::smart_refctd_ptr<const IQueryPool>(queryPool)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CWriteTimestampCmd>(m_commandList, trackResource<IQueryPool>(queryPool)))
         return false;
 
     return writeTimestamp_impl(pipelineStage, queryPool, query);
@@ -940,11 +970,15 @@ bool IGPUCommandBuffer::writeAccelerationStructureProperties(const std::span<con
     if (!isCompatibleDevicewise(as))
         return false;
 
-    auto cmd = m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CWriteAccelerationStructurePropertiesCmd>(m_commandList, queryPool, pAccelerationStructures.size());
+    const bool perCommand = m_resourceTracking==RESOURCE_TRACKING::PER_COMMAND;
+    if (!perCommand)
+        trackResource<IQueryPool>(queryPool);
+    auto cmd = m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CWriteAccelerationStructurePropertiesCmd>(m_commandList, perCommand ? queryPool:nullptr, trackResources<IGPUAccelerationStructure>(pAccelerationStructures.size(),pAccelerationStructures.data()));
     if (!cmd)
         return false;
 
     auto oit = cmd->getVariableCountResources();
+    if (perCommand)
     for (auto& as : pAccelerationStructures)
         *(oit++) = core::smart_refctd_ptr<const core::IReferenceCounted>(as);
     return writeAccelerationStructureProperties_impl(pAccelerationStructures, queryType, queryPool, firstQuery);
@@ -965,7 +999,7 @@ bool IGPUCommandBuffer::copyQueryPoolResults(
     if (invalidBufferRange({dstBuffer.offset,queryCount*stride,dstBuffer.buffer},alignment,IGPUBuffer::EUF_TRANSFER_DST_BIT))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CCopyQueryPoolResultsCmd>(m_commandList, core::smart_refctd_ptr<const IQueryPool>(queryPool), core::smart_refctd_ptr<const IGPUBuffer>(dstBuffer.buffer)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CCopyQueryPoolResultsCmd>(m_commandList, trackResource<IQueryPool>(queryPool), trackResource<IGPUBuffer>(dstBuffer.buffer)))
         return false;
 
     return copyQueryPoolResults_impl(queryPool, firstQuery, queryCount, dstBuffer, stride, flags);
@@ -995,7 +1029,7 @@ bool IGPUCommandBuffer::dispatchIndirect(const asset::SBufferBinding<const IGPUB
     if (invalidBufferBinding(binding,4u/*TODO: is it really 4?*/,IGPUBuffer::EUF_INDIRECT_BUFFER_BIT))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CIndirectCmd>(m_commandList,core::smart_refctd_ptr<const IGPUBuffer>(binding.buffer)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CIndirectCmd>(m_commandList,trackResource<IGPUBuffer>(binding.buffer)))
         return false;
 
     return dispatchIndirect_impl(binding);
@@ -1034,7 +1068,7 @@ bool IGPUCommandBuffer::beginRenderPass(SRenderpassBeginInfo info, const SUBPASS
     if (info.renderpass->getColorLoadOpAttachmentEnd()!=0u && !info.colorClearValues)
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBeginRenderPassCmd>(m_commandList,core::smart_refctd_ptr<const IGPURenderpass>(info.renderpass),core::smart_refctd_ptr<const IGPUFramebuffer>(info.framebuffer)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBeginRenderPassCmd>(m_commandList,trackResource<IGPURenderpass>(info.renderpass),trackResource<IGPUFramebuffer>(info.framebuffer)))
         return false;
 
     if (!beginRenderPass_impl(info,contents))
@@ -1178,7 +1212,7 @@ bool IGPUCommandBuffer::drawIndirect(const asset::SBufferBinding<const IGPUBuffe
     if (invalidDrawIndirect<hlsl::DrawArraysIndirectCommand_t>(binding,drawCount,stride))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CIndirectCmd>(m_commandList,core::smart_refctd_ptr<const IGPUBuffer>(binding.buffer)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CIndirectCmd>(m_commandList,trackResource<IGPUBuffer>(binding.buffer)))
         return false;
 
     return drawIndirect_impl(binding, drawCount, stride);
@@ -1189,7 +1223,7 @@ bool IGPUCommandBuffer::drawIndexedIndirect(const asset::SBufferBinding<const IG
     if (invalidDrawIndirect<hlsl::DrawElementsIndirectCommand_t>(binding,drawCount,stride))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CIndirectCmd>(m_commandList, core::smart_refctd_ptr<const IGPUBuffer>(binding.buffer)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CIndirectCmd>(m_commandList, trackResource<IGPUBuffer>(binding.buffer)))
         return false;
 
     return drawIndexedIndirect_impl(binding, drawCount, stride);
@@ -1200,7 +1234,7 @@ bool IGPUCommandBuffer::drawIndirectCount(const asset::SBufferBinding<const IGPU
     if (!invalidDrawIndirectCount<hlsl::DrawArraysIndirectCommand_t>(indirectBinding,countBinding,maxDrawCount,stride))
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CDrawIndirectCountCmd>(m_commandList, core::smart_refctd_ptr<const IGPUBuffer>(indirectBinding.buffer), core::smart_refctd_ptr<const IGPUBuffer>(countBinding.buffer)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CDrawIndirectCountCmd>(m_commandList, trackResource<IGPUBuffer>(indirectBinding.buffer), trackResource<IGPUBuffer>(countBinding.buffer)))
         return false;
 
     return drawIndirectCount_impl(indirectBinding, countBinding, maxDrawCount, stride);
@@ -1211,7 +1245,7 @@ bool IGPUCommandBuffer::drawIndexedIndirectCount(const asset::SBufferBinding<con
     if (!invalidDrawIndirectCount<hlsl::DrawElementsIndirectCommand_t>(indirectBinding,countBinding,maxDrawCount,stride))
         return false;
     
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CDrawIndirectCountCmd>(m_commandList, core::smart_refctd_ptr<const IGPUBuffer>(indirectBinding.buffer), core::smart_refctd_ptr<const IGPUBuffer>(countBinding.buffer)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CDrawIndirectCountCmd>(m_commandList, trackResource<IGPUBuffer>(indirectBinding.buffer), trackResource<IGPUBuffer>(countBinding.buffer)))
         return false;
 
     return drawIndexedIndirectCount_impl(indirectBinding, countBinding, maxDrawCount, stride);
@@ -1304,7 +1338,7 @@ bool IGPUCommandBuffer::blitImage(const IGPUImage* const srcImage, const IGPUIma
         // probably validate the offsets, and extents
     }
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBlitImageCmd>(m_commandList, core::smart_refctd_ptr<const IGPUImage>(srcImage), core::smart_refctd_ptr<const IGPUImage>(dstImage)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CBlitImageCmd>(m_commandList, trackResource<IGPUImage>(srcImage), trackResource<IGPUImage>(dstImage)))
         return false;
 
     return blitImage_impl(srcImage, srcImageLayout, dstImage, dstImageLayout, regions, filter);
@@ -1337,7 +1371,7 @@ bool IGPUCommandBuffer::resolveImage(const IGPUImage* const srcImage, const IGPU
     if (srcParams.format!=dstParams.format)
         return false;
 
-    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CResolveImageCmd>(m_commandList, core::smart_refctd_ptr<const IGPUImage>(srcImage), core::smart_refctd_ptr<const IGPUImage>(dstImage)))
+    if (!m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CResolveImageCmd>(m_commandList, trackResource<IGPUImage>(srcImage), trackResource<IGPUImage>(dstImage)))
         return false;
 
     return resolveImage_impl(srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, pRegions);
@@ -1357,10 +1391,11 @@ bool IGPUCommandBuffer::executeCommands(const uint32_t count, IGPUCommandBuffer*
             return false;
     }
 
-    auto cmd = m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CExecuteCommandsCmd>(m_commandList,count);
+    const uint32_t heldCount = trackResources<IGPUCommandBuffer>(count,cmdbufs);
+    auto cmd = m_cmdpool->m_commandListPool.emplace<IGPUCommandPool::CExecuteCommandsCmd>(m_commandList,heldCount);
     if (!cmd)
         return false;
-    for (auto i=0u; i<count; i++)
+    for (auto i=0u; i<heldCount; i++)
         cmd->getVariableCountResources()[i] = core::smart_refctd_ptr<const core::IReferenceCounted>(cmdbufs[i]);
     return executeCommands_impl(count,cmdbufs);
 }
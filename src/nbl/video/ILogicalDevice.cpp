@@ -347,19 +347,6 @@ core::smart_refctd_ptr<IGPUShader> ILogicalDevice::createShader(const asset::ICP
     if (!spirv)
         return nullptr;
 
-    // for debugging 
-    if constexpr (true)
-    {
-        system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
-        m_physicalDevice->getSystem()->createFile(future,system::path(cpushader->getFilepathHint()).parent_path()/"compiled.spv",system::IFileBase::ECF_WRITE);
-        if (auto file=future.acquire(); file&&bool(*file))
-        {
-            system::IFile::success_t succ;
-            (*file)->write(succ,spirv->getPointer(),0,spirv->getSize());
-            succ.getBytesProcessed(true);
-        }
-    }
-
     auto retval = createShader_impl(spirvShader.get());
     const auto path = cpushader->getFilepathHint();
     if (retval && !path.empty())
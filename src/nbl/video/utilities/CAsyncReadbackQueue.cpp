@@ -0,0 +1,221 @@
+#include "nbl/video/IPhysicalDevice.h"
+#include "nbl/video/ILogicalDevice.h"
+#include "nbl/video/utilities/CAsyncReadbackQueue.h"
+
+using namespace nbl;
+using namespace video;
+
+
+core::smart_refctd_ptr<CAsyncReadbackQueue> CAsyncReadbackQueue::create(SCreationParams&& params)
+{
+	if (!params.utilities || !params.utilities->getDefaultDownStreamingBuffer() || !params.queue || params.framesInFlight==0u)
+		return nullptr;
+
+	auto* const device = params.utilities->getLogicalDevice();
+	auto semaphore = device->createSemaphore(0ull);
+	auto pool = device->createCommandPool(params.queue->getFamilyIndex(),IGPUCommandPool::CREATE_FLAGS::RESET_COMMAND_BUFFER_BIT);
+	if (!semaphore || !pool)
+		return nullptr;
+	core::vector<core::smart_refctd_ptr<IGPUCommandBuffer>> cmdbufs(params.framesInFlight);
+	if (!pool->createCommandBuffers(IGPUCommandPool::BUFFER_LEVEL::PRIMARY,{cmdbufs.data(),cmdbufs.size()}))
+		return nullptr;
+	core::vector<SFrame> frames(params.framesInFlight);
+	for (uint32_t i=0u; i<params.framesInFlight; i++)
+		frames[i].cmdbuf = std::move(cmdbufs[i]);
+
+	return core::smart_refctd_ptr<CAsyncReadbackQueue>(new CAsyncReadbackQueue(std::move(params),std::move(semaphore),std::move(pool),std::move(frames)),core::dont_grab);
+}
+
+CAsyncReadbackQueue::CAsyncReadbackQueue(SCreationParams&& params, core::smart_refctd_ptr<ISemaphore>&& semaphore, core::smart_refctd_ptr<IGPUCommandPool>&& pool, core::vector<SFrame>&& frames) :
+	m_utilities(std::move(params.utilities)), m_queue(params.queue), m_scheduler(std::move(params.scheduler)),
+	m_semaphore(std::move(semaphore)), m_pool(std::move(pool)), m_frames(std::move(frames)) {}
+
+CAsyncReadbackQueue::~CAsyncReadbackQueue()
+{
+	wait();
+	// a frame recorded but never submitted still holds its staging memory
+	if (m_recording)
+	{
+		auto* const downBuffer = m_utilities->getDefaultDownStreamingBuffer();
+		for (const auto& download : m_frames[m_currentFrame].downloads)
+			downBuffer->multi_deallocate(1u,&download.offset,&download.allocationSize);
+	}
+}
+
+bool CAsyncReadbackQueue::beginFrame()
+{
+	auto& frame = m_frames[m_currentFrame];
+	// the slot's previous use is still in flight, this is the frames-in-flight backpressure
+	if (frame.signalValue)
+	{
+		if (m_semaphore->getCounterValue()<frame.signalValue)
+		{
+			const ISemaphore::SWaitInfo waitInfo = {m_semaphore.get(),frame.signalValue};
+			m_utilities->getLogicalDevice()->blockForSemaphores({&waitInfo,1});
+			m_stats.stallCount++;
+		}
+		retire(frame);
+	}
+	if (!frame.cmdbuf->reset(IGPUCommandBuffer::RESET_FLAGS::RELEASE_RESOURCES_BIT) || !frame.cmdbuf->begin(IGPUCommandBuffer::USAGE::ONE_TIME_SUBMIT_BIT))
+		return false;
+	m_recording = true;
+	return true;
+}
+
+void CAsyncReadbackQueue::consume(const SDownload& download) const
+{
+	auto* const downBuffer = m_utilities->getDefaultDownStreamingBuffer();
+	if (downBuffer->needsManualFlushOrInvalidate())
+	{
+		auto* const device = m_utilities->getLogicalDevice();
+		const auto nonCoherentAtomSize = device->getPhysicalDevice()->getLimits().nonCoherentAtomSize;
+		auto invalidateRange = AlignedMappedMemoryRange(downBuffer->getBuffer()->getBoundMemory().memory,download.offset,download.size,nonCoherentAtomSize);
+		device->invalidateMappedMemoryRanges(1u,&invalidateRange);
+	}
+	download.consumer(0ull,reinterpret_cast<const uint8_t*>(downBuffer->getBufferPointer())+download.offset,download.size);
+	// the GPU is long done with it, so no need to latch the free on anything
+	downBuffer->multi_deallocate(1u,&download.offset,&download.allocationSize);
+}
+
+void CAsyncReadbackQueue::retire(SFrame& frame)
+{
+	for (auto& download : frame.downloads)
+	{
+		if (m_scheduler)
+			m_consumerTasks.push_back(m_scheduler->run([this,download=std::move(download)]()->void{consume(download);}));
+		else
+			consume(download);
+	}
+	frame.downloads.clear();
+	frame.signalValue = 0ull;
+}
+
+bool CAsyncReadbackQueue::makeRoom()
+{
+	if (poll())
+		return true;
+	// the oldest frame in flight
+	SFrame* oldest = nullptr;
+	for (auto& frame : m_frames)
+	if (frame.signalValue && (!oldest || frame.signalValue<oldest->signalValue))
+		oldest = &frame;
+	if (oldest)
+	{
+		const ISemaphore::SWaitInfo waitInfo = {m_semaphore.get(),oldest->signalValue};
+		m_utilities->getLogicalDevice()->blockForSemaphores({&waitInfo,1});
+		m_stats.stallCount++;
+		retire(*oldest);
+		return true;
+	}
+	// nothing left on the GPU, so it's the consumers holding on to the memory
+	if (!m_consumerTasks.empty())
+	{
+		m_scheduler->wait(m_consumerTasks.front().get());
+		m_consumerTasks.erase(m_consumerTasks.begin());
+		m_stats.stallCount++;
+		return true;
+	}
+	return false;
+}
+
+bool CAsyncReadbackQueue::download(const asset::SBufferRange<IGPUBuffer>& srcBufferRange, consumer_t&& consumer)
+{
+	if (!srcBufferRange.isValid() || !srcBufferRange.buffer->getCreationParams().usage.hasFlags(asset::IBuffer::EUF_TRANSFER_SRC_BIT) || !consumer)
+		return false;
+
+	auto* const downBuffer = m_utilities->getDefaultDownStreamingBuffer();
+	const uint32_t alignment = m_utilities->getLogicalDevice()->getPhysicalDevice()->getLimits().nonCoherentAtomSize;
+	const size_t allocationSize = core::alignUp(srcBufferRange.size,alignment);
+	if (allocationSize>downBuffer->getBuffer()->getSize())
+		return false;
+	if (!m_recording && !beginFrame())
+		return false;
+
+	SDownload download = {std::move(consumer),srcBufferRange.size,StreamingTransientDataBufferMT<>::invalid_value,static_cast<uint32_t>(allocationSize)};
+	while (true)
+	{
+		downBuffer->multi_allocate(std::chrono::steady_clock::now()+std::chrono::microseconds(500u),1u,&download.offset,&download.allocationSize,&alignment);
+		if (download.offset!=StreamingTransientDataBufferMT<>::invalid_value)
+			break;
+		if (!makeRoom())
+			return false;
+	}
+
+	auto& frame = m_frames[m_currentFrame];
+	IGPUCommandBuffer::SBufferCopy copy;
+	copy.srcOffset = srcBufferRange.offset;
+	copy.dstOffset = download.offset;
+	copy.size = srcBufferRange.size;
+	if (!frame.cmdbuf->copyBuffer(srcBufferRange.buffer.get(),downBuffer->getBuffer(),1u,&copy))
+	{
+		downBuffer->multi_deallocate(1u,&download.offset,&download.allocationSize);
+		return false;
+	}
+	frame.downloads.push_back(std::move(download));
+	m_stats.downloadCount++;
+	m_stats.downloadedBytes += srcBufferRange.size;
+	return true;
+}
+
+IQueue::RESULT CAsyncReadbackQueue::submit(const std::span<const IQueue::SSubmitInfo::SSemaphoreInfo> waitSemaphores)
+{
+	if (!m_recording)
+		return IQueue::RESULT::SUCCESS;
+
+	auto& frame = m_frames[m_currentFrame];
+	if (!frame.cmdbuf->end())
+		return IQueue::RESULT::OTHER_ERROR;
+	const IQueue::SSubmitInfo::SCommandBufferInfo cmdbufInfo = {frame.cmdbuf.get()};
+	const IQueue::SSubmitInfo::SSemaphoreInfo signalInfo = {m_semaphore.get(),m_lastSignalValue+1ull,asset::PIPELINE_STAGE_FLAGS::COPY_BIT};
+	IQueue::SSubmitInfo submitInfo = {};
+	submitInfo.waitSemaphores = waitSemaphores;
+	submitInfo.commandBuffers = {&cmdbufInfo,1};
+	submitInfo.signalSemaphores = {&signalInfo,1};
+	const auto result = m_queue->submit({&submitInfo,1});
+	m_recording = false;
+	if (result!=IQueue::RESULT::SUCCESS)
+	{
+		// the copies will never happen, give the memory back and drop the consumers without calling them
+		auto* const downBuffer = m_utilities->getDefaultDownStreamingBuffer();
+		for (const auto& download : frame.downloads)
+			downBuffer->multi_deallocate(1u,&download.offset,&download.allocationSize);
+		frame.downloads.clear();
+		return result;
+	}
+
+	frame.signalValue = ++m_lastSignalValue;
+	m_currentFrame = (m_currentFrame+1u)%m_frames.size();
+	m_stats.submitCount++;
+	return result;
+}
+
+uint32_t CAsyncReadbackQueue::poll()
+{
+	uint32_t retval = 0u;
+	const uint64_t completedValue = m_semaphore->getCounterValue();
+	// retire in submission order, so the consumers start in the order the downloads were made
+	for (uint32_t i=0u; i<m_frames.size(); i++)
+	{
+		auto& frame = m_frames[(m_currentFrame+i)%m_frames.size()];
+		if (frame.signalValue && frame.signalValue<=completedValue)
+		{
+			retval += frame.downloads.size();
+			retire(frame);
+		}
+	}
+	std::erase_if(m_consumerTasks,[](const auto& task)->bool{return task->isDone();});
+	return retval;
+}
+
+void CAsyncReadbackQueue::wait()
+{
+	if (m_lastSignalValue)
+	{
+		const ISemaphore::SWaitInfo waitInfo = {m_semaphore.get(),m_lastSignalValue};
+		m_utilities->getLogicalDevice()->blockForSemaphores({&waitInfo,1});
+	}
+	poll();
+	for (const auto& task : m_consumerTasks)
+		m_scheduler->wait(task.get());
+	m_consumerTasks.clear();
+}
@@ -0,0 +1,163 @@
+#include "nbl/video/IPhysicalDevice.h"
+#include "nbl/video/ILogicalDevice.h"
+#include "nbl/video/utilities/CBufferUploadBatcher.h"
+
+#include <numeric>
+
+using namespace nbl;
+using namespace video;
+
+
+bool CBufferUploadBatcher::update(const asset::SBufferRange<IGPUBuffer>& bufferRange, const void* data)
+{
+	if (!bufferRange.isValid() || !bufferRange.buffer->getCreationParams().usage.hasFlags(asset::IBuffer::EUF_TRANSFER_DST_BIT) || !data)
+		return false;
+
+	const size_t dataOffset = m_hostData.size();
+	m_hostData.resize(dataOffset+bufferRange.size);
+	memcpy(m_hostData.data()+dataOffset,data,bufferRange.size);
+	m_pending.push_back({bufferRange.buffer,bufferRange.offset,bufferRange.size,dataOffset});
+	return true;
+}
+
+void CBufferUploadBatcher::compose(const SRange& range, uint8_t* dst) const
+{
+	for (uint32_t i=0u; i<range.updateCount; i++)
+	{
+		const auto& update = m_pending[m_order[range.firstUpdate+i]];
+		memcpy(dst+(update.dstOffset-range.dstOffset),m_hostData.data()+update.dataOffset,update.size);
+	}
+}
+
+bool CBufferUploadBatcher::flush(SIntendedSubmitInfo& nextSubmit)
+{
+	m_stats = {};
+	m_stats.updateCount = static_cast<uint32_t>(m_pending.size());
+	if (m_pending.empty())
+		return true;
+	if (!nextSubmit.valid())
+	{
+		clear();
+		return false;
+	}
+
+	// sort by destination, stable so updates to the same offset stay in order
+	m_order.resize(m_pending.size());
+	std::iota(m_order.begin(),m_order.end(),0u);
+	std::stable_sort(m_order.begin(),m_order.end(),[&](const uint32_t lhs, const uint32_t rhs)->bool
+		{
+			const auto& a = m_pending[lhs];
+			const auto& b = m_pending[rhs];
+			if (a.buffer!=b.buffer)
+				return std::less<const IGPUBuffer*>()(a.buffer.get(),b.buffer.get());
+			return a.dstOffset<b.dstOffset;
+		}
+	);
+	// merge whatever touches or overlaps, gaps are left alone because we don't know what's in the buffer there
+	m_ranges.clear();
+	for (uint32_t i=0u; i<m_order.size(); i++)
+	{
+		const auto& update = m_pending[m_order[i]];
+		if (!m_ranges.empty())
+		{
+			auto& last = m_ranges.back();
+			if (last.buffer==update.buffer.get() && update.dstOffset<=last.dstOffset+last.size)
+			{
+				last.size = core::max(last.size,update.dstOffset+update.size-last.dstOffset);
+				last.updateCount++;
+				continue;
+			}
+		}
+		m_ranges.push_back({update.buffer.get(),update.dstOffset,update.size,i,1u});
+	}
+	// the indices are the order in which the updates came, so when composing the later writes win
+	for (const auto& range : m_ranges)
+		std::sort(m_order.begin()+range.firstUpdate,m_order.begin()+range.firstUpdate+range.updateCount);
+	m_stats.rangeCount = static_cast<uint32_t>(m_ranges.size());
+
+	auto* const upBuffer = m_utilities->getDefaultUpStreamingBuffer();
+	auto* const device = m_utilities->getLogicalDevice();
+	const auto& limits = device->getPhysicalDevice()->getLimits();
+	const uint32_t alignment = limits.nonCoherentAtomSize;
+	const uint32_t optimalTransferAtom = limits.maxResidentInvocations*sizeof(uint32_t);
+	const size_t largeRangeSize = upBuffer->getBuffer()->getSize()/LargeRangeDivisor;
+
+	size_t remainingPackedSize = 0ull;
+	for (const auto& range : m_ranges)
+	if (range.size<=largeRangeSize)
+		remainingPackedSize += core::alignUp(range.size,RangeAlignment);
+
+	bool success = true;
+	for (size_t r=0ull; r<m_ranges.size();)
+	{
+		if (const auto& range=m_ranges[r]; range.size>largeRangeSize)
+		{
+			m_largeRangeScratch.resize(range.size);
+			compose(range,m_largeRangeScratch.data());
+			auto buffer = m_pending[m_order[range.firstUpdate]].buffer;
+			success = m_utilities->updateBufferRangeViaStagingBuffer(nextSubmit,asset::SBufferRange<IGPUBuffer>{range.dstOffset,range.size,std::move(buffer)},m_largeRangeScratch.data()) && success;
+			m_stats.largeRangeCount++;
+			m_stats.uploadedBytes += range.size;
+			r++;
+			continue;
+		}
+
+		// same fragmentation guards as `updateBufferRangeViaStagingBuffer`, then take as many of the following ranges as fit
+		const uint32_t maxAllocationSize = IUtilities::getAllocationSizeForStreamingBuffer(remainingPackedSize,alignment,upBuffer->max_size(),optimalTransferAtom);
+		size_t end = r;
+		size_t packedSize = 0ull;
+		for (; end<m_ranges.size() && m_ranges[end].size<=largeRangeSize; end++)
+		{
+			const size_t rangeEnd = core::alignUp(packedSize,RangeAlignment)+m_ranges[end].size;
+			if (rangeEnd>maxAllocationSize)
+				break;
+			packedSize = rangeEnd;
+		}
+		uint32_t localOffset = StreamingTransientDataBufferMT<>::invalid_value;
+		const uint32_t allocationSize = core::alignUp(packedSize,alignment);
+		if (end!=r)
+			upBuffer->multi_allocate(std::chrono::steady_clock::now()+std::chrono::microseconds(500u),1u,&localOffset,&allocationSize,&alignment);
+		if (localOffset==StreamingTransientDataBufferMT<>::invalid_value)
+		{
+			nextSubmit.overflowSubmit();
+			continue;
+		}
+
+		uint8_t* const staging = reinterpret_cast<uint8_t*>(upBuffer->getBufferPointer())+localOffset;
+		m_regions.clear();
+		for (size_t i=r, packOffset=0ull; i<end; i++)
+		{
+			const auto& range = m_ranges[i];
+			packOffset = core::alignUp(packOffset,RangeAlignment);
+			compose(range,staging+packOffset);
+			m_regions.push_back({localOffset+packOffset,range.dstOffset,range.size});
+			remainingPackedSize -= core::alignUp(range.size,RangeAlignment);
+			m_stats.uploadedBytes += range.size;
+			packOffset += range.size;
+		}
+		if (upBuffer->needsManualFlushOrInvalidate())
+		{
+			auto flushRange = AlignedMappedMemoryRange(upBuffer->getBuffer()->getBoundMemory().memory,localOffset,packedSize,limits.nonCoherentAtomSize);
+			device->flushMappedMemoryRanges(1u,&flushRange);
+		}
+		// the ranges are sorted by buffer, so all of a buffer's ranges in this allocation go into one command
+		auto cmdbuf = nextSubmit.frontHalf.getScratchCommandBuffer();
+		for (size_t first=0ull; first<m_regions.size();)
+		{
+			IGPUBuffer* const dstBuffer = m_ranges[r+first].buffer;
+			size_t last = first+1ull;
+			while (last<m_regions.size() && m_ranges[r+last].buffer==dstBuffer)
+				last++;
+			success = cmdbuf->copyBuffer(upBuffer->getBuffer(),dstBuffer,static_cast<uint32_t>(last-first),m_regions.data()+first) && success;
+			m_stats.copyCommandCount++;
+			first = last;
+		}
+		// freed only after the `scratchSemaphore` reaches a value a future submit will signal
+		upBuffer->multi_deallocate(1u,&localOffset,&allocationSize,nextSubmit.getScratchSemaphoreNextWait(),&cmdbuf);
+		m_stats.stagingAllocationCount++;
+		r = end;
+	}
+
+	clear();
+	return success;
+}
@@ -0,0 +1,223 @@
+#include "nbl/video/IPhysicalDevice.h"
+#include "nbl/video/ILogicalDevice.h"
+#include "nbl/video/utilities/CGPUObjectCreationCache.h"
+
+using namespace nbl;
+using namespace video;
+
+
+namespace
+{
+	using content_hash_t = CGPUObjectCreationCache::SContentHash;
+
+	inline content_hash_t hashBytes(const void* data, const size_t size)
+	{
+		content_hash_t retval;
+		core::XXHash_256(data,size,retval.value);
+		return retval;
+	}
+
+	// big contents get hashed as a list of the hashes of their pieces, so that the pieces can be done in parallel
+	content_hash_t hashContents(const void* data, const size_t size, system::CTaskScheduler* scheduler)
+	{
+		if (size<=CGPUObjectCreationCache::HashPieceSize)
+			return hashBytes(data,size);
+
+		const size_t pieceCount = (size-1u)/CGPUObjectCreationCache::HashPieceSize+1u;
+		core::vector<content_hash_t> pieceHashes(pieceCount);
+		auto hashPieces = [&](const size_t begin, const size_t end) -> void
+		{
+			for (auto i=begin; i<end; i++)
+			{
+				const size_t offset = i*CGPUObjectCreationCache::HashPieceSize;
+				pieceHashes[i] = hashBytes(reinterpret_cast<const uint8_t*>(data)+offset,core::min(CGPUObjectCreationCache::HashPieceSize,size-offset));
+			}
+		};
+		if (scheduler)
+			scheduler->parallel_for(0u,pieceCount,1u,hashPieces);
+		else
+			hashPieces(0u,pieceCount);
+		return hashBytes(pieceHashes.data(),pieceCount*sizeof(content_hash_t));
+	}
+
+	template<size_t N>
+	inline content_hash_t hashWithHeader(const uint64_t (&header)[N], const content_hash_t& contents)
+	{
+		uint64_t combined[N+4];
+		std::copy_n(header,N,combined);
+		std::copy_n(contents.value,4u,combined+N);
+		return hashBytes(combined,sizeof(combined));
+	}
+}
+
+auto CGPUObjectCreationCache::hash(const asset::ICPUBuffer* buffer, system::CTaskScheduler* scheduler) -> SContentHash
+{
+	const uint64_t header[] = {buffer->getSize(),static_cast<uint64_t>(buffer->getUsageFlags().value)};
+	return hashWithHeader(header,hashContents(buffer->getPointer(),buffer->getSize(),scheduler));
+}
+
+auto CGPUObjectCreationCache::hash(const asset::ICPUImage* image, system::CTaskScheduler* scheduler) -> SContentHash
+{
+	const auto& params = image->getCreationParameters();
+	const uint64_t header[] = {
+		static_cast<uint64_t>(params.type),static_cast<uint64_t>(params.samples),static_cast<uint64_t>(params.format),
+		params.extent.width,params.extent.height,params.extent.depth,
+		params.mipLevels,params.arrayLayers,
+		static_cast<uint64_t>(params.flags.value),
+		static_cast<uint64_t>(params.usage.value),
+		static_cast<uint64_t>(params.stencilUsage.value),
+		std::hash<std::bitset<asset::E_FORMAT::EF_COUNT>>()(params.viewFormats)
+	};
+	// the regions tell where in the buffer the texels are, so they're as much a part of the contents as the buffer itself
+	const auto regions = image->getRegions();
+	content_hash_t contents = hashBytes(regions.begin(),regions.size()*sizeof(asset::IImage::SBufferCopy));
+	if (const auto* buffer=image->getBuffer(); buffer)
+	{
+		const content_hash_t pair[2] = {contents,hashContents(buffer->getPointer(),buffer->getSize(),scheduler)};
+		contents = hashBytes(pair,sizeof(pair));
+	}
+	return hashWithHeader(header,contents);
+}
+
+auto CGPUObjectCreationCache::hash(const asset::ICPUShader* shader, const asset::ISPIRVOptimizer* optimizer) -> SContentHash
+{
+	const uint64_t header[] = {static_cast<uint64_t>(shader->getStage()),static_cast<uint64_t>(shader->getContentType())};
+	const auto* code = shader->getContent();
+	content_hash_t contents = code ? hashBytes(code->getPointer(),code->getSize()):content_hash_t{};
+	if (shader->getContentType()!=asset::ICPUShader::E_CONTENT_TYPE::ECT_SPIRV)
+	{
+		const auto& path = shader->getFilepathHint();
+		const content_hash_t pair[2] = {contents,hashBytes(path.data(),path.size())};
+		contents = hashBytes(pair,sizeof(pair));
+	}
+	if (optimizer)
+	{
+		const auto passes = optimizer->getPasses();
+		// an empty pass list still differs from no optimizer, because the module gets round-tripped through the optimizer
+		const content_hash_t pair[2] = {contents,hashBytes(passes.data(),passes.size_bytes())};
+		contents = hashBytes(pair,sizeof(pair));
+	}
+	return hashWithHeader(header,contents);
+}
+
+bool CGPUObjectCreationCache::createShaders(const std::span<const asset::ICPUShader* const> shaders, core::smart_refctd_ptr<IGPUShader>* const output, system::CTaskScheduler* scheduler, const asset::ISPIRVOptimizer* optimizer)
+{
+	const size_t count = shaders.size();
+	core::vector<SContentHash> hashes(count);
+	// the first input with each hash creates the shader, the rest just copy its output
+	core::vector<size_t> firstOccurence(count);
+	core::vector<size_t> toCreate;
+	{
+		core::unordered_map<SKey,size_t,SKeyHash> seen;
+		for (size_t i=0u; i<count; i++)
+		{
+			output[i] = nullptr;
+			if (!shaders[i])
+				continue;
+			hashes[i] = hash(shaders[i],optimizer);
+			const auto inserted = seen.emplace(SKey{hashes[i],asset::IAsset::ET_SHADER},i);
+			firstOccurence[i] = inserted.first->second;
+			if (inserted.second)
+			{
+				output[i] = find<IGPUShader>(asset::IAsset::ET_SHADER,hashes[i]);
+				if (!output[i])
+					toCreate.push_back(i);
+			}
+		}
+	}
+
+	// the device's compiler set (DXC especially) is not thread-safe, so only the SPIR-V module creation runs concurrently
+	std::mutex compilerLock;
+	auto createRange = [&](const size_t begin, const size_t end) -> void
+	{
+		for (auto j=begin; j<end; j++)
+		{
+			const auto i = toCreate[j];
+			core::smart_refctd_ptr<IGPUShader> shader;
+			if (shaders[i]->getContentType()!=asset::ICPUShader::E_CONTENT_TYPE::ECT_SPIRV)
+			{
+				std::lock_guard lock(compilerLock);
+				shader = m_device->createShader(shaders[i],optimizer);
+			}
+			else
+				shader = m_device->createShader(shaders[i],optimizer);
+			output[i] = insert(asset::IAsset::ET_SHADER,hashes[i],std::move(shader));
+		}
+	};
+	if (scheduler)
+		scheduler->parallel_for(0u,toCreate.size(),1u,createRange);
+	else
+		createRange(0u,toCreate.size());
+
+	bool success = true;
+	for (size_t i=0u; i<count; i++)
+	if (shaders[i])
+	{
+		if (firstOccurence[i]!=i)
+			output[i] = output[firstOccurence[i]];
+		success = success && output[i];
+	}
+	return success;
+}
+
+bool CGPUObjectCreationCache::createBuffers(IUtilities* utilities, SIntendedSubmitInfo& nextSubmit, const std::span<const asset::ICPUBuffer* const> buffers, core::smart_refctd_ptr<IGPUBuffer>* const output, system::CTaskScheduler* scheduler)
+{
+	const size_t count = buffers.size();
+	core::vector<SContentHash> hashes(count);
+	auto hashRange = [&](const size_t begin, const size_t end) -> void
+	{
+		for (auto i=begin; i<end; i++)
+		if (buffers[i])
+			hashes[i] = hash(buffers[i],scheduler);
+	};
+	// a few huge buffers still spread over all the workers, since the scheduler handles the nested `parallel_for` over their pieces
+	if (scheduler)
+		scheduler->parallel_for(0u,count,1u,hashRange);
+	else
+		hashRange(0u,count);
+
+	const uint32_t deviceLocalTypeBits = m_device->getPhysicalDevice()->getDeviceLocalMemoryTypeBits();
+	core::unordered_map<SKey,size_t,SKeyHash> seen;
+	bool success = true;
+	for (size_t i=0u; i<count; i++)
+	{
+		output[i] = nullptr;
+		const auto* cpubuffer = buffers[i];
+		if (!cpubuffer)
+			continue;
+
+		const auto inserted = seen.emplace(SKey{hashes[i],asset::IAsset::ET_BUFFER},i);
+		if (!inserted.second)
+		{
+			output[i] = output[inserted.first->second];
+			continue;
+		}
+		if (output[i]=find<IGPUBuffer>(asset::IAsset::ET_BUFFER,hashes[i]); output[i])
+			continue;
+
+		IGPUBuffer::SCreationParams params = {};
+		params.size = cpubuffer->getSize();
+		params.usage = cpubuffer->getUsageFlags();
+		params.usage |= IGPUBuffer::EUF_TRANSFER_DST_BIT;
+		auto gpubuffer = m_device->createBuffer(std::move(params));
+		if (!gpubuffer)
+		{
+			success = false;
+			continue;
+		}
+		auto mreqs = gpubuffer->getMemoryReqs();
+		mreqs.memoryTypeBits &= deviceLocalTypeBits;
+		core::bitflag<IDeviceMemoryAllocation::E_MEMORY_ALLOCATE_FLAGS> allocateFlags(IDeviceMemoryAllocation::EMAF_NONE);
+		if (cpubuffer->getUsageFlags().hasFlags(IGPUBuffer::EUF_SHADER_DEVICE_ADDRESS_BIT))
+			allocateFlags |= IDeviceMemoryAllocation::EMAF_DEVICE_ADDRESS_BIT;
+		// all the uploads share the streaming buffer and the intended submit, so they get batched into as few submits as it can hold
+		if (!m_device->allocate(mreqs,gpubuffer.get(),allocateFlags).isValid() ||
+			!utilities->updateBufferRangeViaStagingBuffer(nextSubmit,asset::SBufferRange<IGPUBuffer>{0u,cpubuffer->getSize(),core::smart_refctd_ptr(gpubuffer)},cpubuffer->getPointer()))
+		{
+			success = false;
+			continue;
+		}
+		output[i] = insert(asset::IAsset::ET_BUFFER,hashes[i],std::move(gpubuffer));
+	}
+	return success;
+}
@@ -0,0 +1,143 @@
+#include "nbl/video/IPhysicalDevice.h"
+#include "nbl/video/ILogicalDevice.h"
+#include "nbl/video/utilities/CPersistentPipelineCache.h"
+
+#include "nbl/core/xxHash256.h"
+
+using namespace nbl;
+using namespace video;
+
+
+core::smart_refctd_ptr<CPersistentPipelineCache> CPersistentPipelineCache::create(SCreationParams&& params)
+{
+	if (!params.device || !params.system || params.filePath.empty())
+		return nullptr;
+
+	const auto data = load(params,params.device->getPipelineCacheKey());
+	auto cache = params.device->createPipelineCache(data);
+	if (!cache && !data.empty())
+	{
+		params.logger.log("Driver refused the pipeline cache data in \"%s\", starting with an empty cache.",system::ILogger::ELL_WARNING,params.filePath.string().c_str());
+		cache = params.device->createPipelineCache(std::span<const uint8_t>{});
+	}
+	if (!cache)
+		return nullptr;
+	return core::smart_refctd_ptr<CPersistentPipelineCache>(new CPersistentPipelineCache(std::move(params),std::move(cache),data.size()),core::dont_grab);
+}
+
+CPersistentPipelineCache::CPersistentPipelineCache(SCreationParams&& params, core::smart_refctd_ptr<IGPUPipelineCache>&& cache, const size_t loadedBytes) :
+	m_device(std::move(params.device)), m_system(std::move(params.system)), m_filePath(std::move(params.filePath)), m_saveInterval(params.saveInterval),
+	m_logger(std::move(params.logger)), m_cache(std::move(cache)), m_lastSave(std::chrono::steady_clock::now())
+{
+	m_stats.loadedBytes = loadedBytes;
+}
+
+CPersistentPipelineCache::~CPersistentPipelineCache()
+{
+	save();
+}
+
+core::vector<uint8_t> CPersistentPipelineCache::load(const SCreationParams& params, const asset::ICPUPipelineCache::SCacheKey& key)
+{
+	if (!params.system->exists(params.filePath,system::IFile::ECF_READ))
+		return {};
+
+	system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
+	params.system->createFile(future,params.filePath,system::IFile::ECF_READ);
+	auto file = future.acquire();
+	if (!file || !bool(*file))
+		return {};
+	const size_t fileSize = (*file)->getSize();
+
+	auto reject = [&](const char* reason) -> core::vector<uint8_t>
+	{
+		params.logger.log("Ignoring pipeline cache \"%s\": %s.",system::ILogger::ELL_WARNING,params.filePath.string().c_str(),reason);
+		return {};
+	};
+
+	SFileHeader header;
+	{
+		system::IFile::success_t succ;
+		(*file)->read(succ,&header,0ull,sizeof(header));
+		if (!succ || header.magic!=SFileHeader::Magic)
+			return reject("not a pipeline cache file");
+	}
+	if (header.version!=SFileHeader::Version)
+		return reject("saved by a different version of the engine");
+	if (header.keySize>fileSize || header.dataSize>fileSize || sizeof(header)+header.keySize+header.dataSize!=fileSize)
+		return reject("truncated");
+
+	// this is where the device, driver and Nabla version check happens
+	std::string fileKey(header.keySize,'\0');
+	{
+		system::IFile::success_t succ;
+		(*file)->read(succ,fileKey.data(),sizeof(header),header.keySize);
+		if (!succ || fileKey!=key.deviceAndDriverUUID)
+			return reject("made for a different device or driver");
+	}
+
+	core::vector<uint8_t> data(header.dataSize);
+	{
+		system::IFile::success_t succ;
+		(*file)->read(succ,data.data(),sizeof(header)+header.keySize,header.dataSize);
+		if (!succ)
+			return reject("failed to read");
+	}
+	uint64_t hash[4];
+	core::XXHash_256(data.data(),data.size(),hash);
+	if (memcmp(hash,header.dataHash,sizeof(hash))!=0)
+		return reject("corrupted");
+	return data;
+}
+
+bool CPersistentPipelineCache::save()
+{
+	std::lock_guard lock(m_saveMutex);
+	m_lastSave = std::chrono::steady_clock::now();
+	// clear it first, so nothing compiled while we're writing gets lost
+	if (!m_dirty.exchange(false))
+		return true;
+
+	const auto key = m_device->getPipelineCacheKey();
+	const auto cpuCache = m_cache->convertToCPUCache();
+	if (!cpuCache)
+		return true;
+	const auto found = cpuCache->getEntries().find(key);
+	if (found==cpuCache->getEntries().end() || !found->second.bin)
+		return true;
+	const auto& data = found->second.bin;
+
+	SFileHeader header;
+	header.keySize = key.deviceAndDriverUUID.size();
+	header.dataSize = data->size();
+	core::XXHash_256(data->data(),data->size(),header.dataHash);
+
+	auto tmpPath = m_filePath;
+	tmpPath += ".tmp";
+	// opening for writing doesn't truncate, a longer leftover from a crashed save would leave garbage at the end
+	m_system->deleteDirectory(tmpPath);
+	bool written = false;
+	{
+		system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
+		m_system->createFile(future,tmpPath,system::IFile::ECF_WRITE);
+		// the file has to be closed before it can be renamed, hence the scope
+		if (auto file=future.acquire(); file&&bool(*file))
+		{
+			system::IFile::success_t headerSucc, keySucc, dataSucc;
+			(*file)->write(headerSucc,&header,0ull,sizeof(header));
+			(*file)->write(keySucc,key.deviceAndDriverUUID.data(),sizeof(header),header.keySize);
+			(*file)->write(dataSucc,data->data(),sizeof(header)+header.keySize,header.dataSize);
+			written = bool(headerSucc) && bool(keySucc) && bool(dataSucc);
+		}
+	}
+	if (!written || m_system->moveFileOrDirectory(tmpPath,m_filePath))
+	{
+		m_logger.log("Failed to write pipeline cache to \"%s\".",system::ILogger::ELL_ERROR,m_filePath.string().c_str());
+		m_dirty.store(true);
+		return false;
+	}
+
+	std::lock_guard statsLock(m_statsMutex);
+	m_stats.saveCount++;
+	return true;
+}
@@ -0,0 +1,303 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+// Standalone check and benchmark of `CAsyncReadbackQueue`, build and link against Nabla and run on any Vulkan device (a software ICD like lavapipe
+// works, `VK_ICD_FILENAMES` picks it), exits with non-zero if a download doesn't arrive exactly once with the contents the frame it was made in
+// wrote, or the queue doesn't give all of the down-streaming buffer back.
+// Every frame a "render" submit fills 4 buffers of 8MiB with a value unique to the frame and download, then the readback of them waits on it.
+// With 3 frames in flight that is more than the default 64MiB down-streaming buffer holds, so the backpressure paths run too. The same frames
+// are then read back with `IUtilities::downloadBufferRangeViaStagingBufferAutoSubmit`, and the time the render thread spends on the readback per
+// frame is printed for both, along with the stalls the queue counted.
+
+#include "nabla.h"
+#include "nbl/system/IApplicationFramework.h"
+
+#include <chrono>
+#include <cstdio>
+
+using namespace nbl;
+using namespace nbl::video;
+
+constexpr uint32_t FrameCount = 120u;
+constexpr uint32_t FramesInFlight = 3u;
+constexpr uint32_t DownloadsPerFrame = 4u;
+constexpr size_t DownloadSize = 8u<<20u;
+// the render side cycles through more buffers than there are frames in flight, so it doesn't wait on the readback every frame
+constexpr uint32_t RenderSlotCount = FramesInFlight+1u;
+
+static uint32_t getPattern(const uint32_t frame, const uint32_t download)
+{
+	return frame*DownloadsPerFrame+download+1u;
+}
+
+//! stands in for encoding, the consumers of both readback paths run it
+struct SVerifier
+{
+	inline void operator()(const uint32_t frame, const uint32_t download, const void* data, const size_t size)
+	{
+		const auto* const words = reinterpret_cast<const uint32_t*>(data);
+		const uint32_t pattern = getPattern(frame,download);
+		bool matches = size==DownloadSize;
+		for (size_t i=0u; matches && i<size/sizeof(uint32_t); i++)
+			matches = words[i]==pattern;
+		if (!matches)
+			mismatches++;
+		if (seen[frame*DownloadsPerFrame+download].exchange(1u))
+			duplicates++;
+		consumed++;
+	}
+
+	std::atomic_uint8_t seen[FrameCount*DownloadsPerFrame] = {};
+	std::atomic_uint32_t consumed = 0u;
+	std::atomic_uint32_t mismatches = 0u;
+	std::atomic_uint32_t duplicates = 0u;
+};
+
+class CRenderer
+{
+	public:
+		inline CRenderer(ILogicalDevice* device, IQueue* queue) : m_device(device), m_queue(queue)
+		{
+			m_semaphore = device->createSemaphore(0ull);
+			m_pool = device->createCommandPool(queue->getFamilyIndex(),IGPUCommandPool::CREATE_FLAGS::RESET_COMMAND_BUFFER_BIT);
+			m_pool->createCommandBuffers(IGPUCommandPool::BUFFER_LEVEL::PRIMARY,{m_cmdbufs,RenderSlotCount});
+			for (auto& buffer : m_buffers)
+			{
+				IGPUBuffer::SCreationParams params = {};
+				params.size = DownloadSize;
+				params.usage = core::bitflag(asset::IBuffer::EUF_TRANSFER_SRC_BIT)|asset::IBuffer::EUF_TRANSFER_DST_BIT;
+				buffer = device->createBuffer(std::move(params));
+				auto reqs = buffer->getMemoryReqs();
+				reqs.memoryTypeBits &= device->getPhysicalDevice()->getDeviceLocalMemoryTypeBits();
+				device->allocate(reqs,buffer.get());
+			}
+		}
+
+		//! fills the slot's buffers, after the readback of the slot's previous frame is done with them
+		inline bool render(const uint32_t frame, const IQueue::SSubmitInfo::SSemaphoreInfo& readbackDone)
+		{
+			const uint32_t slot = frame%RenderSlotCount;
+			// the command buffer can't be reset while its previous submit is pending
+			if (m_slotSignalValues[slot])
+			{
+				const ISemaphore::SWaitInfo waitInfo = {m_semaphore.get(),m_slotSignalValues[slot]};
+				m_device->blockForSemaphores({&waitInfo,1});
+			}
+			auto* const cmdbuf = m_cmdbufs[slot].get();
+			if (!cmdbuf->reset(IGPUCommandBuffer::RESET_FLAGS::RELEASE_RESOURCES_BIT) || !cmdbuf->begin(IGPUCommandBuffer::USAGE::ONE_TIME_SUBMIT_BIT))
+				return false;
+			for (uint32_t d=0u; d<DownloadsPerFrame; d++)
+			if (!cmdbuf->fillBuffer(getRange(frame,d),getPattern(frame,d)))
+				return false;
+			if (!cmdbuf->end())
+				return false;
+
+			const IQueue::SSubmitInfo::SCommandBufferInfo cmdbufInfo = {cmdbuf};
+			const IQueue::SSubmitInfo::SSemaphoreInfo signalInfo = {m_semaphore.get(),m_lastSignalValue+1ull,asset::PIPELINE_STAGE_FLAGS::CLEAR_BIT};
+			IQueue::SSubmitInfo submitInfo = {};
+			if (readbackDone.semaphore && readbackDone.value)
+				submitInfo.waitSemaphores = {&readbackDone,1};
+			submitInfo.commandBuffers = {&cmdbufInfo,1};
+			submitInfo.signalSemaphores = {&signalInfo,1};
+			if (m_queue->submit({&submitInfo,1})!=IQueue::RESULT::SUCCESS)
+				return false;
+			m_slotSignalValues[slot] = ++m_lastSignalValue;
+			return true;
+		}
+
+		inline asset::SBufferRange<IGPUBuffer> getRange(const uint32_t frame, const uint32_t download) const
+		{
+			return {0ull,DownloadSize,m_buffers[(frame%RenderSlotCount)*DownloadsPerFrame+download]};
+		}
+		//! what the readback of the last rendered frame has to wait for
+		inline IQueue::SSubmitInfo::SSemaphoreInfo getDoneInfo() const
+		{
+			return {m_semaphore.get(),m_lastSignalValue,asset::PIPELINE_STAGE_FLAGS::COPY_BIT};
+		}
+
+		inline void wait()
+		{
+			const ISemaphore::SWaitInfo waitInfo = {m_semaphore.get(),m_lastSignalValue};
+			m_device->blockForSemaphores({&waitInfo,1});
+		}
+
+	private:
+		ILogicalDevice* const m_device;
+		IQueue* const m_queue;
+		core::smart_refctd_ptr<ISemaphore> m_semaphore;
+		core::smart_refctd_ptr<IGPUCommandPool> m_pool;
+		core::smart_refctd_ptr<IGPUCommandBuffer> m_cmdbufs[RenderSlotCount];
+		core::smart_refctd_ptr<IGPUBuffer> m_buffers[RenderSlotCount*DownloadsPerFrame];
+		// the timeline keeps going up across both readback runs, the frame numbers start over
+		uint64_t m_slotSignalValues[RenderSlotCount] = {};
+		uint64_t m_lastSignalValue = 0ull;
+};
+
+struct STimings
+{
+	inline void add(const std::chrono::high_resolution_clock::time_point start)
+	{
+		const double ms = std::chrono::duration<double,std::milli>(std::chrono::high_resolution_clock::now()-start).count();
+		total += ms;
+		worst = std::max(worst,ms);
+	}
+
+	double total = 0.0;
+	double worst = 0.0;
+};
+
+static bool checkVerifier(const char* name, const SVerifier& verifier)
+{
+	if (verifier.consumed!=FrameCount*DownloadsPerFrame || verifier.mismatches || verifier.duplicates)
+	{
+		printf("FAILED: %s consumed %u of %u downloads, %u with the wrong contents, %u more than once\n",
+			name,verifier.consumed.load(),FrameCount*DownloadsPerFrame,verifier.mismatches.load(),verifier.duplicates.load());
+		return false;
+	}
+	return true;
+}
+
+int main()
+{
+#ifdef _NBL_PLATFORM_LINUX_
+	auto sys = core::make_smart_refctd_ptr<system::CSystemLinux>();
+#else
+	auto sys = system::IApplicationFramework::createSystem();
+#endif
+	auto logger = core::make_smart_refctd_ptr<system::CStdoutLogger>(core::bitflag(system::ILogger::ELL_ERROR)|system::ILogger::ELL_WARNING);
+	auto connection = CVulkanConnection::create(core::smart_refctd_ptr<system::ISystem>(sys),0u,"asyncReadbackQueueBenchmark",core::smart_refctd_ptr<system::ILogger>(logger),{});
+	if (!connection || connection->getPhysicalDevices().empty())
+	{
+		printf("FAILED: no Vulkan device\n");
+		return 1;
+	}
+	auto* const physicalDevice = connection->getPhysicalDevices().front();
+
+	// any family which can copy, with a second queue for the readback if it has one
+	uint32_t family = 0u;
+	const auto familyProperties = physicalDevice->getQueueFamilyProperties();
+	while (family<familyProperties.size() && !(familyProperties[family].queueFlags&(IQueue::FAMILY_FLAGS::GRAPHICS_BIT|IQueue::FAMILY_FLAGS::COMPUTE_BIT|IQueue::FAMILY_FLAGS::TRANSFER_BIT)))
+		family++;
+	if (family==familyProperties.size())
+	{
+		printf("FAILED: no queue family can copy\n");
+		return 1;
+	}
+	const uint8_t queueCount = std::min<uint32_t>(familyProperties[family].queueCount,2u);
+	ILogicalDevice::SCreationParams params = {};
+	params.queueParams[family].count = queueCount;
+	auto device = physicalDevice->createLogicalDevice(std::move(params));
+	if (!device)
+	{
+		printf("FAILED: couldn't create the logical device\n");
+		return 1;
+	}
+	IQueue* const renderQueue = device->getQueue(family,0u);
+	IQueue* const readbackQueue = device->getQueue(family,queueCount-1u);
+	printf("%s, %u queue(s), %u frames of %u downloads of %zuMiB, %u frames in flight\n",
+		physicalDevice->getProperties().deviceName,queueCount,FrameCount,DownloadsPerFrame,DownloadSize>>20u,FramesInFlight);
+
+	auto utilities = core::make_smart_refctd_ptr<IUtilities>(core::smart_refctd_ptr(device));
+	CRenderer renderer(device.get(),renderQueue);
+
+	STimings asyncTimings;
+	CAsyncReadbackQueue::SStatistics statistics;
+	{
+		SVerifier verifier;
+		CAsyncReadbackQueue::SCreationParams queueParams = {};
+		queueParams.utilities = utilities;
+		queueParams.queue = readbackQueue;
+		queueParams.scheduler = system::CTaskScheduler::create();
+		queueParams.framesInFlight = FramesInFlight;
+		auto readback = CAsyncReadbackQueue::create(std::move(queueParams));
+		if (!readback)
+		{
+			printf("FAILED: couldn't create the CAsyncReadbackQueue\n");
+			return 1;
+		}
+
+		// readback semaphore values the render slots have to wait for before overwriting their buffers
+		uint64_t slotReadbackValues[RenderSlotCount] = {};
+		for (uint32_t frame=0u; frame<FrameCount; frame++)
+		{
+			const uint32_t slot = frame%RenderSlotCount;
+			if (!renderer.render(frame,{readback->getSemaphore(),slotReadbackValues[slot],asset::PIPELINE_STAGE_FLAGS::CLEAR_BIT}))
+			{
+				printf("FAILED: render of frame %u\n",frame);
+				return 1;
+			}
+
+			const auto start = std::chrono::high_resolution_clock::now();
+			for (uint32_t d=0u; d<DownloadsPerFrame; d++)
+			if (!readback->download(renderer.getRange(frame,d),[&verifier,frame,d](const size_t, const void* data, const size_t size)->void{verifier(frame,d,data,size);}))
+			{
+				printf("FAILED: download %u of frame %u\n",d,frame);
+				return 1;
+			}
+			const auto renderDone = renderer.getDoneInfo();
+			if (readback->submit({&renderDone,1})!=IQueue::RESULT::SUCCESS)
+			{
+				printf("FAILED: readback submit of frame %u\n",frame);
+				return 1;
+			}
+			slotReadbackValues[slot] = readback->getLastSignalValue();
+			readback->poll();
+			asyncTimings.add(start);
+		}
+		readback->wait();
+		statistics = readback->getStatistics();
+		if (!checkVerifier("CAsyncReadbackQueue",verifier))
+			return 1;
+	}
+	core::SAddressAllocatorStatistics downStreamingStatistics;
+	utilities->getDefaultDownStreamingBuffer()->fill_statistics(downStreamingStatistics);
+	if (downStreamingStatistics.allocatedSize)
+	{
+		printf("FAILED: CAsyncReadbackQueue didn't give all of the down-streaming buffer back\n");
+		return 1;
+	}
+
+	STimings blockingTimings;
+	{
+		SVerifier verifier;
+		core::vector<uint8_t> data(DownloadSize);
+		for (uint32_t frame=0u; frame<FrameCount; frame++)
+		{
+			// the blocking download is done with the slot's buffers by the time it returns
+			if (!renderer.render(frame,{}))
+			{
+				printf("FAILED: render of frame %u\n",frame);
+				return 1;
+			}
+
+			const auto start = std::chrono::high_resolution_clock::now();
+			const auto renderDone = renderer.getDoneInfo();
+			for (uint32_t d=0u; d<DownloadsPerFrame; d++)
+			{
+				IQueue::SSubmitInfo::SSemaphoreInfo waitInfos[1] = {renderDone};
+				SIntendedSubmitInfo::SFrontHalf submit = {.queue=readbackQueue};
+				// only the first download of the frame has to wait for the render
+				if (d==0u)
+					submit.waitSemaphores = waitInfos;
+				if (!utilities->downloadBufferRangeViaStagingBufferAutoSubmit(submit,renderer.getRange(frame,d),data.data()))
+				{
+					printf("FAILED: blocking download %u of frame %u\n",d,frame);
+					return 1;
+				}
+				verifier(frame,d,data.data(),data.size());
+			}
+			blockingTimings.add(start);
+		}
+		renderer.wait();
+		if (!checkVerifier("downloadBufferRangeViaStagingBufferAutoSubmit",verifier))
+			return 1;
+	}
+
+	printf("CAsyncReadbackQueue: %.2fms average, %.2fms worst per frame on the render thread, %llu stalls over %llu submits\n",
+		asyncTimings.total/FrameCount,asyncTimings.worst,static_cast<unsigned long long>(statistics.stallCount),static_cast<unsigned long long>(statistics.submitCount));
+	printf("downloadBufferRangeViaStagingBufferAutoSubmit: %.2fms average, %.2fms worst per frame on the render thread\n",
+		blockingTimings.total/FrameCount,blockingTimings.worst);
+	printf("all passed\n");
+	return 0;
+}
@@ -0,0 +1,207 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+// Standalone check and benchmark of the `float` intermediate path of `CBlitImageFilter` against the `double` one, build against the Nabla
+// include directory (with optimizations, and `-mavx2 -mfma` or `/arch:AVX2` to cover the FMA path) and run, exits with non-zero if any encoded
+// channel of an `EIP_FLOAT` blit is further than 1 code unit (ULP for the half float formats) away from the `EIP_DOUBLE` one.
+// Blits random noise, the worst case for cancellation, up and down by non-integer factors through 8 and 16 bit UNORM, sRGB and half float
+// formats with a box and a Mitchell resampling kernel, then prints the time both precisions take for a large RGBA8 downscale.
+
+#include "nbl/core/declarations.h"
+#include "nbl/core/definitions.h"
+#include "nbl/asset/filters/CBlitImageFilter.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace nbl;
+using namespace nbl::asset;
+
+//! box reconstruction convolved with a box or Mitchell resampling, one for every channel
+template<class Resampling>
+struct SKernel
+{
+	using reconstruction_t = CWeightFunction1D<SBoxFunction>;
+	using resampling_t = CWeightFunction1D<Resampling>;
+	using blit_utils_t = CBlitUtilities<CDefaultChannelIndependentWeightFunction1D<CConvolutionWeightFunction1D<reconstruction_t,resampling_t>>>;
+};
+using box_kernel_t = SKernel<SBoxFunction>;
+using mitchell_kernel_t = SKernel<SMitchellFunction<>>;
+
+static const char* getFormatName(const E_FORMAT format)
+{
+	switch (format)
+	{
+		case EF_R8_UNORM: return "EF_R8_UNORM";
+		case EF_R8G8B8A8_UNORM: return "EF_R8G8B8A8_UNORM";
+		case EF_R8G8B8A8_SRGB: return "EF_R8G8B8A8_SRGB";
+		case EF_R16_UNORM: return "EF_R16_UNORM";
+		case EF_R16G16B16A16_UNORM: return "EF_R16G16B16A16_UNORM";
+		case EF_R16G16B16A16_SFLOAT: return "EF_R16G16B16A16_SFLOAT";
+		default: return "?";
+	}
+}
+
+static core::smart_refctd_ptr<ICPUImage> createImage(const E_FORMAT format, const uint32_t width, const uint32_t height)
+{
+	ICPUImage::SCreationParams params = {};
+	params.type = IImage::ET_2D;
+	params.samples = ICPUImage::ESCF_1_BIT;
+	params.format = format;
+	params.extent = {width,height,1u};
+	params.mipLevels = 1u;
+	params.arrayLayers = 1u;
+	params.usage = IImage::EUF_SAMPLED_BIT;
+	auto image = ICPUImage::create(std::move(params));
+
+	auto buffer = core::make_smart_refctd_ptr<ICPUBuffer>(size_t(width)*height*getTexelOrBlockBytesize(format));
+	auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(1u);
+	auto& region = regions->front();
+	region.bufferOffset = 0u;
+	region.bufferRowLength = 0u;
+	region.bufferImageHeight = 0u;
+	region.imageSubresource.aspectMask = IImage::EAF_COLOR_BIT;
+	region.imageSubresource.mipLevel = 0u;
+	region.imageSubresource.baseArrayLayer = 0u;
+	region.imageSubresource.layerCount = 1u;
+	region.imageOffset = {0u,0u,0u};
+	region.imageExtent = {width,height,1u};
+	image->setBufferAndRegions(std::move(buffer),regions);
+	return image;
+}
+
+//! returns false if the blit failed
+template<class Kernel>
+static bool blit(ICPUImage* in, ICPUImage* out, const IBlitUtilities::E_INTERMEDIATE_PRECISION precision)
+{
+	using blit_utils_t = typename Kernel::blit_utils_t;
+	using blit_filter_t = CBlitImageFilter<VoidSwizzle,IdentityDither,void,true,blit_utils_t>;
+	const auto inExtent = in->getCreationParameters().extent;
+	const auto outExtent = out->getCreationParameters().extent;
+	const core::vectorSIMDu32 inExtentLayerCount(inExtent.width,inExtent.height,inExtent.depth,1u);
+	const core::vectorSIMDu32 outExtentLayerCount(outExtent.width,outExtent.height,outExtent.depth,1u);
+
+	typename blit_filter_t::state_type state(blit_utils_t::template getConvolutionKernels<typename Kernel::reconstruction_t,typename Kernel::resampling_t>(inExtentLayerCount,outExtentLayerCount));
+	state.inImage = in;
+	state.outImage = out;
+	state.inOffsetBaseLayer = core::vectorSIMDu32(0u);
+	state.inExtentLayerCount = inExtentLayerCount;
+	state.outOffsetBaseLayer = core::vectorSIMDu32(0u);
+	state.outExtentLayerCount = outExtentLayerCount;
+	state.intermediatePrecision = precision;
+
+	state.scratchMemoryByteSize = blit_filter_t::getRequiredScratchByteSize(&state);
+	state.scratchMemory = reinterpret_cast<uint8_t*>(_NBL_ALIGNED_MALLOC(state.scratchMemoryByteSize,32u));
+	const bool success = state.recomputeScaledKernelPhasedLUT() && blit_filter_t::execute(core::execution::seq,&state);
+	_NBL_ALIGNED_FREE(state.scratchMemory);
+	return success;
+}
+
+//! distance between two encoded channels, counting half floats in ULPs
+static uint32_t codeUnitDistance(const E_FORMAT format, const uint8_t* a, const uint8_t* b)
+{
+	const uint32_t channelBytes = getTexelOrBlockBytesize(format)/getFormatChannelCount(format);
+	if (channelBytes==1u)
+		return std::abs(int32_t(*a)-int32_t(*b));
+	uint16_t x, y;
+	memcpy(&x,a,sizeof(x));
+	memcpy(&y,b,sizeof(y));
+	if (isFloatingPointFormat(format))
+	{
+		// sign-magnitude to a monotonic integer line
+		auto toOrdered = [](const uint16_t v) -> int32_t {return v&0x8000u ? -int32_t(v&0x7fffu):int32_t(v);};
+		return std::abs(toOrdered(x)-toOrdered(y));
+	}
+	return std::abs(int32_t(x)-int32_t(y));
+}
+
+template<class Kernel>
+static bool check(const char* kernelName, const E_FORMAT format, const uint32_t inWidth, const uint32_t inHeight, const uint32_t outWidth, const uint32_t outHeight)
+{
+	auto in = createImage(format,inWidth,inHeight);
+	{
+		std::mt19937 rng(inWidth*inHeight+format);
+		auto* texels = reinterpret_cast<uint8_t*>(in->getBuffer()->getPointer());
+		const size_t byteSize = in->getBuffer()->getSize();
+		if (isFloatingPointFormat(format))
+		{
+			// noise in [0,4) so HDR values go through the filter, without any NaN or infinity patterns
+			std::uniform_real_distribution<float> dist(0.f,4.f);
+			auto* halfs = reinterpret_cast<uint16_t*>(texels);
+			for (size_t i=0u; i<byteSize/sizeof(uint16_t); i++)
+				halfs[i] = core::Float16Compressor::compress(dist(rng));
+		}
+		else for (size_t i=0u; i<byteSize; i++)
+			texels[i] = uint8_t(rng());
+	}
+	auto outDouble = createImage(format,outWidth,outHeight);
+	auto outFloat = createImage(format,outWidth,outHeight);
+	if (!blit<Kernel>(in.get(),outDouble.get(),IBlitUtilities::EIP_DOUBLE) || !blit<Kernel>(in.get(),outFloat.get(),IBlitUtilities::EIP_FLOAT))
+	{
+		printf("FAILED: %s blit of %s %ux%u to %ux%u didn't execute\n",kernelName,getFormatName(format),inWidth,inHeight,outWidth,outHeight);
+		return false;
+	}
+
+	const uint32_t channelBytes = getTexelOrBlockBytesize(format)/getFormatChannelCount(format);
+	const auto* a = reinterpret_cast<const uint8_t*>(outDouble->getBuffer()->getPointer());
+	const auto* b = reinterpret_cast<const uint8_t*>(outFloat->getBuffer()->getPointer());
+	const size_t channelCount = outDouble->getBuffer()->getSize()/channelBytes;
+	uint32_t maxDistance = 0u;
+	size_t differing = 0u;
+	for (size_t i=0u; i<channelCount; i++)
+	{
+		const uint32_t distance = codeUnitDistance(format,a+i*channelBytes,b+i*channelBytes);
+		maxDistance = std::max(maxDistance,distance);
+		differing += distance ? 1u:0u;
+	}
+	printf("%-8s %-26s %4ux%-4u -> %4ux%-4u max difference %u code units, %zu of %zu channels differ\n",
+		kernelName,getFormatName(format),inWidth,inHeight,outWidth,outHeight,maxDistance,differing,channelCount);
+	return maxDistance<=1u;
+}
+
+template<class Kernel>
+static bool checkAllFormats(const char* kernelName)
+{
+	constexpr E_FORMAT formats[] = {EF_R8_UNORM,EF_R8G8B8A8_UNORM,EF_R8G8B8A8_SRGB,EF_R16_UNORM,EF_R16G16B16A16_UNORM,EF_R16G16B16A16_SFLOAT};
+	bool success = true;
+	for (const auto format : formats)
+	{
+		success = check<Kernel>(kernelName,format,256u,256u,97u,61u) && success;
+		success = check<Kernel>(kernelName,format,64u,48u,200u,150u) && success;
+	}
+	return success;
+}
+
+template<class Kernel>
+static double timeBlit(ICPUImage* in, ICPUImage* out, const IBlitUtilities::E_INTERMEDIATE_PRECISION precision)
+{
+	double best = std::numeric_limits<double>::max();
+	for (uint32_t run=0u; run<3u; run++)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		blit<Kernel>(in,out,precision);
+		best = std::min(best,std::chrono::duration<double,std::milli>(std::chrono::high_resolution_clock::now()-start).count());
+	}
+	return best;
+}
+
+int main()
+{
+	bool success = checkAllFormats<box_kernel_t>("box");
+	success = checkAllFormats<mitchell_kernel_t>("mitchell") && success;
+	if (!success)
+	{
+		printf("FAILED: the float path is more than 1 code unit off\n");
+		return 1;
+	}
+
+	auto in = createImage(EF_R8G8B8A8_UNORM,2048u,2048u);
+	auto out = createImage(EF_R8G8B8A8_UNORM,1365u,1365u);
+	const double doubleMs = timeBlit<mitchell_kernel_t>(in.get(),out.get(),IBlitUtilities::EIP_DOUBLE);
+	const double floatMs = timeBlit<mitchell_kernel_t>(in.get(),out.get(),IBlitUtilities::EIP_FLOAT);
+	printf("mitchell EF_R8G8B8A8_UNORM 2048x2048 -> 1365x1365, single threaded: double %.1fms, float %.1fms (%.2fx)\n",doubleMs,floatMs,doubleMs/floatMs);
+	printf("all passed\n");
+	return 0;
+}
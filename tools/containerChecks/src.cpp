@@ -0,0 +1,92 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+// Standalone checks for the header-only containers, build against the Nabla include directory and run, exits with non-zero on the first failure.
+// Erasing the first or last node of a `FixedCapacityDoublyLinkedList` used to leave the list's front/back dangling, the next `LRUCache::insert`
+// would then loop forever on the free list.
+
+#include "nbl/core/declarations.h"
+#include "nbl/core/containers/LRUCache.h"
+
+#include <cstdio>
+
+using namespace nbl;
+
+#define NBL_CHECK(EXPR) if (!(EXPR)) {printf("FAILED %s:%d %s\n",__FILE__,__LINE__,#EXPR); return 1;}
+
+template<class Cache>
+static uint32_t countEntries(const Cache& cache, const int maxKey)
+{
+	uint32_t count = 0u;
+	for (int k=0; k<=maxKey; k++)
+	if (cache.peek(k))
+		count++;
+	return count;
+}
+
+int main()
+{
+	// erase the front, then fill past capacity
+	{
+		core::LRUCache<int,int> cache(4u);
+		cache.insert(1,10);
+		cache.insert(2,20);
+		cache.insert(3,30);
+		cache.erase(3);
+		for (int k=4; k<=7; k++)
+			cache.insert(k,k*10);
+		NBL_CHECK(countEntries(cache,7)==4u);
+		for (int k=4; k<=7; k++)
+			NBL_CHECK(cache.peek(k) && *cache.peek(k)==k*10);
+	}
+	// erase the back (least recently used), then evict
+	{
+		core::LRUCache<int,int> cache(3u);
+		cache.insert(1,10);
+		cache.insert(2,20);
+		cache.insert(3,30);
+		cache.erase(1);
+		cache.insert(4,40);
+		cache.insert(5,50);
+		NBL_CHECK(!cache.peek(2));
+		NBL_CHECK(countEntries(cache,5)==3u);
+	}
+	// erase the only entry, the list has to become empty
+	{
+		core::LRUCache<int,int> cache(2u);
+		cache.insert(1,10);
+		cache.erase(1);
+		NBL_CHECK(countEntries(cache,1)==0u);
+		cache.insert(2,20);
+		cache.insert(3,30);
+		cache.insert(4,40);
+		NBL_CHECK(!cache.peek(2) && cache.peek(3) && cache.peek(4));
+	}
+	// touching the back moves it to the front, the next eviction must take the new back
+	{
+		core::LRUCache<int,int> cache(3u);
+		cache.insert(1,10);
+		cache.insert(2,20);
+		cache.insert(3,30);
+		NBL_CHECK(cache.get(1));
+		cache.insert(4,40);
+		NBL_CHECK(cache.peek(1) && !cache.peek(2));
+	}
+	// every remaining node gets disposed exactly once
+	{
+		uint32_t disposed = 0u;
+		{
+			core::LRUCache<int,int> cache(4u,[&disposed](std::pair<int,int>&)->void{disposed++;});
+			cache.insert(1,10);
+			cache.insert(2,20);
+			cache.insert(3,30);
+			cache.erase(2);
+			NBL_CHECK(disposed==1u);
+		}
+		NBL_CHECK(disposed==3u);
+	}
+
+	printf("OK\n");
+	return 0;
+}
@@ -0,0 +1,166 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+// Standalone stress test and thread scaling benchmark of `LockFreePoolAddressAllocator`, build against the Nabla include directory (with
+// optimizations, and ideally once more with `-fsanitize=thread`) and run, exits with non-zero if a block ever gets handed to two threads at once,
+// or the free chain doesn't hold every block exactly once after all threads are done.
+// For 1 to 64 threads (or the count given as the first argument as the maximum) it runs the same total number of allocate/free operations,
+// each thread holding up to 32 blocks, on the locked `PoolAddressAllocatorMT`, the lock-free allocator and the lock-free one with per-thread
+// `magazine_t`s, printing the throughput of each. Scaling only shows on as many hardware threads as there are software ones.
+
+#include "nbl/core/declarations.h"
+#include "nbl/core/alloc/LockFreePoolAddressAllocator.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+using namespace nbl;
+
+constexpr uint32_t BlockSize = 64u;
+constexpr uint32_t BlockCount = 1u<<16u;
+constexpr uint32_t TotalOperations = 1u<<22u;
+constexpr uint32_t MaxHeldPerThread = 32u;
+
+enum E_MODE : uint32_t
+{
+	EM_LOCKED,
+	EM_LOCK_FREE,
+	EM_LOCK_FREE_MAGAZINES,
+	EM_COUNT
+};
+constexpr const char* ModeNames[EM_COUNT] = {"PoolAddressAllocatorMT","LockFreePoolAddressAllocator","LockFreePoolAddressAllocator+magazines"};
+
+template<class AddressAllocator>
+struct SAllocatorWithReserved
+{
+	SAllocatorWithReserved() :
+		reserved(_NBL_ALIGNED_MALLOC(AddressAllocator::reserved_size(BlockSize,BlockCount*BlockSize,BlockSize),_NBL_SIMD_ALIGNMENT)),
+		allocator(reserved,0u,0u,BlockSize,BlockCount*BlockSize,BlockSize) {}
+	~SAllocatorWithReserved() {_NBL_ALIGNED_FREE(reserved);}
+
+	void* reserved;
+	AddressAllocator allocator;
+};
+
+//! returns the time taken in milliseconds, or a negative value if a block was handed out twice
+template<E_MODE Mode, class AddressAllocator>
+static double run(AddressAllocator& allocator, const uint32_t threadCount, std::atomic_uint8_t* owned)
+{
+	std::atomic_bool doubleHandout = false;
+	const auto start = std::chrono::high_resolution_clock::now();
+	{
+		core::vector<std::thread> threads;
+		for (uint32_t t=0u; t<threadCount; t++)
+		threads.emplace_back([&]() -> void
+		{
+			typename core::LockFreePoolAddressAllocator<uint32_t>::magazine_t magazine;
+			auto alloc = [&]() -> uint32_t
+			{
+				if constexpr (Mode==EM_LOCK_FREE_MAGAZINES)
+					return allocator.alloc_addr(magazine,BlockSize,BlockSize);
+				else if constexpr (Mode==EM_LOCK_FREE)
+					return allocator.alloc_addr(BlockSize,BlockSize);
+				else
+				{
+					// the locking adaptor only exposes the multi-allocation entry points
+					uint32_t addr = AddressAllocator::invalid_address;
+					core::address_allocator_traits<AddressAllocator>::multi_alloc_addr(allocator,1u,&addr,&BlockSize,BlockSize);
+					return addr;
+				}
+			};
+			auto free = [&](const uint32_t addr) -> void
+			{
+				owned[addr/BlockSize].store(0u,std::memory_order_relaxed);
+				if constexpr (Mode==EM_LOCK_FREE_MAGAZINES)
+					allocator.free_addr(magazine,addr,BlockSize);
+				else if constexpr (Mode==EM_LOCK_FREE)
+					allocator.free_addr(addr,BlockSize);
+				else
+					core::address_allocator_traits<AddressAllocator>::multi_free_addr(allocator,1u,&addr,&BlockSize);
+			};
+
+			uint32_t held[MaxHeldPerThread];
+			uint32_t heldCount = 0u;
+			for (uint32_t i=0u; i<TotalOperations/threadCount; i++)
+			{
+				// two allocations for every free until the thread holds its maximum, then drain
+				if (heldCount<MaxHeldPerThread && i%3u!=2u)
+				{
+					const auto addr = alloc();
+					if (addr==AddressAllocator::invalid_address)
+						continue;
+					if (owned[addr/BlockSize].exchange(1u,std::memory_order_relaxed))
+						doubleHandout.store(true,std::memory_order_relaxed);
+					held[heldCount++] = addr;
+				}
+				else if (heldCount)
+					free(held[--heldCount]);
+			}
+			while (heldCount)
+				free(held[--heldCount]);
+			if constexpr (Mode==EM_LOCK_FREE_MAGAZINES)
+				allocator.flush(magazine);
+		});
+		for (auto& thread : threads)
+			thread.join();
+	}
+	if (doubleHandout.load())
+		return -1.0;
+	return std::chrono::duration<double,std::milli>(std::chrono::high_resolution_clock::now()-start).count();
+}
+
+//! everything has to be back on the free chain exactly once
+template<class AddressAllocator>
+static bool checkChain(AddressAllocator& allocator)
+{
+	if (allocator.get_free_size()!=BlockCount*BlockSize)
+		return false;
+	core::vector<uint32_t> handedOut;
+	core::vector<bool> seen(BlockCount,false);
+	bool duplicate = false;
+	for (uint32_t addr; (addr=allocator.alloc_addr(BlockSize,BlockSize))!=AddressAllocator::invalid_address; )
+	{
+		duplicate = duplicate || seen[addr/BlockSize];
+		seen[addr/BlockSize] = true;
+		handedOut.push_back(addr);
+	}
+	for (const auto addr : handedOut)
+		allocator.free_addr(addr,BlockSize);
+	return !duplicate && handedOut.size()==BlockCount;
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t maxThreads = argc>1 ? uint32_t(std::atoi(argv[1])):64u;
+	printf("%u hardware threads, %u operations per run\n",std::thread::hardware_concurrency(),TotalOperations);
+
+	SAllocatorWithReserved<core::PoolAddressAllocatorMT<uint32_t,std::recursive_mutex>> locked;
+	SAllocatorWithReserved<core::LockFreePoolAddressAllocator<uint32_t>> lockFree;
+	core::vector<std::atomic_uint8_t> owned(BlockCount);
+	for (uint32_t threadCount=1u; threadCount<=maxThreads; threadCount<<=1u)
+	{
+		double ms[EM_COUNT];
+		ms[EM_LOCKED] = run<EM_LOCKED>(locked.allocator,threadCount,owned.data());
+		ms[EM_LOCK_FREE] = run<EM_LOCK_FREE>(lockFree.allocator,threadCount,owned.data());
+		if (ms[EM_LOCK_FREE]<0.0 || !checkChain(lockFree.allocator))
+		{
+			printf("FAILED: %s with %u threads\n",ModeNames[EM_LOCK_FREE],threadCount);
+			return 1;
+		}
+		ms[EM_LOCK_FREE_MAGAZINES] = run<EM_LOCK_FREE_MAGAZINES>(lockFree.allocator,threadCount,owned.data());
+		if (ms[EM_LOCK_FREE_MAGAZINES]<0.0 || !checkChain(lockFree.allocator))
+		{
+			printf("FAILED: %s with %u threads\n",ModeNames[EM_LOCK_FREE_MAGAZINES],threadCount);
+			return 1;
+		}
+		for (uint32_t mode=0u; mode<EM_COUNT; mode++)
+			printf("%2u threads, %s: %.1f Mops/s\n",threadCount,ModeNames[mode],double(TotalOperations)/ms[mode]*1e-3);
+	}
+	printf("all passed\n");
+	return 0;
+}
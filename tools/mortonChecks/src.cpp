@@ -0,0 +1,86 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+// Standalone checks of `nbl/core/math/morton.h` against a bit by bit interleave, build against the Nabla include directory and run,
+// exits with non-zero on the first failure. Build it once with `-mbmi2` (or `/arch:AVX2`) and once without, to cover both the `pdep`/`pext`
+// and the scalar paths. Coordinates above `bitDepth/dims` bits and codes above `bitDepth/dims*dims` bits have to get dropped by both.
+
+#include "nbl/core/math/morton.h"
+
+#include <cstdio>
+#include <random>
+
+using namespace nbl;
+
+#define NBL_CHECK(EXPR) if (!(EXPR)) {printf("FAILED %s:%d %s (bitDepth %u, %zu byte code)\n",__FILE__,__LINE__,#EXPR,bitDepth,sizeof(T)); return false;}
+
+template<typename T, uint32_t bits>
+static T lowBits(const T x)
+{
+	if constexpr (bits>=sizeof(T)*8u)
+		return x;
+	else
+		return x&((T(1)<<bits)-T(1));
+}
+
+template<typename T, uint32_t bitDepth>
+static T interleave2d(const T x, const T y)
+{
+	T retval = 0u;
+	for (uint32_t i=0u; i<bitDepth/2u; i++)
+		retval |= (((x>>i)&T(1))<<(2u*i))|(((y>>i)&T(1))<<(2u*i+1u));
+	return retval;
+}
+template<typename T, uint32_t bitDepth>
+static T interleave3d(const T x, const T y, const T z)
+{
+	T retval = 0u;
+	for (uint32_t i=0u; i<bitDepth/3u; i++)
+		retval |= (((x>>i)&T(1))<<(3u*i))|(((y>>i)&T(1))<<(3u*i+1u))|(((z>>i)&T(1))<<(3u*i+2u));
+	return retval;
+}
+
+template<typename T, uint32_t bitDepth>
+static bool check(const uint32_t iterations)
+{
+	std::mt19937_64 rng(bitDepth*8u+sizeof(T));
+	for (uint32_t it=0u; it<iterations; it++)
+	{
+		// every other round stays in range, the rest has garbage in the high bits
+		T x = rng(), y = rng(), z = rng(), code = rng();
+		if (it&1u)
+		{
+			x = lowBits<T,bitDepth/3u>(x);
+			y = lowBits<T,bitDepth/3u>(y);
+			z = lowBits<T,bitDepth/3u>(z);
+		}
+		NBL_CHECK((core::morton2d_encode<T,bitDepth>(x,y)==interleave2d<T,bitDepth>(x,y)));
+		NBL_CHECK((core::morton3d_encode<T,bitDepth>(x,y,z)==interleave3d<T,bitDepth>(x,y,z)));
+
+		const T x2 = core::morton2d_decode_x<T,bitDepth>(code);
+		const T y2 = core::morton2d_decode_y<T,bitDepth>(code);
+		NBL_CHECK((interleave2d<T,bitDepth>(x2,y2)==lowBits<T,bitDepth/2u*2u>(code)));
+		NBL_CHECK((x2==lowBits<T,bitDepth/2u>(x2) && y2==lowBits<T,bitDepth/2u>(y2)));
+		const T x3 = core::morton3d_decode_x<T,bitDepth>(code);
+		const T y3 = core::morton3d_decode_y<T,bitDepth>(code);
+		const T z3 = core::morton3d_decode_z<T,bitDepth>(code);
+		NBL_CHECK((interleave3d<T,bitDepth>(x3,y3,z3)==lowBits<T,bitDepth/3u*3u>(code)));
+		NBL_CHECK((x3==lowBits<T,bitDepth/3u>(x3) && y3==lowBits<T,bitDepth/3u>(y3) && z3==lowBits<T,bitDepth/3u>(z3)));
+	}
+	return true;
+}
+
+int main()
+{
+#ifdef _NBL_MORTON_WITH_BMI2_
+	printf("checking the BMI2 path\n");
+#else
+	printf("checking the scalar path\n");
+#endif
+	constexpr uint32_t iterations = 1u<<18u;
+	if (!check<uint32_t,32u>(iterations) || !check<uint32_t,16u>(iterations) || !check<uint64_t,64u>(iterations) || !check<uint64_t,32u>(iterations))
+		return 1;
+	printf("all passed\n");
+	return 0;
+}
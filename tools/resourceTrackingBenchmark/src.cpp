@@ -0,0 +1,164 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+// Standalone check and benchmark of `CRefctdPointerSet`, the set behind `IGPUCommandBuffer::RESOURCE_TRACKING::DEDUPLICATED`, build against the
+// Nabla include directory (with optimizations) and run, exits with non-zero if an object ends up grabbed other than exactly once while in the set,
+// or `clear` leaves a reference behind or gives the slots back.
+// The benchmark mimics recording without a device: every thread records 100k commands referencing 4 of the same 16 shared objects, then resets,
+// once holding a `smart_refctd_ptr` per resource per command like `RESOURCE_TRACKING::PER_COMMAND` and once through the set. It prints the
+// throughput for 1 to 16 threads (or the count given as the first argument as the maximum). Contention only shows on as many hardware threads as
+// there are software ones.
+
+#include "nbl/core/declarations.h"
+#include "nbl/core/definitions.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+using namespace nbl;
+
+#define NBL_CHECK(EXPR) if (!(EXPR)) {printf("FAILED %s:%d %s\n",__FILE__,__LINE__,#EXPR); return false;}
+
+constexpr uint32_t CommandCount = 100000u;
+constexpr uint32_t ResourcesPerCommand = 4u;
+constexpr uint32_t SharedResourceCount = 16u;
+constexpr uint32_t Recordings = 20u;
+
+class CResource final : public core::IReferenceCounted
+{
+	protected:
+		~CResource() = default;
+};
+
+static bool check()
+{
+	constexpr uint32_t ObjectCount = 10000u;
+	core::vector<core::smart_refctd_ptr<CResource>> objects(ObjectCount);
+	for (auto& object : objects)
+		object = core::make_smart_refctd_ptr<CResource>();
+
+	std::mt19937 rng(41u);
+	core::CRefctdPointerSet set;
+	size_t capacity = 0u;
+	for (uint32_t round=0u; round<8u; round++)
+	{
+		// every other round inserts enough distinct objects to grow the set a few times
+		const uint32_t distinct = round&1u ? ObjectCount:97u;
+		core::vector<bool> inserted(ObjectCount,false);
+		for (uint32_t i=0u; i<ObjectCount*4u; i++)
+		{
+			const uint32_t index = rng()%distinct;
+			set.insert(objects[index].get());
+			// repeat the same object now and then, to go through the last inserted shortcut
+			if (rng()%4u==0u)
+				set.insert(objects[index].get());
+			inserted[index] = true;
+		}
+		size_t expectedSize = 0u;
+		for (uint32_t i=0u; i<ObjectCount; i++)
+		{
+			NBL_CHECK(objects[i]->getReferenceCount()==(inserted[i] ? 2:1));
+			expectedSize += inserted[i] ? 1u:0u;
+		}
+		NBL_CHECK(set.size()==expectedSize);
+		NBL_CHECK(set.capacity()*3u>=set.size()*4u);
+
+		capacity = std::max(capacity,set.capacity());
+		set.clear();
+		NBL_CHECK(set.size()==0u && set.capacity()==capacity);
+		for (const auto& object : objects)
+			NBL_CHECK(object->getReferenceCount()==1);
+	}
+
+	// the set has to keep an object alive after every other reference is gone
+	{
+		auto object = core::make_smart_refctd_ptr<CResource>();
+		set.insert(object.get());
+		const auto* raw = object.get();
+		object = nullptr;
+		NBL_CHECK(raw->getReferenceCount()==1);
+		set.clear();
+	}
+	return true;
+}
+
+enum E_MODE : uint32_t
+{
+	EM_PER_COMMAND,
+	EM_DEDUPLICATED,
+	EM_COUNT
+};
+constexpr const char* ModeNames[EM_COUNT] = {"PER_COMMAND","DEDUPLICATED"};
+
+//! returns the time taken in milliseconds
+template<E_MODE Mode>
+static double run(const core::vector<core::smart_refctd_ptr<CResource>>& shared, const uint32_t threadCount)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+	{
+		core::vector<std::thread> threads;
+		for (uint32_t t=0u; t<threadCount; t++)
+		threads.emplace_back([&,t]() -> void
+		{
+			// what the commands would keep in their segments
+			core::vector<core::smart_refctd_ptr<const core::IReferenceCounted>> perCommand;
+			perCommand.reserve(CommandCount*ResourcesPerCommand);
+			core::CRefctdPointerSet deduplicated;
+
+			std::minstd_rand rng(t+1u);
+			for (uint32_t recording=0u; recording<Recordings; recording++)
+			{
+				for (uint32_t command=0u; command<CommandCount; command++)
+				for (uint32_t r=0u; r<ResourcesPerCommand; r++)
+				{
+					const auto* resource = shared[rng()%SharedResourceCount].get();
+					if constexpr (Mode==EM_PER_COMMAND)
+						perCommand.emplace_back(resource);
+					else
+						deduplicated.insert(resource);
+				}
+				// reset
+				perCommand.clear();
+				deduplicated.clear();
+			}
+		});
+		for (auto& thread : threads)
+			thread.join();
+	}
+	return std::chrono::duration<double,std::milli>(std::chrono::high_resolution_clock::now()-start).count();
+}
+
+int main(int argc, char** argv)
+{
+	if (!check())
+		return 1;
+	printf("CRefctdPointerSet checks passed\n");
+
+	const uint32_t maxThreads = argc>1 ? uint32_t(std::atoi(argv[1])):16u;
+	printf("%u hardware threads, %u commands with %u resources each per recording, %u recordings per thread\n",
+		std::thread::hardware_concurrency(),CommandCount,ResourcesPerCommand,Recordings);
+
+	core::vector<core::smart_refctd_ptr<CResource>> shared(SharedResourceCount);
+	for (auto& resource : shared)
+		resource = core::make_smart_refctd_ptr<CResource>();
+	for (uint32_t threadCount=1u; threadCount<=maxThreads; threadCount<<=1u)
+	{
+		double ms[EM_COUNT];
+		ms[EM_PER_COMMAND] = run<EM_PER_COMMAND>(shared,threadCount);
+		ms[EM_DEDUPLICATED] = run<EM_DEDUPLICATED>(shared,threadCount);
+		for (uint32_t mode=0u; mode<EM_COUNT; mode++)
+			printf("%2u threads, %s: %.1f M commands/s\n",threadCount,ModeNames[mode],double(CommandCount)*Recordings*threadCount/ms[mode]*1e-3);
+	}
+	for (const auto& resource : shared)
+	if (resource->getReferenceCount()!=1)
+	{
+		printf("FAILED: a shared resource was left with %d references\n",resource->getReferenceCount());
+		return 1;
+	}
+	printf("all passed\n");
+	return 0;
+}
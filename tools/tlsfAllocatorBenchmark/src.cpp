@@ -0,0 +1,136 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+// Standalone check and benchmark of `TLSFAddressAllocator` against `GeneralpurposeAddressAllocator`, build against the Nabla include directory
+// (with optimizations) and run, exits with non-zero if the TLSF allocator hands out overlapping, misaligned or out of range blocks, loses track
+// of its free space, or fails to coalesce everything back into one block.
+// The benchmark replays the same random mix of allocations (mostly up to 16KiB, one in 16 up to 512KiB) and frees on a 64MiB range with
+// 256 byte blocks for both, and prints the average and worst latency of `alloc_addr` plus how many allocations failed.
+
+#include "nbl/core/declarations.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+
+using namespace nbl;
+
+#define NBL_CHECK(EXPR) if (!(EXPR)) {printf("FAILED %s:%d %s\n",__FILE__,__LINE__,#EXPR); return false;}
+
+constexpr uint32_t BufferSize = 64u<<20u;
+constexpr uint32_t MinBlockSize = 256u;
+constexpr uint32_t MaxAlignment = 4096u;
+
+template<class AddressAllocator>
+struct SAllocatorWithReserved
+{
+	SAllocatorWithReserved(const uint32_t size) :
+		reserved(_NBL_ALIGNED_MALLOC(AddressAllocator::reserved_size(MaxAlignment,size,MinBlockSize),_NBL_SIMD_ALIGNMENT)),
+		allocator(reserved,0u,0u,MaxAlignment,size,MinBlockSize) {}
+	~SAllocatorWithReserved() {_NBL_ALIGNED_FREE(reserved);}
+
+	void* reserved;
+	AddressAllocator allocator;
+};
+
+static bool check()
+{
+	using tlsf_t = core::TLSFAddressAllocator<uint32_t>;
+	SAllocatorWithReserved<tlsf_t> tlsf(BufferSize);
+	auto& allocator = tlsf.allocator;
+
+	std::mt19937 rng(1u);
+	std::map<uint32_t,uint32_t> live; // address to bytes
+	for (uint32_t it=0u; it<2000000u; it++)
+	{
+		if (live.empty() || rng()%100u<52u)
+		{
+			const uint32_t bytes = 1u+rng()%(rng()%8u==0u ? (1u<<20u):8192u);
+			const uint32_t alignment = 1u<<(rng()%13u);
+			const auto addr = allocator.alloc_addr(bytes,alignment);
+			if (addr==tlsf_t::invalid_address)
+				continue;
+			NBL_CHECK(addr%alignment==0u);
+			NBL_CHECK(addr+bytes<=BufferSize);
+			const auto next = live.lower_bound(addr);
+			NBL_CHECK(next==live.end() || next->first>=addr+bytes);
+			NBL_CHECK(next==live.begin() || std::prev(next)->first+std::prev(next)->second<=addr);
+			live[addr] = bytes;
+		}
+		else
+		{
+			auto victim = live.begin();
+			std::advance(victim,rng()%live.size());
+			NBL_CHECK(!allocator.is_double_free(victim->first,victim->second));
+			allocator.free_addr(victim->first,victim->second);
+			live.erase(victim);
+		}
+	}
+	uint32_t used = 0u;
+	for (const auto& entry : live)
+		used += core::roundUp(entry.second,MinBlockSize);
+	NBL_CHECK(used==allocator.get_allocated_size());
+
+	// grow into a new reserved space, then free everything, it all has to coalesce back
+	void* grownReserved = _NBL_ALIGNED_MALLOC(tlsf_t::reserved_size(MaxAlignment,BufferSize*2u,MinBlockSize),_NBL_SIMD_ALIGNMENT);
+	{
+		tlsf_t grown(BufferSize*2u,std::move(allocator),grownReserved);
+		NBL_CHECK(grown.get_allocated_size()==used && grown.get_free_size()==BufferSize*2u-used);
+		for (const auto& entry : live)
+			grown.free_addr(entry.first,entry.second);
+		NBL_CHECK(grown.get_free_size()==BufferSize*2u);
+		NBL_CHECK(grown.alloc_addr(BufferSize*2u,MinBlockSize)==0u);
+	}
+	_NBL_ALIGNED_FREE(grownReserved);
+	return true;
+}
+
+template<class AddressAllocator>
+static void benchmark(const char* name)
+{
+	SAllocatorWithReserved<AddressAllocator> wrapper(BufferSize);
+	auto& allocator = wrapper.allocator;
+
+	std::mt19937 rng(7u);
+	core::vector<std::pair<uint32_t,uint32_t>> live;
+	double total = 0.0, worst = 0.0;
+	size_t allocations = 0u, failures = 0u;
+	for (uint32_t it=0u; it<1000000u; it++)
+	{
+		if (live.empty() || rng()%100u<55u)
+		{
+			const uint32_t bytes = 1u+rng()%(rng()%16u==0u ? (512u<<10u):16384u);
+			const auto start = std::chrono::high_resolution_clock::now();
+			const auto addr = allocator.alloc_addr(bytes,MinBlockSize);
+			const double us = std::chrono::duration<double,std::micro>(std::chrono::high_resolution_clock::now()-start).count();
+			total += us;
+			worst = std::max(worst,us);
+			allocations++;
+			if (addr==AddressAllocator::invalid_address)
+				failures++;
+			else
+				live.emplace_back(addr,bytes);
+		}
+		else
+		{
+			const size_t i = rng()%live.size();
+			allocator.free_addr(live[i].first,live[i].second);
+			live[i] = live.back();
+			live.pop_back();
+		}
+	}
+	printf("%s: alloc_addr average %.3fus, worst %.1fus, %zu of %zu allocations failed\n",name,total/double(allocations),worst,failures,allocations);
+}
+
+int main()
+{
+	if (!check())
+		return 1;
+	printf("TLSF checks passed\n");
+	benchmark<core::GeneralpurposeAddressAllocator<uint32_t>>("GeneralpurposeAddressAllocator");
+	benchmark<core::TLSFAddressAllocator<uint32_t>>("TLSFAddressAllocator");
+	return 0;
+}
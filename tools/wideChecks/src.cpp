@@ -0,0 +1,135 @@
+// Copyright (C) 2018-2023 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+// Standalone checks and benchmark of `nbl/builtin/hlsl/cpp_compat/wide.h` on the colorspace transfer functions, build against the Nabla include
+// directory (with optimizations) and run, exits with non-zero if any lane of a 1, 4, 5, 8 or native lane count batch isn't bit-identical to
+// the `T=float` instantiation. Inputs are random with +-0, denormals, NaN, +-inf and the segment knees mixed in.
+// Build it once for SSE and once with `-mavx2` (or `/arch:AVX2`) to cover both register widths. When FMA is enabled too, also pass
+// `-ffp-contract=off`: GCC and Clang contract the multiplies and adds of the scalar reference into FMAs otherwise, which `wide` never does,
+// and the last bits differ. Afterwards it prints how long the sRGB OETF and the HLG EOTF take per value and per batch.
+
+#include "nbl/core/definitions.h"
+#include "nbl/builtin/hlsl/cpp_compat/wide.h"
+#include "nbl/builtin/hlsl/colorspace/EOTF.hlsl"
+#include "nbl/builtin/hlsl/colorspace/OETF.hlsl"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+
+using namespace nbl::hlsl;
+
+// the documented way to write a batch callable, has to keep compiling with `const` arguments
+static_assert(std::is_same_v<mask_type_t<const wide<float,4> >,wide_mask<float,4> >);
+static_assert(std::is_same_v<scalar_type_t<const wide<float,4> >,float>);
+
+static std::vector<float> makeInput(const size_t count)
+{
+	std::mt19937 rng(7u);
+	std::uniform_real_distribution<float> dist(-0.5f,2.f);
+	std::vector<float> retval(count);
+	for (auto& value : retval)
+		value = dist(rng);
+	constexpr float Special[] = {
+		0.f,-0.f,1.f,-1.f,1e-30f,std::numeric_limits<float>::denorm_min(),65504.f,1e30f,
+		std::numeric_limits<float>::quiet_NaN(),std::numeric_limits<float>::infinity(),-std::numeric_limits<float>::infinity(),
+		0.5f,0.0031308f,0.04045f,0.018053968510808f,1.f/12.f
+	};
+	for (size_t i=0u; i<std::size(Special); i++)
+		retval[i*7u] = Special[i];
+	return retval;
+}
+
+template<typename F>
+static bool check(const char* name, F&& f)
+{
+	// not a multiple of any lane count, so the padded tails get covered
+	constexpr size_t Count = 3u*1001u;
+	const auto input = makeInput(Count);
+	std::vector<float> reference(Count);
+	for (size_t i=0u; i<Count; i++)
+		reference[i] = f(input[i]);
+
+	std::vector<float> outputs[5];
+	for (auto& output : outputs)
+		output.resize(Count);
+	batch_evaluate<1>(input.data(),outputs[0].data(),Count,f);
+	batch_evaluate<4>(input.data(),outputs[1].data(),Count,f);
+	batch_evaluate<5>(input.data(),outputs[2].data(),Count,f);
+	batch_evaluate<8>(input.data(),outputs[3].data(),Count,f);
+	// native lane count, in place
+	outputs[4] = input;
+	batch_evaluate(outputs[4].data(),outputs[4].data(),Count,f);
+
+	constexpr const char* OutputNames[] = {"1 lane","4 lanes","5 lanes","8 lanes","native lanes in place"};
+	bool success = true;
+	for (uint32_t o=0u; o<std::size(outputs); o++)
+	for (size_t i=0u; i<Count; i++)
+	if (memcmp(&outputs[o][i],&reference[i],sizeof(float)))
+	{
+		printf("FAILED: %s with %s differs at %zu, in %a, expected %a, got %a\n",name,OutputNames[o],i,input[i],reference[i],outputs[o][i]);
+		success = false;
+		break;
+	}
+	return success;
+}
+
+#define NBL_CHECK_TRANSFER_FUNCTION(NAMESPACE,FUNCTION) success = check(#NAMESPACE "::" #FUNCTION,[](const auto v){return colorspace::NAMESPACE::FUNCTION<std::remove_cvref_t<decltype(v)> >(v);}) && success
+
+template<typename F>
+static void benchmark(const char* name, F&& f)
+{
+	const size_t count = 3u<<20u;
+	const auto input = makeInput(count);
+	std::vector<float> output(count);
+	auto time = [](auto&& work) -> double
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		work();
+		return std::chrono::duration<double,std::milli>(std::chrono::high_resolution_clock::now()-start).count();
+	};
+	const double scalarMs = time([&]() -> void {for (size_t i=0u; i<count; i++) output[i] = f(input[i]);});
+	const double wide4Ms = time([&]() -> void {batch_evaluate<4>(input.data(),output.data(),count,f);});
+	const double wide8Ms = time([&]() -> void {batch_evaluate<8>(input.data(),output.data(),count,f);});
+	printf("%s on %zu values: float %.2fms, wide<float,4> %.2fms (%.2fx), wide<float,8> %.2fms (%.2fx)\n",
+		name,count,scalarMs,wide4Ms,scalarMs/wide4Ms,wide8Ms,scalarMs/wide8Ms);
+}
+
+int main()
+{
+	printf("%u native lanes\n",uint32_t(wide_native_lanes<float>));
+	bool success = true;
+	NBL_CHECK_TRANSFER_FUNCTION(eotf,identity);
+	NBL_CHECK_TRANSFER_FUNCTION(eotf,sRGB);
+	NBL_CHECK_TRANSFER_FUNCTION(eotf,Display_P3);
+	NBL_CHECK_TRANSFER_FUNCTION(eotf,DCI_P3_XYZ);
+	NBL_CHECK_TRANSFER_FUNCTION(eotf,SMPTE_170M);
+	NBL_CHECK_TRANSFER_FUNCTION(eotf,SMPTE_ST2084);
+	NBL_CHECK_TRANSFER_FUNCTION(eotf,HDR10_HLG);
+	NBL_CHECK_TRANSFER_FUNCTION(eotf,AdobeRGB);
+	NBL_CHECK_TRANSFER_FUNCTION(eotf,Gamma_2_2);
+	NBL_CHECK_TRANSFER_FUNCTION(eotf,ACEScc);
+	NBL_CHECK_TRANSFER_FUNCTION(eotf,ACEScct);
+	NBL_CHECK_TRANSFER_FUNCTION(oetf,identity);
+	NBL_CHECK_TRANSFER_FUNCTION(oetf,sRGB);
+	NBL_CHECK_TRANSFER_FUNCTION(oetf,Display_P3);
+	NBL_CHECK_TRANSFER_FUNCTION(oetf,DCI_P3_XYZ);
+	NBL_CHECK_TRANSFER_FUNCTION(oetf,SMPTE_170M);
+	NBL_CHECK_TRANSFER_FUNCTION(oetf,SMPTE_ST2084);
+	NBL_CHECK_TRANSFER_FUNCTION(oetf,HDR10_HLG);
+	NBL_CHECK_TRANSFER_FUNCTION(oetf,AdobeRGB);
+	NBL_CHECK_TRANSFER_FUNCTION(oetf,Gamma_2_2);
+	NBL_CHECK_TRANSFER_FUNCTION(oetf,ACEScc);
+	NBL_CHECK_TRANSFER_FUNCTION(oetf,ACEScct);
+	if (!success)
+		return 1;
+	printf("all transfer functions bit-identical\n");
+
+	benchmark("oetf::sRGB",[](const auto v){return colorspace::oetf::sRGB<std::remove_cvref_t<decltype(v)> >(v);});
+	benchmark("eotf::HDR10_HLG",[](const auto v){return colorspace::eotf::HDR10_HLG<std::remove_cvref_t<decltype(v)> >(v);});
+	return 0;
+}